@@ -203,6 +203,44 @@ public:
     }
   }
 
+ /// \short Value of the i-th scalar field (as written by
+ /// scalar_value_paraview(...)) at local coordinate s. Used by the 
+ /// elements that opt in to the direct evaluation of the scalars in the
+ /// binary output (see FiniteElement::interpolated_scalar_paraview(...))
+ double interpolated_scalar_adv_diff_paraview(const Vector<double>& s,
+                                              const unsigned& i) const
+  {
+   double value=0.0;
+   if(i<DIM) 
+    {
+     // Get Eulerian coordinate
+     Vector<double> x(DIM);
+     interpolated_x(s,x);
+
+     // Get the wind
+     Vector<double> wind(DIM);
+     unsigned ipt=0;
+     get_wind_adv_diff(ipt,s,x,wind);
+     value=wind[i];
+    }
+   else if(i==DIM)
+    {
+     value=interpolated_u_adv_diff(s);
+    }
+   else 
+    {
+     std::stringstream error_stream;
+     error_stream 
+      << "Advection Diffusion Elements only store " << DIM+1 << " fields "
+      << std::endl;
+     throw OomphLibError(
+      error_stream.str(),
+      OOMPH_CURRENT_FUNCTION,
+      OOMPH_EXCEPTION_LOCATION);
+    }
+   return value;
+  }
+
  /// \short Name of the i-th scalar field. Default implementation
  /// returns V1 for the first one, V2 for the second etc. Can (should!) be
  /// overloaded with more meaningful names in specific elements.
@@ -596,6 +634,22 @@ private:
   AdvectionDiffusionEquations<DIM>()
   { }
 
+ /// \short Evaluate the scalars for the binary paraview output directly
+ /// (unless a derived element outputs a different number of them)
+ bool interpolated_scalar_paraview(const Vector<double>& s,
+                                   const unsigned& i,
+                                   double& value) const
+  {
+   if (this->nscalar_paraview()!=
+       AdvectionDiffusionEquations<DIM>::nscalar_paraview())
+    {
+     return false;
+    }
+   value=AdvectionDiffusionEquations<DIM>::
+    interpolated_scalar_adv_diff_paraview(s,i);
+   return true;
+  }
+
  /// Broken copy constructor
  QAdvectionDiffusionElement(const QAdvectionDiffusionElement<DIM,NNODE_1D>& 
                             dummy) 
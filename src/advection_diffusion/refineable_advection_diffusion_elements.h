@@ -378,6 +378,16 @@ public QAdvectionDiffusionElement<DIM,NNODE_1D>,
  /// Number of continuously interpolated values: 1
  unsigned ncont_interpolated_values() const {return 1;}
 
+ /// \short The unknown is interpolated isoparametrically from its 
+ /// nodal values, so it can be transferred to the sons with a 
+ /// precomputed interpolation matrix during refinement
+ bool get_isoparametric_value_indices(Vector<unsigned>& value_index) const
+  {
+   value_index.resize(1);
+   value_index[0]=this->u_index_adv_diff();
+   return true;
+  }
+
  /// \short Number of vertex nodes in the element
  unsigned nvertex_node() const
   {return QAdvectionDiffusionElement<DIM,NNODE_1D>::nvertex_node();}
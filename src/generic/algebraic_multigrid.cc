@@ -0,0 +1,846 @@
+//LIC// ====================================================================
+//LIC// This file forms part of oomph-lib, the object-oriented, 
+//LIC// multi-physics finite-element library, available 
+//LIC// at http://www.oomph-lib.org.
+//LIC// 
+//LIC// Copyright (C) 2006-2021 Matthias Heil and Andrew Hazel
+//LIC// 
+//LIC// This library is free software; you can redistribute it and/or
+//LIC// modify it under the terms of the GNU Lesser General Public
+//LIC// License as published by the Free Software Foundation; either
+//LIC// version 2.1 of the License, or (at your option) any later version.
+//LIC// 
+//LIC// This library is distributed in the hope that it will be useful,
+//LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//LIC// Lesser General Public License for more details.
+//LIC// 
+//LIC// You should have received a copy of the GNU Lesser General Public
+//LIC// License along with this library; if not, write to the Free Software
+//LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//LIC// 02110-1301  USA.
+//LIC// 
+//LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+//LIC// 
+//LIC//====================================================================
+// Config header generated by autoconfig
+#ifdef HAVE_CONFIG_H
+  #include <oomph-lib-config.h>
+#endif
+
+#include "algebraic_multigrid.h"
+
+
+namespace oomph
+{
+
+
+//=============================================================================
+/// \short Setup the preconditioner: Build (or, if enabled and possible,
+/// reuse) the multigrid hierarchy for the matrix pointed to by matrix_pt().
+//=============================================================================
+void AggregationAMGPreconditioner::setup()
+{
+ // cast the Double Base Matrix to Compressed Row Double Matrix
+ CRDoubleMatrix* cr_matrix_pt = dynamic_cast<CRDoubleMatrix*>(matrix_pt());
+
+#ifdef PARANOID
+ if (cr_matrix_pt == 0)
+  {
+   std::ostringstream error_msg;
+   error_msg << "AggregationAMGPreconditioner only works with "
+             << "CRDoubleMatrix matrices.";
+   throw OomphLibError(error_msg.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ if (cr_matrix_pt->nrow() != cr_matrix_pt->ncol())
+  {
+   std::ostringstream error_msg;
+   error_msg << "AggregationAMGPreconditioner can only be applied to "
+             << "square matrices. The matrix has " << cr_matrix_pt->nrow()
+             << " rows and " << cr_matrix_pt->ncol() << " columns.";
+   throw OomphLibError(error_msg.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ // if the matrix is distributed then build global version
+ bool built_global = false;
+ if (cr_matrix_pt->distributed())
+  {
+   // get the global matrix
+   cr_matrix_pt = cr_matrix_pt->global_matrix();
+
+   // set the flag so we can delete later
+   built_global = true;
+  }
+
+ // store the Distribution
+ this->build_distribution(cr_matrix_pt->distribution_pt());
+
+ double t_start=TimingHelpers::timer();
+
+ // Can we reuse the existing hierarchy?
+ Hierarchy_has_been_reused=false;
+ if (Reuse_hierarchy && (Nlevel>0) && same_sparsity_pattern(*cr_matrix_pt))
+  {
+   // Overwrite the values in the copy of the fine-level matrix
+   const double* value_pt=cr_matrix_pt->value();
+   double* fine_value_pt=Matrix_pt[0]->value();
+   unsigned long n_nz=cr_matrix_pt->nnz();
+   for (unsigned long k=0;k<n_nz;k++)
+    {
+     fine_value_pt[k]=value_pt[k];
+    }
+
+   // Recompute the Galerkin coarse operators with the existing
+   // transfer operators
+   for (unsigned l=0;l<Nlevel-1;l++)
+    {
+     build_coarse_operator(l);
+    }
+
+   Hierarchy_has_been_reused=true;
+  }
+ // Build the hierarchy from scratch
+ else
+  {
+   // Wipe the old hierarchy
+   clean_up_memory();
+
+   // Take a copy of the fine-level matrix
+   Matrix_pt.push_back(new CRDoubleMatrix(*cr_matrix_pt));
+
+   // Coarsen until the matrix is small enough
+   unsigned level=0;
+   while ((Matrix_pt[level]->nrow()>Max_coarse_size) &&
+          (level+1<Max_nlevel))
+    {
+     // Build the aggregates
+     Vector<unsigned> aggregate_index;
+     unsigned n_aggregate=build_aggregates(level,aggregate_index);
+
+     // Stop if the coarsening has stagnated
+     if ((n_aggregate==0) || (n_aggregate>=Matrix_pt[level]->nrow()))
+      {
+       break;
+      }
+
+     // Build the transfer operators and the coarse operator
+     build_transfer_operators(level,aggregate_index,n_aggregate);
+     build_coarse_operator(level);
+     level++;
+    }
+   Nlevel=level+1;
+  }
+
+ // Setup the smoothers and factorise the coarsest matrix
+ setup_smoothers_and_coarse_solver();
+
+ // Doc
+ if (Doc_hierarchy)
+  {
+   oomph_info << "AggregationAMGPreconditioner: ";
+   if (Hierarchy_has_been_reused)
+    {
+     oomph_info << "Reused ";
+    }
+   else
+    {
+     oomph_info << "Built ";
+    }
+   oomph_info << "hierarchy with " << Nlevel << " levels; nrow: ";
+   for (unsigned l=0;l<Nlevel;l++)
+    {
+     oomph_info << Matrix_pt[l]->nrow() << " ";
+    }
+   oomph_info << "; operator complexity: " << operator_complexity()
+              << "; setup time [sec]: " << TimingHelpers::timer()-t_start
+              << std::endl;
+  }
+
+ // delete the global matrix if it has been built
+ if (built_global)
+  {
+   delete cr_matrix_pt;
+  }
+}
+
+
+//=============================================================================
+/// \short Does the matrix have the same sparsity pattern as the finest
+/// matrix in the current hierarchy?
+//=============================================================================
+bool AggregationAMGPreconditioner::same_sparsity_pattern(
+ const CRDoubleMatrix& matrix) const
+{
+ const CRDoubleMatrix* fine_matrix_pt=Matrix_pt[0];
+ if ((matrix.nrow()!=fine_matrix_pt->nrow()) ||
+     (matrix.ncol()!=fine_matrix_pt->ncol()) ||
+     (matrix.nnz()!=fine_matrix_pt->nnz()))
+  {
+   return false;
+  }
+
+ // Compare the row starts...
+ unsigned long n_row=matrix.nrow();
+ const int* row_start=matrix.row_start();
+ const int* fine_row_start=fine_matrix_pt->row_start();
+ for (unsigned long i=0;i<=n_row;i++)
+  {
+   if (row_start[i]!=fine_row_start[i])
+    {
+     return false;
+    }
+  }
+
+ // ...and the column indices
+ unsigned long n_nz=matrix.nnz();
+ const int* column_index=matrix.column_index();
+ const int* fine_column_index=fine_matrix_pt->column_index();
+ for (unsigned long k=0;k<n_nz;k++)
+  {
+   if (column_index[k]!=fine_column_index[k])
+    {
+     return false;
+    }
+  }
+ return true;
+}
+
+
+//=============================================================================
+/// \short Build aggregates for the matrix on level "level": On return 
+/// aggregate_index[i] contains the (coarse) index of the aggregate that 
+/// contains unknown i; the number of aggregates is returned. Unknowns
+/// that are not strongly connected to any other unknowns (e.g. rows
+/// that only contain a diagonal entry) are not aggregated; their 
+/// aggregate index is set to a value that is larger than the number of
+/// aggregates. The aggregation follows the standard three-pass greedy
+/// algorithm of Vanek, Mandel & Brezina (Computing 56, 1996).
+//=============================================================================
+unsigned AggregationAMGPreconditioner::build_aggregates(
+ const unsigned& level, Vector<unsigned>& aggregate_index) const
+{
+ const CRDoubleMatrix* matrix_pt=Matrix_pt[level];
+ unsigned n_row=matrix_pt->nrow();
+ const int* row_start=matrix_pt->row_start();
+ const int* column_index=matrix_pt->column_index();
+ const double* value=matrix_pt->value();
+
+ // Get the absolute values of the diagonal entries
+ Vector<double> abs_diag(n_row,0.0);
+ for (unsigned i=0;i<n_row;i++)
+  {
+   for (int k=row_start[i];k<row_start[i+1];k++)
+    {
+     if (unsigned(column_index[k])==i)
+      {
+       abs_diag[i]+=std::fabs(value[k]);
+      }
+    }
+  }
+
+ // Identify the strong connections
+ std::vector<bool> is_strong(matrix_pt->nnz(),false);
+ std::vector<bool> is_isolated(n_row,true);
+ double theta_squared=Strength_threshold*Strength_threshold;
+ for (unsigned i=0;i<n_row;i++)
+  {
+   for (int k=row_start[i];k<row_start[i+1];k++)
+    {
+     unsigned j=column_index[k];
+     if ((j!=i) && (value[k]!=0.0) &&
+         (value[k]*value[k]>=theta_squared*abs_diag[i]*abs_diag[j]))
+      {
+       is_strong[k]=true;
+       is_isolated[i]=false;
+      }
+    }
+  }
+
+ // Flags for unknowns that haven't been aggregated and isolated unknowns
+ const unsigned not_aggregated=n_row;
+ const unsigned isolated=n_row+1;
+ aggregate_index.assign(n_row,not_aggregated);
+ unsigned n_aggregate=0;
+
+ // Pass 1: Create aggregates from unaggregated unknowns whose strong
+ // neighbours haven't been aggregated either
+ for (unsigned i=0;i<n_row;i++)
+  {
+   if (is_isolated[i])
+    {
+     aggregate_index[i]=isolated;
+     continue;
+    }
+   if (aggregate_index[i]!=not_aggregated)
+    {
+     continue;
+    }
+   bool neighbourhood_is_free=true;
+   for (int k=row_start[i];k<row_start[i+1];k++)
+    {
+     if (is_strong[k] && (aggregate_index[column_index[k]]!=not_aggregated))
+      {
+       neighbourhood_is_free=false;
+       break;
+      }
+    }
+   if (neighbourhood_is_free)
+    {
+     aggregate_index[i]=n_aggregate;
+     for (int k=row_start[i];k<row_start[i+1];k++)
+      {
+       if (is_strong[k])
+        {
+         aggregate_index[column_index[k]]=n_aggregate;
+        }
+      }
+     n_aggregate++;
+    }
+  }
+
+ // Pass 2: Add the remaining unknowns to the aggregate of their
+ // most strongly connected neighbour (only consider the aggregates 
+ // formed in pass 1)
+ Vector<unsigned> pass_one_aggregate_index(aggregate_index);
+ for (unsigned i=0;i<n_row;i++)
+  {
+   if (aggregate_index[i]!=not_aggregated)
+    {
+     continue;
+    }
+   double max_connection=0.0;
+   for (int k=row_start[i];k<row_start[i+1];k++)
+    {
+     unsigned agg=pass_one_aggregate_index[column_index[k]];
+     if (is_strong[k] && (agg<n_aggregate) &&
+         (std::fabs(value[k])>max_connection))
+      {
+       max_connection=std::fabs(value[k]);
+       aggregate_index[i]=agg;
+      }
+    }
+  }
+
+ // Pass 3: Create new aggregates from the remaining unknowns and their
+ // unaggregated strong neighbours
+ for (unsigned i=0;i<n_row;i++)
+  {
+   if (aggregate_index[i]!=not_aggregated)
+    {
+     continue;
+    }
+   aggregate_index[i]=n_aggregate;
+   for (int k=row_start[i];k<row_start[i+1];k++)
+    {
+     if (is_strong[k] && (aggregate_index[column_index[k]]==not_aggregated))
+      {
+       aggregate_index[column_index[k]]=n_aggregate;
+      }
+    }
+   n_aggregate++;
+  }
+
+ return n_aggregate;
+}
+
+
+//=============================================================================
+/// \short Build the (possibly smoothed) prolongation operator and the 
+/// restriction operator for the transfer between level "level" and 
+/// level+1 from the aggregates. The tentative prolongator P_tent
+/// is piecewise constant on the aggregates; if required it is smoothed 
+/// by one damped Jacobi sweep: P = (I - omega D^{-1} A) P_tent 
+/// where omega = Prolongation_damping_factor / rho and rho is the 
+/// (Gershgorin) upper bound for the spectral radius of D^{-1} A. 
+/// The restriction operator is the transpose of P.
+//=============================================================================
+void AggregationAMGPreconditioner::build_transfer_operators(
+ const unsigned& level, const Vector<unsigned>& aggregate_index,
+ const unsigned& n_aggregate)
+{
+ const CRDoubleMatrix* matrix_pt=Matrix_pt[level];
+ unsigned n_row=matrix_pt->nrow();
+ const int* row_start=matrix_pt->row_start();
+ const int* column_index=matrix_pt->column_index();
+ const double* value=matrix_pt->value();
+
+ // Storage for the prolongation operator in CR format
+ Vector<double> p_value;
+ Vector<int> p_column_index;
+ Vector<int> p_row_start(n_row+1,0);
+
+ // Piecewise constant tentative prolongator
+ if (!Smooth_prolongation)
+  {
+   p_value.reserve(n_row);
+   p_column_index.reserve(n_row);
+   for (unsigned i=0;i<n_row;i++)
+    {
+     if (aggregate_index[i]<n_aggregate)
+      {
+       p_value.push_back(1.0);
+       p_column_index.push_back(aggregate_index[i]);
+      }
+     p_row_start[i+1]=p_value.size();
+    }
+  }
+ // Smoothed prolongator
+ else
+  {
+   // Get the diagonal entries and the Gershgorin bound for the spectral
+   // radius of D^{-1} A
+   Vector<double> diag(n_row,0.0);
+   for (unsigned i=0;i<n_row;i++)
+    {
+     for (int k=row_start[i];k<row_start[i+1];k++)
+      {
+       if (unsigned(column_index[k])==i)
+        {
+         diag[i]+=value[k];
+        }
+      }
+    }
+   double rho=0.0;
+   for (unsigned i=0;i<n_row;i++)
+    {
+     if (diag[i]!=0.0)
+      {
+       double row_sum=0.0;
+       for (int k=row_start[i];k<row_start[i+1];k++)
+        {
+         row_sum+=std::fabs(value[k]);
+        }
+       rho=std::max(rho,row_sum/std::fabs(diag[i]));
+      }
+    }
+   double omega=0.0;
+   if (rho>0.0)
+    {
+     omega=Prolongation_damping_factor/rho;
+    }
+
+   // Marker for the position of the coarse column in the current row
+   // of P (-1 if not present yet)
+   Vector<int> position(n_aggregate,-1);
+   p_value.reserve(matrix_pt->nnz());
+   p_column_index.reserve(matrix_pt->nnz());
+   for (unsigned i=0;i<n_row;i++)
+    {
+     unsigned row_begin=p_value.size();
+
+     // Contribution from the identity
+     if (aggregate_index[i]<n_aggregate)
+      {
+       position[aggregate_index[i]]=p_value.size();
+       p_value.push_back(1.0);
+       p_column_index.push_back(aggregate_index[i]);
+      }
+
+     // Contribution from -omega D^{-1} A
+     if (diag[i]!=0.0)
+      {
+       double factor=-omega/diag[i];
+       for (int k=row_start[i];k<row_start[i+1];k++)
+        {
+         unsigned agg=aggregate_index[column_index[k]];
+         if (agg<n_aggregate)
+          {
+           if (position[agg]<0)
+            {
+             position[agg]=p_value.size();
+             p_value.push_back(factor*value[k]);
+             p_column_index.push_back(agg);
+            }
+           else
+            {
+             p_value[position[agg]]+=factor*value[k];
+            }
+          }
+        }
+      }
+
+     // Reset the markers
+     unsigned row_end=p_value.size();
+     for (unsigned k=row_begin;k<row_end;k++)
+      {
+       position[p_column_index[k]]=-1;
+      }
+     p_row_start[i+1]=row_end;
+    }
+  }
+
+ // The restriction operator is the transpose of the prolongation
+ // operator
+ unsigned p_nnz=p_value.size();
+ Vector<double> r_value(p_nnz);
+ Vector<int> r_column_index(p_nnz);
+ Vector<int> r_row_start(n_aggregate+1,0);
+ for (unsigned k=0;k<p_nnz;k++)
+  {
+   r_row_start[p_column_index[k]+1]++;
+  }
+ for (unsigned j=0;j<n_aggregate;j++)
+  {
+   r_row_start[j+1]+=r_row_start[j];
+  }
+ Vector<int> next(n_aggregate);
+ for (unsigned j=0;j<n_aggregate;j++)
+  {
+   next[j]=r_row_start[j];
+  }
+ for (unsigned i=0;i<n_row;i++)
+  {
+   for (int k=p_row_start[i];k<p_row_start[i+1];k++)
+    {
+     int pos=next[p_column_index[k]]++;
+     r_value[pos]=p_value[k];
+     r_column_index[pos]=i;
+    }
+  }
+
+ // Build the matrices
+ const OomphCommunicator* comm_pt=
+  matrix_pt->distribution_pt()->communicator_pt();
+ LinearAlgebraDistribution fine_dist(comm_pt,n_row,false);
+ LinearAlgebraDistribution coarse_dist(comm_pt,n_aggregate,false);
+ Prolongation_matrix_pt.push_back(
+  new CRDoubleMatrix(&fine_dist,n_aggregate,p_value,
+                     p_column_index,p_row_start));
+ Restriction_matrix_pt.push_back(
+  new CRDoubleMatrix(&coarse_dist,n_row,r_value,
+                     r_column_index,r_row_start));
+}
+
+
+//=============================================================================
+/// \short Form the Galerkin coarse operator R A P on level+1 from the 
+/// matrix and the transfer operators on level "level". Any existing
+/// coarse operator on level+1 is deleted.
+//=============================================================================
+void AggregationAMGPreconditioner::build_coarse_operator(
+ const unsigned& level)
+{
+ CRDoubleMatrix a_times_p;
+ Matrix_pt[level]->multiply(*Prolongation_matrix_pt[level],a_times_p);
+ CRDoubleMatrix* coarse_matrix_pt=new CRDoubleMatrix;
+ Restriction_matrix_pt[level]->multiply(a_times_p,*coarse_matrix_pt);
+
+ if (Matrix_pt.size()>level+1)
+  {
+   delete Matrix_pt[level+1];
+   Matrix_pt[level+1]=coarse_matrix_pt;
+  }
+ else
+  {
+   Matrix_pt.push_back(coarse_matrix_pt);
+  }
+}
+
+
+//=============================================================================
+/// \short Setup the smoothers (inverse diagonals) on all levels, allocate
+/// the work storage for the V-cycles and factorise the coarsest matrix.
+//=============================================================================
+void AggregationAMGPreconditioner::setup_smoothers_and_coarse_solver()
+{
+ Inv_diag.resize(Nlevel);
+ Residual.resize(Nlevel);
+ Coarse_rhs.resize(Nlevel);
+ Coarse_correction.resize(Nlevel);
+ for (unsigned l=0;l<Nlevel;l++)
+  {
+   const CRDoubleMatrix* matrix_pt=Matrix_pt[l];
+   unsigned n_row=matrix_pt->nrow();
+   const int* row_start=matrix_pt->row_start();
+   const int* column_index=matrix_pt->column_index();
+   const double* value=matrix_pt->value();
+
+   // Rows with zero diagonal are left alone by the smoothers
+   Inv_diag[l].assign(n_row,0.0);
+   for (unsigned i=0;i<n_row;i++)
+    {
+     double diag=0.0;
+     for (int k=row_start[i];k<row_start[i+1];k++)
+      {
+       if (unsigned(column_index[k])==i)
+        {
+         diag+=value[k];
+        }
+      }
+     if (diag!=0.0)
+      {
+       Inv_diag[l][i]=1.0/diag;
+      }
+    }
+
+   Residual[l].resize(n_row);
+   Coarse_rhs[l].resize(n_row);
+   Coarse_correction[l].resize(n_row);
+  }
+
+ // Factorise the coarsest matrix
+ Coarse_solver.clean_up_memory();
+ Coarse_solver.factorise(Matrix_pt[Nlevel-1]);
+}
+
+
+//=============================================================================
+/// Compute y = A x for the serial CRDoubleMatrix A
+//=============================================================================
+void AggregationAMGPreconditioner::multiply(const CRDoubleMatrix& matrix,
+                                            const Vector<double>& x,
+                                            Vector<double>& y)
+{
+ unsigned n_row=matrix.nrow();
+ const int* row_start=matrix.row_start();
+ const int* column_index=matrix.column_index();
+ const double* value=matrix.value();
+ for (unsigned i=0;i<n_row;i++)
+  {
+   double sum=0.0;
+   for (int k=row_start[i];k<row_start[i+1];k++)
+    {
+     sum+=value[k]*x[column_index[k]];
+    }
+   y[i]=sum;
+  }
+}
+
+
+//=============================================================================
+/// \short Perform nsweep smoothing sweeps on level "level" for the
+/// rhs b. Gauss-Seidel sweeps are performed in forward direction 
+/// for pre-smoothing and in backward direction for post-smoothing
+/// so that the V-cycle is symmetric for symmetric matrices.
+//=============================================================================
+void AggregationAMGPreconditioner::smooth(const unsigned& level, 
+                                          const unsigned& nsweep,
+                                          const Vector<double>& b,
+                                          Vector<double>& x,
+                                          const bool& pre_smooth)
+{
+ const CRDoubleMatrix* matrix_pt=Matrix_pt[level];
+ int n_row=matrix_pt->nrow();
+ const int* row_start=matrix_pt->row_start();
+ const int* column_index=matrix_pt->column_index();
+ const double* value=matrix_pt->value();
+ const Vector<double>& inv_diag=Inv_diag[level];
+
+ for (unsigned sweep=0;sweep<nsweep;sweep++)
+  {
+   if (Smoother==Jacobi)
+    {
+     Vector<double>& res=Residual[level];
+     multiply(*matrix_pt,x,res);
+     for (int i=0;i<n_row;i++)
+      {
+       x[i]+=Jacobi_damping_factor*inv_diag[i]*(b[i]-res[i]);
+      }
+    }
+   else
+    {
+     int first=0;
+     int last=n_row;
+     int increment=1;
+     if (!pre_smooth)
+      {
+       first=n_row-1;
+       last=-1;
+       increment=-1;
+      }
+     for (int i=first;i!=last;i+=increment)
+      {
+       if (inv_diag[i]!=0.0)
+        {
+         double sum=b[i];
+         for (int k=row_start[i];k<row_start[i+1];k++)
+          {
+           sum-=value[k]*x[column_index[k]];
+          }
+         x[i]+=inv_diag[i]*sum;
+        }
+      }
+    }
+  }
+}
+
+
+//=============================================================================
+/// \short Perform one V-cycle on level "level" for the rhs b, 
+/// starting from the initial guess x.
+//=============================================================================
+void AggregationAMGPreconditioner::v_cycle(const unsigned& level, 
+                                           const Vector<double>& b,
+                                           Vector<double>& x)
+{
+ const CRDoubleMatrix* matrix_pt=Matrix_pt[level];
+ unsigned n_row=matrix_pt->nrow();
+
+ // Direct solve on the coarsest level
+ if (level==Nlevel-1)
+  {
+   DoubleVector rhs(matrix_pt->distribution_pt(),0.0);
+   double* rhs_pt=rhs.values_pt();
+   for (unsigned i=0;i<n_row;i++)
+    {
+     rhs_pt[i]=b[i];
+    }
+   DoubleVector soln;
+   Coarse_solver.resolve(rhs,soln);
+   const double* soln_pt=soln.values_pt();
+   for (unsigned i=0;i<n_row;i++)
+    {
+     x[i]=soln_pt[i];
+    }
+   return;
+  }
+
+ // Pre-smoothing
+ smooth(level,Npre_smooth,b,x,true);
+
+ // Compute the residual...
+ Vector<double>& res=Residual[level];
+ multiply(*matrix_pt,x,res);
+ for (unsigned i=0;i<n_row;i++)
+  {
+   res[i]=b[i]-res[i];
+  }
+
+ // ...restrict it...
+ Vector<double>& coarse_rhs=Coarse_rhs[level+1];
+ multiply(*Restriction_matrix_pt[level],res,coarse_rhs);
+
+ // ...solve the coarse problem (recursively)...
+ Vector<double>& coarse_correction=Coarse_correction[level+1];
+ std::fill(coarse_correction.begin(),coarse_correction.end(),0.0);
+ v_cycle(level+1,coarse_rhs,coarse_correction);
+
+ // ...and add the prolongated correction
+ const CRDoubleMatrix* p_matrix_pt=Prolongation_matrix_pt[level];
+ const int* row_start=p_matrix_pt->row_start();
+ const int* column_index=p_matrix_pt->column_index();
+ const double* value=p_matrix_pt->value();
+ for (unsigned i=0;i<n_row;i++)
+  {
+   for (int k=row_start[i];k<row_start[i+1];k++)
+    {
+     x[i]+=value[k]*coarse_correction[column_index[k]];
+    }
+  }
+
+ // Post-smoothing
+ smooth(level,Npost_smooth,b,x,false);
+}
+
+
+//=============================================================================
+/// Apply preconditioner (Nvcycle V-cycles) to r, i.e. z=P^{-1} r
+//=============================================================================
+void AggregationAMGPreconditioner::preconditioner_solve(const DoubleVector& r,
+                                                        DoubleVector& z)
+{
+#ifdef PARANOID
+ if (Nlevel==0)
+  {
+   std::ostringstream error_msg;
+   error_msg << "The preconditioner has not been setup.";
+   throw OomphLibError(error_msg.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ // store the distribution of z
+ LinearAlgebraDistribution* z_dist = 0;
+ if (z.built())
+  {
+   z_dist = new LinearAlgebraDistribution(z.distribution_pt());
+  }
+
+ // copy r to z
+ z = r;
+
+ // if z is distributed then change to global
+ if (z.distributed())
+  {
+   z.redistribute(this->distribution_pt());
+  }
+
+ // Do the V-cycles
+ unsigned n_row=z.nrow();
+ double* z_pt=z.values_pt();
+ Vector<double> b(n_row);
+ Vector<double> x(n_row,0.0);
+ for (unsigned i=0;i<n_row;i++)
+  {
+   b[i]=z_pt[i];
+  }
+ for (unsigned i=0;i<Nvcycle;i++)
+  {
+   v_cycle(0,b,x);
+  }
+ for (unsigned i=0;i<n_row;i++)
+  {
+   z_pt[i]=x[i];
+  }
+
+ // if the distribution of z was preset the redistribute to original
+ if (z_dist != 0)
+  {
+   z.redistribute(z_dist);
+   delete z_dist;
+  }
+}
+
+
+//=============================================================================
+/// \short Operator complexity of the current hierarchy
+//=============================================================================
+double AggregationAMGPreconditioner::operator_complexity() const
+{
+ if (Nlevel==0)
+  {
+   return 0.0;
+  }
+ double total_nnz=0.0;
+ for (unsigned l=0;l<Nlevel;l++)
+  {
+   total_nnz+=double(Matrix_pt[l]->nnz());
+  }
+ return total_nnz/double(Matrix_pt[0]->nnz());
+}
+
+
+//=============================================================================
+/// Wipe the hierarchy
+//=============================================================================
+void AggregationAMGPreconditioner::clean_up_memory()
+{
+ unsigned n_matrix=Matrix_pt.size();
+ for (unsigned l=0;l<n_matrix;l++)
+  {
+   delete Matrix_pt[l];
+  }
+ Matrix_pt.clear();
+ unsigned n_transfer=Prolongation_matrix_pt.size();
+ for (unsigned l=0;l<n_transfer;l++)
+  {
+   delete Prolongation_matrix_pt[l];
+   delete Restriction_matrix_pt[l];
+  }
+ Prolongation_matrix_pt.clear();
+ Restriction_matrix_pt.clear();
+ Inv_diag.clear();
+ Residual.clear();
+ Coarse_rhs.clear();
+ Coarse_correction.clear();
+ Coarse_solver.clean_up_memory();
+ Nlevel=0;
+}
+
+}
@@ -0,0 +1,320 @@
+//LIC// ====================================================================
+//LIC// This file forms part of oomph-lib, the object-oriented, 
+//LIC// multi-physics finite-element library, available 
+//LIC// at http://www.oomph-lib.org.
+//LIC// 
+//LIC// Copyright (C) 2006-2021 Matthias Heil and Andrew Hazel
+//LIC// 
+//LIC// This library is free software; you can redistribute it and/or
+//LIC// modify it under the terms of the GNU Lesser General Public
+//LIC// License as published by the Free Software Foundation; either
+//LIC// version 2.1 of the License, or (at your option) any later version.
+//LIC// 
+//LIC// This library is distributed in the hope that it will be useful,
+//LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//LIC// Lesser General Public License for more details.
+//LIC// 
+//LIC// You should have received a copy of the GNU Lesser General Public
+//LIC// License along with this library; if not, write to the Free Software
+//LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//LIC// 02110-1301  USA.
+//LIC// 
+//LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+//LIC// 
+//LIC//====================================================================
+//Include guards
+#ifndef OOMPH_ALGEBRAIC_MULTIGRID_HEADER
+#define OOMPH_ALGEBRAIC_MULTIGRID_HEADER
+
+
+// Config header generated by autoconfig
+#ifdef HAVE_CONFIG_H
+  #include <oomph-lib-config.h>
+#endif
+
+#include "preconditioner.h"
+#include "linear_solver.h"
+#include "matrices.h"
+
+
+namespace oomph
+{
+
+
+//=============================================================================
+/// \short An in-library aggregation-based algebraic multigrid (AMG)
+/// preconditioner for CRDoubleMatrices. The coarse levels are built
+/// by greedy aggregation of the strongly connected unknowns
+/// (|a_ij| >= theta sqrt(|a_ii a_jj|)); the piecewise constant 
+/// tentative prolongator can (optionally) be smoothed by one damped 
+/// Jacobi sweep (smoothed aggregation), the restriction is the
+/// transpose of the prolongation and the coarse operators are
+/// formed by the Galerkin product R A P. A single application of the
+/// preconditioner performs a specified number of V-cycles with 
+/// damped Jacobi or (symmetric) Gauss-Seidel smoothing; the coarsest 
+/// system is solved with SuperLU.
+///
+/// The set-up cost and memory requirements grow linearly with the 
+/// size of the matrix, which makes the preconditioner a scalable 
+/// (and Hypre-free) alternative to SuperLU for Poisson-like 
+/// sub-systems such as the pressure Poisson and momentum blocks
+/// in the Navier-Stokes block preconditioners. 
+///
+/// If the reuse of the hierarchy is enabled (see 
+/// enable_reuse_of_hierarchy()) a subsequent call to setup(...) 
+/// with a matrix that has the same sparsity pattern as the one 
+/// used to build the hierarchy retains the aggregates and transfer
+/// operators and only recomputes the (numerical) coarse operators, 
+/// smoothers and coarse solver. This is useful during Newton
+/// iterations where the sparsity pattern of the Jacobian does not 
+/// change.
+///
+/// Note: Distributed matrices are gathered onto every processor (as
+/// in ILUZeroPreconditioner<CRDoubleMatrix>); the preconditioner
+/// is therefore only scalable in serial.
+//=============================================================================
+class AggregationAMGPreconditioner : public Preconditioner
+{
+
+ public:
+
+ /// \short Enumeration for the smoothers
+ enum Smoother_type {Jacobi, Gauss_seidel};
+
+ /// Constructor: Set defaults 
+ AggregationAMGPreconditioner() : 
+  Strength_threshold(0.08), Max_coarse_size(500), Max_nlevel(20),
+  Npre_smooth(1), Npost_smooth(1), Nvcycle(1), Smoother(Gauss_seidel),
+  Jacobi_damping_factor(2.0/3.0), Smooth_prolongation(true),
+  Prolongation_damping_factor(4.0/3.0), Reuse_hierarchy(false),
+  Doc_hierarchy(false), Nlevel(0), Hierarchy_has_been_reused(false)
+  {
+   Coarse_solver.disable_doc_stats();
+   Coarse_solver.disable_doc_time();
+  }
+
+ /// Destructor: clean up
+ ~AggregationAMGPreconditioner()
+  {
+   clean_up_memory();
+  }
+
+ /// Broken copy constructor
+ AggregationAMGPreconditioner(const AggregationAMGPreconditioner&) 
+  { 
+   BrokenCopy::broken_copy("AggregationAMGPreconditioner");
+  } 
+ 
+ /// Broken assignment operator
+ void operator=(const AggregationAMGPreconditioner&) 
+  {
+   BrokenCopy::broken_assign("AggregationAMGPreconditioner");
+  }
+
+ /// \short Setup the preconditioner: build (or, if enabled and 
+ /// possible, reuse) the multigrid hierarchy for the matrix
+ /// pointed to by matrix_pt(), which must be a CRDoubleMatrix.
+ void setup();
+
+ /// \short For some reason we need to remind the compiler that there is
+ /// also a function named setup in the base class.
+ using Preconditioner::setup;
+
+ /// Apply preconditioner (Nvcycle V-cycles) to r, i.e. z=P^{-1} r
+ void preconditioner_solve(const DoubleVector &r, DoubleVector &z);
+
+ /// \short Wipe the hierarchy
+ void clean_up_memory();
+
+ /// \short Access to the strength-of-connection threshold theta 
+ /// (default 0.08)
+ double& strength_threshold() {return Strength_threshold;}
+
+ /// \short Access to the max. number of rows in the coarsest matrix
+ /// (default 500). The coarsening stops once the number of rows 
+ /// drops below this value.
+ unsigned& max_coarse_size() {return Max_coarse_size;}
+
+ /// Access to the max. number of levels (default 20)
+ unsigned& max_nlevel() {return Max_nlevel;}
+
+ /// Access to the number of pre-smoothing sweeps (default 1)
+ unsigned& npre_smooth() {return Npre_smooth;}
+
+ /// Access to the number of post-smoothing sweeps (default 1)
+ unsigned& npost_smooth() {return Npost_smooth;}
+
+ /// \short Access to the number of V-cycles performed per 
+ /// preconditioner solve (default 1)
+ unsigned& nvcycle() {return Nvcycle;}
+
+ /// \short Access to the damping factor for the Jacobi smoother 
+ /// (default 2/3)
+ double& jacobi_damping_factor() {return Jacobi_damping_factor;}
+
+ /// \short Access to the (scaled) damping factor for the smoothing of 
+ /// the prolongation operator (default 4/3). The actual damping factor
+ /// is this value divided by an estimate for the spectral radius of
+ /// D^{-1} A.
+ double& prolongation_damping_factor() {return Prolongation_damping_factor;}
+
+ /// \short Use damped Jacobi smoother
+ void use_jacobi_smoother() {Smoother=Jacobi;}
+
+ /// \short Use Gauss-Seidel smoother (forward sweeps for pre-smoothing,
+ /// backward sweeps for post-smoothing; default)
+ void use_gauss_seidel_smoother() {Smoother=Gauss_seidel;}
+
+ /// \short Smooth the tentative prolongator (smoothed aggregation; 
+ /// default)
+ void enable_smoothed_prolongation() {Smooth_prolongation=true;}
+
+ /// \short Use the piecewise constant tentative prolongator (plain 
+ /// aggregation). Often more robust for strongly non-symmetric
+ /// (advection-dominated) matrices.
+ void disable_smoothed_prolongation() {Smooth_prolongation=false;}
+
+ /// \short Retain aggregates and transfer operators when setup() is
+ /// called again for a matrix with the same sparsity pattern.
+ void enable_reuse_of_hierarchy() {Reuse_hierarchy=true;}
+
+ /// \short Rebuild the hierarchy from scratch whenever setup() is 
+ /// called (default)
+ void disable_reuse_of_hierarchy() {Reuse_hierarchy=false;}
+
+ /// Doc the hierarchy (size of levels and complexities) during setup
+ void enable_doc_hierarchy() {Doc_hierarchy=true;}
+
+ /// Don't doc the hierarchy during setup (default)
+ void disable_doc_hierarchy() {Doc_hierarchy=false;}
+
+ /// Number of levels in the current hierarchy
+ unsigned nlevel() const {return Nlevel;}
+
+ /// \short Was the hierarchy reused during the most recent call to
+ /// setup()?
+ bool hierarchy_has_been_reused() const {return Hierarchy_has_been_reused;}
+
+ /// \short Operator complexity of the current hierarchy, i.e. the 
+ /// sum of the number of nonzeros in the matrices on all levels divided
+ /// by the number of nonzeros in the finest matrix.
+ double operator_complexity() const;
+
+ private:
+
+ /// \short Build aggregates for the matrix on level "level": On return 
+ /// aggregate_index[i] contains the (coarse) index of the aggregate that 
+ /// contains unknown i; the number of aggregates is returned.
+ unsigned build_aggregates(const unsigned& level,
+                           Vector<unsigned>& aggregate_index) const;
+
+ /// \short Build the (possibly smoothed) prolongation operator and the 
+ /// restriction operator for the transfer between level "level" and 
+ /// level+1 from the aggregates.
+ void build_transfer_operators(const unsigned& level,
+                               const Vector<unsigned>& aggregate_index,
+                               const unsigned& n_aggregate);
+
+ /// \short Form the Galerkin coarse operator R A P on level+1 
+ /// from the matrix and the transfer operators on level "level" 
+ void build_coarse_operator(const unsigned& level);
+
+ /// \short Setup the smoothers (inverse diagonals) on all levels 
+ /// and factorise the coarsest matrix.
+ void setup_smoothers_and_coarse_solver();
+
+ /// \short Perform one V-cycle on level "level" for the rhs b, 
+ /// starting from the initial guess x.
+ void v_cycle(const unsigned& level, const Vector<double>& b,
+              Vector<double>& x);
+
+ /// \short Perform nsweep smoothing sweeps on level "level" for the
+ /// rhs b. The boolean flag indicates whether we are pre- or 
+ /// post-smoothing (determines the direction of the Gauss-Seidel sweeps).
+ void smooth(const unsigned& level, const unsigned& nsweep,
+             const Vector<double>& b, Vector<double>& x, 
+             const bool& pre_smooth);
+
+ /// \short Does the matrix have the same sparsity pattern as the 
+ /// finest matrix in the current hierarchy?
+ bool same_sparsity_pattern(const CRDoubleMatrix& matrix) const;
+
+ /// Compute y = A x for the serial CRDoubleMatrix A
+ static void multiply(const CRDoubleMatrix& matrix, const Vector<double>& x,
+                      Vector<double>& y);
+
+ /// Strength-of-connection threshold
+ double Strength_threshold;
+
+ /// Max. number of rows in the coarsest matrix
+ unsigned Max_coarse_size;
+
+ /// Max. number of levels
+ unsigned Max_nlevel;
+
+ /// Number of pre-smoothing sweeps
+ unsigned Npre_smooth;
+
+ /// Number of post-smoothing sweeps
+ unsigned Npost_smooth;
+
+ /// Number of V-cycles per preconditioner solve
+ unsigned Nvcycle;
+
+ /// The smoother
+ Smoother_type Smoother;
+
+ /// Damping factor for the Jacobi smoother
+ double Jacobi_damping_factor;
+
+ /// Boolean indicating if the tentative prolongator is to be smoothed
+ bool Smooth_prolongation;
+
+ /// (Scaled) damping factor for the smoothing of the prolongator
+ double Prolongation_damping_factor;
+
+ /// \short Boolean indicating whether the hierarchy is to be reused
+ /// if possible
+ bool Reuse_hierarchy;
+
+ /// Doc the hierarchy?
+ bool Doc_hierarchy;
+
+ /// Number of levels in the current hierarchy
+ unsigned Nlevel;
+
+ /// Was the hierarchy reused during the most recent setup?
+ bool Hierarchy_has_been_reused;
+
+ /// \short (Serial) matrices on all levels. Level 0 is a copy of the
+ /// fine-level matrix since the matrix that is passed to setup(...) 
+ /// may be deleted after the setup.
+ Vector<CRDoubleMatrix*> Matrix_pt;
+
+ /// \short Prolongation operators (from level+1 to level)
+ Vector<CRDoubleMatrix*> Prolongation_matrix_pt;
+
+ /// \short Restriction operators (from level to level+1)
+ Vector<CRDoubleMatrix*> Restriction_matrix_pt;
+
+ /// Inverse diagonals of the matrices on all levels (for the smoothers)
+ Vector<Vector<double> > Inv_diag;
+
+ /// \short Work storage for the residuals on all levels (allocated 
+ /// once during the setup to avoid re-allocation during the V-cycles)
+ Vector<Vector<double> > Residual;
+
+ /// Work storage for the rhs on all coarse levels
+ Vector<Vector<double> > Coarse_rhs;
+
+ /// Work storage for the corrections on all coarse levels
+ Vector<Vector<double> > Coarse_correction;
+
+ /// The direct solver for the coarsest level
+ SuperLUSolver Coarse_solver;
+
+};
+
+}
+#endif
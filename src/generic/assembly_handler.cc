@@ -589,8 +589,12 @@ namespace oomph
    if(E_pt!=0) {delete E_pt;}
    E_pt = new DoubleVector(this->distribution_pt(),0.0);
    DoubleVector f(this->distribution_pt(),0.0);
-   Linear_solver_pt->resolve(b,f);
-   Linear_solver_pt->resolve(Jprod_alpha,*E_pt);
+
+   //Solve for both rhs vectors in a single block resolve
+   Vector<DoubleVector*> rhs_pt(2), result_pt(2);
+   rhs_pt[0] = &b; rhs_pt[1] = &Jprod_alpha;
+   result_pt[0] = &f; result_pt[1] = E_pt;
+   Linear_solver_pt->resolve(rhs_pt,result_pt);
 
    //Calculate the final entry in the vector e
    const double e_final = (*E_pt)[n_dof-1];
@@ -1732,8 +1736,13 @@ namespace oomph
   F.redistribute(Linear_solver_pt->distribution_pt());
   psi.redistribute(Linear_solver_pt->distribution_pt());
 
-  Linear_solver_pt->resolve(F,*C_pt);
-  Linear_solver_pt->resolve(psi,*D_pt);
+  //(both in a single block resolve)
+  {
+   Vector<DoubleVector*> rhs_pt(2), result_pt(2);
+   rhs_pt[0] = &F; rhs_pt[1] = &psi;
+   result_pt[0] = C_pt; result_pt[1] = D_pt;
+   Linear_solver_pt->resolve(rhs_pt,result_pt);
+  }
 
   //We can now construct various dot products
   double psi_d = psi.dot(*D_pt);
@@ -1814,11 +1823,14 @@ namespace oomph
   Jprod_D_and_X1[0].redistribute(Linear_solver_pt->distribution_pt());
   Jprod_D_and_X1[1].redistribute(Linear_solver_pt->distribution_pt());
 
-  //Linear solve to get B
-  Linear_solver_pt->resolve(Jprod_D_and_X1[0],*B_pt);
-  //Liner solve to get x3
+  //Linear solves to get B and x3 (in a single block resolve)
   DoubleVector x3(Linear_solver_pt->distribution_pt(),0.0);
-  Linear_solver_pt->resolve(G,x3);
+  {
+   Vector<DoubleVector*> rhs_pt(2), result_pt(2);
+   rhs_pt[0] = &Jprod_D_and_X1[0]; rhs_pt[1] = &G;
+   result_pt[0] = B_pt; result_pt[1] = &x3;
+   Linear_solver_pt->resolve(rhs_pt,result_pt);
+  }
 
   //Construst a couple of additional products
   double l_x3 = psi.dot(x3);
@@ -2329,8 +2341,11 @@ namespace oomph
 
    DoubleVector f(this->distribution_pt(),0.0);
 
-   Linear_solver_pt->resolve(b,f);
-   Linear_solver_pt->resolve(Jprod_alpha,*E_pt);
+   //Solve for both rhs vectors in a single block resolve
+   Vector<DoubleVector*> rhs_pt(2), result_pt(2);
+   rhs_pt[0] = &b; rhs_pt[1] = &Jprod_alpha;
+   result_pt[0] = &f; result_pt[1] = E_pt;
+   Linear_solver_pt->resolve(rhs_pt,result_pt);
 
    //Calculate the final entry in the vector e
    const double e_final = (*E_pt)[n_dof-1];
@@ -3894,14 +3909,17 @@ Problem_pt->actions_before_newton_convergence_check();
   //Now let's get the appropriate bit of alpha
   for(unsigned n=0;n<n_dof;n++) {alpha[n] = dRdparam[n];}
 
-  //Resolve to find A
-  Linear_solver_pt->resolve(alpha,*A_pt);
-
-  //Get the solution for the second rhs
-  for(unsigned n=0;n<n_dof;n++) {alpha[n] = rhs2[n];}
+  //Get the second rhs
+  DoubleVector alpha2(this->distribution_pt(),0.0);
+  for(unsigned n=0;n<n_dof;n++) {alpha2[n] = rhs2[n];}
 
-  //Resolve to find y1_resolve
-  Linear_solver_pt->resolve(alpha,y1_resolve);
+  //Resolve to find A and y1_resolve (in a single block resolve)
+  {
+   Vector<DoubleVector*> rhs_pt(2), result_pt(2);
+   rhs_pt[0] = &alpha; rhs_pt[1] = &alpha2;
+   result_pt[0] = A_pt; result_pt[1] = &y1_resolve;
+   Linear_solver_pt->resolve(rhs_pt,result_pt);
+  }
 
   //Now set to the complex system
   handler_pt->solve_complex_system();
@@ -0,0 +1,427 @@
+//LIC// ====================================================================
+//LIC// This file forms part of oomph-lib, the object-oriented, 
+//LIC// multi-physics finite-element library, available 
+//LIC// at http://www.oomph-lib.org.
+//LIC// 
+//LIC// Copyright (C) 2006-2021 Matthias Heil and Andrew Hazel
+//LIC// 
+//LIC// This library is free software; you can redistribute it and/or
+//LIC// modify it under the terms of the GNU Lesser General Public
+//LIC// License as published by the Free Software Foundation; either
+//LIC// version 2.1 of the License, or (at your option) any later version.
+//LIC// 
+//LIC// This library is distributed in the hope that it will be useful,
+//LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//LIC// Lesser General Public License for more details.
+//LIC// 
+//LIC// You should have received a copy of the GNU Lesser General Public
+//LIC// License along with this library; if not, write to the Free Software
+//LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//LIC// 02110-1301  USA.
+//LIC// 
+//LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+//LIC// 
+//LIC//====================================================================
+#include<fstream>
+#include<sstream>
+#include<stdexcept>
+
+#include "async_output.h"
+#include "mesh.h"
+#include "problem.h"
+
+
+namespace oomph
+{
+
+
+//=============================================================================
+/// Write the data to file
+//=============================================================================
+void BufferOutputJob::write()
+{
+ std::ofstream outfile(File_name.c_str(),
+                       std::ios_base::out|std::ios_base::binary);
+ if (!outfile.is_open())
+  {
+   std::string error_message="Couldn't open file "+File_name;
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ outfile.write(Buffer.data(),Buffer.size());
+}
+
+
+//=============================================================================
+/// Constructor: Evaluate the plot data of the mesh
+//=============================================================================
+MeshPlotDataOutputJob::MeshPlotDataOutputJob(const Mesh* mesh_pt, 
+                                             const unsigned& nplot,
+                                             const std::string& file_name, 
+                                             const bool& use_xdmf, 
+                                             const double& time) :
+ File_name(file_name), Use_xdmf(use_xdmf), Time(time)
+{
+ Plot_data.build(mesh_pt,nplot);
+}
+
+//=============================================================================
+/// Write the plot data to file
+//=============================================================================
+void MeshPlotDataOutputJob::write()
+{
+ if (Use_xdmf)
+  {
+   Plot_data.output_xdmf(File_name,Time);
+  }
+ else
+  {
+   Plot_data.output_vtu(File_name);
+  }
+}
+
+
+//=============================================================================
+/// Constructor: Start the writer thread
+//=============================================================================
+AsynchronousOutputPipeline::AsynchronousOutputPipeline(
+ const unsigned& max_npending_job) : 
+ Max_npending_job(max_npending_job), Npending_job(0)
+{
+ if (Max_npending_job==0)
+  {
+   throw OomphLibError(
+    "Maximum number of pending output jobs must be at least one",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+
+#ifdef OOMPH_HAS_PTHREADS
+ Shutdown=false;
+ pthread_mutex_init(&Mutex,0);
+ pthread_cond_init(&Job_available,0);
+ pthread_cond_init(&Job_done,0);
+ if (pthread_create(&Writer_thread,0,
+                    &AsynchronousOutputPipeline::writer_thread_entry,
+                    this)!=0)
+  {
+   throw OomphLibError(
+    "Couldn't start the writer thread",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+}
+
+//=============================================================================
+/// Destructor: Write all pending jobs and stop the writer thread. Errors
+/// can't be thrown from here; they are reported as warnings.
+//=============================================================================
+AsynchronousOutputPipeline::~AsynchronousOutputPipeline()
+{
+#ifdef OOMPH_HAS_PTHREADS
+ pthread_mutex_lock(&Mutex);
+ Shutdown=true;
+ pthread_cond_signal(&Job_available);
+ pthread_mutex_unlock(&Mutex);
+
+ // The writer thread empties the queue before it finishes
+ pthread_join(Writer_thread,0);
+
+ pthread_cond_destroy(&Job_done);
+ pthread_cond_destroy(&Job_available);
+ pthread_mutex_destroy(&Mutex);
+#endif
+
+ if (!Writer_error.empty())
+  {
+   OomphLibWarning("Error while writing output: "+Writer_error,
+                   "AsynchronousOutputPipeline::~AsynchronousOutputPipeline()",
+                   OOMPH_EXCEPTION_LOCATION);
+  }
+}
+
+//=============================================================================
+/// Submit a job; blocks while the maximum number of jobs is pending
+//=============================================================================
+void AsynchronousOutputPipeline::submit(OutputJob* job_pt)
+{
+ reserve_slot();
+ queue_job(job_pt);
+}
+
+//=============================================================================
+/// Wait until fewer than the maximum number of jobs are pending and 
+/// reserve a slot for the next job
+//=============================================================================
+void AsynchronousOutputPipeline::reserve_slot()
+{
+#ifdef OOMPH_HAS_PTHREADS
+ pthread_mutex_lock(&Mutex);
+ while (Npending_job>=Max_npending_job)
+  {
+   pthread_cond_wait(&Job_done,&Mutex);
+  }
+ Npending_job++;
+ pthread_mutex_unlock(&Mutex);
+#endif
+}
+
+//=============================================================================
+/// Give back a slot reserved by reserve_slot() without queueing a job
+/// (e.g. because capturing the data failed)
+//=============================================================================
+void AsynchronousOutputPipeline::release_slot()
+{
+#ifdef OOMPH_HAS_PTHREADS
+ pthread_mutex_lock(&Mutex);
+ Npending_job--;
+ pthread_cond_broadcast(&Job_done);
+ pthread_mutex_unlock(&Mutex);
+#endif
+}
+
+//=============================================================================
+/// Queue a job in the slot reserved by reserve_slot() 
+//=============================================================================
+void AsynchronousOutputPipeline::queue_job(OutputJob* job_pt)
+{
+#ifdef OOMPH_HAS_PTHREADS
+
+ pthread_mutex_lock(&Mutex);
+ Queue.push_back(job_pt);
+ pthread_cond_signal(&Job_available);
+ pthread_mutex_unlock(&Mutex);
+
+#else
+
+ // No threads: write the job straight away
+ try
+  {
+   job_pt->write();
+  }
+ catch (...)
+  {
+   delete job_pt;
+   throw;
+  }
+ delete job_pt;
+
+#endif
+
+ rethrow_writer_error();
+}
+
+//=============================================================================
+/// Capture the restart data of the problem in memory and submit it.
+/// (As for all jobs created by the pipeline, a slot is reserved before
+/// the data is captured, so no more than the maximum number of copies
+/// of the data exist at any time.)
+//=============================================================================
+void AsynchronousOutputPipeline::dump(const Problem* problem_pt, 
+                                      const std::string& file_name)
+{
+ reserve_slot();
+ OutputJob* job_pt=0;
+ try
+  {
+   // The file stream is never opened: its buffer is replaced by a 
+   // string buffer so that the (possibly overloaded) Problem::dump(...)
+   // can be used unchanged
+   std::stringbuf dump_buffer(std::ios_base::out|std::ios_base::binary);
+   std::ofstream dump_stream;
+   dump_stream.std::ios::rdbuf(&dump_buffer);
+   problem_pt->dump(dump_stream);
+   job_pt=new BufferOutputJob(file_name,dump_buffer.str());
+  }
+ catch (...)
+  {
+   release_slot();
+   throw;
+  }
+ queue_job(job_pt);
+}
+
+//=============================================================================
+/// Capture the output of Mesh::output(...) in memory and submit it
+//=============================================================================
+void AsynchronousOutputPipeline::output(Mesh* mesh_pt, 
+                                        const std::string& file_name,
+                                        const unsigned& nplot)
+{
+ reserve_slot();
+ OutputJob* job_pt=0;
+ try
+  {
+   std::ostringstream output_stream;
+   mesh_pt->output(output_stream,nplot);
+   job_pt=new BufferOutputJob(file_name,output_stream.str());
+  }
+ catch (...)
+  {
+   release_slot();
+   throw;
+  }
+ queue_job(job_pt);
+}
+
+//=============================================================================
+/// Capture the paraview plot data of the mesh and submit it (VTU)
+//=============================================================================
+void AsynchronousOutputPipeline::output_paraview(const Mesh* mesh_pt, 
+                                                 const std::string& file_name,
+                                                 const unsigned& nplot)
+{
+ reserve_slot();
+ OutputJob* job_pt=0;
+ try
+  {
+   job_pt=new MeshPlotDataOutputJob(mesh_pt,nplot,file_name);
+  }
+ catch (...)
+  {
+   release_slot();
+   throw;
+  }
+ queue_job(job_pt);
+}
+
+//=============================================================================
+/// Capture the paraview plot data of the mesh and submit it (XDMF)
+//=============================================================================
+void AsynchronousOutputPipeline::output_xdmf(const Mesh* mesh_pt, 
+                                             const std::string& file_stem,
+                                             const unsigned& nplot,
+                                             const double& time)
+{
+ reserve_slot();
+ OutputJob* job_pt=0;
+ try
+  {
+   job_pt=new MeshPlotDataOutputJob(mesh_pt,nplot,file_stem,true,time);
+  }
+ catch (...)
+  {
+   release_slot();
+   throw;
+  }
+ queue_job(job_pt);
+}
+
+//=============================================================================
+/// Wait until all pending jobs have been written
+//=============================================================================
+void AsynchronousOutputPipeline::flush()
+{
+#ifdef OOMPH_HAS_PTHREADS
+ pthread_mutex_lock(&Mutex);
+ while (Npending_job>0)
+  {
+   pthread_cond_wait(&Job_done,&Mutex);
+  }
+ pthread_mutex_unlock(&Mutex);
+#endif
+
+ rethrow_writer_error();
+}
+
+//=============================================================================
+/// Number of jobs that have been submitted but not yet written
+//=============================================================================
+unsigned AsynchronousOutputPipeline::npending_job()
+{
+#ifdef OOMPH_HAS_PTHREADS
+ pthread_mutex_lock(&Mutex);
+ unsigned n_pending=Npending_job;
+ pthread_mutex_unlock(&Mutex);
+ return n_pending;
+#else
+ return Npending_job;
+#endif
+}
+
+//=============================================================================
+/// Throw any error from the writer thread (and clear it)
+//=============================================================================
+void AsynchronousOutputPipeline::rethrow_writer_error()
+{
+#ifdef OOMPH_HAS_PTHREADS
+ pthread_mutex_lock(&Mutex);
+#endif
+ std::string error_message=Writer_error;
+ Writer_error.clear();
+#ifdef OOMPH_HAS_PTHREADS
+ pthread_mutex_unlock(&Mutex);
+#endif
+
+ if (!error_message.empty())
+  {
+   throw OomphLibError("Error while writing output: "+error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+}
+
+#ifdef OOMPH_HAS_PTHREADS
+
+//=============================================================================
+/// Entry point for the writer thread
+//=============================================================================
+void* AsynchronousOutputPipeline::writer_thread_entry(void* pipeline_pt)
+{
+ static_cast<AsynchronousOutputPipeline*>(pipeline_pt)->writer_loop();
+ return 0;
+}
+
+//=============================================================================
+/// Main loop of the writer thread: Write the queued jobs in the order
+/// in which they were submitted until the pipeline shuts down and the 
+/// queue is empty
+//=============================================================================
+void AsynchronousOutputPipeline::writer_loop()
+{
+ pthread_mutex_lock(&Mutex);
+ while (true)
+  {
+   while (Queue.empty()&&(!Shutdown))
+    {
+     pthread_cond_wait(&Job_available,&Mutex);
+    }
+   if (Queue.empty()) break;
+   OutputJob* job_pt=Queue.front();
+   Queue.pop_front();
+   pthread_mutex_unlock(&Mutex);
+
+   // Write without holding the lock
+   std::string error_message;
+   try
+    {
+     job_pt->write();
+    }
+   catch (std::exception& error)
+    {
+     error_message=error.what();
+    }
+   catch (...)
+    {
+     error_message="Unknown error";
+    }
+   delete job_pt;
+
+   pthread_mutex_lock(&Mutex);
+   if (!error_message.empty())
+    {
+     if (!Writer_error.empty()) Writer_error+="\n";
+     Writer_error+=error_message;
+    }
+   Npending_job--;
+   pthread_cond_broadcast(&Job_done);
+  }
+ pthread_mutex_unlock(&Mutex);
+}
+
+#endif
+
+}
@@ -0,0 +1,302 @@
+//LIC// ====================================================================
+//LIC// This file forms part of oomph-lib, the object-oriented, 
+//LIC// multi-physics finite-element library, available 
+//LIC// at http://www.oomph-lib.org.
+//LIC// 
+//LIC// Copyright (C) 2006-2021 Matthias Heil and Andrew Hazel
+//LIC// 
+//LIC// This library is free software; you can redistribute it and/or
+//LIC// modify it under the terms of the GNU Lesser General Public
+//LIC// License as published by the Free Software Foundation; either
+//LIC// version 2.1 of the License, or (at your option) any later version.
+//LIC// 
+//LIC// This library is distributed in the hope that it will be useful,
+//LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//LIC// Lesser General Public License for more details.
+//LIC// 
+//LIC// You should have received a copy of the GNU Lesser General Public
+//LIC// License along with this library; if not, write to the Free Software
+//LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//LIC// 02110-1301  USA.
+//LIC// 
+//LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+//LIC// 
+//LIC//====================================================================
+//Include guards
+#ifndef OOMPH_ASYNC_OUTPUT_HEADER
+#define OOMPH_ASYNC_OUTPUT_HEADER
+
+
+// Config header generated by autoconfig
+#ifdef HAVE_CONFIG_H
+  #include <oomph-lib-config.h>
+#endif
+
+#ifdef OOMPH_HAS_PTHREADS
+#include <pthread.h>
+#endif
+
+#include<string>
+#include<list>
+
+#include "Vector.h"
+#include "oomph_utilities.h"
+#include "mesh_plot_data.h"
+
+
+namespace oomph
+{
+
+class Mesh;
+class Problem;
+
+
+//=============================================================================
+/// \short Base class for jobs that are executed by the 
+/// AsynchronousOutputPipeline: Everything that depends on the current 
+/// state of the problem must be captured when the job is created (on 
+/// the thread that runs the time loop); write() only formats the 
+/// captured data and writes it to file, and may be called on a 
+/// background thread while the problem is modified.
+//=============================================================================
+class OutputJob
+{
+
+public:
+
+ /// Empty constructor
+ OutputJob() {}
+
+ /// Broken copy constructor
+ OutputJob(const OutputJob&)
+  {
+   BrokenCopy::broken_copy("OutputJob");
+  }
+
+ /// Broken assignment operator
+ void operator=(const OutputJob&)
+  {
+   BrokenCopy::broken_assign("OutputJob");
+  }
+
+ /// Empty virtual destructor
+ virtual ~OutputJob() {}
+
+ /// Write the captured data to file
+ virtual void write()=0;
+
+};
+
+
+//=============================================================================
+/// \short Output job that writes a block of data (e.g. the output of
+/// Problem::dump(...) or Mesh::output(...), captured in memory) to a file
+//=============================================================================
+class BufferOutputJob : public OutputJob
+{
+
+public:
+
+ /// \short Constructor: Pass the name of the file and the data to be
+ /// written into it
+ BufferOutputJob(const std::string& file_name, const std::string& buffer) :
+  File_name(file_name), Buffer(buffer) {}
+
+ /// Write the data to file
+ void write();
+
+private:
+
+ /// Name of the file
+ std::string File_name;
+
+ /// The data
+ std::string Buffer;
+
+};
+
+
+//=============================================================================
+/// \short Output job that writes the plot data of a mesh, evaluated 
+/// by MeshPlotData::build(...) when the job is created, in binary VTU 
+/// or XDMF format
+//=============================================================================
+class MeshPlotDataOutputJob : public OutputJob
+{
+
+public:
+
+ /// \short Constructor: Evaluate the plot data of the mesh (with 
+ /// nplot plot points in each coordinate direction) to be written
+ /// as VTU into the specified file or (if use_xdmf is true) as XDMF 
+ /// into file_stem.xmf/file_stem.bin, with the specified time.
+ MeshPlotDataOutputJob(const Mesh* mesh_pt, const unsigned& nplot,
+                       const std::string& file_name, 
+                       const bool& use_xdmf=false, 
+                       const double& time=0.0);
+
+ /// Write the plot data to file
+ void write();
+
+private:
+
+ /// The plot data
+ MeshPlotData Plot_data;
+
+ /// Name of the file (stem for XDMF)
+ std::string File_name;
+
+ /// Write XDMF (rather than VTU)?
+ bool Use_xdmf;
+
+ /// Time for XDMF output
+ double Time;
+
+};
+
+
+//=============================================================================
+/// \short Pipeline that writes output and restart files on a background 
+/// thread, so that the time loop can proceed with the next timestep 
+/// while the files of the previous one are written. Each job captures
+/// the (solution-dependent) data in memory when it is submitted; 
+/// formatting and file I/O are left to the writer thread. The number of
+/// jobs that may be pending at any time is bounded (default: two, i.e. 
+/// double buffering): The pipeline's output functions wait until a slot
+/// is free before they capture the data, so no more than that many 
+/// copies of the data exist at any time. All pending jobs are written
+/// by flush() and by the destructor, so no output is lost at the end of
+/// the run. Any error that occurs on the writer thread is re-thrown by 
+/// the next submission or by flush(). Without OOMPH_HAS_PTHREADS the 
+/// jobs are written immediately when they are submitted.
+///
+/// Typical use in the time loop:
+/// \code
+///  AsynchronousOutputPipeline pipeline;
+///  for (...)
+///   {
+///    problem.unsteady_newton_solve(dt);
+///    pipeline.output_paraview(problem.mesh_pt(),"soln.vtu",5);
+///    pipeline.dump(&problem,"restart.dat");
+///   }
+/// \endcode
+//=============================================================================
+class AsynchronousOutputPipeline
+{
+
+public:
+
+ /// \short Constructor: Specify the maximum number of jobs that may be
+ /// pending (queued or being written) at any time
+ AsynchronousOutputPipeline(const unsigned& max_npending_job=2);
+
+ /// Broken copy constructor
+ AsynchronousOutputPipeline(const AsynchronousOutputPipeline&)
+  {
+   BrokenCopy::broken_copy("AsynchronousOutputPipeline");
+  }
+
+ /// Broken assignment operator
+ void operator=(const AsynchronousOutputPipeline&)
+  {
+   BrokenCopy::broken_assign("AsynchronousOutputPipeline");
+  }
+
+ /// \short Destructor: Write all pending jobs and stop the writer thread
+ ~AsynchronousOutputPipeline();
+
+ /// \short Submit a job (which is deleted once it has been written).
+ /// Blocks while the maximum number of jobs is pending. (The job has 
+ /// already captured its data at this point; the functions below 
+ /// wait for a free slot before they capture theirs.)
+ void submit(OutputJob* job_pt);
+
+ /// \short Capture the restart data of the problem (as written by
+ /// Problem::dump(...), including the refinement pattern) and write it
+ /// into the specified file
+ void dump(const Problem* problem_pt, const std::string& file_name);
+
+ /// \short Capture the output of Mesh::output(...) (with nplot plot 
+ /// points) and write it into the specified file
+ void output(Mesh* mesh_pt, const std::string& file_name,
+             const unsigned& nplot);
+
+ /// \short Capture the paraview plot data of the mesh and write it into
+ /// the specified file in binary VTU format
+ void output_paraview(const Mesh* mesh_pt, const std::string& file_name,
+                      const unsigned& nplot);
+
+ /// \short Capture the paraview plot data of the mesh and write it into
+ /// file_stem.bin/file_stem.xmf in XDMF format
+ void output_xdmf(const Mesh* mesh_pt, const std::string& file_stem,
+                  const unsigned& nplot, const double& time=0.0);
+
+ /// Wait until all pending jobs have been written
+ void flush();
+
+ /// Number of pending jobs
+ unsigned npending_job();
+
+ /// Maximum number of pending jobs
+ unsigned max_npending_job() const {return Max_npending_job;}
+
+private:
+
+ /// \short Wait until fewer than the maximum number of jobs are 
+ /// pending and reserve a slot for the next job
+ void reserve_slot();
+
+ /// \short Give back a slot reserved by reserve_slot() without queueing
+ /// a job
+ void release_slot();
+
+ /// Queue a job in the slot reserved by reserve_slot()
+ void queue_job(OutputJob* job_pt);
+
+ /// Throw (on the calling thread) any error from the writer thread
+ void rethrow_writer_error();
+
+#ifdef OOMPH_HAS_PTHREADS
+
+ /// Main loop of the writer thread
+ void writer_loop();
+
+ /// Entry point for the writer thread
+ static void* writer_thread_entry(void* pipeline_pt);
+
+ /// The writer thread
+ pthread_t Writer_thread;
+
+ /// \short Mutex that protects the queue, the counters and the error 
+ /// message
+ pthread_mutex_t Mutex;
+
+ /// Signalled when a job has been queued or the pipeline shuts down
+ pthread_cond_t Job_available;
+
+ /// Signalled when a job has been written
+ pthread_cond_t Job_done;
+
+ /// Jobs waiting to be written
+ std::list<OutputJob*> Queue;
+
+ /// Is the pipeline shutting down?
+ bool Shutdown;
+
+#endif
+
+ /// Maximum number of pending jobs
+ unsigned Max_npending_job;
+
+ /// Number of jobs that have been submitted but not yet written
+ unsigned Npending_job;
+
+ /// Error message from the writer thread (empty if none)
+ std::string Writer_error;
+
+};
+
+}
+
+#endif
@@ -347,6 +347,8 @@ namespace oomph
         }
       }
      Built=true;
+     // Keep the DoubleVector representation in sync with the new data
+     this->setup_doublevector_representation();
     }
    else
     {
@@ -193,10 +193,120 @@ namespace oomph
       receive_haloed_count += size_;
      }
    }
+
+   //Compile the communication pattern into persistent requests
+   setup_persistent_requests();
   }
 #endif
  }
 
+ //============================================================================
+ /// Destructor: free the persistent requests (unless MPI has already
+ /// been finalised)
+ //============================================================================
+ DoubleVectorHaloScheme::~DoubleVectorHaloScheme()
+ {
+#ifdef OOMPH_HAS_MPI
+  int finalized=0;
+  MPI_Finalized(&finalized);
+  if(!finalized)
+   {
+    unsigned n_request=Synchronise_request.size();
+    for(unsigned i=0;i<n_request;i++)
+     {
+      MPI_Request_free(&Synchronise_request[i]);
+     }
+    n_request=Sum_request.size();
+    for(unsigned i=0;i<n_request;i++)
+     {
+      MPI_Request_free(&Sum_request[i]);
+     }
+   }
+#endif
+ }
+
+#ifdef OOMPH_HAS_MPI
+
+ //============================================================================
+ ///\short Set up the packing buffers and the persistent requests for the
+ ///communication pattern defined by Haloed_n/Haloed_displacement and
+ ///Halo_n/Halo_displacement. Messages are only exchanged between
+ ///processors that actually share entries, so the per-call cost of
+ ///synchronise() and sum_all_halo_and_haloed_values() reduces to packing,
+ ///starting the requests and unpacking.
+ //============================================================================
+ void DoubleVectorHaloScheme::setup_persistent_requests()
+ {
+  const int n_proc = Distribution_pt->communicator_pt()->nproc();
+  MPI_Comm comm = Distribution_pt->communicator_pt()->mpi_comm();
+
+  //Tags for the two directions of the exchange
+  const int synchronise_tag = 41;
+  const int sum_tag = 42;
+
+  //Buffers (NB: Haloed_eqns and Halo_eqns may have been padded)
+  Haloed_buffer.resize(Haloed_displacement[n_proc-1]+Haloed_n[n_proc-1]);
+  Halo_buffer.resize(Halo_displacement[n_proc-1]+Halo_n[n_proc-1]);
+
+  for(int d=0;d<n_proc;d++)
+   {
+    //Entries that are haloed on processor d: sent by synchronise(),
+    //received (and summed) by sum_all_halo_and_haloed_values()
+    if(Haloed_n[d]!=0)
+     {
+      double* const haloed_pt = &Haloed_buffer[Haloed_displacement[d]];
+      MPI_Request request;
+      MPI_Send_init(haloed_pt,Haloed_n[d],MPI_DOUBLE,d,synchronise_tag,
+                    comm,&request);
+      Synchronise_request.push_back(request);
+      MPI_Recv_init(haloed_pt,Haloed_n[d],MPI_DOUBLE,d,sum_tag,
+                    comm,&request);
+      Sum_request.push_back(request);
+     }
+
+    //Halo entries whose master lives on processor d
+    if(Halo_n[d]!=0)
+     {
+      double* const halo_pt = &Halo_buffer[Halo_displacement[d]];
+      MPI_Request request;
+      MPI_Recv_init(halo_pt,Halo_n[d],MPI_DOUBLE,d,synchronise_tag,
+                    comm,&request);
+      Synchronise_request.push_back(request);
+      MPI_Send_init(halo_pt,Halo_n[d],MPI_DOUBLE,d,sum_tag,
+                    comm,&request);
+      Sum_request.push_back(request);
+     }
+   }
+ }
+
+ //============================================================================
+ /// Send the packed haloed entries and receive the halo entries
+ //============================================================================
+ void DoubleVectorHaloScheme::exchange_halo_values()
+ {
+  const unsigned n_request = Synchronise_request.size();
+  if(n_request!=0)
+   {
+    MPI_Startall(n_request,&Synchronise_request[0]);
+    MPI_Waitall(n_request,&Synchronise_request[0],MPI_STATUSES_IGNORE);
+   }
+ }
+
+ //============================================================================
+ /// Send the packed halo entries and receive the haloed entries
+ //============================================================================
+ void DoubleVectorHaloScheme::exchange_haloed_values()
+ {
+  const unsigned n_request = Sum_request.size();
+  if(n_request!=0)
+   {
+    MPI_Startall(n_request,&Sum_request[0]);
+    MPI_Waitall(n_request,&Sum_request[0],MPI_STATUSES_IGNORE);
+   }
+ }
+
+#endif
+
  //=====================================================================
  ///\short Function that sets up a vector of pointers to halo 
  /// data, index using the scheme in Local_index. The first arguement
@@ -243,8 +353,8 @@ namespace oomph
 
 
  //=========================================================================
- ///Synchronise the halo data within the vector. This requires one
- ///"all to all" communnication.
+ ///Synchronise the halo data within the vector. This uses the persistent
+ ///point-to-point requests set up by the halo scheme.
  //====================================================================
  void DoubleVectorWithHaloEntries::synchronise()
  {
@@ -252,31 +362,21 @@ namespace oomph
   //Only need to do anything if the DoubleVector is distributed
   if(this->distributed())
   {
-   //Read out the number of entries to send
-   const unsigned n_send = Halo_scheme_pt->Haloed_eqns.size();
-   Vector<double> send_data(n_send);
-   //Read out the data values
+   //Pack the haloed values into the scheme's send buffer
+   Vector<double>& send_data = Halo_scheme_pt->Haloed_buffer;
+   const unsigned n_send = send_data.size();
+   const double* const value_pt = this->values_pt();
    for(unsigned i=0;i<n_send;i++)
    {
-    send_data[i] = (*this)[Halo_scheme_pt->Haloed_eqns[i]];
+    send_data[i] = value_pt[Halo_scheme_pt->Haloed_eqns[i]];
    }
-   
-   //Read out the number of entries to receive
-   const unsigned n_receive = Halo_scheme_pt->Halo_eqns.size();
-   Vector<double> receive_data(n_receive);
-   
-   //Make sure that the send and receive data have size at least one
-   if(n_send==0) {send_data.resize(1);}
-   if(n_receive==0) {receive_data.resize(1);}
+
    //Communicate
-   MPI_Alltoallv(&send_data[0],&Halo_scheme_pt->Haloed_n[0],
-                 &Halo_scheme_pt->Haloed_displacement[0],MPI_DOUBLE,
-                 &receive_data[0],&Halo_scheme_pt->Halo_n[0],
-                 &Halo_scheme_pt->Halo_displacement[0],MPI_DOUBLE,
-                 this->distribution_pt()->communicator_pt()->mpi_comm());
-   
-   
+   Halo_scheme_pt->exchange_halo_values();
+
    //Now I need simply to update my local values
+   const Vector<double>& receive_data = Halo_scheme_pt->Halo_buffer;
+   const unsigned n_receive = receive_data.size();
    for(unsigned i=0;i<n_receive;i++)
    {
     Halo_value[Halo_scheme_pt->Halo_eqns[i]] =receive_data[i];
@@ -288,7 +388,8 @@ namespace oomph
  //=========================================================================
  ///Gather all ther data from multiple processors and sum the result
  /// which will be stored in the master copy and then synchronised to
- /// all copies. This requires two "all to all" communications
+ /// all copies. This uses the persistent point-to-point requests set up
+ /// by the halo scheme (in both directions).
  //====================================================================
  void DoubleVectorWithHaloEntries::sum_all_halo_and_haloed_values()
  {
@@ -297,33 +398,23 @@ namespace oomph
   if(this->distributed())
   {
    //Send the Halo entries to the master processor
-   const unsigned n_send = Halo_scheme_pt->Halo_eqns.size();
-   Vector<double> send_data(n_send);
-   //Read out the data values
+   Vector<double>& send_data = Halo_scheme_pt->Halo_buffer;
+   const unsigned n_send = send_data.size();
    for(unsigned i=0;i<n_send;i++)
    {
     send_data[i] = Halo_value[Halo_scheme_pt->Halo_eqns[i]];
    }
-   
-   //Read out the number of entries to receive
-   const unsigned n_receive = Halo_scheme_pt->Haloed_eqns.size();
-   Vector<double> receive_data(n_receive);
-   
-   //Make sure that the send and receive data have size at least one
-   if(n_send==0) {send_data.resize(1);}
-   if(n_receive==0) {receive_data.resize(1);}
+
    //Communicate
-   MPI_Alltoallv(&send_data[0],&Halo_scheme_pt->Halo_n[0],
-                 &Halo_scheme_pt->Halo_displacement[0],MPI_DOUBLE,
-                 &receive_data[0],&Halo_scheme_pt->Haloed_n[0],
-                 &Halo_scheme_pt->Haloed_displacement[0],MPI_DOUBLE,
-                 this->distribution_pt()->communicator_pt()->mpi_comm());
-   
-   
+   Halo_scheme_pt->exchange_haloed_values();
+
    //Now I need simply to update and sum my  local values
+   const Vector<double>& receive_data = Halo_scheme_pt->Haloed_buffer;
+   const unsigned n_receive = receive_data.size();
+   double* const value_pt = this->values_pt();
    for(unsigned i=0;i<n_receive;i++)
    {
-    (*this)[Halo_scheme_pt->Haloed_eqns[i]] += receive_data[i];
+    value_pt[Halo_scheme_pt->Haloed_eqns[i]] += receive_data[i];
    }
 
    //Then synchronise
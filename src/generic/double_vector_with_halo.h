@@ -87,6 +87,43 @@ class DoubleVectorHaloScheme
  /// \short Store the distribution that was used to setup the halo scheme
  LinearAlgebraDistribution *Distribution_pt;
 
+#ifdef OOMPH_HAS_MPI
+
+ /// \short Buffer for the haloed entries, packed in the order of
+ /// Haloed_eqns (sent by synchronise(), received by
+ /// sum_all_halo_and_haloed_values())
+ Vector<double> Haloed_buffer;
+
+ /// \short Buffer for the halo entries, packed in the order of
+ /// Halo_eqns (received by synchronise(), sent by
+ /// sum_all_halo_and_haloed_values())
+ Vector<double> Halo_buffer;
+
+ /// \short Persistent requests that send the haloed entries to the
+ /// processors that hold them as halos (and receive the halo entries)
+ Vector<MPI_Request> Synchronise_request;
+
+ /// \short Persistent requests for the reverse exchange: send the
+ /// halo entries to the processors that hold the haloed (master) entries
+ Vector<MPI_Request> Sum_request;
+
+ /// \short Set up the buffers and the persistent requests for the
+ /// communication pattern defined by the halo/haloed entries. Only the
+ /// processors that actually share entries exchange messages.
+ void setup_persistent_requests();
+
+ /// \short Post the persistent requests for the synchronisation
+ /// of the halo entries and wait for them (the haloed entries must have
+ /// been packed into Haloed_buffer)
+ void exchange_halo_values();
+
+ /// \short Post the persistent requests that send the halo entries to
+ /// the processors that hold the haloed entries and wait for them (the
+ /// halo entries must have been packed into Halo_buffer)
+ void exchange_haloed_values();
+
+#endif
+
 public:
 
  ///\short Constructor that sets up the required information communicating
@@ -96,6 +133,21 @@ public:
  DoubleVectorHaloScheme(LinearAlgebraDistribution* const &dist_pt,
                         const Vector<unsigned> &required_global_eqn);
 
+ /// Destructor: free the persistent requests
+ ~DoubleVectorHaloScheme();
+
+ /// Broken copy constructor
+ DoubleVectorHaloScheme(const DoubleVectorHaloScheme&)
+  {
+   BrokenCopy::broken_copy("DoubleVectorHaloScheme");
+  }
+
+ /// Broken assignment operator
+ void operator=(const DoubleVectorHaloScheme&)
+  {
+   BrokenCopy::broken_assign("DoubleVectorHaloScheme");
+  }
+
  ///\short Return the number of halo values
  inline unsigned n_halo_values() const {return Local_index.size();}
 
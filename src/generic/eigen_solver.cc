@@ -29,6 +29,8 @@
 #include "mpi.h"
 #endif
 
+#include <limits>
+
 //Include cfortran.h and the header for the FORTRAN ARPACK routines
 #include "cfortran.h"
 #include "arpack.h"
@@ -38,6 +40,9 @@
 #include "eigen_solver.h"
 #include "linear_solver.h"
 #include "problem.h"
+#include "double_multi_vector.h"
+#include "iterative_linear_solver.h"
+#include "SuperLU_preconditioner.h"
 
 
 namespace oomph
@@ -690,4 +695,839 @@ void LAPACK_QZ::find_eigenvalues(const ComplexMatrixBase &A,
  delete[] A_linear;
  delete[] M_linear;
 }
+
+
+
+//===============================================================
+/// Constructor, set default values
+//===============================================================
+KrylovSchur::KrylovSchur() : EigenSolver(), Nkrylov(30), Max_restart(300),
+                             Tolerance(1.0e-10), Compute_eigenvectors(true),
+                             Reuse_shifted_factorisation(false),
+                             Max_iter_with_reused_factorisation(20),
+                             Reused_factorisation_solver_tolerance(1.0e-12),
+                             Doc_stats(false), Nrestart(0), Nfactorisation(0),
+                             Factorised_shift(0.0), Factorised_nrow(0),
+                             Shifted_factorisation_pt(0),
+                             Iterative_solver_pt(0)
+{}
+
+//===============================================================
+/// Destructor, delete the stored factorisation and the 
+/// iterative solver
+//===============================================================
+KrylovSchur::~KrylovSchur()
+{
+ clean_up_memory();
+ delete Iterative_solver_pt;
+}
+
+//===============================================================
+/// Delete the stored factorisation
+//===============================================================
+void KrylovSchur::clean_up_memory()
+{
+ delete Shifted_factorisation_pt;
+ Shifted_factorisation_pt=0;
+ Factorised_nrow=0;
+}
+
+//===============================================================
+/// Factorise the shifted matrix; the factors are stored in 
+/// the form of a SuperLU preconditioner so that they can be used
+/// either directly or to precondition GMRES
+//===============================================================
+void KrylovSchur::factorise_shifted_matrix(CRDoubleMatrix &shifted_matrix)
+{
+ clean_up_memory();
+ Shifted_factorisation_pt = new SuperLUPreconditioner;
+ Shifted_factorisation_pt->setup(&shifted_matrix);
+ Factorised_shift=Sigma_real;
+ Factorised_nrow=shifted_matrix.nrow();
+ Nfactorisation++;
+}
+
+//===============================================================
+/// Apply the shift-invert operator: y = (J - sigma M)^{-1} M x.
+/// If use_reused_factorisation is true, the system is solved by
+/// GMRES, preconditioned with the stored (outdated) factorisation.
+/// If GMRES does not converge within the specified number of
+/// iterations, the matrix is refactorised and the flag is reset.
+//===============================================================
+void KrylovSchur::apply_shift_invert_operator(
+ CRDoubleMatrix &mass_matrix, CRDoubleMatrix &shifted_matrix,
+ const DoubleVector &x, DoubleVector &y, bool &use_reused_factorisation)
+{
+ DoubleVector rhs(x.distribution_pt(),0.0);
+ mass_matrix.multiply(x,rhs);
+
+ if(use_reused_factorisation)
+  {
+   if(Iterative_solver_pt==0)
+    {
+     Iterative_solver_pt = new GMRES<CRDoubleMatrix>;
+     Iterative_solver_pt->disable_doc_time();
+     Iterative_solver_pt->disable_setup_preconditioner_before_solve();
+     Iterative_solver_pt->disable_error_after_max_iter();
+    }
+   Iterative_solver_pt->preconditioner_pt()=Shifted_factorisation_pt;
+   Iterative_solver_pt->tolerance()=Reused_factorisation_solver_tolerance;
+   Iterative_solver_pt->max_iter()=Max_iter_with_reused_factorisation;
+
+   y.build(x.distribution_pt(),0.0);
+   Iterative_solver_pt->solve(&shifted_matrix,rhs,y);
+
+   // Done if GMRES has converged
+   if(Iterative_solver_pt->converged())
+    {
+     return;
+    }
+
+   // Otherwise the factorisation is too far out of date: refactorise
+   if(Doc_stats)
+    {
+     oomph_info << "KrylovSchur: GMRES with reused factorisation did not "
+                << "converge in " << Max_iter_with_reused_factorisation
+                << " iterations; refactorising the shifted matrix."
+                << std::endl;
+    }
+   factorise_shifted_matrix(shifted_matrix);
+   use_reused_factorisation=false;
+  }
+
+ Shifted_factorisation_pt->preconditioner_solve(rhs,y);
+}
+
+//===============================================================
+/// Orthogonalise column j+1 of the basis against the columns
+/// 0,...,j, using block classical Gram-Schmidt with one
+/// reorthogonalisation, and normalise it. The projection 
+/// coefficients are added to h, the norm of the vector before
+/// normalisation is returned.
+//===============================================================
+double KrylovSchur::orthogonalise(DoubleMultiVector &basis, 
+                                  const unsigned &j,
+                                  Vector<double> &h) const
+{
+ const unsigned n_row=basis.nrow_local();
+ double* w_pt=basis.values(j+1);
+ Vector<double> c(j+1);
+
+ // Norm of the vector before orthogonalisation
+ double w_norm_orig=0.0;
+ for(unsigned i=0;i<n_row;i++) {w_norm_orig+=w_pt[i]*w_pt[i];}
+ w_norm_orig=sqrt(w_norm_orig);
+
+ // Two passes of classical Gram-Schmidt
+ for(unsigned pass=0;pass<2;pass++)
+  {
+   for(unsigned k=0;k<=j;k++)
+    {
+     const double* v_pt=basis.values(k);
+     double dot=0.0;
+     for(unsigned i=0;i<n_row;i++) {dot+=v_pt[i]*w_pt[i];}
+     c[k]=dot;
+    }
+   for(unsigned k=0;k<=j;k++)
+    {
+     const double* v_pt=basis.values(k);
+     const double c_k=c[k];
+     for(unsigned i=0;i<n_row;i++) {w_pt[i]-=c_k*v_pt[i];}
+     h[k]+=c_k;
+    }
+  }
+
+ double w_norm=0.0;
+ for(unsigned i=0;i<n_row;i++) {w_norm+=w_pt[i]*w_pt[i];}
+ w_norm=sqrt(w_norm);
+
+ // Breakdown: we have found an invariant subspace. Replace the vector 
+ // by an arbitrary unit vector that is orthogonal to the basis so
+ // that the iteration can continue; the corresponding subdiagonal
+ // entry of the projected matrix is zero.
+ if(w_norm<=1.0e-12*w_norm_orig || w_norm==0.0)
+  {
+   for(unsigned attempt=0;attempt<n_row;attempt++)
+    {
+     for(unsigned i=0;i<n_row;i++) 
+      {w_pt[i]=sin(double((i+1)*(j+2+attempt)));}
+     Vector<double> dummy(j+1,0.0);
+     for(unsigned pass=0;pass<2;pass++)
+      {
+       for(unsigned k=0;k<=j;k++)
+        {
+         const double* v_pt=basis.values(k);
+         double dot=0.0;
+         for(unsigned i=0;i<n_row;i++) {dot+=v_pt[i]*w_pt[i];}
+         for(unsigned i=0;i<n_row;i++) {w_pt[i]-=dot*v_pt[i];}
+        }
+      }
+     double norm=0.0;
+     for(unsigned i=0;i<n_row;i++) {norm+=w_pt[i]*w_pt[i];}
+     norm=sqrt(norm);
+     if(norm>1.0e-8)
+      {
+       for(unsigned i=0;i<n_row;i++) {w_pt[i]/=norm;}
+       return 0.0;
+      }
+    }
+   throw OomphLibError("Unable to extend the Krylov basis",
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+
+ for(unsigned i=0;i<n_row;i++) {w_pt[i]/=w_norm;}
+ return w_norm;
+}
+
+//===============================================================
+/// Compute the complex Schur decomposition T = Q T_s Q^H of the
+/// (small, dense) matrix T: Householder reduction to upper 
+/// Hessenberg form, followed by shifted QR iterations (with 
+/// Wilkinson shifts and deflation).
+//===============================================================
+void KrylovSchur::complex_schur(DenseMatrix<std::complex<double> > &t,
+                                DenseMatrix<std::complex<double> > &q) const
+{
+ typedef std::complex<double> Complex;
+ const int n=t.nrow();
+ q.resize(n,n);
+ q.initialise(Complex(0.0,0.0));
+ for(int i=0;i<n;i++) {q(i,i)=1.0;}
+
+ // Reduction to upper Hessenberg form by Householder reflections
+ Vector<Complex> v(n);
+ for(int k=0;k<n-2;k++)
+  {
+   double x_norm=0.0;
+   for(int i=k+1;i<n;i++) {x_norm+=std::norm(t(i,k));}
+   x_norm=sqrt(x_norm);
+   if(x_norm==0.0) {continue;}
+   const Complex x0=t(k+1,k);
+   const Complex phase = (std::abs(x0)==0.0) ? Complex(1.0,0.0) : 
+    x0/std::abs(x0);
+   const Complex alpha=-phase*x_norm;
+   double v_norm=0.0;
+   for(int i=k+1;i<n;i++) 
+    {
+     v[i]=t(i,k);
+     if(i==k+1) {v[i]-=alpha;}
+     v_norm+=std::norm(v[i]);
+    }
+   v_norm=sqrt(v_norm);
+   if(v_norm==0.0) {continue;}
+   for(int i=k+1;i<n;i++) {v[i]/=v_norm;}
+
+   // T = H T
+   for(int j=k;j<n;j++)
+    {
+     Complex s=0.0;
+     for(int i=k+1;i<n;i++) {s+=std::conj(v[i])*t(i,j);}
+     for(int i=k+1;i<n;i++) {t(i,j)-=2.0*v[i]*s;}
+    }
+   // T = T H and Q = Q H
+   for(int i=0;i<n;i++)
+    {
+     Complex s=0.0, s_q=0.0;
+     for(int j=k+1;j<n;j++) 
+      {
+       s+=t(i,j)*v[j];
+       s_q+=q(i,j)*v[j];
+      }
+     for(int j=k+1;j<n;j++) 
+      {
+       t(i,j)-=2.0*s*std::conj(v[j]);
+       q(i,j)-=2.0*s_q*std::conj(v[j]);
+      }
+    }
+   t(k+1,k)=alpha;
+   for(int i=k+2;i<n;i++) {t(i,k)=0.0;}
+  }
+
+ // Shifted QR iterations
+ const double eps=std::numeric_limits<double>::epsilon();
+ Vector<double> c(n);
+ Vector<Complex> s(n);
+ int iu=n-1;
+ unsigned iter=0;
+ const unsigned max_iter=100*n;
+ while(iu>0)
+  {
+   // Find the start of the active (unreduced) block
+   int il=iu;
+   while(il>0)
+    {
+     double scale=std::abs(t(il,il))+std::abs(t(il-1,il-1));
+     if(scale==0.0) {scale=1.0;}
+     if(std::abs(t(il,il-1))<=eps*scale) 
+      {
+       t(il,il-1)=0.0;
+       break;
+      }
+     il--;
+    }
+
+   // Bottom entry has decoupled
+   if(il==iu)
+    {
+     iu--;
+     iter=0;
+     continue;
+    }
+
+   iter++;
+   if(iter>max_iter)
+    {
+     throw OomphLibError("QR iteration for the Schur form did not converge",
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+
+   // Wilkinson shift (eigenvalue of trailing 2x2 block that is closer
+   // to the bottom-right entry), with occasional exceptional shifts
+   Complex mu;
+   if(iter%11==0)
+    {
+     mu=t(iu,iu)+std::abs(t(iu,iu-1));
+    }
+   else
+    {
+     const Complex a=t(iu-1,iu-1), b=t(iu-1,iu), cc=t(iu,iu-1), d=t(iu,iu);
+     const Complex half_diff=0.5*(a-d);
+     const Complex disc=std::sqrt(half_diff*half_diff+b*cc);
+     const Complex mu1=0.5*(a+d)+disc;
+     const Complex mu2=0.5*(a+d)-disc;
+     mu = (std::abs(mu1-d)<std::abs(mu2-d)) ? mu1 : mu2;
+    }
+
+   // QR factorisation of the shifted active block by Givens rotations
+   for(int k=il;k<=iu;k++) {t(k,k)-=mu;}
+   for(int k=il;k<iu;k++)
+    {
+     const Complex f=t(k,k), g=t(k+1,k);
+     const double f_abs=std::abs(f), g_abs=std::abs(g);
+     const double d=sqrt(f_abs*f_abs+g_abs*g_abs);
+     if(d==0.0) 
+      {
+       c[k]=1.0; 
+       s[k]=0.0;
+       continue;
+      }
+     if(f_abs==0.0)
+      {
+       c[k]=0.0;
+       s[k]=std::conj(g)/g_abs;
+      }
+     else
+      {
+       c[k]=f_abs/d;
+       s[k]=(f/f_abs)*std::conj(g)/d;
+      }
+     for(int j=k;j<n;j++)
+      {
+       const Complex t1=t(k,j), t2=t(k+1,j);
+       t(k,j)=c[k]*t1+s[k]*t2;
+       t(k+1,j)=-std::conj(s[k])*t1+c[k]*t2;
+      }
+    }
+   // ...and multiply by the rotations from the right
+   for(int k=il;k<iu;k++)
+    {
+     for(int i=0;i<=k+1;i++)
+      {
+       const Complex t1=t(i,k), t2=t(i,k+1);
+       t(i,k)=c[k]*t1+std::conj(s[k])*t2;
+       t(i,k+1)=-s[k]*t1+c[k]*t2;
+      }
+     for(int i=0;i<n;i++)
+      {
+       const Complex q1=q(i,k), q2=q(i,k+1);
+       q(i,k)=c[k]*q1+std::conj(s[k])*q2;
+       q(i,k+1)=-s[k]*q1+c[k]*q2;
+      }
+    }
+   for(int k=il;k<=iu;k++) {t(k,k)+=mu;}
+  }
+
+ // Clean up the strictly lower triangular part
+ for(int i=1;i<n;i++)
+  {
+   for(int j=0;j<i;j++) {t(i,j)=0.0;}
+  }
+}
+
+//===============================================================
+/// Reorder the complex Schur form T = Q T_s Q^H (by swapping 
+/// adjacent diagonal entries) so that the selected diagonal entries 
+/// appear first. 
+//===============================================================
+void KrylovSchur::reorder_schur(const std::vector<bool> &selected,
+                                DenseMatrix<std::complex<double> > &t,
+                                DenseMatrix<std::complex<double> > &q) const
+{
+ typedef std::complex<double> Complex;
+ const int n=t.nrow();
+ int pos=0;
+ for(int j=0;j<n;j++)
+  {
+   if(!selected[j]) {continue;}
+
+   // Move entry j to position pos
+   for(int k=j-1;k>=pos;k--)
+    {
+     // Rotation that swaps the diagonal entries k and k+1
+     const Complex f=t(k,k+1), g=t(k+1,k+1)-t(k,k);
+     const double f_abs=std::abs(f), g_abs=std::abs(g);
+     const double d=sqrt(f_abs*f_abs+g_abs*g_abs);
+     if(d==0.0) {continue;}
+     double cs;
+     Complex sn;
+     if(f_abs==0.0)
+      {
+       cs=0.0;
+       sn=std::conj(g)/g_abs;
+      }
+     else
+      {
+       cs=f_abs/d;
+       sn=(f/f_abs)*std::conj(g)/d;
+      }
+     const Complex t_kk=t(k,k), t_k1k1=t(k+1,k+1);
+     for(int jj=k;jj<n;jj++)
+      {
+       const Complex t1=t(k,jj), t2=t(k+1,jj);
+       t(k,jj)=cs*t1+sn*t2;
+       t(k+1,jj)=-std::conj(sn)*t1+cs*t2;
+      }
+     for(int i=0;i<=k+1;i++)
+      {
+       const Complex t1=t(i,k), t2=t(i,k+1);
+       t(i,k)=cs*t1+std::conj(sn)*t2;
+       t(i,k+1)=-sn*t1+cs*t2;
+      }
+     for(int i=0;i<n;i++)
+      {
+       const Complex q1=q(i,k), q2=q(i,k+1);
+       q(i,k)=cs*q1+std::conj(sn)*q2;
+       q(i,k+1)=-sn*q1+cs*q2;
+      }
+     t(k+1,k)=0.0;
+     t(k,k)=t_k1k1;
+     t(k+1,k+1)=t_kk;
+    }
+   pos++;
+  }
+}
+
+//===============================================================
+/// Get the (normalised) eigenvector of Q T_s Q^H associated with the
+/// j-th diagonal entry of the (upper triangular) Schur form T_s
+//===============================================================
+void KrylovSchur::schur_eigenvector(
+ const DenseMatrix<std::complex<double> > &t,
+ const DenseMatrix<std::complex<double> > &q,
+ const unsigned &j, Vector<std::complex<double> > &y) const
+{
+ typedef std::complex<double> Complex;
+ const unsigned n=t.nrow();
+ const double small=std::numeric_limits<double>::epsilon()*
+  (std::abs(t(j,j))+1.0e-300);
+
+ // Back substitution for the eigenvector of T_s
+ Vector<Complex> x(j+1,0.0);
+ x[j]=1.0;
+ for(int i=int(j)-1;i>=0;i--)
+  {
+   Complex sum=0.0;
+   for(unsigned l=i+1;l<=j;l++) {sum+=t(i,l)*x[l];}
+   Complex diff=t(i,i)-t(j,j);
+   if(std::abs(diff)<small) {diff=small;}
+   x[i]=-sum/diff;
+  }
+
+ // Transform back and normalise
+ y.resize(n);
+ double norm=0.0;
+ for(unsigned i=0;i<n;i++)
+  {
+   Complex sum=0.0;
+   for(unsigned l=0;l<=j;l++) {sum+=q(i,l)*x[l];}
+   y[i]=sum;
+   norm+=std::norm(sum);
+  }
+ norm=sqrt(norm);
+ for(unsigned i=0;i<n;i++) {y[i]/=norm;}
+}
+
+//==========================================================================
+/// Use the Krylov-Schur method to solve an eigen problem that is 
+/// assembled by elements in a mesh in a Problem object.
+//==========================================================================
+void KrylovSchur::solve_eigenproblem(Problem* const &problem_pt,
+                                     const int &n_eval,
+                                     Vector<std::complex<double> > &eigenvalue,
+                                     Vector<DoubleVector> &eigenvector)
+{
+ typedef std::complex<double> Complex;
+
+ // Set up the sizes
+ const unsigned n=problem_pt->ndof();
+ const unsigned nev=n_eval;
+ unsigned m = Nkrylov < n ? Nkrylov : n;
+
+ // If the Krylov subspace is too small to compute the desired number 
+ // of eigenvalues, complain and increase it
+ if(nev+2 > m)
+  {
+   std::ostringstream warning_stream;
+   warning_stream << "Number of requested eigenvalues " << nev << "\n"
+                  << "is too large for the dimension of the Krylov "
+                  << "subspace: " << m << "\n";
+   m = 2*nev+10;
+   if(m > n) {m = n;}
+   warning_stream << "Increasing the dimension of the Krylov subspace to " 
+                  << m << "\n but you may want to increase further using\n"
+                  << "KrylovSchur::nkrylov()\n"
+                  << "which will also get rid of this warning.\n";
+   OomphLibWarning(warning_stream.str(),
+                   OOMPH_CURRENT_FUNCTION,
+                   OOMPH_EXCEPTION_LOCATION);
+  }
+
+ // Build a non-distributed distribution
+ LinearAlgebraDistribution dist(problem_pt->communicator_pt(),n,false);
+ this->build_distribution(dist);
+
+ // Assemble the matrices; pass the shift into the assembly
+ CRDoubleMatrix M(this->distribution_pt()), 
+  AsigmaM(this->distribution_pt());
+ problem_pt->get_eigenproblem_matrices(M,AsigmaM,Sigma_real);
+
+ // Factorise the shifted matrix, or reuse the existing factorisation
+ // if the shift and the size of the problem are unchanged
+ bool use_reused_factorisation = Reuse_shifted_factorisation &&
+  (Shifted_factorisation_pt!=0) && (Factorised_shift==Sigma_real) &&
+  (Factorised_nrow==n);
+ if(!use_reused_factorisation) {factorise_shifted_matrix(AsigmaM);}
+
+ // Storage for the Krylov basis (one column more than the dimension 
+ // of the subspace) and the projected matrix: the first m rows contain
+ // the (m x m) Rayleigh quotient, the last row the coupling vector
+ // to the residual vector
+ DoubleMultiVector basis(m+1,this->distribution_pt(),0.0);
+ DenseMatrix<double> b(m+1,m,0.0);
+
+ // Starting vector: Apply the operator to an arbitrary vector to purge 
+ // components in the null space of the mass matrix
+ {
+  DoubleVector x(this->distribution_pt(),0.0), y;
+  for(unsigned i=0;i<n;i++) {x[i]=1.0+0.5*sin(double(i+1));}
+  apply_shift_invert_operator(M,AsigmaM,x,y,use_reused_factorisation);
+  double norm=y.norm();
+  if(norm==0.0) 
+   {
+    throw OomphLibError("Starting vector lies in the null space of M",
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+  double* v_pt=basis.values(0);
+  for(unsigned i=0;i<n;i++) {v_pt[i]=y[i]/norm;}
+ }
+
+ // Number of basis vectors retained after the restart
+ unsigned k=0;
+
+ // Schur form of the projected matrix
+ DenseMatrix<Complex> t, q;
+ Vector<unsigned> order(m);
+ unsigned n_converged=0;
+
+ DoubleVector x(this->distribution_pt(),0.0), y;
+ Nrestart=0;
+ for(;;)
+  {
+   // Expand the Krylov decomposition from k to m vectors
+   for(unsigned j=k;j<m;j++)
+    {
+     const double* v_pt=basis.values(j);
+     for(unsigned i=0;i<n;i++) {x[i]=v_pt[i];}
+     apply_shift_invert_operator(M,AsigmaM,x,y,use_reused_factorisation);
+     double* w_pt=basis.values(j+1);
+     for(unsigned i=0;i<n;i++) {w_pt[i]=y[i];}
+     Vector<double> h(j+1,0.0);
+     const double beta=orthogonalise(basis,j,h);
+     for(unsigned l=0;l<=j;l++) {b(l,j)=h[l];}
+     for(unsigned l=j+1;l<=m;l++) {b(l,j)=0.0;}
+     if(j+1<m) {b(j+1,j)=beta;}
+     else {b(m,j)=beta;}
+    }
+
+   // Schur decomposition of the Rayleigh quotient
+   t.resize(m,m);
+   for(unsigned i=0;i<m;i++)
+    {
+     for(unsigned j=0;j<m;j++) {t(i,j)=b(i,j);}
+    }
+   complex_schur(t,q);
+
+   // Sort the Ritz values by decreasing magnitude (the eigenvalues
+   // closest to the shift come first)
+   for(unsigned i=0;i<m;i++) {order[i]=i;}
+   for(unsigned i=1;i<m;i++)
+    {
+     unsigned tmp=order[i];
+     int l=int(i)-1;
+     while(l>=0 && std::abs(t(order[l],order[l]))<std::abs(t(tmp,tmp)))
+      {
+       order[l+1]=order[l];
+       l--;
+      }
+     order[l+1]=tmp;
+    }
+
+   // Check convergence of the wanted Ritz pairs: the residual is given
+   // by the product of the coupling vector and the Ritz vector
+   n_converged=0;
+   for(unsigned i=0;i<nev && i<m;i++)
+    {
+     Vector<Complex> ritz_vector;
+     schur_eigenvector(t,q,order[i],ritz_vector);
+     Complex res=0.0;
+     for(unsigned l=0;l<m;l++) {res+=b(m,l)*ritz_vector[l];}
+     if(std::abs(res)<=Tolerance*std::abs(t(order[i],order[i])))
+      {n_converged++;}
+     else {break;}
+    }
+
+   if(n_converged>=nev || m==n) {break;}
+   if(Nrestart>=Max_restart)
+    {
+     std::ostringstream warning_stream;
+     warning_stream << "Krylov-Schur iteration did not converge after "
+                    << Max_restart << " restarts.\n"
+                    << "Only " << n_converged << " of the " << nev 
+                    << " requested eigenvalues have converged.\n";
+     OomphLibWarning(warning_stream.str(),
+                     OOMPH_CURRENT_FUNCTION,
+                     OOMPH_EXCEPTION_LOCATION);
+     break;
+    }
+   Nrestart++;
+
+   // Select the Ritz values to retain: Keep the wanted ones plus
+   // half of the remaining ones, and complete complex conjugate pairs
+   // so that the retained invariant subspace has a real basis
+   unsigned p=nev+(m-nev)/2;
+   if(p>m-1) {p=m-1;}
+   std::vector<bool> selected(m,false);
+   for(unsigned i=0;i<p;i++) {selected[order[i]]=true;}
+   for(unsigned i=0;i<m;i++)
+    {
+     if(!selected[i]) {continue;}
+     const Complex theta=t(i,i);
+     if(std::abs(theta.imag())<=1.0e-12*std::abs(theta)) {continue;}
+     unsigned partner=i;
+     double min_diff=std::numeric_limits<double>::max();
+     for(unsigned l=0;l<m;l++)
+      {
+       if(l==i) {continue;}
+       double diff=std::abs(t(l,l)-std::conj(theta));
+       if(diff<min_diff) {min_diff=diff; partner=l;}
+      }
+     if(partner!=i && !selected[partner]) {selected[partner]=true;}
+    }
+   k=0;
+   for(unsigned i=0;i<m;i++) {if(selected[i]) {k++;}}
+   if(k>=m) {k=m-1;}
+
+   reorder_schur(selected,t,q);
+
+   // Real orthonormal basis Y of the selected invariant subspace: 
+   // Pivoted modified Gram-Schmidt applied to the real and imaginary 
+   // parts of the first k Schur vectors
+   DenseMatrix<double> cand(m,2*k,0.0);
+   for(unsigned l=0;l<k;l++)
+    {
+     for(unsigned i=0;i<m;i++)
+      {
+       cand(i,2*l)=q(i,l).real();
+       cand(i,2*l+1)=q(i,l).imag();
+      }
+    }
+   DenseMatrix<double> yy(m,k,0.0);
+   std::vector<bool> used(2*k,false);
+   for(unsigned l=0;l<k;l++)
+    {
+     unsigned pivot=0;
+     double max_norm=-1.0;
+     for(unsigned c=0;c<2*k;c++)
+      {
+       if(used[c]) {continue;}
+       double norm=0.0;
+       for(unsigned i=0;i<m;i++) {norm+=cand(i,c)*cand(i,c);}
+       if(norm>max_norm) {max_norm=norm; pivot=c;}
+      }
+     used[pivot]=true;
+     max_norm=sqrt(max_norm);
+     for(unsigned i=0;i<m;i++) {yy(i,l)=cand(i,pivot)/max_norm;}
+     for(unsigned c=0;c<2*k;c++)
+      {
+       if(used[c]) {continue;}
+       double dot=0.0;
+       for(unsigned i=0;i<m;i++) {dot+=yy(i,l)*cand(i,c);}
+       for(unsigned i=0;i<m;i++) {cand(i,c)-=dot*yy(i,l);}
+      }
+    }
+
+   // New Rayleigh quotient S = Y^T B Y and coupling vector b^T Y. 
+   // The coupling vector becomes the k-th row of the projected matrix
+   // because the residual vector becomes the k-th basis vector
+   DenseMatrix<double> by(m,k,0.0);
+   for(unsigned i=0;i<m;i++)
+    {
+     for(unsigned l=0;l<k;l++)
+      {
+       double sum=0.0;
+       for(unsigned j=0;j<m;j++) {sum+=b(i,j)*yy(j,l);}
+       by(i,l)=sum;
+      }
+    }
+   Vector<double> coupling(k,0.0);
+   for(unsigned l=0;l<k;l++)
+    {
+     for(unsigned j=0;j<m;j++) {coupling[l]+=b(m,j)*yy(j,l);}
+    }
+   b.initialise(0.0);
+   for(unsigned i=0;i<k;i++)
+    {
+     for(unsigned l=0;l<k;l++)
+      {
+       double sum=0.0;
+       for(unsigned j=0;j<m;j++) {sum+=yy(j,i)*by(j,l);}
+       b(i,l)=sum;
+      }
+    }
+   for(unsigned l=0;l<k;l++) {b(k,l)=coupling[l];}
+
+   // Update the basis, V_k = V_m Y, and move the residual vector 
+   // into column k
+   {
+    DoubleMultiVector new_basis(k,this->distribution_pt(),0.0);
+    for(unsigned l=0;l<k;l++)
+     {
+      double* new_pt=new_basis.values(l);
+      for(unsigned j=0;j<m;j++)
+       {
+        const double y_jl=yy(j,l);
+        if(y_jl==0.0) {continue;}
+        const double* v_pt=basis.values(j);
+        for(unsigned i=0;i<n;i++) {new_pt[i]+=y_jl*v_pt[i];}
+       }
+     }
+    const double* res_pt=basis.values(m);
+    double* v_k_pt=basis.values(k);
+    for(unsigned i=0;i<n;i++) {v_k_pt[i]=res_pt[i];}
+    for(unsigned l=0;l<k;l++)
+     {
+      const double* new_pt=new_basis.values(l);
+      double* v_pt=basis.values(l);
+      for(unsigned i=0;i<n;i++) {v_pt[i]=new_pt[i];}
+     }
+   }
+  }
+
+ if(Doc_stats)
+  {
+   oomph_info << "KrylovSchur: " << n_converged << " eigenvalues converged "
+              << "after " << Nrestart << " restarts; number of "
+              << "factorisations of the shifted matrix: " << Nfactorisation
+              << std::endl;
+  }
+
+ // Extract the converged eigenvalues (and complete the last 
+ // complex conjugate pair if required)
+ unsigned n_out=nev<m ? nev : m;
+ if(n_out<m)
+  {
+   const Complex theta=t(order[n_out-1],order[n_out-1]);
+   if(std::abs(theta.imag())>1.0e-12*std::abs(theta))
+    {
+     unsigned n_complex=0;
+     for(unsigned i=0;i<n_out;i++)
+      {
+       const Complex th=t(order[i],order[i]);
+       if(std::abs(th.imag())>1.0e-12*std::abs(th)) {n_complex++;}
+      }
+     if(n_complex%2==1) {n_out++;}
+    }
+  }
+
+ eigenvalue.resize(n_out);
+ if(Compute_eigenvectors) {eigenvector.resize(n_out);}
+ else {eigenvector.resize(0);}
+
+ std::vector<bool> done(m,false);
+ unsigned count=0;
+ for(unsigned i=0;i<n_out && count<n_out;i++)
+  {
+   const unsigned idx=order[i];
+   if(done[idx]) {continue;}
+   done[idx]=true;
+   Complex theta=t(idx,idx);
+   const bool is_complex=std::abs(theta.imag())>1.0e-12*std::abs(theta);
+   unsigned partner=idx;
+   if(is_complex)
+    {
+     double min_diff=std::numeric_limits<double>::max();
+     for(unsigned l=0;l<n_out;l++)
+      {
+       if(done[order[l]]) {continue;}
+       double diff=std::abs(t(order[l],order[l])-std::conj(theta));
+       if(diff<min_diff) {min_diff=diff; partner=order[l];}
+      }
+     done[partner]=true;
+     // Use the Ritz value whose eigenvalue has positive imaginary part;
+     // lambda = sigma + 1/theta so its imaginary part has the opposite 
+     // sign to that of theta
+     if(theta.imag()>0.0 && partner!=idx) {theta=t(partner,partner);}
+    }
+   Complex lambda=Sigma_real+1.0/theta;
+   if(!is_complex) {lambda=Complex(lambda.real(),0.0);}
+
+   if(Compute_eigenvectors)
+    {
+     const unsigned eig_idx = 
+      (is_complex && partner!=idx && t(idx,idx).imag()>0.0) ? partner : idx;
+     Vector<Complex> ritz_vector;
+     schur_eigenvector(t,q,eig_idx,ritz_vector);
+     eigenvector[count].build(this->distribution_pt(),0.0);
+     if(is_complex && count+1<n_out)
+      {eigenvector[count+1].build(this->distribution_pt(),0.0);}
+     for(unsigned j=0;j<m;j++)
+      {
+       const double* v_pt=basis.values(j);
+       const double re=ritz_vector[j].real();
+       const double im=ritz_vector[j].imag();
+       for(unsigned l=0;l<n;l++)
+        {
+         eigenvector[count][l]+=re*v_pt[l];
+         if(is_complex && count+1<n_out) 
+          {eigenvector[count+1][l]+=im*v_pt[l];}
+        }
+      }
+    }
+
+   eigenvalue[count]=lambda;
+   count++;
+   if(is_complex && count<n_out)
+    {
+     eigenvalue[count]=std::conj(lambda);
+     count++;
+    }
+  }
+
+ // Delete the factorisation unless it is to be reused
+ if(!Reuse_shifted_factorisation) {clean_up_memory();}
+}
+
 }
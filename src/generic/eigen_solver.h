@@ -54,6 +54,18 @@ class DoubleMatrixBase;
 //Forward definition of linear solver class
 class LinearSolver; 
 
+//Forward definition of preconditioner class
+class Preconditioner;
+
+//Forward definition of CR matrix class
+class CRDoubleMatrix;
+
+//Forward definition of multi vector class
+class DoubleMultiVector;
+
+//Forward definition of the GMRES solver
+template<typename MATRIX> class GMRES;
+
 //=======================================================================
 /// Base class for all EigenProblem solves. This simply defines standard 
 /// interfaces so that different solvers can be used easily.
@@ -218,6 +230,209 @@ class LAPACK_QZ : public EigenSolver
 
 };
 
+
+
+//=====================================================================
+/// \short Native (Fortran-free) Krylov-Schur eigensolver for the
+/// generalised eigenproblem \f$ J x = \lambda M x \f$ assembled by
+/// Problem::get_eigenproblem_matrices(...). The solver uses the 
+/// shift-invert operator \f$ (J - \sigma M)^{-1} M \f$ and returns
+/// the eigenvalues closest to the shift \f$ \sigma \f$. The 
+/// Krylov basis is stored in a DoubleMultiVector, the orthogonalisation
+/// is done with block classical Gram-Schmidt (with one
+/// reorthogonalisation) and the method restarts (Stewart, SIAM J. Matrix
+/// Anal. Appl. 23, 2001) by retaining a real orthonormal basis
+/// of the invariant subspace of the projected matrix associated with the 
+/// wanted Ritz values.
+///
+/// The shifted matrix is factorised with SuperLU. If the reuse of the 
+/// factorisation is enabled (see enable_reuse_of_shifted_factorisation())
+/// the factors are retained after the solve. A subsequent solve with
+/// the same shift (e.g. the next step in a continuation sweep) then 
+/// uses them as a preconditioner for GMRES solves with the new shifted 
+/// matrix; the matrix is only refactorised if GMRES fails to converge 
+/// within a specified number of iterations.
+///
+/// As in the ARPACK interface, complex eigenvectors are returned as
+/// two consecutive real vectors that contain the real and imaginary
+/// parts of the eigenvector associated with the first eigenvalue 
+/// of the complex conjugate pair (the one with positive imaginary part).
+/// Note: Like ARPACK, this solver only works with non-distributed 
+/// matrices and vectors.
+//=====================================================================
+class KrylovSchur : public EigenSolver
+{
+  public:
+ 
+ ///Constructor
+ KrylovSchur();
+
+ /// Broken copy constructor
+ KrylovSchur(const KrylovSchur&) 
+  { 
+   BrokenCopy::broken_copy("KrylovSchur");
+  } 
+
+ /// Broken assignment operator
+ void operator=(const KrylovSchur&) 
+  {
+   BrokenCopy::broken_assign("KrylovSchur");
+  }
+
+ ///Destructor, delete the stored factorisation and the iterative solver
+ virtual ~KrylovSchur();
+
+ /// Solve the eigen problem
+ void solve_eigenproblem(Problem* const &problem_pt,
+                         const int &n_eval,
+                         Vector<std::complex<double> > &eigenvalue,
+                         Vector<DoubleVector> &eigenvector);
+
+ /// \short Access function for the max. dimension of the Krylov 
+ /// subspace (default 30)
+ unsigned &nkrylov() {return Nkrylov;}
+
+ /// \short Access function for the max. number of restarts (default 300)
+ unsigned &max_restart() {return Max_restart;}
+
+ /// \short Access function for the (relative) convergence tolerance 
+ /// for the Ritz pairs of the shift-inverted operator (default 1e-10)
+ double &tolerance() {return Tolerance;}
+
+ /// \short Set to enable the computation of the eigenvectors (default)
+ void enable_compute_eigenvectors() {Compute_eigenvectors=true;}
+
+ /// \short Set to disable the computation of the eigenvectors
+ void disable_compute_eigenvectors() {Compute_eigenvectors=false;}
+
+ /// \short Retain the factorisation of the shifted matrix after the solve 
+ /// and use it as a preconditioner for subsequent solves with the same 
+ /// shift.
+ void enable_reuse_of_shifted_factorisation() 
+ {Reuse_shifted_factorisation=true;}
+
+ /// \short Factorise the shifted matrix afresh for every solve (default)
+ void disable_reuse_of_shifted_factorisation() 
+ {
+  Reuse_shifted_factorisation=false;
+  clean_up_memory();
+ }
+
+ /// \short Access function for the max. number of GMRES iterations
+ /// performed with a reused factorisation before the shifted matrix is 
+ /// refactorised (default 20)
+ unsigned &max_iter_with_reused_factorisation() 
+ {return Max_iter_with_reused_factorisation;}
+
+ /// \short Access function for the tolerance of the GMRES solves with 
+ /// a reused factorisation (default 1e-12)
+ double &reused_factorisation_solver_tolerance() 
+ {return Reused_factorisation_solver_tolerance;}
+
+ /// Doc convergence statistics
+ void enable_doc_stats() {Doc_stats=true;}
+
+ /// Don't doc convergence statistics (default)
+ void disable_doc_stats() {Doc_stats=false;}
+
+ /// Number of restarts taken in the most recent solve
+ unsigned nrestart() const {return Nrestart;}
+
+ /// \short Number of factorisations of the shifted matrix performed
+ /// since the solver was created
+ unsigned nfactorisation() const {return Nfactorisation;}
+
+ /// Delete the stored factorisation
+ void clean_up_memory();
+
+  private:
+
+ /// \short Apply the shift-invert operator: y = (J - sigma M)^{-1} M x.
+ /// The boolean flag indicates whether the (reused) factorisation
+ /// is used as a preconditioner for GMRES; it is reset to false if the 
+ /// matrix had to be refactorised.
+ void apply_shift_invert_operator(CRDoubleMatrix &mass_matrix,
+                                  CRDoubleMatrix &shifted_matrix,
+                                  const DoubleVector &x,
+                                  DoubleVector &y,
+                                  bool &use_reused_factorisation);
+
+ /// Factorise the shifted matrix
+ void factorise_shifted_matrix(CRDoubleMatrix &shifted_matrix);
+
+ /// \short Orthogonalise column j+1 of the basis against columns 
+ /// 0,...,j (block classical Gram-Schmidt with one reorthogonalisation) 
+ /// and normalise it. The projection coefficients are added to h;
+ /// the norm of the vector before normalisation is returned.
+ double orthogonalise(DoubleMultiVector &basis, const unsigned &j,
+                      Vector<double> &h) const;
+
+ /// \short Compute the complex Schur decomposition of the n x n 
+ /// matrix T, i.e. T = Q T_s Q^H; on return T contains the upper 
+ /// triangular matrix T_s and Q the unitary matrix.
+ void complex_schur(DenseMatrix<std::complex<double> > &t,
+                    DenseMatrix<std::complex<double> > &q) const;
+
+ /// \short Reorder the complex Schur form T = Q T_s Q^H so that the 
+ /// diagonal entries that are flagged as selected appear first.
+ void reorder_schur(const std::vector<bool> &selected,
+                    DenseMatrix<std::complex<double> > &t,
+                    DenseMatrix<std::complex<double> > &q) const;
+
+ /// \short Get the (normalised) eigenvector of the original matrix 
+ /// associated with the j-th diagonal entry of the Schur form.
+ void schur_eigenvector(const DenseMatrix<std::complex<double> > &t,
+                        const DenseMatrix<std::complex<double> > &q,
+                        const unsigned &j,
+                        Vector<std::complex<double> > &y) const;
+
+ /// Max. dimension of the Krylov subspace
+ unsigned Nkrylov;
+
+ /// Max. number of restarts
+ unsigned Max_restart;
+
+ /// Convergence tolerance
+ double Tolerance;
+
+ /// \short Boolean to indicate whether or not to compute the eigenvectors
+ bool Compute_eigenvectors;
+
+ /// Boolean to indicate whether the factorisation is to be reused
+ bool Reuse_shifted_factorisation;
+
+ /// \short Max. number of GMRES iterations performed with the reused 
+ /// factorisation
+ unsigned Max_iter_with_reused_factorisation;
+
+ /// Tolerance for GMRES solves with the reused factorisation
+ double Reused_factorisation_solver_tolerance;
+
+ /// Doc stats?
+ bool Doc_stats;
+
+ /// Number of restarts taken in the most recent solve
+ unsigned Nrestart;
+
+ /// Number of factorisations of the shifted matrix
+ unsigned Nfactorisation;
+
+ /// \short The shift for which the stored factorisation was computed
+ double Factorised_shift;
+
+ /// \short Number of rows of the matrix for which the stored 
+ /// factorisation was computed
+ unsigned Factorised_nrow;
+
+ /// \short Pointer to the (SuperLU-based) factorisation of the 
+ /// shifted matrix (null if there is none)
+ Preconditioner* Shifted_factorisation_pt;
+
+ /// Pointer to the GMRES solver used with the reused factorisation
+ GMRES<CRDoubleMatrix>* Iterative_solver_pt;
+
+};
+
 }
 
 #endif
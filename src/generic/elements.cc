@@ -4947,6 +4947,169 @@ void FiniteElement::locate_zeta(const Vector<double> &zeta,
   for(unsigned n=0;n<n_node;n++) {node_pt(n)->node_update();}
  }
 
+//======================================================================
+/// Append the values of all scalar fields at the plot points to values
+/// (ordered by plot point). Generic version: evaluate them with
+/// interpolated_scalar_paraview(...) if the element implements it;
+/// otherwise parse the output of scalar_value_paraview(...), which is 
+/// written into memory rather than to a file, with full precision.
+//======================================================================
+void FiniteElement::get_scalar_values_paraview(const unsigned& nplot,
+                                               Vector<double>& values) const
+{
+ const unsigned n_scalar=nscalar_paraview();
+ const unsigned n_plot_point=nplot_points_paraview(nplot);
+ const unsigned long n_existing=values.size();
+ values.resize(n_existing+n_scalar*n_plot_point,0.0);
+ if ((n_scalar==0)||(n_plot_point==0)) {return;}
+
+ // Evaluate the scalars directly if possible
+ Vector<double> s(dim());
+ get_s_plot(0,nplot,s);
+ if (interpolated_scalar_paraview(s,0,values[n_existing]))
+  {
+   for (unsigned j=0;j<n_plot_point;j++)
+    {
+     get_s_plot(j,nplot,s);
+     for (unsigned i=0;i<n_scalar;i++)
+      {
+       if (!interpolated_scalar_paraview(s,i,values[n_existing+j*n_scalar+i]))
+        {
+         std::ostringstream error_stream;
+         error_stream << "interpolated_scalar_paraview(...) isn't "
+                      << "implemented for the " << i << "-th scalar\n"
+                      << "but it is implemented for the 0-th one."
+                      << std::endl;
+         throw OomphLibError(error_stream.str(),
+                             OOMPH_CURRENT_FUNCTION,
+                             OOMPH_EXCEPTION_LOCATION);
+        }
+      }
+    }
+   return;
+  }
+
+ // Otherwise parse the text output
+ for (unsigned i=0;i<n_scalar;i++)
+  {
+   // The file stream is never opened: its buffer is replaced by a 
+   // string buffer
+   std::stringbuf scalar_buffer;
+   std::ofstream scalar_stream;
+   scalar_stream.std::ios::rdbuf(&scalar_buffer);
+   scalar_stream.precision(17);
+   scalar_value_paraview(scalar_stream,i,nplot);
+
+   std::istringstream scalar_values(scalar_buffer.str());
+   for (unsigned j=0;j<n_plot_point;j++)
+    {
+     scalar_values >> values[n_existing+j*n_scalar+i];
+    }
+   if (scalar_values.fail())
+    {
+     std::ostringstream error_stream;
+     error_stream << "Couldn't read " << n_plot_point << " values of the "
+                  << i << "-th scalar from the output of\n"
+                  << "scalar_value_paraview(...)" << std::endl;
+     throw OomphLibError(error_stream.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+}
+
+//======================================================================
+/// Append the coordinates of the plot points to x (three per plot point,
+/// padded with zeroes)
+//======================================================================
+void FiniteElement::get_plot_point_coordinates_paraview(
+ const unsigned& nplot, Vector<double>& x) const
+{
+ //Decide the dimensions of the nodes
+ unsigned nnod=nnode();
+ if (nnod==0) return;
+ unsigned n=node_pt(0)->ndim();
+ if (n>3)
+  {
+   throw OomphLibError(
+    "Paraview plot points can't have more than 3 dimensions",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+
+ // Local and global coordinates
+ Vector<double> s(dim(),0.0);
+ Vector<double> x_plot(n,0.0);
+
+ unsigned n_plot_point=nplot_points_paraview(nplot);
+ x.reserve(x.size()+3*n_plot_point);
+ for (unsigned j=0; j<n_plot_point; j++)
+  {
+   this->get_s_plot(j,nplot,s);
+   this->interpolated_x(s,x_plot);
+   for (unsigned i=0;i<3;i++)
+    {
+     if (i<n)
+      {
+       x.push_back(x_plot[i]);
+      }
+     else
+      {
+       x.push_back(0.0);
+      }
+    }
+  }
+}
+
+//======================================================================
+/// Append the connectivity, offsets and types of the paraview 
+/// sub-elements to the vectors. The information is obtained (in
+/// memory) from the text output functions, which are implemented for
+/// all geometric element types.
+//======================================================================
+void FiniteElement::get_paraview_cells(const unsigned& nplot,
+                                       unsigned& counter,
+                                       unsigned& offset_sum,
+                                       Vector<int>& connectivity,
+                                       Vector<int>& offsets,
+                                       Vector<unsigned char>& type) const
+{
+ // The file stream is never opened: its buffer is replaced by a 
+ // string buffer for each bit of information in turn
+ std::ofstream cell_stream;
+ int entry=0;
+
+ // Connectivity
+ {
+  std::stringbuf cell_buffer;
+  cell_stream.std::ios::rdbuf(&cell_buffer);
+  write_paraview_output_offset_information(cell_stream,nplot,counter);
+  std::istringstream cell_values(cell_buffer.str());
+  while (cell_values >> entry) {connectivity.push_back(entry);}
+ }
+
+ // Offsets
+ {
+  std::stringbuf cell_buffer;
+  cell_stream.std::ios::rdbuf(&cell_buffer);
+  write_paraview_offsets(cell_stream,nplot,offset_sum);
+  std::istringstream cell_values(cell_buffer.str());
+  while (cell_values >> entry) {offsets.push_back(entry);}
+ }
+
+ // Types
+ {
+  std::stringbuf cell_buffer;
+  cell_stream.std::ios::rdbuf(&cell_buffer);
+  write_paraview_type(cell_stream,nplot);
+  std::istringstream cell_values(cell_buffer.str());
+  while (cell_values >> entry) {type.push_back((unsigned char)(entry));}
+ }
+
+ // Don't leave the stream pointing at a destroyed buffer
+ cell_stream.std::ios::rdbuf(0);
+}
+
 //======================================================================
 /// The purpose of this function is to identify all possible
 /// Data that can affect the fields interpolated by the FiniteElement.
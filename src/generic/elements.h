@@ -2907,6 +2907,55 @@ namespace oomph
       return "V"+StringConversion::to_string(i);
     }
 
+    /// \short Compute the value of the i-th scalar field (as written by
+    /// scalar_value_paraview(...)) at local coordinate s and return
+    /// true. The default implementation returns false to indicate that
+    /// this hasn't been implemented for the element, in which case
+    /// get_scalar_values_paraview(...) parses the output of 
+    /// scalar_value_paraview(...) instead. Elements opt in by overloading
+    /// this in their concrete (e.g. QElement-based) classes, returning 
+    /// false if a derived element outputs different scalars, so that 
+    /// elements derived from them don't silently inherit it.
+    virtual bool interpolated_scalar_paraview(const Vector<double>& /*s*/,
+                                              const unsigned& /*i*/,
+                                              double& /*value*/) const
+    {
+      return false;
+    }
+
+    /// \short Append the values of all nscalar_paraview() scalar fields
+    /// at the plot points (for parameter nplot) to values, ordered by 
+    /// plot point: values[j*nscalar_paraview()+i] (relative to the 
+    /// initial size of values) is the i-th scalar at the j-th plot point.
+    /// Used by the binary output writers in MeshPlotData. The default
+    /// implementation evaluates interpolated_scalar_paraview(...) or, if
+    /// that isn't implemented, parses the output of 
+    /// scalar_value_paraview(...); overload it in specific elements to 
+    /// evaluate the shape functions only once per plot point for all 
+    /// fields.
+    virtual void get_scalar_values_paraview(const unsigned& nplot,
+                                            Vector<double>& values) const;
+
+    /// \short Append the coordinates of the plot points (for parameter
+    /// nplot) to x: three per plot point (padded with zeroes), as in
+    /// output_paraview(...)
+    void get_plot_point_coordinates_paraview(const unsigned& nplot,
+                                             Vector<double>& x) const;
+
+    /// \short Append the connectivity (with the element's first plot 
+    /// point numbered counter), the offsets (continuing from offset_sum)
+    /// and the types of the paraview sub-elements to the vectors, and
+    /// increment counter and offset_sum accordingly. Obtained from
+    /// write_paraview_output_offset_information(...), 
+    /// write_paraview_offsets(...) and write_paraview_type(...), so it
+    /// works for all geometric element types.
+    void get_paraview_cells(const unsigned& nplot,
+                            unsigned& counter,
+                            unsigned& offset_sum,
+                            Vector<int>& connectivity,
+                            Vector<int>& offsets,
+                            Vector<unsigned char>& type) const;
+
     /// \short Output the element data --- typically the values at the
     /// nodes in a format suitable for post-processing.
     virtual void output(std::ostream &outfile)
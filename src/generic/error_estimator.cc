@@ -36,6 +36,206 @@
 namespace oomph
 {
 
+//======================================================================
+/// Helpers for the (threaded) patch recovery in 
+/// Z2ErrorEstimator::get_element_errors(...)
+//======================================================================
+namespace Z2ErrorEstimatorHelpers
+{
+
+ /// \short Max. number of recovery terms (complete cubic polynomial
+ /// in 3D)
+ const unsigned Max_nrecovery_terms=20;
+
+ //======================================================================
+ /// \short The work shared between the threads: The elements whose
+ /// contributions to the patch recovery problems are required, the
+ /// patches to be processed and the storage for the results.
+ //======================================================================
+ class PatchRecoveryWork
+ {
+
+   public:
+
+  /// What's to be done?
+  enum Task{Compute_element_data, Recover_patch_fluxes};
+
+  /// Constructor: Everything is set up by the caller
+  PatchRecoveryWork() : Current_task(Compute_element_data), Mesh_pt(0),
+   Num_recovery_terms(0), Num_flux_terms(0), Dim(0), Integral_q_pt(0),
+   Integral_t_pt(0) {}
+
+  /// Destructor: Delete the integration schemes
+  ~PatchRecoveryWork()
+   {
+    delete Integral_q_pt;
+    Integral_q_pt=0;
+    delete Integral_t_pt;
+    Integral_t_pt=0;
+   }
+
+  /// Length of the recovery data for one element
+  unsigned element_data_length() const
+   {
+    return Num_recovery_terms*(Num_recovery_terms+Num_flux_terms);
+   }
+
+  /// Current task
+  Task Current_task;
+
+  /// The mesh
+  Mesh* Mesh_pt;
+
+  /// Number of recovery terms
+  unsigned Num_recovery_terms;
+
+  /// Number of flux terms
+  unsigned Num_flux_terms;
+
+  /// Spatial dimension
+  unsigned Dim;
+
+  /// Recovery integration scheme for quad/brick elements
+  Integral* Integral_q_pt;
+
+  /// Recovery integration scheme for triangle/tet elements
+  Integral* Integral_t_pt;
+
+  /// Numbers of the elements whose recovery data is required
+  Vector<unsigned> Element_list;
+
+  /// \short Element_slot[e]=k if element e is Element_list[k];
+  /// UINT_MAX otherwise
+  Vector<unsigned> Element_slot;
+
+  /// \short Recovery data for element Element_list[k], starting at 
+  /// Element_data[k*element_data_length()]
+  Vector<double> Element_data;
+
+  /// Numbers of the patches to be processed
+  Vector<unsigned> Patch_list;
+
+  /// \short Recovered flux coefficients for patch Patch_list[k]:
+  /// Coefficient i of flux j is 
+  /// Patch_coeff[(k*Num_recovery_terms+i)*Num_flux_terms+j]
+  Vector<double> Patch_coeff;
+
+ };
+
+#ifdef OOMPH_HAS_PTHREADS
+
+ //======================================================================
+ /// \short Work for one of the threads in 
+ /// Z2ErrorEstimator::do_patch_recovery_work(...)
+ //======================================================================
+ class PatchRecoveryChunk
+ {
+
+   public:
+
+  /// Constructor: Everything is set up by the caller
+  PatchRecoveryChunk() : Estimator_pt(0), Work_pt(0), First(0), Last(0) {}
+
+  /// The error estimator
+  Z2ErrorEstimator* Estimator_pt;
+
+  /// The shared work
+  PatchRecoveryWork* Work_pt;
+
+  /// First entry to be processed
+  unsigned First;
+
+  /// One after the last entry to be processed
+  unsigned Last;
+
+ };
+
+#endif
+
+ //======================================================================
+ /// \short Solve the n x n system a x = b for nrhs right hand sides
+ /// by LU decomposition with partial pivoting. The matrix a_pt[i*n+j]
+ /// is overwritten; the right hand sides b_pt[irhs*n+i] are overwritten
+ /// by the solutions.
+ //======================================================================
+ void solve_small_dense_system(const unsigned& n, double* const& a_pt,
+                               const unsigned& nrhs, double* const& b_pt)
+ {
+  unsigned pivot[Max_nrecovery_terms];
+  for (unsigned k=0;k<n;k++)
+   {
+    // Find pivot
+    unsigned p=k;
+    double max_entry=std::fabs(a_pt[k*n+k]);
+    for (unsigned i=k+1;i<n;i++)
+     {
+      if (std::fabs(a_pt[i*n+k])>max_entry)
+       {
+        max_entry=std::fabs(a_pt[i*n+k]);
+        p=i;
+       }
+     }
+    if (max_entry==0.0)
+     {
+      throw OomphLibError("Singular Matrix",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+     }
+    pivot[k]=p;
+    if (p!=k)
+     {
+      for (unsigned j=0;j<n;j++)
+       {
+        std::swap(a_pt[k*n+j],a_pt[p*n+j]);
+       }
+     }
+
+    // Eliminate
+    double inv_pivot=1.0/a_pt[k*n+k];
+    for (unsigned i=k+1;i<n;i++)
+     {
+      double factor=a_pt[i*n+k]*inv_pivot;
+      a_pt[i*n+k]=factor;
+      for (unsigned j=k+1;j<n;j++)
+       {
+        a_pt[i*n+j]-=factor*a_pt[k*n+j];
+       }
+     }
+   }
+
+  // Forward and back substitution for each rhs
+  for (unsigned irhs=0;irhs<nrhs;irhs++)
+   {
+    double* x_pt=b_pt+irhs*n;
+    for (unsigned k=0;k<n;k++)
+     {
+      if (pivot[k]!=k)
+       {
+        std::swap(x_pt[k],x_pt[pivot[k]]);
+       }
+     }
+    for (unsigned k=0;k<n;k++)
+     {
+      for (unsigned i=k+1;i<n;i++)
+       {
+        x_pt[i]-=a_pt[i*n+k]*x_pt[k];
+       }
+     }
+    for (int i=int(n)-1;i>=0;i--)
+     {
+      double sum=x_pt[i];
+      for (unsigned j=i+1;j<n;j++)
+       {
+        sum-=a_pt[i*n+j]*x_pt[j];
+       }
+      x_pt[i]=sum/a_pt[i*n+i];
+     }
+   }
+ }
+
+}
+
+
 
 //====================================================================
 /// Recovery shape functions as functions of the global, Eulerian
@@ -605,151 +805,432 @@ void Z2ErrorEstimator::setup_patches
 
 
 //======================================================================
-/// Given the vector of elements that make up a patch,
-/// the number of recovery and flux terms, and the
-/// spatial dimension of the problem, compute
-/// the matrix of recovered flux coefficients and return
-/// a pointer to it.
+/// Is the stored patch connectivity still valid for the specified
+/// mesh, i.e. does it have the same elements with the same nodes?
 //======================================================================
-void Z2ErrorEstimator::get_recovered_flux_in_patch(
- const Vector<ElementWithZ2ErrorEstimator*>& patch_el_pt,
- const unsigned& num_recovery_terms,
- const unsigned& num_flux_terms,
- const unsigned& dim,
- DenseMatrix<double>*& recovered_flux_coefficient_pt)
+bool Z2ErrorEstimator::patch_connectivity_is_up_to_date(Mesh* const& mesh_pt)
+ const
 {
- // Create/initialise matrix for linear system
- DenseDoubleMatrix recovery_mat(num_recovery_terms,num_recovery_terms,0.0);
- 
- // Ceate/initialise vector of RHSs
- Vector< Vector<double> > rhs(num_flux_terms);
- for (unsigned irhs=0;irhs<num_flux_terms;irhs++)
+ if ((mesh_pt!=Patch_mesh_pt)||(Patch_mesh_pt==0)) return false;
+
+ unsigned nelem=mesh_pt->nelement();
+ if (nelem!=Patch_element_pt.size()) return false;
+ for (unsigned e=0;e<nelem;e++)
   {
-   rhs[irhs].resize(num_recovery_terms);
-   for (unsigned j=0;j<num_recovery_terms;j++)
+   if (mesh_pt->element_pt(e)!=Patch_element_pt[e]) return false;
+   FiniteElement* el_pt=mesh_pt->finite_element_pt(e);
+   unsigned j_first=Patch_element_node_start[e];
+   unsigned nnod=el_pt->nnode();
+   if (nnod!=Patch_element_node_start[e+1]-j_first) return false;
+   for (unsigned n=0;n<nnod;n++)
     {
-     rhs[irhs][j]=0.0;
+     if (el_pt->node_pt(n)!=Patch_element_node_pt[j_first+n]) return false;
     }
   }
+ return true;
+}
 
-  
- //Create a new integration scheme based on the recovery order
- //in the elements
- //Need to find the type of the element, default is to assume a quad
- bool is_q_mesh=true;
- //If we can dynamic cast to the TElementBase, then it's a triangle/tet
- //Note that I'm assuming that all elements are of the same geometry, but
- //if they weren't we could adapt...
- if(dynamic_cast<TElementBase*>(patch_el_pt[0])) {is_q_mesh=false;}
-
- Integral* const integ_pt = this->integral_rec(dim,is_q_mesh);
-
- //Loop over all elements in patch to assemble linear system
- unsigned nelem=patch_el_pt.size();
-for (unsigned e=0;e<nelem;e++)
+
+//======================================================================
+/// Setup the patch connectivity for the specified mesh (unless it's 
+/// still up to date): The patches and their elements are the same
+/// (and in the same order) as the ones set up by setup_patches(...)
+/// but they're flat-packed and the distinct nodes are numbered 
+/// by sorting rather than via maps.
+//======================================================================
+void Z2ErrorEstimator::setup_patch_connectivity(Mesh* const& mesh_pt)
+{
+ if (patch_connectivity_is_up_to_date(mesh_pt)) return;
+
+ flush_patch_connectivity();
+ Patch_mesh_pt=mesh_pt;
+
+#ifdef PARANOID
+ // Check if all elements request the same recovery order
+ unsigned ndisagree=0;
+#endif
+
+ // Store the elements and (flat-packed) their nodes
+ unsigned nelem=mesh_pt->nelement();
+ Patch_element_pt.resize(nelem);
+ Patch_element_node_start.resize(nelem+1);
+ unsigned n_entry=0;
+ for (unsigned e=0;e<nelem;e++)
   {
-   // Get pointer to element
-   ElementWithZ2ErrorEstimator* const el_pt=patch_el_pt[e];
-  
-   // Create storage for the recovery shape function values 
-   Vector<double> psi_r(num_recovery_terms);
-   
-   //Create vector to hold local coordinates
-   Vector<double> s(dim); 
+   ElementWithZ2ErrorEstimator* el_pt=
+    dynamic_cast<ElementWithZ2ErrorEstimator*>(mesh_pt->element_pt(e));
+
+#ifdef PARANOID
+   // Check if all elements request the same recovery order
+   if (el_pt->nrecovery_order()!=Recovery_order){ndisagree++;}
+#endif
+
+   Patch_element_pt[e]=mesh_pt->element_pt(e);
+   Patch_element_node_start[e]=n_entry;
+   n_entry+=el_pt->nnode();
+  }
+ Patch_element_node_start[nelem]=n_entry;
+
+#ifdef PARANOID
+ // Check if all elements request the same recovery order
+ if (ndisagree!=0)
+  {
+   oomph_info 
+    << "\n\n========================================================\n";
+   oomph_info << "WARNING: " << std::endl;
+   oomph_info << ndisagree << " out of " << mesh_pt->nelement() 
+              << " elements\n";
+   oomph_info << "have different preferences for the order of the recovery\n";
+   oomph_info << "shape functions. We are using: Recovery_order=" 
+              << Recovery_order << std::endl;
+   oomph_info 
+    << "========================================================\n\n";
+  }
+#endif
+
+ Patch_element_node_pt.resize(n_entry);
+ Vector<unsigned> entry_element(n_entry);
+ for (unsigned e=0;e<nelem;e++)
+  {
+   FiniteElement* el_pt=mesh_pt->finite_element_pt(e);
+   unsigned j_first=Patch_element_node_start[e];
+   unsigned nnod=el_pt->nnode();
+   for (unsigned n=0;n<nnod;n++)
+    {
+     Patch_element_node_pt[j_first+n]=el_pt->node_pt(n);
+     entry_element[j_first+n]=e;
+    }
+  }
 
-   //Loop over the integration points
-   unsigned Nintpt = integ_pt->nweight();
+ // Number the distinct nodes by sorting the entries; the 
+ // elements adjacent to node k are then 
+ // node_element[j] for node_element_start[k] <= j < node_element_start[k+1]
+ // (in the order in which they appear in the mesh because the 
+ // sort is by node, then entry)
+ Vector<std::pair<Node*,unsigned> > sorted_entry(n_entry);
+ for (unsigned j=0;j<n_entry;j++)
+  {
+   sorted_entry[j]=std::make_pair(Patch_element_node_pt[j],j);
+  }
+ std::sort(sorted_entry.begin(),sorted_entry.end());
+ Patch_element_node_index.resize(n_entry);
+ Vector<unsigned> node_element_start;
+ Vector<unsigned> node_element(n_entry);
+ for (unsigned j=0;j<n_entry;j++)
+  {
+   if ((j==0)||(sorted_entry[j].first!=sorted_entry[j-1].first))
+    {
+     Patch_node_pt.push_back(sorted_entry[j].first);
+     node_element_start.push_back(j);
+    }
+   Patch_element_node_index[sorted_entry[j].second]=Patch_node_pt.size()-1;
+   node_element[j]=entry_element[sorted_entry[j].second];
+  }
+ node_element_start.push_back(n_entry);
 
-   for(unsigned ipt=0;ipt<Nintpt;ipt++)
+ // Loop over all elements, extract adjacency for corner nodes only
+ unsigned n_node=Patch_node_pt.size();
+ std::vector<bool> done(n_node,false);
+ Patch_start.push_back(0);
+ for (unsigned e=0;e<nelem;e++)
+  {
+   ElementWithZ2ErrorEstimator* el_pt=
+    dynamic_cast<ElementWithZ2ErrorEstimator*>(mesh_pt->element_pt(e));
+   unsigned j_first=Patch_element_node_start[e];
+   unsigned j_last=Patch_element_node_start[e+1];
+
+   // Loop over corner nodes
+   unsigned n_vertex=el_pt->nvertex_node();
+   for (unsigned n=0;n<n_vertex;n++)
     {
-     //Assign values of s, the local coordinate
-     for(unsigned i=0;i<dim;i++)
+     Node* nod_pt=el_pt->vertex_node_pt(n);
+     unsigned k=UINT_MAX;
+     for (unsigned j=j_first;j<j_last;j++)
+      {
+       if (Patch_element_node_pt[j]==nod_pt)
+        {
+         k=Patch_element_node_index[j];
+         break;
+        }
+      }
+#ifdef PARANOID
+     if (k==UINT_MAX)
       {
-       s[i] = integ_pt->knot(ipt,i);
+       throw OomphLibError("Vertex node isn't one of the element's nodes",
+                           OOMPH_CURRENT_FUNCTION,
+                           OOMPH_EXCEPTION_LOCATION);
       }
-     
-     //Get the integral weight
-     double w = integ_pt->weight(ipt);
-     
-     //Jaocbian of mapping
-     double J = el_pt->J_eulerian(s);
-     
-     // Interpolate the global (Eulerian) coordinate
-     Vector<double> x(dim);
-     el_pt->interpolated_x(s,x);
+#endif
+
+     // Has this node been considered before?
+     if (!done[k])
+      {
+       done[k]=true;
+       for (unsigned j=node_element_start[k];j<node_element_start[k+1];j++)
+        {
+         Patch_element.push_back(node_element[j]);
+        }
+       Patch_start.push_back(Patch_element.size());
+      }
+    }
+  }
+}
+
+
+//======================================================================
+/// Compute the element's contribution to the recovery problem of any
+/// patch it's part of: The recovery matrix, followed by the right hand
+/// sides for the flux components (see header for details)
+//======================================================================
+void Z2ErrorEstimator::get_element_recovery_data(
+ ElementWithZ2ErrorEstimator* const& el_pt,
+ Integral* const& integ_pt,
+ const unsigned& num_recovery_terms,
+ const unsigned& num_flux_terms,
+ const unsigned& dim,
+ double* const& data_pt)
+{
+ // Initialise
+ unsigned n_data=num_recovery_terms*(num_recovery_terms+num_flux_terms);
+ for (unsigned j=0;j<n_data;j++)
+  {
+   data_pt[j]=0.0;
+  }
+ double* const mat_pt=data_pt;
+ double* const rhs_pt=data_pt+num_recovery_terms*num_recovery_terms;
 
+ // Create storage for the recovery shape function values 
+ Vector<double> psi_r(num_recovery_terms);
+   
+ //Create vector to hold local and global coordinates
+ Vector<double> s(dim); 
+ Vector<double> x(dim);
 
-     // Premultiply the weights and the Jacobian
-     // and the geometric jacobian weight (used in axisymmetric
-     // and spherical coordinate systems)
-     double W = w*J*(el_pt->geometric_jacobian(x));
+ // FE estimates for Z2 flux
+ Vector<double> fe_flux(num_flux_terms); 
 
-     // Recovery shape functions at global (Eulerian) coordinate
-     shape_rec(x,dim,psi_r);
+ //Loop over the integration points
+ unsigned n_intpt=integ_pt->nweight();
+ for(unsigned ipt=0;ipt<n_intpt;ipt++)
+  {
+   //Assign values of s, the local coordinate
+   for(unsigned i=0;i<dim;i++)
+    {
+     s[i] = integ_pt->knot(ipt,i);
+    }
      
-     // Get FE estimates for Z2 flux: 
-     Vector<double> fe_flux(num_flux_terms); 
-     el_pt->get_Z2_flux(s,fe_flux);
+   //Get the integral weight
+   double w = integ_pt->weight(ipt);
      
-     // Add elemental RHSs and recovery matrix to global versions
-     //----------------------------------------------------------
+   //Jaocbian of mapping
+   double J = el_pt->J_eulerian(s);
      
-     // RHS for different flux components
-     for (unsigned i=0;i<num_flux_terms;i++)
-      {
-       // Loop over the nodes for the test functions 
-       for(unsigned l=0;l<num_recovery_terms;l++)
-        {
-         rhs[i][l] += fe_flux[i]*psi_r[l]*W;
-        }
-      }
+   // Interpolate the global (Eulerian) coordinate
+   el_pt->interpolated_x(s,x);
 
+   // Premultiply the weights and the Jacobian
+   // and the geometric jacobian weight (used in axisymmetric
+   // and spherical coordinate systems)
+   double W = w*J*(el_pt->geometric_jacobian(x));
 
-     // Loop over the nodes for the test functions 
+   // Recovery shape functions at global (Eulerian) coordinate
+   shape_rec(x,dim,psi_r);
+     
+   // Get FE estimates for Z2 flux: 
+   el_pt->get_Z2_flux(s,fe_flux);
+     
+   // RHS for different flux components
+   for (unsigned i=0;i<num_flux_terms;i++)
+    {
      for(unsigned l=0;l<num_recovery_terms;l++)
       {
-       //Loop over the nodes for the variables
-       for(unsigned l2=0;l2<num_recovery_terms;l2++)
-        { 
-         //Add contribution to recovery matrix
-         recovery_mat(l,l2)+=psi_r[l]*psi_r[l2]*W;
-        }
+       rhs_pt[i*num_recovery_terms+l] += fe_flux[i]*psi_r[l]*W;
       }
     }
-    
-  } // End of loop over elements that make up patch. 
 
- //Delete the integration scheme
- delete integ_pt;
+   // Recovery matrix
+   for(unsigned l=0;l<num_recovery_terms;l++)
+    {
+     for(unsigned l2=0;l2<num_recovery_terms;l2++)
+      { 
+       mat_pt[l*num_recovery_terms+l2]+=psi_r[l]*psi_r[l2]*W;
+      }
+    }
+  }
+}
 
- // Linear system is now assembled: Solve recovery system
 
- // LU decompose the recovery matrix
- recovery_mat.ludecompose();
- 
- // Back-substitute (and overwrite for all rhs
- for (unsigned irhs=0;irhs<num_flux_terms;irhs++)
+//======================================================================
+/// Assemble the recovery problem for patch work.Patch_list[k] from the
+/// elements' contributions and solve it. The recovered flux 
+/// coefficients are returned in coeff_pt[icoeff*num_flux_terms+i].
+//======================================================================
+void Z2ErrorEstimator::get_recovered_flux_coefficients_in_patch(
+ const Z2ErrorEstimatorHelpers::PatchRecoveryWork& work, const unsigned& k,
+ double* const& coeff_pt, double* const& rhs_pt) const
+{
+ const unsigned num_recovery_terms=work.Num_recovery_terms;
+ const unsigned num_flux_terms=work.Num_flux_terms;
+ const unsigned n_mat=num_recovery_terms*num_recovery_terms;
+ const unsigned n_rhs=num_recovery_terms*num_flux_terms;
+ const unsigned n_data=work.element_data_length();
+
+ // Fixed-size storage for the recovery matrix
+ double mat[Z2ErrorEstimatorHelpers::Max_nrecovery_terms*
+            Z2ErrorEstimatorHelpers::Max_nrecovery_terms];
+ for (unsigned j=0;j<n_mat;j++)
   {
-   recovery_mat.lubksub(rhs[irhs]);
+   mat[j]=0.0;
   }
- 
- // Now create a matrix to store the flux recovery coefficients.
- // Pointer to this matrix will be returned.
- recovered_flux_coefficient_pt =
-  new DenseMatrix<double>(num_recovery_terms,num_flux_terms);
+ for (unsigned j=0;j<n_rhs;j++)
+  {
+   rhs_pt[j]=0.0;
+  }
+
+ // Add the contributions from the elements in the patch
+ unsigned p=work.Patch_list[k];
+ for (unsigned j=Patch_start[p];j<Patch_start[p+1];j++)
+  {
+   const double* data_pt=
+    &work.Element_data[work.Element_slot[Patch_element[j]]*n_data];
+   for (unsigned i=0;i<n_mat;i++)
+    {
+     mat[i]+=data_pt[i];
+    }
+   for (unsigned i=0;i<n_rhs;i++)
+    {
+     rhs_pt[i]+=data_pt[n_mat+i];
+    }
+  }
+
+ // Linear system is now assembled: Solve recovery system
+ Z2ErrorEstimatorHelpers::solve_small_dense_system(num_recovery_terms,mat,
+                                                   num_flux_terms,rhs_pt);
 
  // Copy coefficients
  for (unsigned icoeff=0;icoeff<num_recovery_terms;icoeff++)
   {
    for (unsigned irhs=0;irhs<num_flux_terms;irhs++)
     {
-     (*recovered_flux_coefficient_pt)(icoeff,irhs)=rhs[irhs][icoeff]; 
+     coeff_pt[icoeff*num_flux_terms+irhs]=
+      rhs_pt[irhs*num_recovery_terms+icoeff]; 
+    }
+  }
+}
+
+
+//======================================================================
+/// Do the work (computing the elemental recovery data or recovering
+/// the fluxes in the patches) for entries first to last-1
+//======================================================================
+void Z2ErrorEstimator::do_patch_recovery_work(
+ Z2ErrorEstimatorHelpers::PatchRecoveryWork& work,
+ const unsigned& first, const unsigned& last)
+{
+ if (work.Current_task==
+     Z2ErrorEstimatorHelpers::PatchRecoveryWork::Compute_element_data)
+  {
+   unsigned n_data=work.element_data_length();
+   for (unsigned k=first;k<last;k++)
+    {
+     ElementWithZ2ErrorEstimator* el_pt=
+      dynamic_cast<ElementWithZ2ErrorEstimator*>(
+       work.Mesh_pt->element_pt(work.Element_list[k]));
+
+     // Triangles/tets need a different integration scheme 
+     Integral* integ_pt=work.Integral_q_pt;
+     if (dynamic_cast<TElementBase*>(el_pt)!=0)
+      {
+       integ_pt=work.Integral_t_pt;
+      }
+     get_element_recovery_data(el_pt,integ_pt,work.Num_recovery_terms,
+                               work.Num_flux_terms,work.Dim,
+                               &work.Element_data[k*n_data]);
+    }
+  }
+ else
+  {
+   unsigned n_coeff=work.Num_recovery_terms*work.Num_flux_terms;
+   Vector<double> rhs(n_coeff);
+   for (unsigned k=first;k<last;k++)
+    {
+     get_recovered_flux_coefficients_in_patch(work,k,
+                                              &work.Patch_coeff[k*n_coeff],
+                                              &rhs[0]);
+    }
+  }
+}
+
+
+#ifdef OOMPH_HAS_PTHREADS
+
+//======================================================================
+/// Work for one of the threads in do_patch_recovery_work(...); the 
+/// argument is a pointer to a Z2ErrorEstimatorHelpers::PatchRecoveryChunk
+//======================================================================
+void Z2ErrorEstimator::patch_recovery_chunk_work(void* chunk_pt)
+{
+ Z2ErrorEstimatorHelpers::PatchRecoveryChunk* c_pt=
+  static_cast<Z2ErrorEstimatorHelpers::PatchRecoveryChunk*>(chunk_pt);
+ c_pt->Estimator_pt->do_patch_recovery_work(*(c_pt->Work_pt),
+                                            c_pt->First,c_pt->Last);
+}
+
+#endif
+
+
+//======================================================================
+/// Do the work (computing the elemental recovery data or recovering
+/// the fluxes in the patches) for entries 0 to n_work-1. With pthreads,
+/// contiguous chunks are processed concurrently by up to Nthread 
+/// threads.
+//======================================================================
+void Z2ErrorEstimator::do_patch_recovery_work(
+ Z2ErrorEstimatorHelpers::PatchRecoveryWork& work, const unsigned& n_work)
+{
+#ifdef OOMPH_HAS_PTHREADS
+
+ // How many threads are worth it?
+ unsigned n_thread=Nthread;
+ if (Min_npatch_per_thread>0)
+  {
+   n_thread=std::min(n_thread,n_work/Min_npatch_per_thread);
+  }
+ if (n_thread>1)
+  {
+   // Split the work into contiguous chunks; the first one 
+   // is done by this thread
+   Vector<Z2ErrorEstimatorHelpers::PatchRecoveryChunk> chunk(n_thread);
+   for (unsigned t=0;t<n_thread;t++)
+    {
+     chunk[t].Estimator_pt=this;
+     chunk[t].Work_pt=&work;
+     chunk[t].First=(t*n_work)/n_thread;
+     chunk[t].Last=((t+1)*n_work)/n_thread;
+    }
+   std::string error_message=ThreadingHelpers::do_work_in_threads(
+    &Z2ErrorEstimator::patch_recovery_chunk_work,chunk);
+   if (!error_message.empty())
+    {
+     throw OomphLibError(error_message,
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
     }
+   return;
   }
 
+#endif
+
+ // Serial
+ do_patch_recovery_work(work,0,n_work);
 }
 
 
+/// Min. number of patches per thread in the threaded patch recovery
+unsigned Z2ErrorEstimator::Min_npatch_per_thread=64;
+
+
+
 //==================================================================
 /// Number of coefficients for expansion of recovered fluxes
 /// for given spatial dimension of elements.
@@ -1025,40 +1506,34 @@ void Z2ErrorEstimator::get_element_errors(Mesh*& mesh_pt,
   unsigned num_recovery_terms=nrecovery_terms(dim);
 
 
-  // Setup patches (also returns Vector of vertex nodes)
-  //====================================================
-  std::map<Node*,Vector<ElementWithZ2ErrorEstimator*>*> adjacent_elements_pt;
-  Vector<Node*> vertex_node_pt;
-  setup_patches(mesh_pt,adjacent_elements_pt,vertex_node_pt);
+  // Setup patches (the connectivity is retained between calls as 
+  //=============================================================
+  // long as the mesh's elements and their nodes don't change)
+  //==========================================================
+  setup_patch_connectivity(mesh_pt);
 
   // Loop over all patches to get recovered flux value coefficients
   //===============================================================
 
-  // Map to store sets of pointers to the recovered flux coefficient matrices
-  // for each node. 
-  std::map<Node*,std::set<DenseMatrix<double>*> > flux_coeff_pt;
-
-  // We store the pointers to the recovered flux coefficient matrices for 
-  // various patches in a vector so we can delete them later
-  Vector<DenseMatrix<double>*> vector_of_recovered_flux_coefficient_pt;
-
-  typedef std::map<Node*,Vector<ElementWithZ2ErrorEstimator*>*>::iterator IT;
+  unsigned nelem=mesh_pt->nelement();
 
+#ifdef OOMPH_HAS_MPI
   // Need to translate ElementWithZ2ErrorEstimator pointer to element number
-  // in order to give each processor elements to work on if the problem
-  // has not yet been distributed.  In order to reduce the use of #ifdef this
-  // is also done for the serial problem and the code is amended accordingly.
-
+  // in order to communicate the errors of the haloed elements if the
+  // mesh has been distributed
   std::map<ElementWithZ2ErrorEstimator*,int> elem_num;
-  unsigned nelem=mesh_pt->nelement();
-  for (unsigned e=0;e<nelem;e++)
-   { 
-     elem_num[dynamic_cast<ElementWithZ2ErrorEstimator*>(
-               mesh_pt->element_pt(e))]=e;
+  if (mesh_pt->is_mesh_distributed())
+   {
+    for (unsigned e=0;e<nelem;e++)
+     { 
+      elem_num[dynamic_cast<ElementWithZ2ErrorEstimator*>(
+        mesh_pt->element_pt(e))]=e;
+     }
    }
+#endif
 
   // This isn't a global variable
-  int n_patch=adjacent_elements_pt.size(); // also needed by serial version
+  int n_patch=Patch_start.size()-1; // also needed by serial version
 
   // Default values for serial AND parallel distributed problem
   int itbegin=0;
@@ -1086,55 +1561,71 @@ void Z2ErrorEstimator::get_element_errors(Mesh*& mesh_pt,
    }
 #endif
 
-  // Set up matrices and vectors which will be sent later
-  // - full matrix of all recovered coefficients
-  Vector<DenseMatrix<double>*> vector_of_recovered_flux_coefficient_pt_to_send;
-  // - vectors containing element numbers in each patch
-  Vector<Vector<int> > vector_of_elements_in_patch_to_send;
-
-  // Now we can loop over the patches on the current process
+  // Collect the patches on the current process whose corner node is
+  // surrounded by at least two elements, and the elements involved
+  Z2ErrorEstimatorHelpers::PatchRecoveryWork work;
+  work.Mesh_pt=mesh_pt;
+  work.Num_recovery_terms=num_recovery_terms;
+  work.Num_flux_terms=num_flux_terms;
+  work.Dim=dim;
+  work.Element_slot.resize(nelem,UINT_MAX);
+
+  // Element numbers in the patches, flat-packed as 
+  // [number of elements in patch, element numbers, ...]
+  Vector<int> patch_elements;
   for (int i=itbegin;i<itend;i++)
    {
-    // Which vertex node are we at?
-    Node* nod_pt=vertex_node_pt[i];
-
-    // Pointer to vector of pointers to elements that make up
-    // the patch. 
-    Vector<ElementWithZ2ErrorEstimator*>* el_vec_pt=
-     adjacent_elements_pt[nod_pt];
-
-    // Is the corner node that is central to the patch surrounded by 
-    // at least two elements? 
-    unsigned nelem=(*el_vec_pt).size();
-
-    if (nelem>=2) 
+    unsigned first=Patch_start[i];
+    unsigned last=Patch_start[i+1];
+    if (last-first>=2)
      {
-      // store the number of elements in the patch
-      Vector<int> elements_in_this_patch;
-      for (unsigned e=0;e<nelem;e++)
+      work.Patch_list.push_back(i);
+      patch_elements.push_back(last-first);
+      for (unsigned j=first;j<last;j++)
        {
-        elements_in_this_patch.push_back(elem_num[(*el_vec_pt)[e]]);
+        unsigned e=Patch_element[j];
+        patch_elements.push_back(e);
+        if (work.Element_slot[e]==UINT_MAX)
+         {
+          work.Element_slot[e]=work.Element_list.size();
+          work.Element_list.push_back(e);
+         }
        }
+     }
+   }
 
-      // put them into storage vector ready to send
-      vector_of_elements_in_patch_to_send.push_back(elements_in_this_patch);
-      
-      // Given the vector of elements that make up the patch,
-      // the number of recovery and flux terms, and the spatial
-      // dimension of the problem,  compute
-      // the matrix of recovered flux coefficients and return
-      // a pointer to it.
-      DenseMatrix<double>* recovered_flux_coefficient_pt=0;
-      get_recovered_flux_in_patch(*el_vec_pt,num_recovery_terms,num_flux_terms,
-                                  dim,recovered_flux_coefficient_pt);
-
-      // Store pointer to recovered flux coefficients for 
-      // current patch in vector so we can send and then delete it later
-      vector_of_recovered_flux_coefficient_pt_to_send.
-       push_back(recovered_flux_coefficient_pt);
-
-      } // end of if(nelem>=2)
-
+  // Compute the elements' contributions to the recovery problems, 
+  // then assemble and solve the problems for the patches (both
+  // in parallel)
+  unsigned n_patch_here=work.Patch_list.size();
+  if (n_patch_here>0)
+   {
+    // Check unconditionally: The recovery matrices and pivots live in
+    // fixed-size (stack) arrays
+    if (num_recovery_terms>Z2ErrorEstimatorHelpers::Max_nrecovery_terms)
+     {
+      std::ostringstream error_stream;
+      error_stream << "Number of recovery terms " << num_recovery_terms 
+                   << " exceeds the max. of "
+                   << Z2ErrorEstimatorHelpers::Max_nrecovery_terms 
+                   << std::endl;
+      throw OomphLibError(error_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+     }
+    work.Integral_q_pt=integral_rec(dim,true);
+    work.Integral_t_pt=integral_rec(dim,false);
+
+    unsigned n_element_here=work.Element_list.size();
+    work.Element_data.resize(n_element_here*work.element_data_length());
+    work.Current_task=
+     Z2ErrorEstimatorHelpers::PatchRecoveryWork::Compute_element_data;
+    do_patch_recovery_work(work,n_element_here);
+
+    work.Patch_coeff.resize(n_patch_here*num_recovery_terms*num_flux_terms);
+    work.Current_task=
+     Z2ErrorEstimatorHelpers::PatchRecoveryWork::Recover_patch_fluxes;
+    do_patch_recovery_work(work,n_patch_here);
    }
 
 // Now broadcast the result from each process to every other process
@@ -1149,227 +1640,116 @@ void Z2ErrorEstimator::get_element_errors(Mesh*& mesh_pt,
     OomphCommunicator* comm_pt=MPI_Helpers::communicator_pt();
 
     // All local recovered fluxes have been calculated, so now share result
+    Vector<int> all_patch_elements;
+    Vector<double> all_patch_coeff;
     for (int iproc=0;iproc<n_proc;iproc++)
      {
       // Broadcast number of patches processed
-      int n_patches=vector_of_recovered_flux_coefficient_pt_to_send.size();
+      int n_patches=n_patch_here;
       MPI_Bcast(&n_patches,1,MPI_INT,iproc,comm_pt->mpi_comm());
+      if (n_patches==0) continue;
 
-      // Loop over these patches, broadcast recovered flux coefficients
-      for (int ipatch=0;ipatch<n_patches;ipatch++)
+      // Broadcast the elements in the patches and the recovered flux 
+      // coefficients
+      Vector<int> elements;
+      Vector<double> coeff;
+      if (my_rank==iproc)
        {
-        // Number of elements in this patch
-        Vector<int> elements(0);
-        unsigned nelements=0;
-
-        // Which processor are we on?
-        if (my_rank==iproc) 
-         {  
-          elements=vector_of_elements_in_patch_to_send[ipatch]; 
-          nelements=elements.size();
-         }
-
-        // Broadcast elements
-        comm_pt->broadcast(iproc,elements);
-
-        // Now get recovered flux coefficients
-        DenseMatrix<double>* recovered_flux_coefficient_pt;
-
-        // Which processor are we on?
-        if (my_rank==iproc)
-         {
-          recovered_flux_coefficient_pt=
-           vector_of_recovered_flux_coefficient_pt_to_send[ipatch];
-         }
-        else
-         {
-          recovered_flux_coefficient_pt=new DenseMatrix<double>;
-         }
-
-        // broadcast this matrix from the loop processor
-        DenseMatrix<double> mattosend=*recovered_flux_coefficient_pt;
-        comm_pt->broadcast(iproc,mattosend);
-
-        // Set pointer on all processors
-        *recovered_flux_coefficient_pt=mattosend;
-
-        // End of parallel broadcasting
-        vector_of_recovered_flux_coefficient_pt.
-         push_back(recovered_flux_coefficient_pt);
-
-        // Loop over elements in patch (work out nelements again after bcast)
-        nelements=elements.size();
-
-        for (unsigned e=0;e<nelements;e++)
-         {
-          // Get pointer to element
-          ElementWithZ2ErrorEstimator* el_pt=
-           dynamic_cast<ElementWithZ2ErrorEstimator*>(
-            mesh_pt->element_pt(elements[e]));
-
-          // Loop over all nodes in element 
-          unsigned num_nod=el_pt->nnode();
-          for (unsigned n=0;n<num_nod;n++)
-           {
-            // Get the node
-            Node* nod_pt=el_pt->node_pt(n);
-            // Add the pointer to the current flux coefficient matrix 
-            // to the set for the node
-            // Mesh not distributed here so nod_pt cannot be halo
-            flux_coeff_pt[nod_pt].
-             insert(recovered_flux_coefficient_pt);
-           }
-         }
- 
-       } // end loop over patches on current processor
+        elements=patch_elements;
+        coeff=work.Patch_coeff;
+       }
+      comm_pt->broadcast(iproc,elements);
+      comm_pt->broadcast(iproc,coeff);
 
+      all_patch_elements.insert(all_patch_elements.end(),
+                                elements.begin(),elements.end());
+      all_patch_coeff.insert(all_patch_coeff.end(),
+                             coeff.begin(),coeff.end());
      } // end loop over processors
-   
+
+    patch_elements=all_patch_elements;
+    work.Patch_coeff=all_patch_coeff;
    }
-  else // is_mesh_distributed=true
-   {
 
 #endif // end ifdef OOMPH_HAS_MPI for parallel job without mesh distribution
 
-    // Do the same for a distributed mesh as for a serial job
-    // up to the point where the elemental error is calculated
-    // and then communicate that (see below)
-    int n_patches=vector_of_recovered_flux_coefficient_pt_to_send.size();
-
-    // Loop over these patches
-    for (int ipatch=0;ipatch<n_patches;ipatch++)
+  // Loop over all patches and add their recovered flux coefficients 
+  //----------------------------------------------------------------
+  // to those of the nodes in their elements
+  //----------------------------------------
+  unsigned n_coeff=num_recovery_terms*num_flux_terms;
+  unsigned n_patch_node=Patch_node_pt.size();
+  Vector<double> averaged_flux_coeff(n_patch_node*n_coeff,0.0);
+  Vector<unsigned> npatches(n_patch_node,0);
+
+  // Last patch that contributed to the node (to count each patch only
+  // once)
+  Vector<unsigned> last_patch(n_patch_node,UINT_MAX);
+  unsigned n_patch_entry=patch_elements.size();
+  unsigned pos=0;
+  unsigned q=0;
+  while (pos<n_patch_entry)
+   {
+    unsigned nel=patch_elements[pos++];
+    for (unsigned i=0;i<nel;i++)
      {
-      // Number of elements in this patch
-      Vector<int> elements;
-      int nelements; // Needs to be int for elem_num call later
-      elements=vector_of_elements_in_patch_to_send[ipatch]; 
-      nelements=elements.size();
-
-      // Now get recovered flux coefficients
-      DenseMatrix<double>* recovered_flux_coefficient_pt;
-      recovered_flux_coefficient_pt=
-       vector_of_recovered_flux_coefficient_pt_to_send[ipatch];
-
-      vector_of_recovered_flux_coefficient_pt.
-       push_back(recovered_flux_coefficient_pt);
-
-      for (int e=0;e<nelements;e++)
+      unsigned e=patch_elements[pos++];
+      unsigned j_last=Patch_element_node_start[e+1];
+      for (unsigned j=Patch_element_node_start[e];j<j_last;j++)
        {
-        // Get pointer to element
-        ElementWithZ2ErrorEstimator* el_pt=
-         dynamic_cast<ElementWithZ2ErrorEstimator*>(
-          mesh_pt->element_pt(elements[e]));
-
-        // Loop over all nodes in element 
-        unsigned num_nod=el_pt->nnode();
-        for (unsigned n=0;n<num_nod;n++)
+        unsigned k=Patch_element_node_index[j];
+        if (last_patch[k]!=q)
          {
-          // Get the node
-          Node* nod_pt=el_pt->node_pt(n);
-          // Add the pointer to the current flux coefficient matrix 
-          // to the set for this node
-          flux_coeff_pt[nod_pt].
-           insert(recovered_flux_coefficient_pt);
+          last_patch[k]=q;
+          npatches[k]++;
+          for (unsigned c=0;c<n_coeff;c++)
+           {
+            averaged_flux_coeff[k*n_coeff+c]+=work.Patch_coeff[q*n_coeff+c];
+           }
          }
        }
- 
-     } // End loop over patches on current processor
-
-
-#ifdef OOMPH_HAS_MPI
-   } // End if(is_mesh_distributed)
-#endif
-
-  // Cleanup patch storage scheme
-  for (IT it=adjacent_elements_pt.begin();
-       it!=adjacent_elements_pt.end();it++)
-   {   
-    delete it->second;
+     }
+    q++;
    }
-  adjacent_elements_pt.clear();
 
   // Loop over all nodes, take average of recovered flux values
   //-----------------------------------------------------------
   // and evaluate recovered flux at nodes
   //-------------------------------------
 
-  // Map of (averaged) recoverd flux values at nodes
-  MapMatrixMixed<Node*,int,double> rec_flux_map;
-
-  // Loop over all nodes
-  unsigned n_node=mesh_pt->nnode();
-  for (unsigned n=0;n<n_node;n++)
+  // (Averaged) recovered flux values at node Patch_node_pt[k]:
+  // rec_flux_at_node[k*num_flux_terms+i]
+  Vector<double> rec_flux_at_node(n_patch_node*num_flux_terms,0.0);
+  Vector<double> x(dim);
+  Vector<double> psi_r(num_recovery_terms);
+  for (unsigned k=0;k<n_patch_node;k++)
    {
-    Node* nod_pt=mesh_pt->node_pt(n);
-
-    // How many patches is this node a member of?
-    unsigned npatches=flux_coeff_pt[nod_pt].size();
-
-    // Matrix of averaged coefficients for this node
-    DenseMatrix<double> averaged_flux_coeff
-     (num_recovery_terms,num_flux_terms,0.0);
-
-    // Loop over matrices for different patches and add contributions
-    typedef std::set<DenseMatrix<double>*>::iterator IT;
-    for (IT it=flux_coeff_pt[nod_pt].begin();
-           it!=flux_coeff_pt[nod_pt].end();it++)
-     {
-      for (unsigned i=0;i<num_recovery_terms;i++)
-       {
-        for (unsigned j=0;j<num_flux_terms;j++)
+    Node* nod_pt=Patch_node_pt[k];
 
-         {
-          // ...just add it -- we'll divide by the number of patches later
-          averaged_flux_coeff(i,j)+=(*(*it))(i,j);
-         }
-       }
-     }
-    
-    // Now evaluate the recovered flux (based on the averaged coefficients)
-    //---------------------------------------------------------------------
-    // at the nodal position itself.
-    //------------------------------
-    
     // Get global (Eulerian) nodal position
-    Vector<double> x(dim);
     for (unsigned i=0;i<dim;i++)
      {
       x[i]=nod_pt->x(i);
      }
     
     // Evaluate global recovery functions at node
-    Vector<double> psi_r(num_recovery_terms);
     shape_rec(x,dim,psi_r);
     
-    // Initialise nodal fluxes
-    for (unsigned i=0;i<num_flux_terms;i++)
-     {
-      rec_flux_map(nod_pt,i)=0.0;
-     }
-    
     // Loop over coefficients for flux recovery 
     for (unsigned i=0;i<num_flux_terms;i++)
      {
+      double flux=0.0;
       for (unsigned icoeff=0;icoeff<num_recovery_terms;icoeff++)
        {
-        rec_flux_map(nod_pt,i)+=
-         averaged_flux_coeff(icoeff,i)*psi_r[icoeff];
+        flux+=averaged_flux_coeff[k*n_coeff+icoeff*num_flux_terms+i]*
+         psi_r[icoeff];
        }
       // Now take averaging into account
-      rec_flux_map(nod_pt,i)/=double(npatches);
-      
+      rec_flux_at_node[k*num_flux_terms+i]=flux/double(npatches[k]);
      }
 
    } // end loop over nodes
 
-  // We're done with the recovered flux coefficient matrices for 
-  // the various patches and can delete them 
-  unsigned npatch=vector_of_recovered_flux_coefficient_pt.size();
-  for (unsigned p=0;p<npatch;p++)
-   {
-    delete vector_of_recovered_flux_coefficient_pt[p];
-   }
-
   // NOTE FOR FUTURE REFERENCE - revisit in case of adaptivity problems in 
   // parallel jobs
   //
@@ -1481,14 +1861,15 @@ void Z2ErrorEstimator::get_element_errors(Mesh*& mesh_pt,
       Vector<double> rec_flux(num_flux_terms,0.0);
 
       // Loop over all nodes (incl. halo nodes) to assemble contribution
+      unsigned j_first=Patch_element_node_start[e];
       for (unsigned n=0;n<n_node;n++)
        {
-        Node* nod_pt=el_pt->node_pt(n);
+        unsigned k=Patch_element_node_index[j_first+n];
 
           // Loop over components
           for (unsigned i=0;i<num_flux_terms;i++)
            {
-            rec_flux[i]+=rec_flux_map(nod_pt,i)*psi[n];
+            rec_flux[i]+=rec_flux_at_node[k*num_flux_terms+i]*psi[n];
            }
        }
 
@@ -1722,6 +2103,15 @@ void Z2ErrorEstimator::get_element_errors(Mesh*& mesh_pt,
   // Doc global fluxes?
   if (doc_info.is_doc_enabled())
    {
+    // Map of (averaged) recoverd flux values at nodes
+    MapMatrixMixed<Node*,int,double> rec_flux_map;
+    for (unsigned k=0;k<n_patch_node;k++)
+     {
+      for (unsigned i=0;i<num_flux_terms;i++)
+       {
+        rec_flux_map(Patch_node_pt[k],i)=rec_flux_at_node[k*num_flux_terms+i];
+       }
+     }
     doc_flux(mesh_pt,num_flux_terms,
              rec_flux_map,elemental_error,doc_info);
    }
@@ -306,6 +306,14 @@ class ElementWithZ2ErrorEstimator : public virtual FiniteElement
 ///  
 ///
 //========================================================================
+
+// Forward declaration of the work shared between the threads
+// in Z2ErrorEstimator::get_element_errors(...)
+namespace Z2ErrorEstimatorHelpers
+{
+ class PatchRecoveryWork;
+}
+
 class Z2ErrorEstimator : public virtual ErrorEstimator
 {
   public:
@@ -317,7 +325,8 @@ class Z2ErrorEstimator : public virtual ErrorEstimator
  /// Constructor: Set order of recovery shape functions
  Z2ErrorEstimator(const unsigned& recovery_order) : 
   Recovery_order(recovery_order), Recovery_order_from_first_element(false),
-  Reference_flux_norm(0.0), Combined_error_fct_pt(0)
+  Reference_flux_norm(0.0), Combined_error_fct_pt(0), Nthread(1),
+  Patch_mesh_pt(0)
   {}
   
   
@@ -326,7 +335,7 @@ class Z2ErrorEstimator : public virtual ErrorEstimator
   /// when the error estimator is applied
   Z2ErrorEstimator() : Recovery_order(0), 
    Recovery_order_from_first_element(true), Reference_flux_norm(0.0),
-   Combined_error_fct_pt(0)
+   Combined_error_fct_pt(0), Nthread(1), Patch_mesh_pt(0)
     {}
    
   /// Broken copy constructor
@@ -389,6 +398,35 @@ class Z2ErrorEstimator : public virtual ErrorEstimator
    adjacent_elements_pt,
    Vector<Node*>& vertex_node_pt);
   
+ /// \short Access function for the number of threads used to recover
+ /// the fluxes in the patches (only used if oomph-lib was built with 
+ /// pthreads; defaults to one). The elements' get_Z2_flux(...) 
+ /// function must be thread-safe if this is increased.
+ unsigned& nthread() {return Nthread;}
+
+ /// \short Number of threads used to recover the fluxes in the patches
+ /// (const version)
+ unsigned nthread() const {return Nthread;}
+
+ /// \short Min. number of patches per thread in the threaded patch
+ /// recovery
+ static unsigned Min_npatch_per_thread;
+
+ /// \short Wipe the patch connectivity that is retained between calls 
+ /// to get_element_errors(...). (Not usually required: It's rebuilt
+ /// automatically when the mesh's elements or nodes have changed.)
+ void flush_patch_connectivity()
+  {
+   Patch_mesh_pt=0;
+   Patch_element_pt.clear();
+   Patch_element_node_start.clear();
+   Patch_element_node_pt.clear();
+   Patch_element_node_index.clear();
+   Patch_node_pt.clear();
+   Patch_start.clear();
+   Patch_element.clear();
+  }
+
  /// Access function for prescribed reference flux norm    
  double& reference_flux_norm() {return Reference_flux_norm;}
                                                             
@@ -400,18 +438,57 @@ class Z2ErrorEstimator : public virtual ErrorEstimator
  
   private:
 
- /// \short Given the vector of elements that make up a patch,
- /// the number of recovery and flux terms, and the spatial
- /// dimension of the problem, compute
- /// the matrix of recovered flux coefficients and return
- /// a pointer to it.
- void get_recovered_flux_in_patch(
-  const Vector<ElementWithZ2ErrorEstimator*>& patch_el_pt,
-  const unsigned& num_recovery_terms,
-  const unsigned& num_flux_terms,
-  const unsigned& dim,
-  DenseMatrix<double>*& recovered_flux_coefficient_pt);
- 
+ /// \short Setup the patch connectivity (Patch_start, Patch_element, etc.)
+ /// for the specified mesh unless it's still up to date. This is the
+ /// flat-packed equivalent of setup_patches(...)
+ void setup_patch_connectivity(Mesh* const& mesh_pt);
+
+ /// \short Is the stored patch connectivity still valid for the 
+ /// specified mesh, i.e. does it have the same elements with the 
+ /// same nodes?
+ bool patch_connectivity_is_up_to_date(Mesh* const& mesh_pt) const;
+
+ /// \short Compute the element's contribution to the recovery problem 
+ /// of any patch it's part of (the recovery shape functions are
+ /// functions of the global coordinates so this doesn't depend on the
+ /// patch), using the recovery integration scheme integ_pt: 
+ /// data_pt[] contains the num_recovery_terms x num_recovery_terms
+ /// recovery matrix, followed by the num_flux_terms right hand sides 
+ /// (each of length num_recovery_terms).
+ void get_element_recovery_data(ElementWithZ2ErrorEstimator* const& el_pt,
+                                Integral* const& integ_pt,
+                                const unsigned& num_recovery_terms,
+                                const unsigned& num_flux_terms,
+                                const unsigned& dim,
+                                double* const& data_pt);
+
+ /// \short Assemble and solve the recovery problem for the patch
+ /// work.Patch_list[k] from the precomputed elemental contributions.
+ /// The num_recovery_terms x num_flux_terms coefficients are returned
+ /// (row by row) in coeff_pt[]; rhs_pt[] is workspace of size
+ /// num_recovery_terms*num_flux_terms.
+ void get_recovered_flux_coefficients_in_patch(
+  const Z2ErrorEstimatorHelpers::PatchRecoveryWork& work, const unsigned& k,
+  double* const& coeff_pt, double* const& rhs_pt) const;
+
+ /// \short Do the work (computing the elemental recovery data or
+ /// recovering the fluxes in the patches) for entries first to last-1
+ void do_patch_recovery_work(Z2ErrorEstimatorHelpers::PatchRecoveryWork& work,
+                             const unsigned& first, const unsigned& last);
+
+ /// \short Do the work (computing the elemental recovery data or
+ /// recovering the fluxes in the patches) in parallel, using up to 
+ /// Nthread threads
+ void do_patch_recovery_work(Z2ErrorEstimatorHelpers::PatchRecoveryWork& work,
+                             const unsigned& n_work);
+
+#ifdef OOMPH_HAS_PTHREADS
+
+ /// \short Work for one of the threads in do_patch_recovery_work(...);
+ /// the argument is a pointer to a Z2ErrorEstimatorHelpers::PatchRecoveryChunk
+ static void patch_recovery_chunk_work(void* chunk_pt);
+
+#endif
 
  /// \short Return number of coefficients for expansion of recovered fluxes
  /// for given spatial dimension of elements.
@@ -450,6 +527,39 @@ class Z2ErrorEstimator : public virtual ErrorEstimator
 
  /// Function pointer to combined error estimator function
  CombinedErrorEstimateFctPt Combined_error_fct_pt;
+
+ /// Number of threads used for the patch recovery
+ unsigned Nthread;
+
+ /// \short The mesh for which the patch connectivity was set up
+ /// (null if there isn't any)
+ Mesh* Patch_mesh_pt;
+
+ /// \short The mesh's elements when the patch connectivity was set up
+ Vector<GeneralisedElement*> Patch_element_pt;
+
+ /// \short Nodes of element e are Patch_element_node_pt[j] for
+ /// Patch_element_node_start[e] <= j < Patch_element_node_start[e+1]
+ Vector<unsigned> Patch_element_node_start;
+
+ /// \short Flat-packed nodes of all elements (see 
+ /// Patch_element_node_start)
+ Vector<Node*> Patch_element_node_pt;
+
+ /// \short Number of the node Patch_element_node_pt[j] in Patch_node_pt
+ Vector<unsigned> Patch_element_node_index;
+
+ /// \short All (distinct) nodes in the elements
+ Vector<Node*> Patch_node_pt;
+
+ /// \short The elements in patch p (one for each vertex node, in the
+ /// order in which they are first encountered) are 
+ /// Patch_element[j] for Patch_start[p] <= j < Patch_start[p+1]
+ Vector<unsigned> Patch_start;
+
+ /// \short Flat-packed element numbers of the elements in the patches
+ /// (see Patch_start)
+ Vector<unsigned> Patch_element;
                     
 };
 
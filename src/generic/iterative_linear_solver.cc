@@ -2282,6 +2282,9 @@ namespace oomph
                                    DoubleVector &solution)
   {
 
+    // Not converged yet
+    Converged=false;
+
     // Get number of dofs
     unsigned n_dof=rhs.nrow();
 
@@ -2465,6 +2468,8 @@ namespace oomph
     // if GMRES converges immediately
     if (resid <= Tolerance)
     {
+      Converged=true;
+      Iterations=0;
       if (Doc_time)
       {
         oomph_info << "GMRES converged immediately. Normalised residual norm: "
@@ -2650,6 +2655,7 @@ namespace oomph
           Solution_time = t_end-t_start;
 
           Iterations = iter;
+          Converged = true;
 
           if (Doc_time)
           {
@@ -2717,6 +2723,7 @@ namespace oomph
         Solution_time = t_end-t_start;
 
         Iterations = iter;
+        Converged = true;
 
         if (Doc_time)
         {
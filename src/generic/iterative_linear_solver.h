@@ -1246,6 +1246,7 @@ namespace oomph
 
     /// Constructor
     GMRES() : Iterations(0),
+      Converged(false),
       Matrix_pt(0),
       Resolving(false),
       Matrix_can_be_deleted(true),
@@ -1336,6 +1337,14 @@ namespace oomph
       return Iterations;
     }
 
+    /// \short Did the most recent solve converge to the required
+    /// tolerance? (Only meaningful if the error after max. iterations
+    /// was disabled.)
+    bool converged() const
+    {
+      return Converged;
+    }
+
     /// \short access function indicating whether restarted GMRES is used
     bool iteration_restart() const
     {
@@ -1554,6 +1563,9 @@ namespace oomph
     /// Number of iterations taken
     unsigned Iterations;
 
+    /// Flag indicating if the most recent solve converged
+    bool Converged;
+
     /// \short The number of iterations before the iteration proceedure is
     /// restarted if iteration restart is used
     unsigned Restart;
@@ -45,6 +45,163 @@ namespace oomph
 {
 
 
+  //=============================================================================
+  /// Linear-algebra-type solver for several rhs vectors (the columns of
+  /// rhs). Default implementation: Solve for the first rhs vector (with
+  /// resolves enabled) and then resolve for the remaining ones.
+  //=============================================================================
+  void LinearSolver::solve(DoubleMatrixBase* const &matrix_pt,
+                           const DoubleMultiVector &rhs,
+                           DoubleMultiVector &result)
+  {
+    const unsigned n_vector=rhs.nvector();
+
+#ifdef PARANOID
+    if (!rhs.built())
+    {
+      throw OomphLibError("The rhs multi-vector must be built",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+
+    // Build the result (if required)
+    if ((!result.built()) || (result.nvector()!=n_vector) ||
+        (!(*result.distribution_pt()==*rhs.distribution_pt())))
+    {
+      result.build(n_vector,rhs.distribution_pt(),0.0);
+    }
+    if (n_vector==0) {return;}
+
+    // We need the factors/matrix for the resolves
+    const bool resolve_enabled=Enable_resolve;
+    if (!resolve_enabled) {enable_resolve();}
+
+    // Solve for the first rhs
+    const unsigned n_row_local=rhs.nrow_local();
+    {
+      DoubleVector rhs_0(rhs.doublevector(0)), result_0;
+      solve(matrix_pt,rhs_0,result_0);
+      const double* result_0_pt=result_0.values_pt();
+      double* values_pt=result.values(0);
+      for (unsigned i=0;i<n_row_local;i++)
+      {
+        values_pt[i]=result_0_pt[i];
+      }
+    }
+
+    // ...and resolve for the others
+    if (n_vector>1)
+    {
+      std::vector<int> index(n_vector-1);
+      for (unsigned v=1;v<n_vector;v++) {index[v-1]=v;}
+      DoubleMultiVector rhs_rest(rhs,index,false);
+      DoubleMultiVector result_rest(result,index,false);
+      resolve(rhs_rest,result_rest);
+    }
+
+    // Restore the resolve status
+    if (!resolve_enabled) {disable_resolve();}
+  }
+
+  //=============================================================================
+  /// Resolve for several rhs vectors (the columns of rhs). Default
+  /// implementation: Resolve for each column in turn.
+  //=============================================================================
+  void LinearSolver::resolve(const DoubleMultiVector &rhs,
+                             DoubleMultiVector &result)
+  {
+    const unsigned n_vector=rhs.nvector();
+
+    // Build the result (if required)
+    if ((!result.built()) || (result.nvector()!=n_vector) ||
+        (!(*result.distribution_pt()==*rhs.distribution_pt())))
+    {
+      result.build(n_vector,rhs.distribution_pt(),0.0);
+    }
+
+    const unsigned n_row_local=rhs.nrow_local();
+    for (unsigned v=0;v<n_vector;v++)
+    {
+      // Copy the rhs into a DoubleVector that the solver is allowed to
+      // redistribute
+      DoubleVector rhs_v(rhs.doublevector(v)), result_v;
+      resolve(rhs_v,result_v);
+      const double* result_v_pt=result_v.values_pt();
+      double* values_pt=result.values(v);
+      for (unsigned i=0;i<n_row_local;i++)
+      {
+        values_pt[i]=result_v_pt[i];
+      }
+    }
+  }
+
+  //=============================================================================
+  /// Resolve for the rhs vectors pointed to by rhs_pt, returning the
+  /// solutions in the vectors pointed to by result_pt. The vectors are
+  /// packed into a DoubleMultiVector and passed to the block resolve.
+  //=============================================================================
+  void LinearSolver::resolve(const Vector<DoubleVector*> &rhs_pt,
+                             const Vector<DoubleVector*> &result_pt)
+  {
+    const unsigned n_vector=rhs_pt.size();
+    if (n_vector==0) {return;}
+
+#ifdef PARANOID
+    if (result_pt.size()!=n_vector)
+    {
+      std::ostringstream error_message_stream;
+      error_message_stream
+          << "Number of rhs vectors (" << n_vector << ") does not match "
+          << "the number of result vectors (" << result_pt.size() << ")";
+      throw OomphLibError(error_message_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+    for (unsigned v=1;v<n_vector;v++)
+    {
+      if (!(*rhs_pt[v]->distribution_pt()==*rhs_pt[0]->distribution_pt()))
+      {
+        throw OomphLibError(
+          "All rhs vectors must have the same distribution",
+          OOMPH_CURRENT_FUNCTION,
+          OOMPH_EXCEPTION_LOCATION);
+      }
+    }
+#endif
+
+    // Pack the rhs vectors
+    DoubleMultiVector rhs(n_vector,rhs_pt[0]->distribution_pt(),0.0);
+    const unsigned n_row_local=rhs.nrow_local();
+    for (unsigned v=0;v<n_vector;v++)
+    {
+      const double* rhs_v_pt=rhs_pt[v]->values_pt();
+      double* values_pt=rhs.values(v);
+      for (unsigned i=0;i<n_row_local;i++)
+      {
+        values_pt[i]=rhs_v_pt[i];
+      }
+    }
+
+    // Solve
+    DoubleMultiVector result;
+    resolve(rhs,result);
+
+    // Unpack the solutions (the solver may have redistributed them)
+    for (unsigned v=0;v<n_vector;v++)
+    {
+      result_pt[v]->build(result.distribution_pt(),0.0);
+      double* result_v_pt=result_pt[v]->values_pt();
+      const double* values_pt=result.values(v);
+      const unsigned n_row_local_result=result.nrow_local();
+      for (unsigned i=0;i<n_row_local_result;i++)
+      {
+        result_v_pt[i]=values_pt[i];
+      }
+    }
+  }
+
+
   //=============================================================================
   /// Solver: Takes pointer to problem and returns the results Vector
   /// which contains the solution of the linear system defined by
@@ -353,6 +510,85 @@ namespace oomph
     }
   }
 
+  //=============================================================================
+  /// Do the backsubstitution for the DenseLU solver for several rhs 
+  /// vectors: Each row of the LU factors is applied to all columns
+  /// before moving on to the next one, so the factors are traversed
+  /// only once.
+  /// WARNING: this class does not perform any PARANOID checks on the vectors -
+  /// these are all performed in the solve(...) method.
+  //=============================================================================
+  void DenseLU::backsub(const DoubleMultiVector &rhs,
+                        DoubleMultiVector &result)
+  {
+    const unsigned n_vector = rhs.nvector();
+    const unsigned long n = rhs.nrow();
+
+    //Copy the rhs vectors into the result vectors
+    for (unsigned v=0; v<n_vector; v++)
+    {
+      const double* rhs_pt = rhs.values(v);
+      double* result_pt = result.values(v);
+      for (unsigned long i=0; i<n; ++i)
+      {
+        result_pt[i] = rhs_pt[i];
+      }
+    }
+    double** result_pt = result.values();
+
+    // Loop over all rows for forward substition
+    Vector<double> sum(n_vector);
+    for (unsigned long i=0; i<n; i++)
+    {
+      unsigned long ip = Index[i];
+      for (unsigned v=0; v<n_vector; v++)
+      {
+        sum[v] = result_pt[v][ip];
+        result_pt[v][ip] = result_pt[v][i];
+      }
+      for (unsigned long j=0; j<i; j++)
+      {
+        const double lu = LU_factors[n*i+j];
+        if (lu != 0.0)
+        {
+          for (unsigned v=0; v<n_vector; v++)
+          {
+            sum[v] -= lu*result_pt[v][j];
+          }
+        }
+      }
+      for (unsigned v=0; v<n_vector; v++)
+      {
+        result_pt[v][i] = sum[v];
+      }
+    }
+
+    //Now do the back substitution
+    for (long i=long(n)-1; i>=0; i--)
+    {
+      for (unsigned v=0; v<n_vector; v++)
+      {
+        sum[v] = result_pt[v][i];
+      }
+      for (long j=i+1; j<long(n); j++)
+      {
+        const double lu = LU_factors[n*i+j];
+        if (lu != 0.0)
+        {
+          for (unsigned v=0; v<n_vector; v++)
+          {
+            sum[v] -= lu*result_pt[v][j];
+          }
+        }
+      }
+      const double pivot = LU_factors[n*i+i];
+      for (unsigned v=0; v<n_vector; v++)
+      {
+        result_pt[v][i] = sum[v]/pivot;
+      }
+    }
+  }
+
   //=============================================================================
   /// Do the backsubstitution for the DenseLU solver.
   /// WARNING: this class does not perform any PARANOID checks on the vectors -
@@ -546,6 +782,67 @@ namespace oomph
     if (!Enable_resolve) {clean_up_memory();}
   }
 
+  //=============================================================================
+  /// \short Linear-algebra-type solver for several rhs vectors (the
+  /// columns of rhs): Factorise the matrix once and do a single
+  /// backsubstitution sweep for all rhs vectors.
+  //=============================================================================
+  void DenseLU::solve(DoubleMatrixBase* const &matrix_pt,
+                      const DoubleMultiVector &rhs,
+                      DoubleMultiVector &result)
+  {
+#ifdef PARANOID
+    if (rhs.distribution_pt()->distributed())
+    {
+      throw OomphLibError("The rhs vectors must not be distributed",
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+    if (matrix_pt->nrow() != rhs.nrow())
+    {
+      std::ostringstream error_message_stream;
+      error_message_stream
+          << "The matrix and the rhs vectors must have the same number of rows.";
+      throw OomphLibError(error_message_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+
+    // Build the result (if required)
+    if ((!result.built()) || (result.nvector()!=rhs.nvector()) ||
+        (!(*result.distribution_pt()==*rhs.distribution_pt())))
+    {
+      result.build(rhs.nvector(),rhs.distribution_pt(),0.0);
+    }
+
+    // set the distribution
+    this->build_distribution(rhs.distribution_pt());
+
+    // Time the solver
+    double t_start = TimingHelpers::timer();
+
+    // factorise
+    factorise(matrix_pt);
+
+    // backsubstitute
+    backsub(rhs,result);
+
+    //Doc time for solver
+    double t_end = TimingHelpers::timer();
+
+    Solution_time = t_end-t_start;
+    if (Doc_time)
+    {
+      oomph_info << std::endl << "CPU for solve with DenseLU for "
+                 << rhs.nvector() << " rhs vectors [sec]: "
+                 << Solution_time << std::endl << std::endl;
+    }
+
+    //If we are not resolving then delete storage
+    if (!Enable_resolve) {clean_up_memory();}
+  }
+
   //==================================================================
   /// Solver: Takes pointer to problem and returns the results Vector
   /// which contains the solution of the linear system defined by
@@ -1735,6 +2032,101 @@ namespace oomph
   }
 
 
+  //===============================================================
+  /// Solve for several rhs vectors (the columns of rhs): factorise
+  /// the matrix and do the triangular solves for all rhs vectors 
+  /// in a single sweep over the LU factors.
+  //===============================================================
+  void SuperLUSolver::solve(DoubleMatrixBase* const &matrix_pt,
+                            const DoubleMultiVector &rhs,
+                            DoubleMultiVector &result)
+  {
+    // Initialise timer
+    double t_start = TimingHelpers::timer();
+
+#ifdef PARANOID
+    // check that the rhs vector is setup
+    if (!rhs.built())
+    {
+      std::ostringstream error_message_stream;
+      error_message_stream
+          << "The vectors rhs must be setup";
+      throw OomphLibError(error_message_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+
+    // check that the matrix and the rhs vector have the same nrow()
+    if (matrix_pt->nrow() != rhs.nrow())
+    {
+      std::ostringstream error_message_stream;
+      error_message_stream
+          << "The matrix and the rhs vector must have the same number of rows.";
+      throw OomphLibError(error_message_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+
+    // set the distribution
+    if (dynamic_cast<DistributableLinearAlgebraObject*>(matrix_pt))
+    {
+      // the solver has the same distribution as the matrix if possible
+      this->build_distribution(dynamic_cast<DistributableLinearAlgebraObject*>
+                               (matrix_pt)->distribution_pt());
+    }
+    else
+    {
+      // the solver has the same distribution as the RHS
+      this->build_distribution(rhs.distribution_pt());
+    }
+
+    // Factorise the matrix
+    factorise(matrix_pt);
+
+    //Now do the back solve
+    backsub(rhs,result);
+
+    // Doc time for solve
+    double t_end = TimingHelpers::timer();
+    Solution_time = t_end-t_start;
+    if (Doc_time)
+    {
+      oomph_info << "Time for SuperLUSolver solve (ndof="
+                 << matrix_pt->nrow() << ", nrhs=" << rhs.nvector() 
+                 << ") [sec]: " << Solution_time << std::endl;
+    }
+
+    // If we are not storing the solver data for resolves, delete it
+    if (!Enable_resolve)
+    {
+      clean_up_memory();
+    }
+  }
+
+  //===============================================================
+  /// Resolve the system for several rhs vectors (the columns of rhs)
+  //===============================================================
+  void SuperLUSolver::resolve(const DoubleMultiVector &rhs,
+                              DoubleMultiVector &result)
+  {
+    // Store starting time for solve
+    double t_start = TimingHelpers::timer();
+
+    // backsub
+    backsub(rhs,result);
+
+    // Doc time for solve
+    double t_end = TimingHelpers::timer();
+    Solution_time = t_end-t_start;
+    if (Doc_time)
+    {
+      oomph_info << "Time for SuperLUSolver solve (ndof=" << rhs.nrow()
+                 << ", nrhs=" << rhs.nvector() << ") [sec]: " 
+                 << t_end-t_start << std::endl;
+    }
+  }
+
   //===================================================================
   ///\short LU decompose the matrix addressed by matrix_pt by using
   /// the SuperLU solver. The resulting matrix factors are stored
@@ -2211,6 +2603,45 @@ namespace oomph
     }
   }
 
+  //=============================================================================
+  /// Do the backsubstitution for several rhs vectors (the columns of rhs).
+  /// SuperLU (serial) processes all rhs vectors in a single call; for
+  /// SuperLU_DIST the rhs vectors are processed one at a time.
+  /// Note - this method performs no paranoid checks on the factors - these 
+  /// are all performed in solve(...) and resolve(...)
+  //=============================================================================
+  void SuperLUSolver::backsub(const DoubleMultiVector &rhs,
+                              DoubleMultiVector &result)
+  {
+#ifdef OOMPH_HAS_MPI
+    if (Using_dist)
+    {
+      const unsigned n_vector=rhs.nvector();
+      if ((!result.built()) || (result.nvector()!=n_vector) ||
+          (!(*result.distribution_pt()==*this->distribution_pt())))
+      {
+        result.build(n_vector,this->distribution_pt(),0.0);
+      }
+      const unsigned n_row_local=result.nrow_local();
+      for (unsigned v=0;v<n_vector;v++)
+      {
+        DoubleVector rhs_v(rhs.doublevector(v)), result_v;
+        backsub_distributed(rhs_v,result_v);
+        const double* result_v_pt=result_v.values_pt();
+        double* values_pt=result.values(v);
+        for (unsigned i=0;i<n_row_local;i++)
+        {
+          values_pt[i]=result_v_pt[i];
+        }
+      }
+    }
+    else
+#endif
+    {
+      backsub_serial(rhs,result);
+    }
+  }
+
 #ifdef OOMPH_HAS_MPI
   //=========================================================================
   ///Static warning to suppress warnings about incorrect distribution of
@@ -2533,6 +2964,123 @@ namespace oomph
     }
   }
 
+  //================================================================
+  /// Do the backsubstitution for SuperLU for several rhs vectors: 
+  /// The rhs vectors are copied into a contiguous (column major) block
+  /// and the triangular solves are done for all of them in one call.
+  //================================================================
+  void SuperLUSolver::backsub_serial(const DoubleMultiVector &rhs,
+                                     DoubleMultiVector &result)
+  {
+    //Find the number of unknowns
+    int n = rhs.nrow();
+
+    //Number of RHSs
+    int nrhs = rhs.nvector();
+
+#ifdef PARANOID
+    // PARANOID check that this rhs distribution is setup
+    if (!rhs.built())
+    {
+      std::ostringstream error_message_stream;
+      error_message_stream
+          << "The rhs vector distribution must be setup.";
+      throw OomphLibError(error_message_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+    // PARANOID check that the rhs has the right number of global rows
+    if (static_cast<int>(Serial_n_dof) != n)
+    {
+      throw OomphLibError(
+        "RHS does not have the same dimension as the linear system",
+        OOMPH_CURRENT_FUNCTION,
+        OOMPH_EXCEPTION_LOCATION);
+    }
+    // PARANOID check that the rhs is not distributed
+    if (rhs.distribution_pt()->distributed())
+    {
+      std::ostringstream error_message_stream;
+      error_message_stream
+          << "The rhs vector must not be distributed.";
+      throw OomphLibError(error_message_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+
+    // Build the result (if required)
+    if ((!result.built()) || (result.nvector()!=rhs.nvector()) ||
+        (!(*result.distribution_pt()==*rhs.distribution_pt())))
+    {
+      result.build(rhs.nvector(),rhs.distribution_pt(),0.0);
+    }
+    if (nrhs==0) {return;}
+
+    // Can we work in the result's storage directly? Only if its 
+    // columns are stored contiguously
+    bool contiguous=true;
+    for (int v=1;v<nrhs;v++)
+    {
+      if (result.values(v)!=result.values(0)+v*n) {contiguous=false;}
+    }
+    Vector<double> block_storage;
+    double* block_pt=result.values(0);
+    if (!contiguous)
+    {
+      block_storage.resize(n*nrhs);
+      block_pt=&block_storage[0];
+    }
+
+    // copy rhs to result
+    for (int v=0;v<nrhs;v++)
+    {
+      const double* rhs_pt=rhs.values(v);
+      double* column_pt=block_pt+v*n;
+      for (int i=0;i<n;i++)
+      {
+        column_pt[i]=rhs_pt[i];
+      }
+    }
+
+    //Cast the boolean flags to ints for SuperLU
+    int transpose = Serial_compressed_row_flag;
+    int doc = Doc_stats;
+
+    //Do the backsubsitition phase
+    int i=2;
+    superlu(&i, &n, 0,  &nrhs,
+            0, 0, 0,
+            block_pt, &n,  &transpose, &doc,
+            &Serial_f_factors, &Serial_info);
+
+    // Throw an error if superLU returned an error status in info.
+    if (Serial_info != 0)
+    {
+      std::ostringstream error_msg;
+      error_msg << "SuperLU returned the error status code "
+                << Serial_info
+                << " . See the SuperLU documentation for what this means.";
+      throw OomphLibError(error_msg.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+    }
+
+    // Copy the solutions back if required
+    if (!contiguous)
+    {
+      for (int v=0;v<nrhs;v++)
+      {
+        const double* column_pt=block_pt+v*n;
+        double* result_pt=result.values(v);
+        for (int i=0;i<n;i++)
+        {
+          result_pt[i]=column_pt[i];
+        }
+      }
+    }
+  }
+
   //=============================================================================
   /// Clean up the memory
   //=============================================================================
@@ -43,6 +43,7 @@
 //oomph-lib headers
 #include "Vector.h"
 #include "double_vector.h"
+#include "double_multi_vector.h"
 #include "matrices.h"
 
 namespace oomph
@@ -235,6 +236,32 @@ class LinearSolver : public DistributableLinearAlgebraObject
 		      OOMPH_EXCEPTION_LOCATION);
  } // End of resolve_transpose
 
+ /// \short Linear-algebra-type solver for several right-hand sides:
+ /// Takes pointer to a matrix and a multi-vector whose columns are 
+ /// the rhs vectors and returns the solutions in the columns of result.
+ /// The default implementation solves for the first rhs and resolves
+ /// for the others; solvers that can process all rhs vectors in a 
+ /// single sweep (e.g. a single forward/back substitution) overload it.
+ virtual void solve(DoubleMatrixBase* const &matrix_pt,
+                    const DoubleMultiVector &rhs,
+                    DoubleMultiVector &result);
+
+ /// \short Resolve the system defined by the last assembled jacobian
+ /// for the rhs vectors stored in the columns of rhs. The solutions are 
+ /// returned in the columns of result. The default implementation calls
+ /// resolve(...) for each column in turn.
+ virtual void resolve(const DoubleMultiVector &rhs, 
+                      DoubleMultiVector &result);
+
+ /// \short Resolve the system defined by the last assembled jacobian
+ /// for the rhs vectors pointed to by rhs_pt; the solutions are returned
+ /// in the vectors pointed to by result_pt. The vectors are packed into 
+ /// a DoubleMultiVector so that solvers with a block resolve only 
+ /// traverse their factors/matrix once. All rhs vectors must have 
+ /// the same distribution.
+ void resolve(const Vector<DoubleVector*> &rhs_pt,
+              const Vector<DoubleVector*> &result_pt);
+
  /// \short Empty virtual function that can be overloaded in specific
  /// linear solvers to clean up any memory that may have been
  /// allocated (e.g. when preparing for a re-solve).
@@ -365,6 +392,13 @@ class DenseLU : public LinearSolver
 	    const Vector<double> &rhs,
             Vector<double> &result);
 
+ /// \short Linear-algebra-type solver for several rhs vectors (stored
+ /// in the columns of rhs): The LU factors are traversed only once 
+ /// for all rhs vectors.
+ void solve(DoubleMatrixBase* const &matrix_pt,
+	    const DoubleMultiVector &rhs,
+            DoubleMultiVector &result);
+
  ///  \short returns the time taken to assemble the jacobian matrix and 
  /// residual vector
  double jacobian_setup_time() const
@@ -391,6 +425,10 @@ class DenseLU : public LinearSolver
  /// perform back substitution using Vector<double>
  void backsub(const Vector<double> &rhs, Vector<double> &result);
 
+ /// \short Do the backsubstitution for several rhs vectors at once, 
+ /// i.e. solve LU result = rhs for each column of rhs.
+ void backsub(const DoubleMultiVector &rhs, DoubleMultiVector &result);
+
  /// Clean up the stored LU factors
  void clean_up_memory();
 
@@ -602,6 +640,19 @@ class SuperLUSolver : public LinearSolver
  /// Jacobian and the specified rhs vector if resolve has been enabled.
  void resolve_transpose(const DoubleVector &rhs, DoubleVector &result);
 
+ /// \short Linear-algebra-type solver for several rhs vectors (stored
+ /// in the columns of rhs): The matrix is factorised once and the 
+ /// triangular solves are performed for all rhs vectors in a single
+ /// sweep over the LU factors.
+ void solve(DoubleMatrixBase* const &matrix_pt,
+            const DoubleMultiVector &rhs,
+            DoubleMultiVector &result);
+
+ /// \short Resolve the system defined by the last assembled jacobian
+ /// for several rhs vectors (stored in the columns of rhs) 
+ /// if resolve has been enabled.
+ void resolve(const DoubleMultiVector &rhs, DoubleMultiVector &result);
+
  /// Enable documentation of solver statistics
  void enable_doc_stats() {Doc_stats = true;}
 
@@ -637,6 +688,11 @@ class SuperLUSolver : public LinearSolver
  void backsub_transpose(const DoubleVector& rhs,
 			DoubleVector& result);
  
+ /// \short Do the backsubstitution for several rhs vectors (stored in
+ /// the columns of rhs)
+ void backsub(const DoubleMultiVector &rhs,
+              DoubleMultiVector &result);
+ 
  /// Clean up the memory allocated by the solver
  void clean_up_memory();
 
@@ -731,6 +787,11 @@ class SuperLUSolver : public LinearSolver
  void backsub_transpose_serial(const DoubleVector &rhs,
 			       DoubleVector &result);
 
+ /// \short Multiple rhs backsub method for SuperLU (serial): The
+ /// triangular solves are done for all rhs vectors in a single call
+ void backsub_serial(const DoubleMultiVector &rhs,
+                     DoubleMultiVector &result);
+
 #ifdef OOMPH_HAS_MPI
   /// factorise method for SuperLU Dist
  void factorise_distributed(DoubleMatrixBase* const &matrix_pt);
@@ -41,6 +41,7 @@
 #include "elastic_problems.h"
 #include "refineable_mesh.h"
 #include "triangle_mesh.h"
+#include "mesh_plot_data.h"
 #include "shape.h"
 
 namespace oomph
@@ -57,6 +58,12 @@ Steady<0> Mesh::Default_TimeStepper;
 //=======================================================================
 bool Mesh::Suppress_warning_about_empty_mesh_level_time_stepper_function=false;
 
+//=======================================================================
+/// Min. number of nodes or elements per thread in the threaded
+/// equation numbering
+//=======================================================================
+unsigned Mesh::Min_nobject_per_eqn_numbering_thread=1000;
+
 //=======================================================================
 /// Merge meshes.
 /// Note: This simply merges the meshes' elements and nodes (ignoring
@@ -521,8 +528,77 @@ void Mesh::node_update(const bool& update_all_solid_nodes)
    // Replace the Mesh's i-th node pointer with the reordered node pointer
    node_pt(i)=reordering[i];
   }
+
+  // Re-pool the nodal storage in the new order (unless this would
+  // invalidate the pointers to the dofs; the existing pool remains
+  // valid, though no longer in the order of the nodes)
+  if ((Nodal_storage_pool_pt!=0)&&(!nodal_values_have_eqn_numbers()))
+   {
+    enable_pooled_nodal_storage();
+   }
  } // End of reorder_nodes
 
+
+//=======================================================
+/// Do any of the values stored at the nodes have (global)
+/// equation numbers?
+//========================================================
+ bool Mesh::nodal_values_have_eqn_numbers() const
+ {
+  const unsigned long n_node=Node_pt.size();
+  for (unsigned long n=0;n<n_node;n++)
+   {
+    Node* const nod_pt=Node_pt[n];
+    if (nod_pt->is_a_copy()) {continue;}
+    const unsigned n_value=nod_pt->nvalue();
+    for (unsigned i=0;i<n_value;i++)
+     {
+      if (nod_pt->eqn_number(i)>=0) {return true;}
+     }
+   }
+  return false;
+ }
+
+//=======================================================
+/// Move the values, history values, equation numbers and 
+/// positions of all nodes into contiguous pooled storage 
+/// owned by the mesh.
+//========================================================
+ void Mesh::enable_pooled_nodal_storage(
+  const bool& equations_will_be_renumbered)
+ {
+  if ((!equations_will_be_renumbered)&&nodal_values_have_eqn_numbers())
+   {
+    throw OomphLibError(
+     "The equations have already been numbered, so moving the nodal\n"
+     "values into pooled storage would leave the pointers to the dofs\n"
+     "(in the Problem and the elements) dangling. Enable the pooled\n"
+     "storage before numbering the equations or use\n"
+     "Problem::enable_pooled_nodal_storage(), which renumbers them.\n",
+     OOMPH_CURRENT_FUNCTION,
+     OOMPH_EXCEPTION_LOCATION);
+   }
+  if (Nodal_storage_pool_pt==0)
+   {
+    Nodal_storage_pool_pt=new NodalStoragePool;
+   }
+  Nodal_storage_pool_pt->build(Node_pt);
+ }
+
+//=======================================================
+/// Give the nodes back their own storage and delete the 
+/// pooled storage.
+//========================================================
+ void Mesh::disable_pooled_nodal_storage()
+ {
+  if (Nodal_storage_pool_pt!=0)
+   {
+    Nodal_storage_pool_pt->release(Node_pt);
+    delete Nodal_storage_pool_pt;
+    Nodal_storage_pool_pt=0;
+   }
+ }
+
 //=======================================================
 /// Get a vector of the nodes in the order in which they are encountered
 /// when stepping through the elements (similar to reorder_nodes() but
@@ -640,6 +716,187 @@ void Mesh::node_update(const bool& update_all_solid_nodes)
  } // End of get_node_reordering
 
 
+//========================================================
+/// Reorder the elements to improve the locality of memory
+/// accesses: Either along a space-filling curve through the 
+/// elements' centroids or by a reverse Cuthill-McKee ordering
+/// of the graph of elements that share nodes.
+//========================================================
+ void Mesh::reorder_elements_for_locality(const unsigned& reordering)
+ {
+  const unsigned long n_element=nelement();
+  if ((reordering==No_locality_reordering)||(n_element==0)) {return;}
+
+  Vector<unsigned long> ordering;
+  if ((reordering==Morton_reordering)||(reordering==Hilbert_reordering))
+   {
+    // Centroids of the elements (empty for elements without nodes)
+    Vector<Vector<double> > centroid(n_element);
+    for (unsigned long e=0;e<n_element;e++)
+     {
+      FiniteElement* el_pt=dynamic_cast<FiniteElement*>(Element_pt[e]);
+      if (el_pt==0) {continue;}
+      const unsigned n_node=el_pt->nnode();
+      if (n_node==0) {continue;}
+      const unsigned n_dim=el_pt->node_pt(0)->ndim();
+      centroid[e].resize(n_dim,0.0);
+      for (unsigned j=0;j<n_node;j++)
+       {
+        for (unsigned i=0;i<n_dim;i++)
+         {
+          centroid[e][i]+=el_pt->node_pt(j)->x(i)/double(n_node);
+         }
+       }
+     }
+    LocalityReorderingHelpers::
+     space_filling_curve_ordering(centroid,
+                                  (reordering==Hilbert_reordering),
+                                  ordering);
+   }
+  else if (reordering==Reverse_cuthill_mckee_reordering)
+   {
+    // The groups are the nodes; their members the elements 
+    // that share them
+    std::map<Node*,unsigned long> node_number;
+    Vector<Vector<unsigned long> > node_element;
+    std::vector<bool> has_nodes(n_element,false);
+    for (unsigned long e=0;e<n_element;e++)
+     {
+      FiniteElement* el_pt=dynamic_cast<FiniteElement*>(Element_pt[e]);
+      if (el_pt==0) {continue;}
+      const unsigned n_node=el_pt->nnode();
+      for (unsigned j=0;j<n_node;j++)
+       {
+        std::map<Node*,unsigned long>::iterator it=
+         node_number.find(el_pt->node_pt(j));
+        if (it==node_number.end())
+         {
+          node_number[el_pt->node_pt(j)]=node_element.size();
+          node_element.push_back(Vector<unsigned long>(1,e));
+         }
+        else
+         {
+          node_element[it->second].push_back(e);
+         }
+        has_nodes[e]=true;
+       }
+     }
+    const unsigned long n_group=node_element.size();
+    Vector<unsigned long> group_start(n_group+1,0);
+    Vector<unsigned long> group_vertex;
+    for (unsigned long g=0;g<n_group;g++)
+     {
+      group_vertex.insert(group_vertex.end(),
+                          node_element[g].begin(),node_element[g].end());
+      group_start[g+1]=group_vertex.size();
+     }
+    Vector<unsigned long> rcm_ordering;
+    LocalityReorderingHelpers::reverse_cuthill_mckee(n_element,group_start,
+                                                     group_vertex,
+                                                     rcm_ordering);
+
+    // Move elements without nodes (isolated in the graph) to the end
+    ordering.reserve(n_element);
+    for (unsigned long k=0;k<n_element;k++)
+     {
+      if (has_nodes[rcm_ordering[k]]) {ordering.push_back(rcm_ordering[k]);}
+     }
+    for (unsigned long e=0;e<n_element;e++)
+     {
+      if (!has_nodes[e]) {ordering.push_back(e);}
+     }
+   }
+  else
+   {
+    std::ostringstream error_stream;
+    error_stream << "Unknown locality reordering " << reordering << std::endl;
+    throw OomphLibError(error_stream.str(),
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+
+  Vector<GeneralisedElement*> old_element_pt(Element_pt);
+  for (unsigned long k=0;k<n_element;k++)
+   {
+    Element_pt[k]=old_element_pt[ordering[k]];
+   }
+ }
+
+
+//========================================================
+/// Reorder the nodes to improve the locality of memory
+/// accesses: Either along a space-filling curve through their 
+/// positions or by a reverse Cuthill-McKee ordering of the graph 
+/// of nodes that share elements.
+//========================================================
+ void Mesh::reorder_nodes_for_locality(const unsigned& reordering)
+ {
+  const unsigned long n_node=nnode();
+  if ((reordering==No_locality_reordering)||(n_node==0)) {return;}
+
+  Vector<unsigned long> ordering;
+  if ((reordering==Morton_reordering)||(reordering==Hilbert_reordering))
+   {
+    Vector<Vector<double> > x(n_node);
+    for (unsigned long j=0;j<n_node;j++)
+     {
+      const unsigned n_dim=Node_pt[j]->ndim();
+      x[j].resize(n_dim);
+      for (unsigned i=0;i<n_dim;i++) {x[j][i]=Node_pt[j]->x(i);}
+     }
+    LocalityReorderingHelpers::
+     space_filling_curve_ordering(x,(reordering==Hilbert_reordering),
+                                  ordering);
+   }
+  else if (reordering==Reverse_cuthill_mckee_reordering)
+   {
+    // The groups are the elements; their members the nodes 
+    std::map<Node*,unsigned long> node_number;
+    for (unsigned long j=0;j<n_node;j++) {node_number[Node_pt[j]]=j;}
+    const unsigned long n_element=nelement();
+    Vector<unsigned long> group_start(1,0);
+    Vector<unsigned long> group_vertex;
+    for (unsigned long e=0;e<n_element;e++)
+     {
+      FiniteElement* el_pt=dynamic_cast<FiniteElement*>(Element_pt[e]);
+      if (el_pt==0) {continue;}
+      const unsigned n_el_node=el_pt->nnode();
+      for (unsigned j=0;j<n_el_node;j++)
+       {
+        // Ignore nodes that are not stored in this mesh
+        std::map<Node*,unsigned long>::iterator it=
+         node_number.find(el_pt->node_pt(j));
+        if (it!=node_number.end()) {group_vertex.push_back(it->second);}
+       }
+      group_start.push_back(group_vertex.size());
+     }
+    LocalityReorderingHelpers::reverse_cuthill_mckee(n_node,group_start,
+                                                     group_vertex,ordering);
+   }
+  else
+   {
+    std::ostringstream error_stream;
+    error_stream << "Unknown locality reordering " << reordering << std::endl;
+    throw OomphLibError(error_stream.str(),
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+
+  Vector<Node*> old_node_pt(Node_pt);
+  for (unsigned long k=0;k<n_node;k++)
+   {
+    Node_pt[k]=old_node_pt[ordering[k]];
+   }
+
+  // Re-pool the nodal storage in the new order (unless this would
+  // invalidate the pointers to the dofs, see reorder_nodes())
+  if ((Nodal_storage_pool_pt!=0)&&(!nodal_values_have_eqn_numbers()))
+   {
+    enable_pooled_nodal_storage();
+   }
+ }
+
+
 //========================================================
 /// Virtual Destructor to clean up all memory
 //========================================================
@@ -664,12 +921,145 @@ Mesh::~Mesh()
  // Wipe the storage for all externally-based elements and delete halos
  delete_all_external_storage();
 
+ // Now that the nodes have gone we can free any pooled storage
+ delete Nodal_storage_pool_pt; Nodal_storage_pool_pt=0;
 }
 
+#ifdef OOMPH_HAS_PTHREADS
+
 //========================================================
-/// Assign (global) equation numbers to the nodes
+/// Helpers for the threaded equation numbering in Mesh
 //========================================================
-unsigned long Mesh::assign_global_eqn_numbers(Vector<double *> &Dof_pt)
+namespace MeshEqnNumberingHelpers
+{
+
+ //=====================================================================
+ /// \short Work for one of the threads in 
+ /// Mesh::assign_global_eqn_numbers(...) or 
+ /// Mesh::assign_local_eqn_numbers(...): The nodes 
+ /// First_node,...,Last_node-1 and the elements
+ /// First_element,...,Last_element-1.
+ //=====================================================================
+ class EqnNumberingChunk
+ {
+
+   public:
+
+  /// Constructor: Everything is set up by the caller
+  EqnNumberingChunk() : Mesh_pt(0), First_node(0), Last_node(0), 
+   First_element(0), Last_element(0), Node_eqn_number(0), 
+   Element_eqn_number(0), Store_local_dof_pt(false) {}
+
+  /// The mesh
+  Mesh* Mesh_pt;
+
+  /// First node to be numbered
+  unsigned long First_node;
+
+  /// One after the last node to be numbered
+  unsigned long Last_node;
+
+  /// First element to be numbered
+  unsigned long First_element;
+
+  /// One after the last element to be numbered
+  unsigned long Last_element;
+
+  /// \short Global equation number of the first unknown in the nodes;
+  /// one after the last one on return
+  unsigned long Node_eqn_number;
+
+  /// \short Global equation number of the first unknown in the elements'
+  /// internal data; one after the last one on return
+  unsigned long Element_eqn_number;
+
+  /// Pointers to the unknowns in the nodes, in the order of numbering
+  Vector<double*> Node_dof_pt;
+
+  /// \short Pointers to the unknowns in the elements' internal data,
+  /// in the order of numbering
+  Vector<double*> Element_dof_pt;
+
+  /// Store pointers to the dofs in the elements (local numbering)?
+  bool Store_local_dof_pt;
+
+ };
+
+
+ //=====================================================================
+ /// \short Work for one thread in the global numbering: Number the
+ /// chunk's nodes and internal data, starting from the chunk's
+ /// equation numbers. The argument is a pointer to an EqnNumberingChunk.
+ //=====================================================================
+ void global_eqn_numbering_chunk_work(void* chunk_pt)
+ {
+  EqnNumberingChunk* c_pt=static_cast<EqnNumberingChunk*>(chunk_pt);
+  c_pt->Node_dof_pt.clear();
+  for (unsigned long i=c_pt->First_node;i<c_pt->Last_node;i++)
+   {
+    c_pt->Mesh_pt->node_pt(i)->assign_eqn_numbers(c_pt->Node_eqn_number,
+                                                   c_pt->Node_dof_pt);
+   }
+  c_pt->Element_dof_pt.clear();
+  for (unsigned long i=c_pt->First_element;i<c_pt->Last_element;i++)
+   {
+    c_pt->Mesh_pt->element_pt(i)->
+     assign_internal_eqn_numbers(c_pt->Element_eqn_number,
+                                 c_pt->Element_dof_pt);
+   }
+ }
+
+
+ //=====================================================================
+ /// \short Work for one thread in the local numbering: Assign the local
+ /// equation numbers in the chunk's elements. The argument is a pointer
+ /// to an EqnNumberingChunk.
+ //=====================================================================
+ void local_eqn_numbering_chunk_work(void* chunk_pt)
+ {
+  EqnNumberingChunk* c_pt=static_cast<EqnNumberingChunk*>(chunk_pt);
+  for (unsigned long i=c_pt->First_element;i<c_pt->Last_element;i++)
+   {
+    c_pt->Mesh_pt->element_pt(i)->
+     assign_local_eqn_numbers(c_pt->Store_local_dof_pt);
+   }
+ }
+
+
+ //=====================================================================
+ /// \short Process all chunks concurrently with work_fct_pt (see
+ /// ThreadingHelpers::do_work_in_threads(...)). Throws an OomphLibError
+ /// with the collated error messages if any chunk failed.
+ //=====================================================================
+ void do_work_in_threads(Vector<EqnNumberingChunk>& chunk,
+                         ThreadingHelpers::ChunkWorkFctPt work_fct_pt)
+ {
+  std::string error_message=
+   ThreadingHelpers::do_work_in_threads(work_fct_pt,chunk);
+  if (!error_message.empty())
+   {
+    throw OomphLibError(error_message,
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+ }
+
+}
+
+#endif
+
+
+//========================================================
+/// Assign (global) equation numbers to the nodes and the
+/// elements' internal data. With pthreads, the work is split
+/// into contiguous chunks of nodes and elements for up to n_thread
+/// threads: Each chunk is first numbered from zero to count its
+/// unknowns; the chunks are then renumbered from the offsets given
+/// by the prefix sums of these counts, which reproduces the serial
+/// numbering, and their dof pointers are appended in order.
+//========================================================
+unsigned long Mesh::assign_global_eqn_numbers(Vector<double *> &Dof_pt,
+                                              const unsigned& n_thread)
 {
  //Find out the current number of equations
  unsigned long equation_number=Dof_pt.size();
@@ -677,13 +1067,84 @@ unsigned long Mesh::assign_global_eqn_numbers(Vector<double *> &Dof_pt)
  //Loop over the nodes and call their assigment functions
  unsigned long nnod = Node_pt.size();
 
+ //Number of elements
+ unsigned long nel = Element_pt.size();
+
+#ifdef OOMPH_HAS_PTHREADS
+
+ // How many threads are worth it?
+ unsigned n_chunk=n_thread;
+ if (Min_nobject_per_eqn_numbering_thread>0)
+  {
+   n_chunk=std::min(n_chunk,unsigned(std::max(nnod,nel)/
+                                      Min_nobject_per_eqn_numbering_thread));
+  }
+ if (n_chunk>1)
+  {
+   Vector<MeshEqnNumberingHelpers::EqnNumberingChunk> chunk(n_chunk);
+   for (unsigned t=0;t<n_chunk;t++)
+    {
+     chunk[t].Mesh_pt=this;
+     chunk[t].First_node=(t*nnod)/n_chunk;
+     chunk[t].Last_node=((t+1)*nnod)/n_chunk;
+     chunk[t].First_element=(t*nel)/n_chunk;
+     chunk[t].Last_element=((t+1)*nel)/n_chunk;
+    }
+
+   // Count the unknowns in each chunk
+   MeshEqnNumberingHelpers::do_work_in_threads(
+    chunk,&MeshEqnNumberingHelpers::global_eqn_numbering_chunk_work);
+
+   // Prefix sums: The nodes come first, followed by the internal data
+   unsigned long node_eqn_number=equation_number;
+   for (unsigned t=0;t<n_chunk;t++)
+    {
+     unsigned long n_dof_in_chunk=chunk[t].Node_eqn_number;
+     chunk[t].Node_eqn_number=node_eqn_number;
+     node_eqn_number+=n_dof_in_chunk;
+    }
+   unsigned long element_eqn_number=node_eqn_number;
+   for (unsigned t=0;t<n_chunk;t++)
+    {
+     unsigned long n_dof_in_chunk=chunk[t].Element_eqn_number;
+     chunk[t].Element_eqn_number=element_eqn_number;
+     element_eqn_number+=n_dof_in_chunk;
+    }
+
+   // Now assign the actual equation numbers
+   MeshEqnNumberingHelpers::do_work_in_threads(
+    chunk,&MeshEqnNumberingHelpers::global_eqn_numbering_chunk_work);
+
+   // Append the pointers to the dofs
+   Dof_pt.reserve(element_eqn_number);
+   for (unsigned t=0;t<n_chunk;t++)
+    {
+     Dof_pt.insert(Dof_pt.end(),chunk[t].Node_dof_pt.begin(),
+                   chunk[t].Node_dof_pt.end());
+    }
+   for (unsigned t=0;t<n_chunk;t++)
+    {
+     Dof_pt.insert(Dof_pt.end(),chunk[t].Element_dof_pt.begin(),
+                   chunk[t].Element_dof_pt.end());
+    }
+
+   //Return the total number of equations
+   return element_eqn_number;
+  }
+
+#else
+
+ // The number of threads is only used with pthreads
+ (void)n_thread;
+
+#endif
+
  for(unsigned long i=0;i<nnod;i++)
   {
    Node_pt[i]->assign_eqn_numbers(equation_number,Dof_pt);
   }
 
  //Loop over the elements and number their internals
- unsigned long nel = Element_pt.size();
  for(unsigned long i=0;i<nel;i++)
   {
    Element_pt[i]->assign_internal_eqn_numbers(equation_number,Dof_pt);
@@ -755,12 +1216,48 @@ void Mesh::describe_local_dofs(std::ostream& out,
 
 
 //========================================================
-/// Assign local equation numbers in all elements
+/// Assign local equation numbers in all elements. With pthreads, 
+/// contiguous chunks of elements are numbered by up to n_thread
+/// threads, unless the pointers to the dofs are to be stored in the 
+/// elements (this uses static storage in GeneralisedElement).
 //========================================================
-void Mesh::assign_local_eqn_numbers(const bool &store_local_dof_pt)
+void Mesh::assign_local_eqn_numbers(const bool &store_local_dof_pt,
+                                    const unsigned& n_thread)
 {
- //Now loop over the elements and assign local equation numbers
  unsigned long Element_pt_range = Element_pt.size();
+
+#ifdef OOMPH_HAS_PTHREADS
+
+ // How many threads are worth it?
+ unsigned n_chunk=store_local_dof_pt ? 1 : n_thread;
+ if (Min_nobject_per_eqn_numbering_thread>0)
+  {
+   n_chunk=std::min(n_chunk,unsigned(Element_pt_range/
+                                      Min_nobject_per_eqn_numbering_thread));
+  }
+ if (n_chunk>1)
+  {
+   Vector<MeshEqnNumberingHelpers::EqnNumberingChunk> chunk(n_chunk);
+   for (unsigned t=0;t<n_chunk;t++)
+    {
+     chunk[t].Mesh_pt=this;
+     chunk[t].First_element=(t*Element_pt_range)/n_chunk;
+     chunk[t].Last_element=((t+1)*Element_pt_range)/n_chunk;
+     chunk[t].Store_local_dof_pt=store_local_dof_pt;
+    }
+   MeshEqnNumberingHelpers::do_work_in_threads(
+    chunk,&MeshEqnNumberingHelpers::local_eqn_numbering_chunk_work);
+   return;
+  }
+
+#else
+
+ // The number of threads is only used with pthreads
+ (void)n_thread;
+
+#endif
+
+ //Now loop over the elements and assign local equation numbers
  for(unsigned long i=0;i<Element_pt_range;i++)
   {
    Element_pt[i]->assign_local_eqn_numbers(store_local_dof_pt);
@@ -1213,6 +1710,135 @@ void Mesh::read(std::ifstream &restart_file)
   }
 }
 
+
+//===================================================================
+/// Dump the data in the mesh in binary restart format, i.e. append 
+/// the structural information to size and the values to values.
+/// Nodes are dumped in the same standard ordering as in dump(...).
+//===================================================================
+void Mesh::dump_binary(Vector<unsigned>& size, Vector<double>& values,
+                       const bool& use_old_ordering) const
+{
+ // Get a reordering of the nodes so that the dump file is in a standard
+ // ordering regardless of the sequence of mesh refinements etc.
+ Vector<Node*> reordering;
+ this->get_node_reordering(reordering, use_old_ordering);
+
+ // Doc # of nodes
+ unsigned long n_node = this->nnode();
+ size.push_back(n_node);
+
+ //Loop over all the nodes and dump their data
+ for(unsigned long nd=0; nd<n_node; nd++)
+  {
+   reordering[nd]->dump_binary(size,values);
+  }
+
+ // Loop over elements and deal with internal data
+ unsigned n_element = this->nelement();
+ for(unsigned e=0;e<n_element;e++)
+  {
+   GeneralisedElement* el_pt = this->element_pt(e);
+   unsigned n_internal = el_pt->ninternal_data();
+   if(n_internal > 0)
+    {
+     size.push_back(n_internal);
+     for(unsigned i=0;i<n_internal;i++)
+      {
+       el_pt->internal_data_pt(i)->dump_binary(size,values);
+      }
+    }
+  }
+}
+
+
+//=======================================================
+/// Read solution from vectors written by dump_binary(...).
+/// Returns true if any Data object's storage did not match
+/// the restart data exactly.
+//=======================================================
+bool Mesh::read_binary(const Vector<unsigned>& size, 
+                       unsigned long& size_index,
+                       const Vector<double>& values, 
+                       unsigned long& value_index)
+{
+ // Reorder the nodes within the mesh's node vector
+ // to establish a standard ordering regardless of the sequence
+ // of mesh refinements etc
+ this->reorder_nodes();
+
+ bool mismatch=false;
+
+ // Check # of nodes:
+ unsigned long n_node = this->nnode();
+ unsigned long check_n_node=0;
+ if (size_index<size.size())
+  {
+   check_n_node=size[size_index++];
+  }
+ if (check_n_node!=n_node)
+  {
+   std::ostringstream error_stream;
+   error_stream << "The number of nodes allocated " << n_node
+                << " is not the same as specified in the restart file "
+                << check_n_node << std::endl;
+
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+
+ //Loop over the nodes (read_binary(...) is virtual so SolidNodes
+ //read their Lagrangian coordinates too)
+ for(unsigned long n=0;n<n_node;n++)
+  {
+   if (this->node_pt(n)->read_binary(size,size_index,values,value_index))
+    {
+     mismatch=true;
+    }
+  }
+
+ // Read internal data of elements:
+ //--------------------------------
+ unsigned n_element = this->nelement();
+ for (unsigned e=0;e<n_element;e++)
+  {
+   GeneralisedElement* el_pt = this->element_pt(e);
+   unsigned n_internal=el_pt->ninternal_data();
+   if (n_internal>0)
+    {
+     // Check # of internals :
+     unsigned check_n_internal=0;
+     if (size_index<size.size())
+      {
+       check_n_internal=size[size_index++];
+      }
+     if (check_n_internal!=n_internal)
+      {
+       std::ostringstream error_stream;
+       error_stream << "The number of internal data  " << n_internal
+                    << " is not the same as specified in the restart file "
+                    << check_n_internal << std::endl;
+
+       throw OomphLibError(error_stream.str(),
+                           OOMPH_CURRENT_FUNCTION,
+                           OOMPH_EXCEPTION_LOCATION);
+      }
+
+     for (unsigned i=0;i<n_internal;i++)
+      {
+       if (el_pt->internal_data_pt(i)->read_binary(size,size_index,
+                                                   values,value_index))
+        {
+         mismatch=true;
+        }
+      }
+    }
+  }
+
+ return mismatch;
+}
+
  
 //========================================================
 /// Output in paraview format into specified file.
@@ -1512,6 +2138,32 @@ void Mesh::output_paraview(std::ofstream &file_out,
 }
  
 
+//========================================================
+/// Output in paraview format into specified file, with
+/// the arrays appended in raw binary form.
+//========================================================
+void Mesh::output_paraview_binary(std::ofstream &file_out, 
+                                  const unsigned &nplot) const
+{
+ MeshPlotData plot_data;
+ plot_data.build(this,nplot);
+ plot_data.output_vtu(file_out);
+}
+
+//========================================================
+/// Output plot data into raw binary file file_stem.bin,
+/// described by the XDMF file file_stem.xmf
+//========================================================
+void Mesh::output_xdmf(const std::string& file_stem,
+                       const unsigned &nplot,
+                       const double& time) const
+{
+ MeshPlotData plot_data;
+ plot_data.build(this,nplot);
+ plot_data.output_xdmf(file_stem,time);
+}
+ 
+
 //========================================================
 /// Output in paraview format into specified file.
 ///
@@ -4864,6 +5516,76 @@ void Mesh::get_all_halo_data(std::map<unsigned,double*> &map_of_halo_data)
 
 
 
+//========================================================================
+/// Get the (sorted) ranks of the processors with which this mesh
+/// shares root halo(ed) elements or halo(ed) nodes.
+//========================================================================
+void Mesh::get_neighbouring_processors(Vector<unsigned>& neighbour_proc)
+{
+ std::set<unsigned> proc_set;
+
+ // Root halo(ed) elements
+ for (std::map<unsigned,Vector<GeneralisedElement*> >::iterator it=
+       Root_halo_element_pt.begin();it!=Root_halo_element_pt.end();it++)
+  {
+   if (it->second.size()!=0) {proc_set.insert(it->first);}
+  }
+ for (std::map<unsigned,Vector<GeneralisedElement*> >::iterator it=
+       Root_haloed_element_pt.begin();it!=Root_haloed_element_pt.end();it++)
+  {
+   if (it->second.size()!=0) {proc_set.insert(it->first);}
+  }
+
+ // Halo(ed) nodes
+ for (std::map<unsigned,Vector<Node*> >::iterator it=
+       Halo_node_pt.begin();it!=Halo_node_pt.end();it++)
+  {
+   if (it->second.size()!=0) {proc_set.insert(it->first);}
+  }
+ for (std::map<unsigned,Vector<Node*> >::iterator it=
+       Haloed_node_pt.begin();it!=Haloed_node_pt.end();it++)
+  {
+   if (it->second.size()!=0) {proc_set.insert(it->first);}
+  }
+
+ neighbour_proc.assign(proc_set.begin(),proc_set.end());
+
+#ifdef PARANOID
+ // Check that the neighbour relation is symmetric -- the point-to-point
+ // exchanges that rely on it would hang otherwise
+ if (Comm_pt!=0)
+  {
+   int n_proc=Comm_pt->nproc();
+   Vector<int> is_neighbour(n_proc,0);
+   unsigned n_neighbour=neighbour_proc.size();
+   for (unsigned i=0;i<n_neighbour;i++)
+    {
+     is_neighbour[neighbour_proc[i]]=1;
+    }
+   Vector<int> is_neighbour_of(n_proc,0);
+   MPI_Alltoall(&is_neighbour[0],1,MPI_INT,&is_neighbour_of[0],1,MPI_INT,
+                Comm_pt->mpi_comm());
+   for (int d=0;d<n_proc;d++)
+    {
+     if (is_neighbour[d]!=is_neighbour_of[d])
+      {
+       std::ostringstream error_stream;
+       error_stream 
+        << "Processor " << d << " is " 
+        << (is_neighbour[d] ? "" : "not ") 
+        << "a neighbour of processor " << Comm_pt->my_rank() 
+        << "\nbut not vice versa. The halo/haloed lookup schemes "
+        << "are inconsistent.\n";
+       throw OomphLibError(error_stream.str(),
+                           OOMPH_CURRENT_FUNCTION,
+                           OOMPH_EXCEPTION_LOCATION);
+      }
+    }
+  }
+#endif
+}
+
+
 //========================================================================
 /// Get halo node stats for this distributed mesh:
 /// Average/max/min number of halo nodes over all processors.
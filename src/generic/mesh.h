@@ -157,9 +157,12 @@ class Mesh
 
  /// \short Assign the global equation numbers in the Data stored at the nodes
  /// and also internal element Data. Also, build (via push_back) the
- /// Vector of pointers to the dofs (variables).
+ /// Vector of pointers to the dofs (variables). With pthreads, contiguous
+ /// chunks of the nodes and elements are numbered concurrently by up to 
+ /// n_thread threads (the numbering is the same as in the serial case).
  unsigned long
-  assign_global_eqn_numbers(Vector<double *> &Dof_pt);
+  assign_global_eqn_numbers(Vector<double *> &Dof_pt, 
+                            const unsigned& n_thread=1);
 
  /// \short Function to describe the dofs of the Mesh. The ostream 
  /// specifies the output stream to which the description 
@@ -183,8 +186,12 @@ class Mesh
                           const std::string& current_string) const;
 
  /// \short Assign the local equation numbers in all elements
- /// If the boolean argument is true then also store pointers to dofs
- void assign_local_eqn_numbers(const bool &store_local_dof_pt);
+ /// If the boolean argument is true then also store pointers to dofs.
+ /// With pthreads, contiguous chunks of the elements are numbered
+ /// concurrently by up to n_thread threads unless the pointers to the
+ /// dofs are stored (the elements share static storage for them).
+ void assign_local_eqn_numbers(const bool &store_local_dof_pt,
+                               const unsigned& n_thread=1);
 
  /// Vector of pointers to nodes
  Vector<Node*> Node_pt;
@@ -192,6 +199,17 @@ class Mesh
  /// Vector of pointers to generalised elements
  Vector<GeneralisedElement*> Element_pt;
 
+ /// \short Pointer to the pool that holds the nodal values, equation 
+ /// numbers and positions in contiguous storage (null if the nodes 
+ /// own their storage, the default)
+ NodalStoragePool* Nodal_storage_pool_pt;
+
+ /// \short Do any of the values stored at the nodes have (global) 
+ /// equation numbers? If so, moving them into (or within) the pooled
+ /// storage would invalidate the pointers to the dofs held by the
+ /// Problem and the elements.
+ bool nodal_values_have_eqn_numbers() const;
+
  /// \short Vector of boolean data that indicates whether the boundary
  /// coordinates have been set for the boundary
  std::vector<bool> Boundary_coordinate_exists;
@@ -241,11 +259,17 @@ public:
  /// timestepper function
  static bool Suppress_warning_about_empty_mesh_level_time_stepper_function;
 
+ /// \short Min. number of nodes or elements per thread in the threaded
+ /// equation numbering
+ static unsigned Min_nobject_per_eqn_numbering_thread;
+
  /// \short Default constructor
  Mesh()
   {
    // Lookup scheme hasn't been setup yet
    Lookup_for_elements_next_boundary_is_setup=false;
+   // Nodes own their storage
+   Nodal_storage_pool_pt=0;
 #ifdef OOMPH_HAS_MPI
    // Set defaults for distributed meshes
 
@@ -265,6 +289,8 @@ public:
  /// duplicates; no boundary information etc. is created).
  Mesh(const Vector<Mesh*>& sub_mesh_pt)
   {
+   // Nodes own their storage
+   Nodal_storage_pool_pt=0;
 #ifdef OOMPH_HAS_MPI
    // Mesh hasn't been distributed: Null out pointer to communicator
    Comm_pt=0;
@@ -445,9 +471,36 @@ public:
 /// vectors that store the pointers to them.
  void flush_node_storage()
  {
+  // The nodes survive the mesh so they must own their storage
+  disable_pooled_nodal_storage();
   Node_pt.clear();
  }
 
+ /// \short Move the values, history values, equation numbers and 
+ /// positions of all nodes into a few contiguous arrays owned by
+ /// the mesh (ordered as the nodes in the mesh) to improve the cache 
+ /// behaviour of loops over the nodes. The nodes' access functions
+ /// are unaffected. See NodalStoragePool for details.
+ /// This moves the nodal values, so it must be called before the 
+ /// equations are numbered, unless the caller renumbers them 
+ /// afterwards (and says so by setting equations_will_be_renumbered 
+ /// to true): Use Problem::enable_pooled_nodal_storage() to (re-)pool 
+ /// the storage of a problem's mesh, e.g. after mesh adaptation.
+ /// reorder_nodes() re-pools the storage automatically if the 
+ /// equations haven't been numbered yet.
+ void enable_pooled_nodal_storage(
+  const bool& equations_will_be_renumbered=false);
+
+ /// \short Give the nodes back their own storage and delete the
+ /// pooled storage.
+ void disable_pooled_nodal_storage();
+
+ /// \short Are the nodes' values and positions held in pooled storage?
+ bool pooled_nodal_storage_is_enabled() const 
+  {
+   return Nodal_storage_pool_pt!=0;
+  }
+
  /// Return pointer to global node n
  Node* &node_pt(const unsigned long &n) {return Node_pt[n];}
 
@@ -629,6 +682,31 @@ public:
  virtual void get_node_reordering(Vector<Node*> &reordering,
                                   const bool& use_old_ordering=true) const;
 
+ /// \short Reorderings of the elements and nodes that improve the 
+ /// locality of memory accesses during assembly and node updates
+ enum Locality_reordering {No_locality_reordering,
+                           Morton_reordering,
+                           Hilbert_reordering,
+                           Reverse_cuthill_mckee_reordering};
+
+ /// \short Reorder the elements to improve locality: Either along 
+ /// a space-filling curve through the elements' centroids
+ /// (Morton_reordering or Hilbert_reordering) or by a reverse
+ /// Cuthill-McKee ordering of the graph of elements that share nodes 
+ /// (Reverse_cuthill_mckee_reordering). Elements without nodes are
+ /// moved to the end. Only changes the order of the pointers in the
+ /// mesh's element vector.
+ void reorder_elements_for_locality(const unsigned& reordering);
+
+ /// \short Reorder the nodes to improve locality: Either along 
+ /// a space-filling curve through their positions (Morton_reordering or 
+ /// Hilbert_reordering) or by a reverse Cuthill-McKee ordering of the
+ /// graph of nodes that share elements (Reverse_cuthill_mckee_reordering).
+ /// Only changes the order of the pointers in the mesh's node vector
+ /// (and re-pools the nodal storage if pooling is enabled and the 
+ /// equations haven't been numbered yet).
+ void reorder_nodes_for_locality(const unsigned& reordering);
+
  /// \short Constuct a Mesh of FACE_ELEMENTs along the b-th boundary
  /// of the mesh (which contains elements of type BULK_ELEMENT)
  template<class BULK_ELEMENT, template<class> class FACE_ELEMENT>
@@ -900,6 +978,24 @@ public:
  /// \short Read solution from restart file
  virtual void read(std::ifstream &restart_file);
 
+ /// \short Dump the data in the mesh in binary restart format: Append 
+ /// the structural information (numbers of nodes, values, history 
+ /// values, ...) to size and all (nodal and internal) values to values,
+ /// in the same order as in dump(...).
+ virtual void dump_binary(Vector<unsigned>& size, Vector<double>& values,
+                          const bool& use_old_ordering=true) const;
+
+ /// \short Read the data in the mesh from vectors written by
+ /// dump_binary(...), starting at entry size_index of size and 
+ /// value_index of values. Both indices are advanced past the 
+ /// entries that were read. Returns true if any Data object's
+ /// storage did not match the restart data exactly (e.g. steady
+ /// restart of an unsteady run; see Data::read_binary(...)).
+ virtual bool read_binary(const Vector<unsigned>& size, 
+                          unsigned long& size_index,
+                          const Vector<double>& values, 
+                          unsigned long& value_index);
+
 
  /// \short Output in paraview format into specified file. Breaks up each
  /// element into sub-elements for plotting purposes. We assume
@@ -909,6 +1005,22 @@ public:
  void output_paraview(std::ofstream &file_out, 
                       const unsigned &nplot) const;
 
+ /// \short Output in paraview format into specified file, with all 
+ /// arrays appended in raw binary form (much faster than the ASCII
+ /// output of output_paraview(...), and without loss of precision). 
+ /// The file should have been opened in std::ios_base::binary mode.
+ /// Uses MeshPlotData; the same restrictions as for output_paraview(...)
+ /// apply.
+ void output_paraview_binary(std::ofstream &file_out, 
+                             const unsigned &nplot) const;
+
+ /// \short Output the plot data (as in output_paraview(...)) into
+ /// the raw binary file file_stem.bin, described by the XDMF file
+ /// file_stem.xmf (which is read by paraview, visit, ...)
+ void output_xdmf(const std::string& file_stem,
+                  const unsigned &nplot,
+                  const double& time=0.0) const;
+
  /// \short Output in paraview format into specified file. Breaks up each
  /// element into sub-elements for plotting purposes. We assume
  /// that all elements are of the same type (fct will break 
@@ -2061,6 +2173,13 @@ public:
    Shared_node_pt[p].push_back(nod_pt);
   }
 
+ /// \short Get the (sorted) ranks of the processors with which this
+ /// mesh shares root halo(ed) elements or halo(ed) nodes. Since the
+ /// halo/haloed lookup schemes are set up pairwise, this set is
+ /// symmetric, i.e. if processor p is a neighbour of processor q then
+ /// q is a neighbour of p.
+ void get_neighbouring_processors(Vector<unsigned>& neighbour_proc);
+
  /// \short Get halo node stats for this distributed mesh:
  /// Average/max/min number of halo nodes over all processors.
  /// \b Careful: Involves MPI Broadcasts and must therefore
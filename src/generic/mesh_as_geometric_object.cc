@@ -54,8 +54,12 @@ namespace MeshAsGeomObject_Helper
 {
 
  /// \short Default sample point container type. Must currently be one of
- /// UseCGALSamplePointContainer, UseRefineableBinArray or
- /// UseNonRefineableBinArray 
+ /// UseCGALSamplePointContainer, UseRefineableBinArray,
+ /// UseNonRefineableBinArray or UseBoundingBoxTree. The bounding box
+ /// tree (which locates all points in a single pass and warm-starts
+ /// each search from the element in which the previous point was found)
+ /// is opt-in: Set this to UseBoundingBoxTree or pass 
+ /// BoundingBoxTreeParameters to the MeshAsGeomObject's constructor.
 #ifdef OOMPH_HAS_CGAL
  unsigned Default_sample_point_container_version=UseCGALSamplePointContainer;
 #else
@@ -81,6 +85,11 @@ namespace MeshAsGeomObject_Helper
 
      break;
 
+   case UseBoundingBoxTree:
+    sample_point_container_parameters_pt=new BoundingBoxTreeParameters(mesh_pt);
+
+     break;
+
 #ifdef OOMPH_HAS_CGAL
 
    case UseCGALSamplePointContainer:
@@ -142,6 +142,11 @@ class MeshAsGeomObject : public GeomObject
    {
     Sample_point_container_version=UseNonRefineableBinArray;
    }
+  else if (dynamic_cast<BoundingBoxTreeParameters*>(
+            sample_point_container_parameters_pt)!=0)
+   {
+    Sample_point_container_version=UseBoundingBoxTree;
+   }
 #ifdef OOMPH_HAS_CGAL
   else if (dynamic_cast<CGALSamplePointContainerParameters*>(
             sample_point_container_parameters_pt)!=0)
@@ -268,6 +273,11 @@ class MeshAsGeomObject : public GeomObject
    
    Sample_point_container_pt=new NonRefineableBinArray(sample_point_container_parameters_pt);
    break;
+
+  case UseBoundingBoxTree:
+   
+   Sample_point_container_pt=new BoundingBoxTree(sample_point_container_parameters_pt);
+   break;
    
 #ifdef OOMPH_HAS_CGAL
 
@@ -422,6 +432,23 @@ class MeshAsGeomObject : public GeomObject
 
  }
 
+ /// \short Batched version of locate_zeta(...): Find the sub geometric
+ /// objects and the local coordinates s[i] therein that correspond to the
+ /// intrinsic coordinates zeta[i]; sub_geom_object_pt[i]=0 if zeta[i]
+ /// can't be located. guess_el_pt is either empty or contains an 
+ /// (optional, possibly null) initial guess for the element containing 
+ /// each point (with s[i] as the initial guess for the local coordinate);
+ /// whether (and how) the guesses and multiple threads are used depends
+ /// on the sample point container.
+ void locate_zeta_batch(const Vector<Vector<double> >& zeta,
+                        const Vector<FiniteElement*>& guess_el_pt,
+                        Vector<GeomObject*>& sub_geom_object_pt,
+                        Vector<Vector<double> >& s)
+ {
+  Sample_point_container_pt->locate_zeta_batch(zeta,guess_el_pt,
+                                               sub_geom_object_pt,s);
+ }
+
  /// \short Return the position as a function of the intrinsic coordinate zeta.
  /// This provides an (expensive!) default implementation in which
  /// we loop over all the constituent sub-objects and check if they
@@ -0,0 +1,499 @@
+//LIC// ====================================================================
+//LIC// This file forms part of oomph-lib, the object-oriented, 
+//LIC// multi-physics finite-element library, available 
+//LIC// at http://www.oomph-lib.org.
+//LIC// 
+//LIC// Copyright (C) 2006-2021 Matthias Heil and Andrew Hazel
+//LIC// 
+//LIC// This library is free software; you can redistribute it and/or
+//LIC// modify it under the terms of the GNU Lesser General Public
+//LIC// License as published by the Free Software Foundation; either
+//LIC// version 2.1 of the License, or (at your option) any later version.
+//LIC// 
+//LIC// This library is distributed in the hope that it will be useful,
+//LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//LIC// Lesser General Public License for more details.
+//LIC// 
+//LIC// You should have received a copy of the GNU Lesser General Public
+//LIC// License along with this library; if not, write to the Free Software
+//LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//LIC// 02110-1301  USA.
+//LIC// 
+//LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+//LIC// 
+//LIC//====================================================================
+#include<fstream>
+#include<sstream>
+
+#include "mesh_plot_data.h"
+#include "mesh.h"
+#include "elements.h"
+
+
+namespace oomph
+{
+
+
+//=============================================================================
+/// Helper functions for the binary output of MeshPlotData
+//=============================================================================
+namespace MeshPlotDataHelpers
+{
+
+ /// Byte order of this machine in VTK/XDMF notation
+ std::string byte_order()
+ {
+  const unsigned one=1;
+  if (*reinterpret_cast<const unsigned char*>(&one)==1)
+   {
+    return "Little";
+   }
+  return "Big";
+ }
+
+ /// \short Append a block of raw VTK data (preceded by its size in bytes 
+ /// as an unsigned 64 bit integer) to the stream
+ void write_vtk_block(std::ostream& outfile, const char* data_pt, 
+                      const unsigned long long& n_byte)
+ {
+  outfile.write(reinterpret_cast<const char*>(&n_byte),sizeof(n_byte));
+  if (n_byte>0)
+   {
+    outfile.write(data_pt,n_byte);
+   }
+ }
+
+ /// \short The XDMF cell type (for "Mixed" topologies) corresponding 
+ /// to the VTK cell type, and the number of vertices that have to be
+ /// specified explicitly for that type (0 if implied by the type)
+ void xdmf_cell_type(const unsigned& vtk_type, int& xdmf_type, 
+                     int& n_explicit_vertex)
+ {
+  n_explicit_vertex=0;
+  switch (vtk_type)
+   {
+   case 1: xdmf_type=1; n_explicit_vertex=1; break; // vertex
+   case 3: xdmf_type=2; n_explicit_vertex=2; break; // line
+   case 5: xdmf_type=4; break;  // triangle
+   case 9: xdmf_type=5; break;  // quadrilateral
+   case 10: xdmf_type=6; break; // tetrahedron
+   case 12: xdmf_type=9; break; // hexahedron
+   case 13: xdmf_type=8; break; // wedge
+   case 14: xdmf_type=7; break; // pyramid
+   case 21: xdmf_type=34; break; // quadratic edge
+   case 22: xdmf_type=36; break; // quadratic triangle
+   case 23: xdmf_type=37; break; // quadratic quadrilateral
+   case 24: xdmf_type=38; break; // quadratic tetrahedron
+   case 25: xdmf_type=48; break; // quadratic hexahedron
+   default:
+    {
+     std::ostringstream error_stream;
+     error_stream << "VTK cell type " << vtk_type 
+                  << " has no XDMF equivalent (yet)" << std::endl;
+     throw OomphLibError(error_stream.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+   }
+ }
+
+ /// Pointer to the raw bytes of a vector (null if empty)
+ template<class T>
+ const char* raw_pt(const Vector<T>& v)
+ {
+  if (v.empty()) return 0;
+  return reinterpret_cast<const char*>(&v[0]);
+ }
+
+ /// Strip the directory from a file name
+ std::string file_name_without_directory(const std::string& file_name)
+ {
+  std::string::size_type slash=file_name.find_last_of('/');
+  if (slash==std::string::npos) return file_name;
+  return file_name.substr(slash+1);
+ }
+
+}
+
+
+//=============================================================================
+/// Evaluate the plot data for all (non-halo) FiniteElements in the mesh
+//=============================================================================
+void MeshPlotData::build(const Mesh* mesh_pt, const unsigned& nplot)
+{
+ clear();
+
+ // Collect the elements to be plotted
+ Vector<FiniteElement*> plot_element_pt;
+ const unsigned long n_element=mesh_pt->nelement();
+ plot_element_pt.reserve(n_element);
+ for (unsigned long e=0;e<n_element;e++)
+  {
+   FiniteElement* fe_pt=dynamic_cast<FiniteElement*>(mesh_pt->element_pt(e));
+   if (fe_pt==0)
+    {
+     std::ostringstream error_stream;
+     error_stream << "Recast for element " << e << " failed" << std::endl;
+     throw OomphLibError(error_stream.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+#ifdef OOMPH_HAS_MPI
+   if ((!mesh_pt->Output_halo_elements)&&(fe_pt->is_halo())) continue;
+#endif
+   plot_element_pt.push_back(fe_pt);
+  }
+ const unsigned long n_plot_element=plot_element_pt.size();
+ if (n_plot_element==0) return;
+
+ // Names of the scalars (from the first element)
+ const unsigned n_scalar=plot_element_pt[0]->nscalar_paraview();
+ Scalar_name.resize(n_scalar);
+ for (unsigned i=0;i<n_scalar;i++)
+  {
+   Scalar_name[i]=plot_element_pt[0]->scalar_name_paraview(i);
+  }
+
+ // Count the plot points and check consistency
+ Vector<unsigned long> first_plot_point(n_plot_element+1,0);
+ for (unsigned long e=0;e<n_plot_element;e++)
+  {
+   FiniteElement* fe_pt=plot_element_pt[e];
+   if (fe_pt->nscalar_paraview()!=n_scalar)
+    {
+     std::ostringstream error_stream;
+     error_stream 
+      <<  "Element " << e << " has a different number of scalar fields\n"
+      << "than the first element; paraview cannot handle this.\n"
+      << "We suggest that the problem is broken up into submeshes instead." 
+      << std::endl;
+     throw OomphLibError(error_stream.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+   first_plot_point[e+1]=first_plot_point[e]+
+    fe_pt->nplot_points_paraview(nplot);
+  }
+ Nplot_point=first_plot_point[n_plot_element];
+
+ // Evaluate coordinates, scalars and cells element by element. The
+ // scalars of each element are obtained in one batch (ordered by plot
+ // point) and then distributed into the per-field arrays.
+ Plot_point_coordinates.reserve(3*Nplot_point);
+ Scalar_value.resize(n_scalar*Nplot_point,0.0);
+ unsigned counter=0;
+ unsigned offset_sum=0;
+ Vector<double> element_values;
+ for (unsigned long e=0;e<n_plot_element;e++)
+  {
+   FiniteElement* fe_pt=plot_element_pt[e];
+
+   fe_pt->get_plot_point_coordinates_paraview(nplot,
+                                              Plot_point_coordinates);
+
+   element_values.clear();
+   fe_pt->get_scalar_values_paraview(nplot,element_values);
+   const unsigned long j_first=first_plot_point[e];
+   const unsigned long n_element_plot_point=first_plot_point[e+1]-j_first;
+#ifdef PARANOID
+   if (element_values.size()!=n_scalar*n_element_plot_point)
+    {
+     std::ostringstream error_stream;
+     error_stream << "Element " << e << " returned " 
+                  << element_values.size() << " scalar values but "
+                  << n_scalar*n_element_plot_point << " were expected ("
+                  << n_scalar << " scalars at " << n_element_plot_point
+                  << " plot points)." << std::endl;
+     throw OomphLibError(error_stream.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+   for (unsigned long j=0;j<n_element_plot_point;j++)
+    {
+     for (unsigned i=0;i<n_scalar;i++)
+      {
+       Scalar_value[i*Nplot_point+j_first+j]=element_values[j*n_scalar+i];
+      }
+    }
+
+   fe_pt->get_paraview_cells(nplot,counter,offset_sum,
+                             Connectivity,Offset,Cell_type);
+  }
+
+#ifdef PARANOID
+ if (Plot_point_coordinates.size()!=3*Nplot_point)
+  {
+   throw OomphLibError(
+    "Number of plot point coordinates doesn't match number of plot points",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+}
+
+//=============================================================================
+/// Wipe the data
+//=============================================================================
+void MeshPlotData::clear()
+{
+ Nplot_point=0;
+ Plot_point_coordinates.clear();
+ Scalar_name.clear();
+ Scalar_value.clear();
+ Connectivity.clear();
+ Offset.clear();
+ Cell_type.clear();
+}
+
+//=============================================================================
+/// Write the data as a VTK unstructured grid with raw binary appended
+/// arrays: the XML header describes all arrays by their offset in the 
+/// appended data section, which contains each array preceded by its
+/// size in bytes.
+//=============================================================================
+void MeshPlotData::output_vtu(std::ostream& outfile) const
+{
+ const unsigned n_scalar=nscalar();
+ const unsigned long long n_value_byte=Nplot_point*sizeof(double);
+ const unsigned long long n_coordinate_byte=
+  Plot_point_coordinates.size()*sizeof(double);
+ const unsigned long long n_connectivity_byte=
+  Connectivity.size()*sizeof(int);
+ const unsigned long long n_offset_byte=Offset.size()*sizeof(int);
+ const unsigned long long n_type_byte=Cell_type.size();
+ const unsigned long long header_byte=sizeof(unsigned long long);
+
+ outfile 
+  << "<?xml version=\"1.0\"?>\n"
+  << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" "
+  << "byte_order=\"" << MeshPlotDataHelpers::byte_order() << "Endian\" "
+  << "header_type=\"UInt64\">\n"
+  << "<UnstructuredGrid>\n" 
+  << "<Piece NumberOfPoints=\"" << Nplot_point
+  << "\" NumberOfCells=\"" << ncell() << "\">\n";
+
+ // Point data
+ unsigned long long offset=0;
+ outfile << "<PointData";
+ if (n_scalar>0) outfile << " Scalars=\"" << Scalar_name[0] << "\"";
+ outfile << ">\n";
+ for (unsigned i=0;i<n_scalar;i++)
+  {
+   outfile << "<DataArray type=\"Float64\" Name=\"" << Scalar_name[i]
+           << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+   offset+=header_byte+n_value_byte;
+  }
+ outfile << "</PointData>\n";
+
+ // Points
+ outfile << "<Points>\n"
+         << "<DataArray type=\"Float64\" NumberOfComponents=\"3\" "
+         << "format=\"appended\" offset=\"" << offset << "\"/>\n"
+         << "</Points>\n";
+ offset+=header_byte+n_coordinate_byte;
+
+ // Cells
+ outfile << "<Cells>\n"
+         << "<DataArray type=\"Int32\" Name=\"connectivity\" "
+         << "format=\"appended\" offset=\"" << offset << "\"/>\n";
+ offset+=header_byte+n_connectivity_byte;
+ outfile << "<DataArray type=\"Int32\" Name=\"offsets\" "
+         << "format=\"appended\" offset=\"" << offset << "\"/>\n";
+ offset+=header_byte+n_offset_byte;
+ outfile << "<DataArray type=\"UInt8\" Name=\"types\" "
+         << "format=\"appended\" offset=\"" << offset << "\"/>\n"
+         << "</Cells>\n"
+         << "</Piece>\n"
+         << "</UnstructuredGrid>\n"
+         << "<AppendedData encoding=\"raw\">\n_";
+
+ // The arrays
+ for (unsigned i=0;i<n_scalar;i++)
+  {
+   MeshPlotDataHelpers::write_vtk_block(
+    outfile,reinterpret_cast<const char*>(&Scalar_value[i*Nplot_point]),
+    n_value_byte);
+  }
+ MeshPlotDataHelpers::write_vtk_block(
+  outfile,MeshPlotDataHelpers::raw_pt(Plot_point_coordinates),
+  n_coordinate_byte);
+ MeshPlotDataHelpers::write_vtk_block(
+  outfile,MeshPlotDataHelpers::raw_pt(Connectivity),
+  n_connectivity_byte);
+ MeshPlotDataHelpers::write_vtk_block(
+  outfile,MeshPlotDataHelpers::raw_pt(Offset),n_offset_byte);
+ MeshPlotDataHelpers::write_vtk_block(
+  outfile,MeshPlotDataHelpers::raw_pt(Cell_type),n_type_byte);
+
+ outfile << "\n</AppendedData>\n"
+         << "</VTKFile>\n";
+}
+
+//=============================================================================
+/// Write the data as a VTK unstructured grid with raw binary appended
+/// arrays into the specified file
+//=============================================================================
+void MeshPlotData::output_vtu(const std::string& file_name) const
+{
+ std::ofstream outfile(file_name.c_str(),
+                       std::ios_base::out|std::ios_base::binary);
+ if (!outfile.is_open())
+  {
+   std::string error_message="Couldn't open file "+file_name;
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ output_vtu(outfile);
+}
+
+//=============================================================================
+/// Write the index for the pieces of a distributed mesh
+//=============================================================================
+void MeshPlotData::output_pvtu(const std::string& file_name,
+                               const Vector<std::string>& piece_file_name) 
+ const
+{
+ std::ofstream outfile(file_name.c_str());
+ if (!outfile.is_open())
+  {
+   std::string error_message="Couldn't open file "+file_name;
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+
+ const unsigned n_scalar=nscalar();
+ outfile 
+  << "<?xml version=\"1.0\"?>\n"
+  << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" "
+  << "byte_order=\"" << MeshPlotDataHelpers::byte_order() << "Endian\" "
+  << "header_type=\"UInt64\">\n"
+  << "<PUnstructuredGrid GhostLevel=\"0\">\n"
+  << "<PPointData";
+ if (n_scalar>0) outfile << " Scalars=\"" << Scalar_name[0] << "\"";
+ outfile << ">\n";
+ for (unsigned i=0;i<n_scalar;i++)
+  {
+   outfile << "<PDataArray type=\"Float64\" Name=\"" << Scalar_name[i] 
+           << "\"/>\n";
+  }
+ outfile << "</PPointData>\n"
+         << "<PPoints>\n"
+         << "<PDataArray type=\"Float64\" NumberOfComponents=\"3\"/>\n"
+         << "</PPoints>\n";
+ const unsigned n_piece=piece_file_name.size();
+ for (unsigned p=0;p<n_piece;p++)
+  {
+   outfile << "<Piece Source=\"" << piece_file_name[p] << "\"/>\n";
+  }
+ outfile << "</PUnstructuredGrid>\n"
+         << "</VTKFile>\n";
+}
+
+//=============================================================================
+/// Write the arrays into the raw binary file file_stem.bin and the
+/// XDMF description into file_stem.xmf. The cells are described as
+/// a "Mixed" topology, so meshes with different cell types are allowed.
+//=============================================================================
+void MeshPlotData::output_xdmf(const std::string& file_stem, 
+                               const double& time) const
+{
+ // Assemble the topology: XDMF cell type, (vertex count for 
+ // polyvertices/lines,) vertices for each cell
+ Vector<int> topology;
+ topology.reserve(Connectivity.size()+2*Cell_type.size());
+ const unsigned long n_cell=ncell();
+ int first_vertex=0;
+ for (unsigned long c=0;c<n_cell;c++)
+  {
+   int xdmf_type=0;
+   int n_explicit_vertex=0;
+   MeshPlotDataHelpers::xdmf_cell_type(Cell_type[c],xdmf_type,
+                                       n_explicit_vertex);
+   topology.push_back(xdmf_type);
+   if (n_explicit_vertex>0) topology.push_back(n_explicit_vertex);
+   for (int v=first_vertex;v<Offset[c];v++)
+    {
+     topology.push_back(Connectivity[v]);
+    }
+   first_vertex=Offset[c];
+  }
+
+ // Heavy data
+ std::string heavy_file_name=file_stem+".bin";
+ std::ofstream heavy_file(heavy_file_name.c_str(),
+                          std::ios_base::out|std::ios_base::binary);
+ if (!heavy_file.is_open())
+  {
+   std::string error_message="Couldn't open file "+heavy_file_name;
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ const unsigned n_scalar=nscalar();
+ const unsigned long long topology_offset=0;
+ const unsigned long long coordinate_offset=topology.size()*sizeof(int);
+ const unsigned long long scalar_offset=
+  coordinate_offset+Plot_point_coordinates.size()*sizeof(double);
+ heavy_file.write(MeshPlotDataHelpers::raw_pt(topology),
+                  topology.size()*sizeof(int));
+ heavy_file.write(MeshPlotDataHelpers::raw_pt(Plot_point_coordinates),
+                  Plot_point_coordinates.size()*sizeof(double));
+ heavy_file.write(MeshPlotDataHelpers::raw_pt(Scalar_value),
+                  Scalar_value.size()*sizeof(double));
+ heavy_file.close();
+
+ // Light data
+ std::string light_file_name=file_stem+".xmf";
+ std::ofstream light_file(light_file_name.c_str());
+ if (!light_file.is_open())
+  {
+   std::string error_message="Couldn't open file "+light_file_name;
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ const std::string heavy_data=
+  MeshPlotDataHelpers::file_name_without_directory(heavy_file_name);
+ const std::string endian=MeshPlotDataHelpers::byte_order();
+ light_file.precision(17);
+ light_file 
+  << "<?xml version=\"1.0\" ?>\n"
+  << "<Xdmf Version=\"2.0\">\n"
+  << "<Domain>\n"
+  << "<Grid Name=\"mesh\" GridType=\"Uniform\">\n"
+  << "<Time Value=\"" << time << "\"/>\n"
+  << "<Topology TopologyType=\"Mixed\" NumberOfElements=\"" << n_cell
+  << "\">\n"
+  << "<DataItem Dimensions=\"" << topology.size() 
+  << "\" NumberType=\"Int\" Precision=\"4\" Format=\"Binary\" Endian=\""
+  << endian << "\" Seek=\"" << topology_offset << "\">" 
+  << heavy_data << "</DataItem>\n"
+  << "</Topology>\n"
+  << "<Geometry GeometryType=\"XYZ\">\n"
+  << "<DataItem Dimensions=\"" << Nplot_point 
+  << " 3\" NumberType=\"Float\" Precision=\"8\" Format=\"Binary\" Endian=\""
+  << endian << "\" Seek=\"" << coordinate_offset << "\">" 
+  << heavy_data << "</DataItem>\n"
+  << "</Geometry>\n";
+ for (unsigned i=0;i<n_scalar;i++)
+  {
+   light_file 
+    << "<Attribute Name=\"" << Scalar_name[i] 
+    << "\" AttributeType=\"Scalar\" Center=\"Node\">\n"
+    << "<DataItem Dimensions=\"" << Nplot_point
+    << "\" NumberType=\"Float\" Precision=\"8\" Format=\"Binary\" Endian=\""
+    << endian << "\" Seek=\"" 
+    << scalar_offset+i*Nplot_point*sizeof(double) << "\">" 
+    << heavy_data << "</DataItem>\n"
+    << "</Attribute>\n";
+  }
+ light_file << "</Grid>\n"
+            << "</Domain>\n"
+            << "</Xdmf>\n";
+}
+
+}
@@ -0,0 +1,166 @@
+//LIC// ====================================================================
+//LIC// This file forms part of oomph-lib, the object-oriented, 
+//LIC// multi-physics finite-element library, available 
+//LIC// at http://www.oomph-lib.org.
+//LIC// 
+//LIC// Copyright (C) 2006-2021 Matthias Heil and Andrew Hazel
+//LIC// 
+//LIC// This library is free software; you can redistribute it and/or
+//LIC// modify it under the terms of the GNU Lesser General Public
+//LIC// License as published by the Free Software Foundation; either
+//LIC// version 2.1 of the License, or (at your option) any later version.
+//LIC// 
+//LIC// This library is distributed in the hope that it will be useful,
+//LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//LIC// Lesser General Public License for more details.
+//LIC// 
+//LIC// You should have received a copy of the GNU Lesser General Public
+//LIC// License along with this library; if not, write to the Free Software
+//LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//LIC// 02110-1301  USA.
+//LIC// 
+//LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+//LIC// 
+//LIC//====================================================================
+//Include guards
+#ifndef OOMPH_MESH_PLOT_DATA_HEADER
+#define OOMPH_MESH_PLOT_DATA_HEADER
+
+
+// Config header generated by autoconfig
+#ifdef HAVE_CONFIG_H
+  #include <oomph-lib-config.h>
+#endif
+
+#include<string>
+#include<iostream>
+
+#include "Vector.h"
+#include "oomph_utilities.h"
+
+
+namespace oomph
+{
+
+class Mesh;
+
+
+//=============================================================================
+/// \short Plot data of a mesh, i.e. the coordinates of the paraview plot 
+/// points of all its FiniteElements, the values of all scalar fields at
+/// these points and the connectivity of the paraview sub-elements, 
+/// evaluated once by build(...) and stored in contiguous arrays. The data
+/// can then be written in binary formats that are much faster to write 
+/// (and to read into paraview) than the ASCII output of 
+/// Mesh::output_paraview(...):
+/// - output_vtu(...): VTK unstructured grid with the arrays appended in
+///   raw binary form; 
+/// - output_xdmf(...): the arrays are written into a raw binary file
+///   (heavy data) that is described by a light XML (XDMF) index.
+/// Since the evaluation and the writing are separate, the writing can be
+/// deferred (or performed by another thread) while the computation 
+/// continues. In distributed problems, each processor builds the data 
+/// for its own (non-halo) elements and writes its own file; 
+/// output_pvtu(...) writes the index for the pieces.
+//=============================================================================
+class MeshPlotData
+{
+
+public:
+
+ /// Constructor: empty data
+ MeshPlotData() : Nplot_point(0) {}
+
+ /// Broken copy constructor
+ MeshPlotData(const MeshPlotData&)
+  {
+   BrokenCopy::broken_copy("MeshPlotData");
+  }
+
+ /// Broken assignment operator
+ void operator=(const MeshPlotData&)
+  {
+   BrokenCopy::broken_assign("MeshPlotData");
+  }
+
+ /// Empty destructor
+ ~MeshPlotData() {}
+
+ /// \short Evaluate the plot data for all FiniteElements in the mesh,
+ /// with nplot plot points in each coordinate direction (as in 
+ /// Mesh::output_paraview(...)). Halo elements are skipped unless the
+ /// mesh outputs them. All elements must have the same number of 
+ /// scalar fields.
+ void build(const Mesh* mesh_pt, const unsigned& nplot);
+
+ /// Wipe the data
+ void clear();
+
+ /// Number of plot points
+ unsigned long nplot_point() const {return Nplot_point;}
+
+ /// Number of (paraview sub-)cells
+ unsigned long ncell() const {return Cell_type.size();}
+
+ /// Number of scalar fields
+ unsigned nscalar() const {return Scalar_name.size();}
+
+ /// Name of the i-th scalar field
+ const std::string& scalar_name(const unsigned& i) const
+  {
+   return Scalar_name[i];
+  }
+
+ /// \short Write the data as a VTK unstructured grid (.vtu) with the 
+ /// arrays appended in raw binary form. The stream should have been 
+ /// opened in std::ios_base::binary mode.
+ void output_vtu(std::ostream& outfile) const;
+
+ /// \short Write the data as a VTK unstructured grid (.vtu) with the 
+ /// arrays appended in raw binary form into the specified file
+ void output_vtu(const std::string& file_name) const;
+
+ /// \short Write the index (.pvtu) for the pieces of a distributed 
+ /// mesh that were written (typically one per processor) into the 
+ /// specified .vtu files by output_vtu(...). The names of the pieces
+ /// are relative to the location of the .pvtu file. The scalar fields
+ /// are taken from this object.
+ void output_pvtu(const std::string& file_name,
+                  const Vector<std::string>& piece_file_name) const;
+
+ /// \short Write the arrays into the raw binary file file_stem.bin and
+ /// their description (XDMF, with the specified time) into the 
+ /// XML file file_stem.xmf
+ void output_xdmf(const std::string& file_stem, 
+                  const double& time=0.0) const;
+
+private:
+
+ /// Number of plot points
+ unsigned long Nplot_point;
+
+ /// Coordinates of the plot points (three per plot point)
+ Vector<double> Plot_point_coordinates;
+
+ /// Names of the scalar fields
+ Vector<std::string> Scalar_name;
+
+ /// \short Values of the scalar fields: the value of the i-th field at
+ /// the j-th plot point is Scalar_value[i*Nplot_point+j]
+ Vector<double> Scalar_value;
+
+ /// Connectivity of the (paraview sub-)cells
+ Vector<int> Connectivity;
+
+ /// Offsets of the (paraview sub-)cells in the connectivity
+ Vector<int> Offset;
+
+ /// VTK types of the (paraview sub-)cells
+ Vector<unsigned char> Cell_type;
+
+};
+
+}
+
+#endif
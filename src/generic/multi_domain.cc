@@ -68,6 +68,20 @@ namespace Multi_domain_functions
   /// Used locally to ensure that we're not searching for the same
   /// elements over and over again when we go around the spirals.
   Vector<Vector<unsigned> > External_element_located;
+
+  /// \short Lookup scheme for the external elements (and the local
+  /// coordinates within them) that were assigned to a local element's
+  /// integration points during the previous setup:
+  /// External_element_guess_pt[e][ipt] and External_element_guess_s[e][ipt].
+  /// Used as initial guesses for the (warm-started) search in sample point 
+  /// containers of type UseBoundingBoxTree so that small mesh motions
+  /// don't require a full re-search. The pointers are never dereferenced
+  /// unless the element is (still) in the mesh.
+  Vector<Vector<FiniteElement*> > External_element_guess_pt;
+
+  /// \short Local coordinates in the previously assigned external elements
+  /// (see External_element_guess_pt)
+  Vector<Vector<Vector<double> > > External_element_guess_s;
   
   /// \short Vector of flat-packed zeta coordinates for which the external
   /// element could not be found during current local search. These
@@ -1709,6 +1723,53 @@ namespace Multi_domain_functions
    // for padded entries).
    Located_element_status.resize(n_zeta,Not_found);
 
+   // Locate the zeta tuples for each mesh in one batch (which the
+   // sample point container may process concurrently) before dealing
+   // with the results in order below. Each mesh's tuples are terminated 
+   // by a tuple of DBL_MAXs.
+   Vector<GeomObject*> located_sub_geom_obj_pt(n_zeta,0);
+   Vector<Vector<double> > located_s(n_zeta);
+   {
+    unsigned i_zeta=0;
+    for (unsigned i_mesh=0;(i_mesh<n_mesh)&&(i_zeta<n_zeta);i_mesh++)
+     {
+      Vector<Vector<double> > batch_zeta;
+      Vector<unsigned> batch_index;
+      while (i_zeta<n_zeta)
+       {
+        Vector<double> x_global(Dim);
+        bool reached_end_of_mesh=false;
+        for (unsigned ii=0;ii<Dim;ii++)
+         {
+          x_global[ii]=Received_flat_packed_zetas_to_be_found[i_zeta*Dim+ii];
+          if (x_global[ii]==DBL_MAX)
+           {
+            reached_end_of_mesh=true;
+           }
+         }
+        i_zeta++;
+        if (reached_end_of_mesh)
+         {
+          break;
+         }
+        batch_zeta.push_back(x_global);
+        batch_index.push_back(i_zeta-1);
+       }
+      Vector<FiniteElement*> no_guess_el_pt;
+      Vector<GeomObject*> batch_sub_geom_obj_pt;
+      Vector<Vector<double> > batch_s;
+      mesh_geom_obj_pt[i_mesh]->locate_zeta_batch(batch_zeta,no_guess_el_pt,
+                                                  batch_sub_geom_obj_pt,
+                                                  batch_s);
+      unsigned n_batch=batch_index.size();
+      for (unsigned k=0;k<n_batch;k++)
+       {
+        located_sub_geom_obj_pt[batch_index[k]]=batch_sub_geom_obj_pt[k];
+        located_s[batch_index[k]]=batch_s[k];
+       }
+     }
+   }
+
    // Counter for flat-packed array of external zeta coordinates
    unsigned count=0;
 
@@ -1774,14 +1835,12 @@ namespace Multi_domain_functions
         }
       }
          
-     // Perform locate_zeta for these coordinates and current mesh
-     GeomObject *sub_geom_obj_pt=0;
-     Vector<double> ss(Dim);
+     // Result of locate_zeta for these coordinates and current mesh
+     // (from the batch above)
+     GeomObject *sub_geom_obj_pt=located_sub_geom_obj_pt[i];
+     Vector<double> ss(located_s[i]);
      if (!reached_end_of_mesh)
       {
-       mesh_geom_obj_pt[i_mesh]->locate_zeta(x_global,
-                                             sub_geom_obj_pt,ss);
-
        // Did the locate method work?
        if (sub_geom_obj_pt!=0)
         {
@@ -2047,6 +2106,66 @@ namespace Multi_domain_functions
     {         
      // Number of local elements
      unsigned n_element=mesh_pt[i_mesh]->nelement();
+
+     // Locate all outstanding integration points in one batch (which
+     // the sample point container may process concurrently), starting
+     // from the external elements that were assigned to them during the
+     // previous setup (if these were recorded)
+     Vector<Vector<double> > batch_x_global;
+     Vector<GeomObject*> batch_sub_geom_obj_pt;
+     Vector<Vector<double> > batch_s_ext;
+     unsigned batch_count=0;
+     {
+       Vector<FiniteElement*> batch_guess_el_pt;
+       unsigned e_count_batch=e_count;
+       for (unsigned e=0;e<n_element;e++)
+        {
+         ElementWithExternalElement *el_pt=
+          dynamic_cast<ElementWithExternalElement*>(mesh_pt[i_mesh]->
+                                                    element_pt(e));
+#ifdef OOMPH_HAS_MPI
+         if (!el_pt->is_halo()) 
+#endif 
+          {
+           unsigned n_intpt=el_pt->integral_pt()->nweight();
+           unsigned el_dim=el_pt->dim();
+           Vector<double> s_local(el_dim);
+           Vector<double> x_global(el_dim);
+           bool have_guess=
+            (e_count_batch<External_element_guess_pt.size())&&
+            (External_element_guess_pt[e_count_batch].size()==n_intpt);
+           for (unsigned ipt=0;ipt<n_intpt;ipt++)
+            {
+             if (External_element_located[e_count_batch][ipt]==0)
+              {
+               for (unsigned i=0;i<el_dim;i++)
+                {
+                 s_local[i]=el_pt->integral_pt()->knot(ipt,i);
+                }
+               el_pt->interpolated_zeta(s_local,x_global);
+               batch_x_global.push_back(x_global);
+               if (have_guess)
+                {
+                 batch_guess_el_pt.push_back(
+                  External_element_guess_pt[e_count_batch][ipt]);
+                 batch_s_ext.push_back(
+                  External_element_guess_s[e_count_batch][ipt]);
+                }
+               else
+                {
+                 batch_guess_el_pt.push_back(0);
+                 batch_s_ext.push_back(Vector<double>(el_dim));
+                }
+              }
+            }
+          }
+         e_count_batch++;
+        }
+       mesh_geom_obj_pt[i_mesh]->locate_zeta_batch(batch_x_global,
+                                                   batch_guess_el_pt,
+                                                   batch_sub_geom_obj_pt,
+                                                   batch_s_ext);
+     }
      
      // Loop over this processor's elements
      for (unsigned e=0;e<n_element;e++)
@@ -2080,8 +2199,7 @@ namespace Multi_domain_functions
           }
 #endif
 
-         // Set storage for local and global coordinates
-         Vector<double> s_local(el_dim);
+         // Set storage for global coordinates
          Vector<double> x_global(el_dim);
          
          // Loop over integration points
@@ -2090,19 +2208,12 @@ namespace Multi_domain_functions
            // Has this integration point been done yet?
            if (External_element_located[e_count][ipt]==0)
             {
-             // Get local coordinates
-             for (unsigned i=0;i<el_dim;i++)
-              {
-               s_local[i]=el_pt->integral_pt()->knot(ipt,i);
-              }
-             // Interpolate to global coordinates
-             el_pt->interpolated_zeta(s_local,x_global);
-             
-             // Storage for geometric object and its local coordinates
-             GeomObject* sub_geom_obj_pt=0;
-             Vector<double> s_ext(el_dim);
-             mesh_geom_obj_pt[i_mesh]->locate_zeta(x_global,
-                                                   sub_geom_obj_pt,s_ext);
+             // Global coordinates, geometric object and its local 
+             // coordinates (located in the batch above)
+             x_global=batch_x_global[batch_count];
+             GeomObject* sub_geom_obj_pt=batch_sub_geom_obj_pt[batch_count];
+             Vector<double> s_ext(batch_s_ext[batch_count]);
+             batch_count++;
 
              // Has the required element been located?
              if (sub_geom_obj_pt!=0)
@@ -2279,6 +2390,8 @@ namespace Multi_domain_functions
    Flat_packed_doubles.clear();
    Flat_packed_unsigneds.clear();
    External_element_located.clear();
+   External_element_guess_pt.clear();
+   External_element_guess_s.clear();
   }
 
   /// Vector of zeta coordinates that we're currently trying to locate;
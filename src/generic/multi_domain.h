@@ -79,6 +79,20 @@ namespace Multi_domain_functions
   /// Used locally to ensure that we're not searching for the same
   /// elements over and over again when we go around the spirals.
   extern Vector<Vector<unsigned> > External_element_located;
+
+  /// \short Lookup scheme for the external elements (and the local
+  /// coordinates within them) that were assigned to a local element's
+  /// integration points during the previous setup:
+  /// External_element_guess_pt[e][ipt] and External_element_guess_s[e][ipt].
+  /// Used as initial guesses for the (warm-started) search in sample point 
+  /// containers of type UseBoundingBoxTree so that small mesh motions
+  /// don't require a full re-search. The pointers are never dereferenced
+  /// unless the element is (still) in the mesh.
+  extern Vector<Vector<FiniteElement*> > External_element_guess_pt;
+
+  /// \short Local coordinates in the previously assigned external elements
+  /// (see External_element_guess_pt)
+  extern Vector<Vector<Vector<double> > > External_element_guess_s;
   
   /// \short Vector of flat-packed zeta coordinates for which the external
   /// element could not be found during current local search. These
@@ -254,6 +268,24 @@ namespace Multi_domain_functions
                                        Mesh* const &external_mesh_pt,
                                        const unsigned& interaction_index=0);
 
+  /// \short Incremental version of setup_multi_domain_interaction(...)
+  /// (same arguments) for use after mesh_pt and/or external_mesh_pt
+  /// have been adapted. The external element (and the local
+  /// coordinate within it) is only recomputed for integration points 
+  /// whose previously assigned external element no longer exists, or
+  /// no longer contains the integration point (e.g. because the 
+  /// element itself was created by refinement). The search is 
+  /// warm-started from the previous external element, from the 
+  /// external element assigned to the father element (for elements
+  /// created by refinement), or from the sons of previous external elements
+  /// that have since been refined. We fall back to the full setup for 
+  /// distributed problems and if any integration point can't be located.
+  template<class EXT_ELEMENT>
+   void update_multi_domain_interaction(Problem* problem_pt,
+                                        Mesh* const &mesh_pt,
+                                        Mesh* const &external_mesh_pt,
+                                        const unsigned& interaction_index=0);
+
   /// \short Function to set up the one-way multi-domain interaction for 
   /// FSI-like problems. 
   /// - \c mesh_pt points to the mesh of \c ElemenWithExternalElements for which
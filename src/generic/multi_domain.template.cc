@@ -52,6 +52,9 @@
 #include "refineable_elements.h"
 #include "Qspectral_elements.h"
 
+//Needed for the tree-based warm starts in the incremental update
+#include "refineable_mesh.h"
+
 namespace oomph
 {
 
@@ -309,6 +312,287 @@ namespace oomph
   }
 
 
+//========================================================================
+/// Incremental version of setup_multi_domain_interaction(...) for use
+/// after mesh_pt and/or external_mesh_pt have been adapted: Only
+/// recompute the external elements (and the local coordinates within
+/// them) for integration points whose previously assigned external
+/// element has disappeared or no longer contains the integration point.
+/// Searches are warm-started using the tree (father/son) relationships
+/// between the old and new elements. Falls back to the full setup
+/// for distributed problems and if any integration point can't be 
+/// located in this way.
+//========================================================================
+ template<class EXT_ELEMENT>
+  void Multi_domain_functions::update_multi_domain_interaction
+  (Problem* problem_pt, Mesh* const &mesh_pt, Mesh* const &external_mesh_pt,
+   const unsigned& interaction_index)
+  {
+#ifdef OOMPH_HAS_MPI
+   // The external (halo) elements of distributed problems are set up 
+   // by the ring-like parallel search: Do the full setup
+   if (problem_pt->problem_has_been_distributed())
+    {
+     setup_multi_domain_interaction<EXT_ELEMENT>
+      (problem_pt,mesh_pt,external_mesh_pt,interaction_index);
+     return;
+    }
+#endif
+
+   double t_start=0.0;
+   if (Doc_timings) 
+    {
+     t_start=TimingHelpers::timer();
+    }
+
+   // Bulk elements must not be external elements in this case
+   Use_bulk_element_as_external=false;
+
+   // Set Dim (and check consistency of element dimensions)
+   get_dim_helper(problem_pt,mesh_pt,external_mesh_pt);
+
+   // Elements that are currently in the external mesh: Only these
+   // can be used directly
+   std::set<FiniteElement*> live_element_pt;
+   unsigned n_ext_element=external_mesh_pt->nelement();
+   for (unsigned e=0;e<n_ext_element;e++)
+    {
+     live_element_pt.insert(external_mesh_pt->finite_element_pt(e));
+    }
+
+   // Elements in the external mesh that have been refined since the
+   // last setup are no longer in the mesh but still exist as the
+   // objects associated with the non-leaf nodes of the external
+   // mesh's tree forest. Their sons provide good initial guesses.
+   std::map<FiniteElement*,Tree*> refined_element_tree_pt;
+   TreeBasedRefineableMeshBase* ext_ref_mesh_pt=
+    dynamic_cast<TreeBasedRefineableMeshBase*>(external_mesh_pt);
+   if (ext_ref_mesh_pt!=0)
+    {
+     if (ext_ref_mesh_pt->forest_pt()!=0)
+      {
+       Vector<Tree*> all_tree_nodes_pt;
+       ext_ref_mesh_pt->forest_pt()->
+        stick_all_tree_nodes_into_vector(all_tree_nodes_pt);
+       unsigned n_tree_node=all_tree_nodes_pt.size();
+       for (unsigned i=0;i<n_tree_node;i++)
+        {
+         if (!all_tree_nodes_pt[i]->is_leaf())
+          {
+           refined_element_tree_pt[
+            all_tree_nodes_pt[i]->object_pt()]=all_tree_nodes_pt[i];
+          }
+        }
+      }
+    }
+
+   // Integration points that have to be (re-)located, their global
+   // coordinates and the initial guesses for the search
+   Vector<ElementWithExternalElement*> relocate_el_pt;
+   Vector<unsigned> relocate_ipt;
+   Vector<Vector<double> > relocate_x_global;
+   Vector<FiniteElement*> relocate_guess_el_pt;
+   Vector<Vector<double> > relocate_s;
+
+   // Total number of integration points
+   unsigned tot_int=0;
+
+   // Loop over elements
+   unsigned n_element=mesh_pt->nelement();
+   for (unsigned e=0;e<n_element;e++)
+    {
+     ElementWithExternalElement *el_pt=
+      dynamic_cast<ElementWithExternalElement*>(mesh_pt->element_pt(e));
+     
+     // (Re-)allocate storage if the element is new or its number
+     // of integration points has changed; existing entries are retained
+     el_pt->initialise_external_element_storage();
+
+     // Elements created by refinement: Their father element's 
+     // external elements provide the initial guesses
+     ElementWithExternalElement* father_el_pt=0;
+     RefineableElement* ref_el_pt=dynamic_cast<RefineableElement*>(el_pt);
+     if (ref_el_pt!=0)
+      {
+       if (ref_el_pt->tree_pt()!=0)
+        {
+         if (ref_el_pt->tree_pt()->father_pt()!=0)
+          {
+           father_el_pt=dynamic_cast<ElementWithExternalElement*>(
+            ref_el_pt->tree_pt()->father_pt()->object_pt());
+           if (father_el_pt!=0)
+            {
+             if (!father_el_pt->storage_has_been_allocated())
+              {
+               father_el_pt=0;
+              }
+            }
+          }
+        }
+      }
+
+     unsigned el_dim=el_pt->dim();
+     Vector<double> s_local(el_dim);
+     Vector<double> x_global(el_dim);
+     Vector<double> x_ext(el_dim);
+     unsigned n_intpt=el_pt->integral_pt()->nweight();
+     for (unsigned ipt=0;ipt<n_intpt;ipt++)
+      {
+       tot_int++;
+
+       // Global coordinates of integration point
+       for (unsigned i=0;i<el_dim;i++)
+        {
+         s_local[i]=el_pt->integral_pt()->knot(ipt,i);
+        }
+       el_pt->interpolated_zeta(s_local,x_global);
+
+       // Previous external element: Only dereference it if it's
+       // still in the external mesh
+       FiniteElement* guess_el_pt=
+        el_pt->external_element_pt(interaction_index,ipt);
+       Vector<double> s_guess(el_pt->external_element_local_coord
+                              (interaction_index,ipt));
+       if (live_element_pt.find(guess_el_pt)!=live_element_pt.end())
+        {
+         // Does it still contain the integration point?
+         if (s_guess.size()==guess_el_pt->dim())
+          {
+           guess_el_pt->interpolated_zeta(s_guess,x_ext);
+           double max_error=0.0;
+           for (unsigned i=0;i<el_dim;i++)
+            {
+             max_error=std::max(max_error,std::fabs(x_ext[i]-x_global[i]));
+            }
+           if (max_error<=Locate_zeta_helpers::Newton_tolerance)
+            {
+             // Nothing to be done
+             continue;
+            }
+          }
+        }
+       else 
+        {
+         guess_el_pt=0;
+        }
+
+       // Try the father's external element instead
+       if ((guess_el_pt==0)&&(father_el_pt!=0))
+        {
+         unsigned father_ipt=0;
+         if (ipt<father_el_pt->integral_pt()->nweight())
+          {
+           father_ipt=ipt;
+          }
+         guess_el_pt=
+          father_el_pt->external_element_pt(interaction_index,father_ipt);
+         s_guess=father_el_pt->external_element_local_coord
+          (interaction_index,father_ipt);
+        }
+
+       // Previous external element has been refined: Use its first
+       // leaf descendant
+       if ((guess_el_pt!=0)&&
+           (live_element_pt.find(guess_el_pt)==live_element_pt.end()))
+        {
+         std::map<FiniteElement*,Tree*>::iterator it=
+          refined_element_tree_pt.find(guess_el_pt);
+         if (it!=refined_element_tree_pt.end())
+          {
+           Tree* tree_pt=it->second;
+           while (!tree_pt->is_leaf())
+            {
+             tree_pt=tree_pt->son_pt(0);
+            }
+           guess_el_pt=tree_pt->object_pt();
+           if (live_element_pt.find(guess_el_pt)==live_element_pt.end())
+            {
+             guess_el_pt=0;
+            }
+          }
+         else
+          {
+           // Element has been deleted (by unrefinement)
+           guess_el_pt=0;
+          }
+        }
+       if ((guess_el_pt==0)||(s_guess.size()!=el_dim))
+        {
+         s_guess.resize(el_dim);
+         for (unsigned i=0;i<el_dim;i++)
+          {
+           s_guess[i]=0.0;
+          }
+        }
+
+       // Wipe the old assignment and record the point for the search
+       el_pt->external_element_pt(interaction_index,ipt)=0;
+       relocate_el_pt.push_back(el_pt);
+       relocate_ipt.push_back(ipt);
+       relocate_x_global.push_back(x_global);
+       relocate_guess_el_pt.push_back(guess_el_pt);
+       relocate_s.push_back(s_guess);
+      }
+    }
+
+   // Locate the outstanding points in one batch
+   unsigned n_relocate=relocate_el_pt.size();
+   bool all_located=true;
+   if (n_relocate>0)
+    {
+     MeshAsGeomObject* mesh_geom_obj_pt=
+      new MeshAsGeomObject(external_mesh_pt);
+     Vector<GeomObject*> sub_geom_obj_pt;
+     mesh_geom_obj_pt->locate_zeta_batch(relocate_x_global,
+                                         relocate_guess_el_pt,
+                                         sub_geom_obj_pt,
+                                         relocate_s);
+     for (unsigned p=0;p<n_relocate;p++)
+      {
+       if (sub_geom_obj_pt[p]==0)
+        {
+         all_located=false;
+         break;
+        }
+       relocate_el_pt[p]->external_element_pt(interaction_index,
+                                              relocate_ipt[p])=
+        dynamic_cast<FiniteElement*>(sub_geom_obj_pt[p]);
+       relocate_el_pt[p]->external_element_local_coord(interaction_index,
+                                                       relocate_ipt[p])=
+        relocate_s[p];
+      }
+     delete mesh_geom_obj_pt;
+    }
+
+   if (Doc_stats)
+    {
+     oomph_info << "Incremental multi-domain update: Relocated " 
+                << n_relocate << " of " << tot_int
+                << " integration points" << std::endl;
+    }
+
+   // Failed: Do the full setup (which deals with failures properly)
+   if (!all_located)
+    {
+     if (Doc_stats)
+      {
+       oomph_info << "Incremental multi-domain update failed to locate "
+                  << "all integration points; doing full setup." 
+                  << std::endl;
+      }
+     setup_multi_domain_interaction<EXT_ELEMENT>
+      (problem_pt,mesh_pt,external_mesh_pt,interaction_index);
+     return;
+    }
+
+   if (Doc_timings) 
+    {
+     oomph_info << "CPU for incremental update of multi-domain interaction: "
+                << TimingHelpers::timer()-t_start << std::endl;
+    }
+  }
+
+
 //========================================================================
  /// Function to set up the one-way multi-domain interaction for 
  /// FSI-like problems. 
@@ -714,6 +998,23 @@ namespace oomph
     }
    External_element_located.resize(e_count);
 
+   // Bounding box trees can use the external elements from the previous 
+   // setup as initial guesses: Record them before they're wiped
+   bool record_guesses=false;
+   for (unsigned i_mesh=0;i_mesh<n_mesh;i_mesh++)
+    {
+     if (mesh_geom_obj_pt[i_mesh]->sample_point_container_version()==
+         UseBoundingBoxTree)
+      {
+       record_guesses=true;
+      }
+    }
+   if (record_guesses)
+    {
+     External_element_guess_pt.resize(e_count);
+     External_element_guess_s.resize(e_count);
+    }
+
    // Reset counter for elements in flat packed storage
    e_count=0;
    
@@ -726,6 +1027,11 @@ namespace oomph
       {
        // Zero-sized vector means its a halo
        External_element_located[e_count].resize(0);
+       if (record_guesses)
+        {
+         External_element_guess_pt[e_count].resize(0);
+         External_element_guess_s[e_count].resize(0);
+        }
        ElementWithExternalElement *el_pt=
         dynamic_cast<ElementWithExternalElement*>(
          mesh_pt[i_mesh]->element_pt(e));
@@ -742,10 +1048,23 @@ namespace oomph
          //points within the element has changed.
          el_pt->initialise_external_element_storage();
 
-         // Clear any previous allocation
+         // Clear any previous allocation (but keep it as the initial
+         // guess if required)
          unsigned n_intpt=el_pt->integral_pt()->nweight();
+         if (record_guesses)
+          {
+           External_element_guess_pt[e_count].resize(n_intpt);
+           External_element_guess_s[e_count].resize(n_intpt);
+          }
          for (unsigned ipt=0;ipt<n_intpt;ipt++)
           {
+           if (record_guesses)
+            {
+             External_element_guess_pt[e_count][ipt]=
+              el_pt->external_element_pt(interaction_index,ipt);
+             External_element_guess_s[e_count][ipt]=
+              el_pt->external_element_local_coord(interaction_index,ipt);
+            }
            el_pt->external_element_pt(interaction_index,ipt)=0;
           }
 
@@ -1297,6 +1616,12 @@ namespace oomph
           has_not_reached_max_level_of_search=false;
          }
        }
+      else if (mesh_geom_obj_pt[0]->sample_point_container_version()==
+               UseBoundingBoxTree)
+       {
+        // Bounding box trees search exhaustively; no need to spiral
+        has_not_reached_max_level_of_search=false;
+       }
 #ifdef OOMPH_HAS_CGAL
       else if (mesh_geom_obj_pt[0]->sample_point_container_version()==
                UseCGALSamplePointContainer)
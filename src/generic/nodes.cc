@@ -188,6 +188,25 @@ namespace oomph
   //If we have nulled out the storage already return immediately
   if((Value==0) && (Eqn_number==0)) {return;}
   
+  //If the storage is held in a NodalStoragePool it's not ours to delete
+  if(Value_storage_is_pooled)
+   {
+    Value = 0; Eqn_number = 0;
+    Value_storage_is_pooled=false;
+    return;
+   }
+
+  //If the values are held in a DofStoragePool only the pointers
+  //and equation numbers are ours
+  if(Value_storage_is_in_dof_pool)
+   {
+    delete[] Value; delete[] Eqn_number;
+    Value = 0; Eqn_number = 0;
+    Value_storage_is_in_dof_pool=false;
+    ++Dof_pool_generation;
+    return;
+   }
+
   //Delete the double storage arrays at once (they were allocated at once)
   delete[] Value[0];
   //Delete the pointers to the arrays.
@@ -195,6 +214,67 @@ namespace oomph
   //Null out the pointers
   Value = 0; Eqn_number = 0;
  }
+
+//================================================================
+/// If the values and equation numbers are stored in a 
+/// NodalStoragePool or DofStoragePool, copy them into storage 
+/// allocated (and owned) by the Data object. Called before the 
+/// storage is re-allocated.
+//================================================================
+ void Data::unpool_value_storage()
+ {
+  //Only the values are held in a DofStoragePool: Copy them into
+  //our own storage and re-direct the (existing) pointers
+  if(Value_storage_is_in_dof_pool)
+   {
+    const unsigned n_value = nvalue();
+    const unsigned n_tstorage = ntstorage();
+    double *values = new double[n_value*n_tstorage];
+    for(unsigned i=0;i<n_value;i++)
+     {
+      for(unsigned t=0;t<n_tstorage;t++) 
+       {values[i*n_tstorage+t] = Value[i][t];}
+      Value[i] = &values[i*n_tstorage];
+     }
+    Value_storage_is_in_dof_pool=false;
+    ++Dof_pool_generation;
+
+    //Update any pointers in any copies of this data
+    for(unsigned i=0;i<Ncopies;i++)
+     {
+      Copy_of_data_pt[i]->reset_copied_pointers();
+     }
+    return;
+   }
+
+  if(!Value_storage_is_pooled) {return;}
+
+  const unsigned n_value = nvalue();
+  const unsigned n_tstorage = ntstorage();
+
+  //Allocate the storage in the usual way
+  double **value_new_pt = new double*[n_value];
+  long *eqn_number_new = new long[n_value];
+  double *values = new double[n_value*n_tstorage];
+
+  //Copy the pooled values and equation numbers
+  for(unsigned i=0;i<n_value;i++)
+   {
+    value_new_pt[i] = &values[i*n_tstorage];
+    for(unsigned t=0;t<n_tstorage;t++) {value_new_pt[i][t] = Value[i][t];}
+    eqn_number_new[i] = Eqn_number[i];
+   }
+
+  Value = value_new_pt;
+  Eqn_number = eqn_number_new;
+  Value_storage_is_pooled=false;
+
+  //Update any pointers in any copies of this data
+  for(unsigned i=0;i<Ncopies;i++)
+   {
+    Copy_of_data_pt[i]->reset_copied_pointers();
+   }
+ }
  
 //================================================================
 /// Default (steady) timestepper for steady Data
@@ -212,6 +292,12 @@ TimeStepper* Data::Default_static_time_stepper_pt=new Steady<0>();
 //================================================================
 long Data::Is_unclassified=-10;
 
+//================================================================
+/// \short Counter that is incremented whenever the values of any
+/// Data leave a DofStoragePool
+//================================================================
+unsigned long Data::Dof_pool_generation=0;
+
 //================================================================
 /// Static "Magic number" to indicate that the value is constrained,
 /// usually because is it associated with non-conforming data,
@@ -235,6 +321,8 @@ long Data::Is_segregated_solve_pinned=-3;
 #ifdef OOMPH_HAS_MPI
               , Non_halo_proc_ID(-1)
 #endif
+              , Value_storage_is_pooled(false)
+              , Value_storage_is_in_dof_pool(false)
 
  {}
 
@@ -251,6 +339,8 @@ long Data::Is_segregated_solve_pinned=-3;
 #ifdef OOMPH_HAS_MPI
   , Non_halo_proc_ID(-1)
 #endif
+  , Value_storage_is_pooled(false)
+  , Value_storage_is_in_dof_pool(false)
  {
   //Only bother to do something if there are values
   if(initial_n_value > 0)
@@ -294,6 +384,8 @@ Data::Data(TimeStepper* const &time_stepper_pt_,
 #ifdef OOMPH_HAS_MPI
  , Non_halo_proc_ID(-1) 
 #endif
+ , Value_storage_is_pooled(false)
+ , Value_storage_is_in_dof_pool(false)
 {
  //If we are in charge of allocating the storage,
  //and there are data to allocate, do so
@@ -391,6 +483,9 @@ Data::Data(TimeStepper* const &time_stepper_pt_,
  //If the timestepper is unchanged do nothing
  if(Time_stepper_pt==time_stepper_pt) {return;}
 
+ //Pooled storage can't be resized: Take ownership of the values first
+ unpool_value_storage();
+
  //Find the amount of data to be preserved
  //Default is just the current values 
  unsigned n_preserved_tstorage = 1;
@@ -534,15 +629,16 @@ bool Data::does_pointer_correspond_to_value(double*const &parameter_pt)
   //Find the amount of data stored
   const unsigned n_value = nvalue();
   const unsigned n_time = ntstorage();
-  const unsigned n_storage = n_value*n_time;
-
-  //Pointer to the local data
-  double *local_value_pt = Value[0];
 
   //Loop over data and if we find the pointer then return true
-  for(unsigned i=0;i<n_storage;++i)
+  //(the values aren't necessarily stored in a single array if they
+  //are held in a DofStoragePool)
+  for(unsigned i=0;i<n_value;++i)
    {
-    if(parameter_pt==(local_value_pt+i)) {return true;}
+    for(unsigned t=0;t<n_time;++t)
+     {
+      if(parameter_pt==(Value[i]+t)) {return true;}
+     }
    }
 
   //If we get to here we haven't found the data
@@ -835,6 +931,116 @@ void Data::read(std::ifstream& restart_file)
 }
 
 
+//================================================================
+/// Dump data object in binary restart format: Append the number
+/// of values and of history values to size and the values
+/// themselves (ordered as in dump(...)) to values.
+//================================================================
+void Data::dump_binary(Vector<unsigned>& size, Vector<double>& values) const
+{
+ //Find the amount of storage used
+ const unsigned value_pt_range = nvalue();
+ const unsigned time_steps_range = ntstorage();
+
+ size.push_back(value_pt_range);
+ size.push_back(time_steps_range);
+
+ // Write data
+ for(unsigned t=0;t<time_steps_range;t++)
+  {
+   for(unsigned j=0;j<value_pt_range;j++) 
+    {
+     values.push_back(value(t,j));
+    }
+  }
+}
+
+//================================================================
+/// Read data object from vectors written by dump_binary(...).
+/// The indices are advanced past the entries read. Returns true
+/// if the number of history values or the number of values in the
+/// file does not match the storage allocated here.
+//================================================================
+bool Data::read_binary(const Vector<unsigned>& size, 
+                       unsigned long& size_index,
+                       const Vector<double>& values, 
+                       unsigned long& value_index)
+{
+ //Find the amount of data stored 
+ const unsigned value_pt_range = nvalue();
+ const unsigned time_steps_range = ntstorage();
+
+#ifdef PARANOID
+ if (size_index+2>size.size())
+  {
+   throw OomphLibError(
+    "Binary restart data ends before all Data objects have been read",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ const unsigned check_nvalues=size[size_index++];
+ const unsigned check_ntvalues=size[size_index++];
+
+ if (check_nvalues<value_pt_range)
+  {
+   std::ostringstream error_stream;
+   error_stream 
+    << "Number of values stored in dump file is less than the amount "
+    << "of storage allocated in Data object "
+    <<  check_nvalues << " " << value_pt_range << std::endl;
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+
+#ifdef PARANOID
+ if (value_index+check_nvalues*check_ntvalues>values.size())
+  {
+   throw OomphLibError(
+    "Binary restart data ends before all Data objects have been read",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ // Proper (dynamic or static) restart: copy all history values
+ if (check_ntvalues==time_steps_range)
+  {
+   for(unsigned t=0;t<time_steps_range;t++)
+    {
+     for(unsigned j=0;j<value_pt_range;j++) 
+      {
+       set_value(t,j,values[value_index+t*check_nvalues+j]);
+      }
+    }
+  }
+ // Dynamic run restarted from steady run or vice versa: Only
+ // the current values are used; any remaining history values
+ // are zeroed, as in read(...)
+ else
+  {
+   for(unsigned j=0;j<value_pt_range;j++) 
+    {
+     if (check_ntvalues>0)
+      {
+       set_value(0,j,values[value_index+j]);
+      }
+     for(unsigned t=1;t<time_steps_range;t++)
+      {
+       set_value(t,j,0.0);
+      }
+    }
+  }
+
+ // Skip the entries that have been read (or ignored)
+ value_index+=check_nvalues*check_ntvalues;
+
+ return (check_ntvalues!=time_steps_range)||(check_nvalues!=value_pt_range);
+}
+
+
 //===================================================================
 /// Return the total number of doubles stored per value to record
 /// the time history of ecah value. The information is read from the
@@ -977,6 +1183,9 @@ void Data::resize(const unsigned &n_value)
   }
 #endif
 
+ //Pooled storage can't be resized: Take ownership of the values first
+ unpool_value_storage();
+
  //Find amount of additional time storage required
  //N.B. We can't change timesteppers in this process
  const unsigned t_storage = ntstorage();
@@ -1094,12 +1303,12 @@ void Data::add_values_to_vector(Vector<double> &vector_of_values)
  if(n_value==0) {return;}
 #endif
 
- //Pointer to the first entry in the data array
- double* data_pt = Value[0];
-
  //Loop over values
  for(unsigned i=0;i<n_value;i++)
   {
+   //Pointer to the first entry for this value
+   double* data_pt = Value[i];
+
    //Loop over time histories
    for(unsigned t=0;t<n_tstorage;t++)
     {
@@ -1151,12 +1360,12 @@ void Data::read_values_from_vector(const Vector<double> &vector_of_values,
  //If no values are stored, return immediately
  if(n_value==0) {return;}
 
- //Pointer to the first entry in the data array
- double* data_pt = Value[0];
-
  //Loop over values
  for(unsigned i=0;i<n_value;i++)
   {
+   //Pointer to the first entry for this value
+   double* data_pt = Value[i];
+
    //Loop over time histories
    for(unsigned t=0;t<n_tstorage;t++)
     {
@@ -1514,6 +1723,7 @@ Node::Node() : Data(),
                Position_time_stepper_pt(Data::Default_static_time_stepper_pt),
                Hanging_pt(0),
                Ndim(0), Nposition_type(0), Obsolete(false),
+               Position_storage_is_pooled(false),
                Aux_node_update_fct_pt(0)
 {
 #ifdef LEAK_CHECK
@@ -1537,7 +1747,8 @@ Node::Node(const unsigned &n_dim,
  Position_time_stepper_pt(Data::Default_static_time_stepper_pt),
  Hanging_pt(0),
  Ndim(n_dim), 
- Nposition_type(n_position_type), Obsolete(false), Aux_node_update_fct_pt(0)
+ Nposition_type(n_position_type), Obsolete(false),
+ Position_storage_is_pooled(false), Aux_node_update_fct_pt(0)
 {
 #ifdef LEAK_CHECK
  LeakCheckNames::Node_build+=1;
@@ -1585,7 +1796,8 @@ Node::Node(TimeStepper* const &time_stepper_pt_,
    X_position(0), 
    Position_time_stepper_pt(time_stepper_pt_), 
    Hanging_pt(0),
-   Ndim(n_dim), Nposition_type(n_position_type), Obsolete(false), Aux_node_update_fct_pt(0)
+   Ndim(n_dim), Nposition_type(n_position_type), Obsolete(false),
+ Position_storage_is_pooled(false), Aux_node_update_fct_pt(0)
 {
 #ifdef LEAK_CHECK
  LeakCheckNames::Node_build+=1;
@@ -1658,6 +1870,10 @@ Node::~Node()
  //Test this and if so, we're done
  if(X_position==0) {return;}
 
+ //If the positions are held in a NodalStoragePool they're not ours
+ //to delete
+ if(Position_storage_is_pooled) {X_position=0; return;}
+
  //If we're still here we must free our own memory which was allocated
  //in one block
  delete[] X_position[0];
@@ -1666,6 +1882,34 @@ Node::~Node()
  delete[] X_position; X_position=0;
 }
 
+//================================================================
+/// If the positions are stored in a NodalStoragePool, copy them 
+/// into storage allocated (and owned) by the Node. Called before the 
+/// storage is re-allocated.
+//================================================================
+void Node::unpool_position_storage()
+{
+ if(!Position_storage_is_pooled) {return;}
+
+ const unsigned n_storage = this->ndim()*this->nposition_type();
+ const unsigned n_tstorage = Position_time_stepper_pt->ntstorage();
+
+ //Allocate the storage in the usual way
+ double **x_position_new_pt = new double*[n_storage];
+ double *x_positions = new double[n_storage*n_tstorage];
+
+ //Copy the pooled positions
+ for(unsigned j=0;j<n_storage;j++)
+  {
+   x_position_new_pt[j] = &x_positions[j*n_tstorage];
+   for(unsigned t=0;t<n_tstorage;t++) 
+    {x_position_new_pt[j][t] = X_position[j][t];}
+  }
+
+ X_position = x_position_new_pt;
+ Position_storage_is_pooled=false;
+}
+
 //================================================================
 /// Set a new position TimeStepper be resizing the appropriate storage.
 /// The current (zero) values will be unaffected, but all other entries
@@ -1677,6 +1921,9 @@ void Node::set_position_time_stepper(TimeStepper*
 {
  //If the timestepper is unchanged do nothing
  if(Position_time_stepper_pt==position_time_stepper_pt) {return;}
+
+ //Pooled storage can't be resized: Take ownership of the positions first
+ unpool_position_storage();
  
  //Find the amount of data to be preserved
  unsigned n_preserved_tstorage =1;
@@ -1980,6 +2227,94 @@ void Node::read(std::ifstream& restart_file)
  Data::read(restart_file);
 }
 
+//================================================================
+/// Dump nodal positions and associated data in binary restart format
+//================================================================
+void Node::dump_binary(Vector<unsigned>& size, Vector<double>& values) const
+{
+ // Number of positional values
+ const unsigned npos_storage = Ndim*Nposition_type;
+ const unsigned time_steps_range = Position_time_stepper_pt->ntstorage();
+ size.push_back(npos_storage);
+ size.push_back(time_steps_range);
+
+ for(unsigned t=0;t<time_steps_range;t++)
+  {
+   for(unsigned j=0;j<npos_storage;j++) 
+    {
+     values.push_back(X_position[j][t]);
+    }
+  }
+
+ // Dump out data
+ Data::dump_binary(size,values);
+}
+
+//================================================================
+/// Read nodal positions and associated data from vectors written
+/// by dump_binary(...). Returns true if the nodal data did not match
+/// the allocated storage exactly (see Data::read_binary(...)).
+//================================================================
+bool Node::read_binary(const Vector<unsigned>& size, 
+                       unsigned long& size_index,
+                       const Vector<double>& values, 
+                       unsigned long& value_index)
+{
+ // Number of positional values
+ const unsigned npos_storage = Ndim*Nposition_type;
+
+ // Number of time values (incl present)
+ const unsigned time_steps_range = Position_time_stepper_pt->ntstorage();
+
+#ifdef PARANOID
+ if (size_index+2>size.size())
+  {
+   throw OomphLibError(
+    "Binary restart data ends before all Nodes have been read",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ const unsigned check_npos_storage=size[size_index++];
+ const unsigned check_time_steps_range=size[size_index++];
+ if ((check_npos_storage!=npos_storage)||
+     (check_time_steps_range!=time_steps_range))
+  {
+   std::ostringstream error_stream;
+   error_stream << "The allocated positional storage " 
+                << npos_storage << " x " << time_steps_range 
+                << " is not the same as that in the input file "
+                << check_npos_storage << " x " 
+                << check_time_steps_range << std::endl;
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+
+#ifdef PARANOID
+ if (value_index+npos_storage*time_steps_range>values.size())
+  {
+   throw OomphLibError(
+    "Binary restart data ends before all Nodes have been read",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ // Read fixed nodal positions
+ for(unsigned t=0;t<time_steps_range;t++)
+  {
+   for(unsigned j=0;j<npos_storage;j++) 
+    {
+     X_position[j][t] = values[value_index++];
+    }
+  }
+
+ //  Read associated data
+ return Data::read_binary(size,size_index,values,value_index);
+}
+
 //=====================================================================
 /// Set the hanging data for the i-th  value. 
 /// If node is already hanging, simply overwrite the appropriate entry.
@@ -3424,6 +3759,80 @@ void SolidNode::read(std::ifstream& restart_file)
  Node::read(restart_file);
 }
 
+//================================================================
+/// Dump nodal positions (variable and fixed) and associated data
+/// in binary restart format
+//================================================================
+void SolidNode::dump_binary(Vector<unsigned>& size, 
+                            Vector<double>& values) const
+{
+ // Number of lagrangian values
+ const unsigned nlagrangian_storage = Nlagrangian*Nlagrangian_type;
+ size.push_back(nlagrangian_storage);
+ for(unsigned j=0;j<nlagrangian_storage;j++) 
+  {
+   values.push_back(Xi_position[j]);
+  }
+
+ // Dump out Eulerian positions and nodal data
+ Node::dump_binary(size,values);
+}
+
+//================================================================
+/// Read nodal positions (variable and fixed) and associated data
+/// from vectors written by dump_binary(...)
+//================================================================
+bool SolidNode::read_binary(const Vector<unsigned>& size, 
+                            unsigned long& size_index,
+                            const Vector<double>& values, 
+                            unsigned long& value_index)
+{
+ // Number of lagrangian values
+ const unsigned nlagrangian_storage = Nlagrangian*Nlagrangian_type;
+
+#ifdef PARANOID
+ if (size_index+1>size.size())
+  {
+   throw OomphLibError(
+    "Binary restart data ends before all SolidNodes have been read",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ const unsigned check_nlagrangian_storage=size[size_index++];
+ if(check_nlagrangian_storage!=nlagrangian_storage)
+  {
+   std::ostringstream error_stream;
+   error_stream << "The allocated Lagrangian storage " 
+                << nlagrangian_storage << 
+    " is not the same as that in the input file "
+                << check_nlagrangian_storage << std::endl;
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+
+#ifdef PARANOID
+ if (value_index+nlagrangian_storage>values.size())
+  {
+   throw OomphLibError(
+    "Binary restart data ends before all SolidNodes have been read",
+    OOMPH_CURRENT_FUNCTION,
+    OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ // Read Lagrangian positions
+ for(unsigned j=0;j<nlagrangian_storage;j++) 
+  {
+   Xi_position[j] = values[value_index++];
+  }
+
+ // Read Eulerian positions and nodal data
+ return Node::read_binary(size,size_index,values,value_index);
+}
+
 //===================================================================
 /// Set the variable position data from an external source. 
 /// This is mainly used when setting periodic solid problems.
@@ -3714,4 +4123,361 @@ void SolidNode::read_eqn_numbers_from_vector(
 #endif
 
 
+
+
+/////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////
+
+
+//=======================================================================
+/// Free the pooled storage
+//=======================================================================
+void NodalStoragePool::clean_up_memory()
+{
+ delete[] Value_pt_storage; Value_pt_storage=0;
+ delete[] Value_storage; Value_storage=0;
+ delete[] Eqn_number_storage; Eqn_number_storage=0;
+ delete[] Position_pt_storage; Position_pt_storage=0;
+ delete[] Position_storage; Position_storage=0;
+ Nvalue_storage=0;
+ Nposition_storage=0;
+}
+
+
+//=======================================================================
+/// Move the storage of the specified nodes into the pool 
+/// (in the order of the vector). Any previously pooled storage is
+/// released.
+//=======================================================================
+void NodalStoragePool::build(const Vector<Node*>& node_pt)
+{
+ const unsigned long n_node=node_pt.size();
+
+ // Count the storage required
+ unsigned long n_value_pt=0;
+ unsigned long n_value=0;
+ unsigned long n_position_pt=0;
+ unsigned long n_position=0;
+ for(unsigned long n=0;n<n_node;n++)
+  {
+   Node* const nod_pt=node_pt[n];
+   if((!nod_pt->is_a_copy())&&(nod_pt->Value!=0))
+    {
+     n_value_pt+=nod_pt->nvalue();
+     n_value+=nod_pt->nvalue()*nod_pt->ntstorage();
+    }
+   if((dynamic_cast<SolidNode*>(nod_pt)==0)&&(nod_pt->X_position!=0))
+    {
+     const unsigned n_storage=nod_pt->ndim()*nod_pt->nposition_type();
+     n_position_pt+=n_storage;
+     n_position+=n_storage*nod_pt->position_time_stepper_pt()->ntstorage();
+    }
+  }
+
+ // Allocate the new pool
+ double** value_pt_storage=new double*[n_value_pt];
+ double* value_storage=new double[n_value];
+ long* eqn_number_storage=new long[n_value_pt];
+ double** position_pt_storage=new double*[n_position_pt];
+ double* position_storage=new double[n_position];
+
+ // Move the storage into the new pool
+ unsigned long value_pt_index=0;
+ unsigned long value_index=0;
+ unsigned long position_pt_index=0;
+ unsigned long position_index=0;
+ for(unsigned long n=0;n<n_node;n++)
+  {
+   Node* const nod_pt=node_pt[n];
+
+   // Values and equation numbers
+   if((!nod_pt->is_a_copy())&&(nod_pt->Value!=0))
+    {
+     // Take the values out of any DofStoragePool first (the node
+     // then owns all its storage)
+     nod_pt->unpool_value_storage();
+
+     const unsigned n_val=nod_pt->nvalue();
+     const unsigned n_tstorage=nod_pt->ntstorage();
+     double** new_value_pt=&value_pt_storage[value_pt_index];
+     long* new_eqn_number_pt=&eqn_number_storage[value_pt_index];
+     for(unsigned i=0;i<n_val;i++)
+      {
+       new_value_pt[i]=&value_storage[value_index];
+       for(unsigned t=0;t<n_tstorage;t++)
+        {
+         value_storage[value_index++]=nod_pt->Value[i][t];
+        }
+       new_eqn_number_pt[i]=nod_pt->Eqn_number[i];
+      }
+     value_pt_index+=n_val;
+
+     // Free the node's own storage (if it's pooled, the old pool
+     // owns it)
+     if(!nod_pt->Value_storage_is_pooled)
+      {
+       delete[] nod_pt->Value[0];
+       delete[] nod_pt->Value;
+       delete[] nod_pt->Eqn_number;
+      }
+     nod_pt->Value=new_value_pt;
+     nod_pt->Eqn_number=new_eqn_number_pt;
+     nod_pt->Value_storage_is_pooled=true;
+
+     // Update any pointers in any copies of this data
+     const unsigned n_copies=nod_pt->Ncopies;
+     for(unsigned i=0;i<n_copies;i++)
+      {
+       nod_pt->Copy_of_data_pt[i]->reset_copied_pointers();
+      }
+    }
+
+   // Positions
+   if((dynamic_cast<SolidNode*>(nod_pt)==0)&&(nod_pt->X_position!=0))
+    {
+     const unsigned n_storage=nod_pt->ndim()*nod_pt->nposition_type();
+     const unsigned n_tstorage=
+      nod_pt->position_time_stepper_pt()->ntstorage();
+     double** new_x_position_pt=&position_pt_storage[position_pt_index];
+     for(unsigned j=0;j<n_storage;j++)
+      {
+       new_x_position_pt[j]=&position_storage[position_index];
+       for(unsigned t=0;t<n_tstorage;t++)
+        {
+         position_storage[position_index++]=nod_pt->X_position[j][t];
+        }
+      }
+     position_pt_index+=n_storage;
+
+     if(!nod_pt->Position_storage_is_pooled)
+      {
+       delete[] nod_pt->X_position[0];
+       delete[] nod_pt->X_position;
+      }
+     nod_pt->X_position=new_x_position_pt;
+     nod_pt->Position_storage_is_pooled=true;
+    }
+  }
+
+ // Free the old pool and keep the new one
+ clean_up_memory();
+ Value_pt_storage=value_pt_storage;
+ Value_storage=value_storage;
+ Eqn_number_storage=eqn_number_storage;
+ Position_pt_storage=position_pt_storage;
+ Position_storage=position_storage;
+ Nvalue_storage=n_value;
+ Nposition_storage=n_position;
+}
+
+
+//=======================================================================
+/// Copy the storage of the specified nodes that is held in this
+/// pool back into storage owned by the nodes.
+//=======================================================================
+void NodalStoragePool::release(const Vector<Node*>& node_pt)
+{
+ const unsigned long n_node=node_pt.size();
+ for(unsigned long n=0;n<n_node;n++)
+  {
+   Node* const nod_pt=node_pt[n];
+   if((nod_pt->Value!=0)&&value_storage_is_in_pool(nod_pt))
+    {
+     nod_pt->unpool_value_storage();
+    }
+   if((nod_pt->X_position!=0)&&position_storage_is_in_pool(nod_pt))
+    {
+     nod_pt->unpool_position_storage();
+    }
+  }
+}
+
+
+
+
+/////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////
+
+
+//=======================================================================
+/// Free the pooled storage
+//=======================================================================
+void DofStoragePool::clean_up_memory()
+{
+ delete[] Value_storage; Value_storage=0;
+ Nvalue_storage=0;
+ Ndof=0;
+ Ntstorage=0;
+}
+
+
+//=======================================================================
+/// Move the values of the specified (distinct) Data into the pool,
+/// ordered by equation number. Returns false (and leaves the storage
+/// unchanged) if the unknowns have different numbers of history 
+/// values or their equation numbers are not a permutation of 
+/// 0,...,n_dof-1.
+//=======================================================================
+bool DofStoragePool::build(const Vector<Data*>& data_pt, 
+                           const unsigned long& n_dof)
+{
+ const unsigned long n_data=data_pt.size();
+
+ // Check that the unknowns can be stored with a fixed stride and
+ // count the storage required for the pinned values
+ unsigned n_tstorage=0;
+ unsigned long n_pinned_storage=0;
+ std::vector<bool> eqn_is_stored(n_dof,false);
+ unsigned long n_eqn_stored=0;
+ for(unsigned long d=0;d<n_data;d++)
+  {
+   Data* const dat_pt=data_pt[d];
+   if((dat_pt->is_a_copy())||(dat_pt->Value==0)) {continue;}
+   const unsigned n_val=dat_pt->nvalue();
+   const unsigned n_tstorage_data=dat_pt->ntstorage();
+   for(unsigned i=0;i<n_val;i++)
+    {
+     const long eqn=dat_pt->Eqn_number[i];
+     if(eqn<0) 
+      {
+       n_pinned_storage+=n_tstorage_data;
+       continue;
+      }
+     if(n_tstorage==0) {n_tstorage=n_tstorage_data;}
+     if((n_tstorage_data!=n_tstorage)||
+        (static_cast<unsigned long>(eqn)>=n_dof)||
+        eqn_is_stored[eqn])
+      {
+       return false;
+      }
+     eqn_is_stored[eqn]=true;
+     n_eqn_stored++;
+    }
+  }
+ if(n_eqn_stored!=n_dof) {return false;}
+ if(n_tstorage==0) {n_tstorage=1;}
+
+ // Allocate the new pool
+ const unsigned long n_value=n_dof*n_tstorage+n_pinned_storage;
+ double* value_storage=new double[n_value];
+
+ // Move the values into the new pool
+ unsigned long pinned_index=n_dof*n_tstorage;
+ for(unsigned long d=0;d<n_data;d++)
+  {
+   Data* const dat_pt=data_pt[d];
+   if((dat_pt->is_a_copy())||(dat_pt->Value==0)) {continue;}
+
+   // If the values are held in a NodalStoragePool, get our own 
+   // pointers first (the DofStoragePool only holds the values)
+   if(dat_pt->Value_storage_is_pooled) {dat_pt->unpool_value_storage();}
+
+   const unsigned n_val=dat_pt->nvalue();
+   const unsigned n_tstorage_data=dat_pt->ntstorage();
+
+   // Keep track of the old storage (if it's owned by the Data)
+   double* old_values_pt=0;
+   if(!dat_pt->Value_storage_is_in_dof_pool) 
+    {
+     old_values_pt=dat_pt->Value[0];
+    }
+
+   for(unsigned i=0;i<n_val;i++)
+    {
+     double* new_value_pt=0;
+     const long eqn=dat_pt->Eqn_number[i];
+     if(eqn>=0) 
+      {
+       new_value_pt=&value_storage[eqn*n_tstorage];
+      }
+     else
+      {
+       new_value_pt=&value_storage[pinned_index];
+       pinned_index+=n_tstorage_data;
+      }
+     for(unsigned t=0;t<n_tstorage_data;t++)
+      {
+       new_value_pt[t]=dat_pt->Value[i][t];
+      }
+     dat_pt->Value[i]=new_value_pt;
+    }
+
+   delete[] old_values_pt;
+   dat_pt->Value_storage_is_in_dof_pool=true;
+
+   // Update any pointers in any copies of this data
+   const unsigned n_copies=dat_pt->Ncopies;
+   for(unsigned i=0;i<n_copies;i++)
+    {
+     dat_pt->Copy_of_data_pt[i]->reset_copied_pointers();
+    }
+  }
+
+ // Free the old pool and keep the new one
+ clean_up_memory();
+ Value_storage=value_storage;
+ Nvalue_storage=n_value;
+ Ndof=n_dof;
+ Ntstorage=n_tstorage;
+ Generation=Data::Dof_pool_generation;
+ return true;
+}
+
+
+//=======================================================================
+/// Check that the values of all unknowns stored in the specified
+/// Data are (still) held in this pool at the position given by their
+/// equation numbers. If so, the pool is marked as intact, so 
+/// no_data_has_left() returns true until another Data leaves a pool.
+//=======================================================================
+bool DofStoragePool::is_intact(const Vector<Data*>& data_pt)
+{
+ if(Value_storage==0) {return false;}
+
+ unsigned long n_eqn_stored=0;
+ const unsigned long n_data=data_pt.size();
+ for(unsigned long d=0;d<n_data;d++)
+  {
+   Data* const dat_pt=data_pt[d];
+   if((dat_pt->is_a_copy())||(dat_pt->Value==0)) {continue;}
+   const unsigned n_val=dat_pt->nvalue();
+   for(unsigned i=0;i<n_val;i++)
+    {
+     const long eqn=dat_pt->Eqn_number[i];
+     if(eqn<0) {continue;}
+     if((!dat_pt->Value_storage_is_in_dof_pool)||
+        (static_cast<unsigned long>(eqn)>=Ndof)||
+        (dat_pt->Value[i]!=&Value_storage[eqn*Ntstorage]))
+      {
+       return false;
+      }
+     n_eqn_stored++;
+    }
+  }
+ if(n_eqn_stored!=Ndof) {return false;}
+
+ Generation=Data::Dof_pool_generation;
+ return true;
+}
+
+
+//=======================================================================
+/// Copy the values of the specified Data that are held in this
+/// pool back into storage owned by the Data.
+//=======================================================================
+void DofStoragePool::release(const Vector<Data*>& data_pt)
+{
+ const unsigned long n_data=data_pt.size();
+ for(unsigned long d=0;d<n_data;d++)
+  {
+   Data* const dat_pt=data_pt[d];
+   if((dat_pt->Value!=0)&&value_storage_is_in_pool(dat_pt))
+    {
+     dat_pt->unpool_value_storage();
+    }
+  }
+}
+
 }
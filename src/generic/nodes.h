@@ -101,6 +101,14 @@ class Data
  //the use of positions as variables for solid mechanics problems.
  friend class SolidNode;
 
+ //The storage pool moves the values and equation numbers into
+ //contiguous arrays
+ friend class NodalStoragePool;
+
+ //The dof storage pool moves the values into an array that is ordered
+ //by equation number
+ friend class DofStoragePool;
+
  /// \short C-style array of pointers to data values and 
  /// possible history values. The data must be ordered in such a way
  /// that Value[i][t] gives the i-th data value at the time value t.
@@ -143,6 +151,21 @@ class Data
 
 #endif
 
+ /// \short Flag to indicate that the values and equation numbers are
+ /// stored in a NodalStoragePool (which owns the memory)
+ bool Value_storage_is_pooled;
+
+ /// \short Flag to indicate that the values (but not the pointers to
+ /// them or the equation numbers) are stored in a DofStoragePool 
+ /// (which owns the memory)
+ bool Value_storage_is_in_dof_pool;
+
+ /// \short Counter that is incremented whenever the values of any Data 
+ /// leave a DofStoragePool (because the Data re-allocates its storage
+ /// or is deleted), so that the pools can detect that they may no 
+ /// longer hold all the values they were built for.
+ static unsigned long Dof_pool_generation;
+
  /// \short Check that the arguments are within
  /// the range of the stored data values and timesteps.
  void range_check(const unsigned &t, const unsigned &i) const;
@@ -150,6 +173,12 @@ class Data
  /// \short Delete all storage allocated by the Data object for values
  /// and equation numbers.
  void delete_value_storage();
+
+ /// \short If the values and equation numbers are stored in a
+ /// NodalStoragePool or DofStoragePool, copy them into storage allocated
+ /// (and owned) by the Data object. Called before the storage is 
+ /// re-allocated.
+ void unpool_value_storage();
  
  /// \short Add the pointer data_pt to the array Copy_of_data_pt.
  /// This should be used whenever copies are made of the data.
@@ -250,6 +279,14 @@ class Data
  /// always returns false.
  virtual bool is_a_copy() const {return false;}
 
+ /// \short Are the values and equation numbers stored in a
+ /// NodalStoragePool?
+ bool value_storage_is_pooled() const {return Value_storage_is_pooled;}
+
+ /// \short Are the values stored in a DofStoragePool?
+ bool value_storage_is_in_dof_pool() const 
+  {return Value_storage_is_in_dof_pool;}
+
  /// \short Return flag to indicate whether the i-th value is a copy.
  /// A base Data object can never be a copy so the default implementation
  /// always returns false.
@@ -348,6 +385,24 @@ class Data
  /// Read data object from a file.
  void read(std::ifstream& restart_file);
 
+ /// \short Dump the data object in binary restart format: Append the
+ /// number of values and the number of history values to size, and
+ /// the values (in the same order as in dump(...)) to values.
+ void dump_binary(Vector<unsigned>& size, Vector<double>& values) const;
+
+ /// \short Read data object from vectors written by dump_binary(...),
+ /// starting at entry size_index of size and value_index of values.
+ /// Both indices are advanced past the entries that were read. As in
+ /// read(...), extra values in the file are ignored, and missing 
+ /// history values (steady restart of an unsteady run) are filled 
+ /// with zeroes. Returns true if the number of history values in the
+ /// file differed from the storage allocated here, so the caller can 
+ /// issue a single warning rather than one per Data object.
+ bool read_binary(const Vector<unsigned>& size, 
+                  unsigned long& size_index,
+                  const Vector<double>& values, 
+                  unsigned long& value_index);
+
  /// Return the pointer to the equation number of the i-th stored variable.
  long* eqn_number_pt(const unsigned &i) 
   {
@@ -856,6 +911,9 @@ public:
  //The BoundaryNodeBase class must use knowledge of the internal data storage
  ///to construct periodic Nodes
  friend class BoundaryNodeBase;
+
+ //The storage pool moves the positions into contiguous arrays
+ friend class NodalStoragePool;
  
   protected:
 
@@ -898,6 +956,15 @@ public:
  /// obsolete --- usually during mesh refinement process 
  bool Obsolete;
 
+ /// \short Flag to indicate that the positions are stored in a
+ /// NodalStoragePool (which owns the memory)
+ bool Position_storage_is_pooled;
+
+ /// \short If the positions are stored in a NodalStoragePool, copy
+ /// them into storage allocated (and owned) by the Node. Called before
+ /// the storage is re-allocated.
+ void unpool_position_storage();
+
  /// \short Direct access to the pointer to the i-th stored coordinate data
  double* x_position_pt(const unsigned &i) {return X_position[i];}
 
@@ -1113,6 +1180,18 @@ public:
 ///Read nodal position and associated data from file for restart
  void read(std::ifstream& restart_file);
 
+ /// \short Dump nodal position and associated data in binary restart
+ /// format (see Data::dump_binary(...))
+ virtual void dump_binary(Vector<unsigned>& size, 
+                          Vector<double>& values) const;
+
+ /// \short Read nodal position and associated data from vectors
+ /// written by dump_binary(...) (see Data::read_binary(...))
+ virtual bool read_binary(const Vector<unsigned>& size, 
+                          unsigned long& size_index,
+                          const Vector<double>& values, 
+                          unsigned long& value_index);
+
  ///\short The pin_all() function must be overloaded by SolidNodes,
  ///so we put the virtual interface here to avoid virtual functions in Data
  virtual void pin_all() {Data::pin_all();}
@@ -1348,6 +1427,9 @@ public:
  /// Test whether node is obsolete
  bool is_obsolete() {return Obsolete;}
 
+ /// Are the positions stored in a NodalStoragePool?
+ bool position_storage_is_pooled() const {return Position_storage_is_pooled;}
+
  /// \short Return the i-th value stored at the Node. This interface
  /// does NOT take the hanging status of the Node into account.
  double raw_value(const unsigned &i) const {return Data::value(i);}
@@ -1643,6 +1725,17 @@ public:
  /// data from file for restart
  void read(std::ifstream& restart_file);
 
+ /// \short Dump nodal positions (variable and fixed) and associated 
+ /// data in binary restart format
+ void dump_binary(Vector<unsigned>& size, Vector<double>& values) const;
+
+ /// \short Read nodal positions (variable and fixed) and associated 
+ /// data from vectors written by dump_binary(...)
+ bool read_binary(const Vector<unsigned>& size, 
+                  unsigned long& size_index,
+                  const Vector<double>& values, 
+                  unsigned long& value_index);
+
  ///Return the variable_position data (const version)
  const Data &variable_position() const {return *Variable_position_pt;}
 
@@ -2704,6 +2797,256 @@ inline void BoundaryNode<SolidNode>::make_periodic(Node* const &node_pt)
 
 
 
+
+
+//////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+
+
+//=====================================================================
+/// \short Pooled (structure-of-arrays) storage for the values, 
+/// history values, equation numbers and positions of a set of Nodes.
+/// By default every Data object allocates its own arrays for its 
+/// values and equation numbers (and every Node its own array for its 
+/// positions), so a large mesh generates a huge number of small heap 
+/// allocations that end up scattered in memory. The pool copies the
+/// storage of the nodes (in the order in which they are specified) into
+/// a few large contiguous arrays and redirects the nodes' internal 
+/// pointers into these, so loops over the nodes (assembly, 
+/// shifting of history values, getting/setting dofs, dump/restart, ...)
+/// access memory sequentially. The nodes' access functions are 
+/// unaffected. 
+///
+/// Values that are copies of other Data (e.g. in periodic nodes) and the
+/// positions of SolidNodes (which are stored as Data) are not pooled.
+/// If a pooled Data object has to re-allocate its storage (because
+/// it is resized or its timestepper is changed), it automatically 
+/// copies its values back into storage that it owns. 
+///
+/// Building (or releasing) the pool moves the values, so any pointers
+/// to them (e.g. to the dofs in the Problem and the elements) have to
+/// be rebuilt afterwards, see Mesh::enable_pooled_nodal_storage(...).
+///
+/// The pool owns the memory: It must not be deleted before the nodes 
+/// have either been deleted or released from the pool.
+//=====================================================================
+class NodalStoragePool
+{
+
+ public:
+
+ /// Constructor: Empty pool
+ NodalStoragePool() : Value_pt_storage(0), Value_storage(0), 
+  Eqn_number_storage(0), Position_pt_storage(0), Position_storage(0),
+  Nvalue_storage(0), Nposition_storage(0)
+  {}
+
+ /// Destructor: Free the pooled storage
+ ~NodalStoragePool() {clean_up_memory();}
+
+ /// Broken copy constructor
+ NodalStoragePool(const NodalStoragePool&)
+  {
+   BrokenCopy::broken_copy("NodalStoragePool");
+  }
+
+ /// Broken assignment operator
+ void operator=(const NodalStoragePool&)
+  {
+   BrokenCopy::broken_assign("NodalStoragePool");
+  }
+
+ /// \short Move the storage of the specified nodes into the pool 
+ /// (in the order of the vector). Any previously pooled storage is
+ /// released; nodes that were stored in the previous pool but are not
+ /// contained in node_pt must have been released or deleted.
+ void build(const Vector<Node*>& node_pt);
+
+ /// \short Copy the storage of the specified nodes that is held in this
+ /// pool back into storage owned by the nodes.
+ void release(const Vector<Node*>& node_pt);
+
+ /// \short Total number of (current and history) values in the pool
+ unsigned long nvalue_storage() const {return Nvalue_storage;}
+
+ /// \short Total number of (current and history) positions in the pool
+ unsigned long nposition_storage() const {return Nposition_storage;}
+
+ /// \short Pointer to the contiguous array of pooled values (for 
+ /// fast loops over all values)
+ double* value_storage_pt() {return Value_storage;}
+
+ /// \short Pointer to the contiguous array of pooled positions (for 
+ /// fast loops over all positions)
+ double* position_storage_pt() {return Position_storage;}
+
+ private:
+
+ /// Free the pooled storage
+ void clean_up_memory();
+
+ /// Are the values of data_pt stored in this pool?
+ bool value_storage_is_in_pool(Data* const &data_pt) const
+  {
+   return (data_pt->Value_storage_is_pooled)&&
+    (data_pt->Value[0]>=Value_storage)&&
+    (data_pt->Value[0]<Value_storage+Nvalue_storage);
+  }
+
+ /// Are the positions of nod_pt stored in this pool?
+ bool position_storage_is_in_pool(Node* const &nod_pt) const
+  {
+   return (nod_pt->Position_storage_is_pooled)&&
+    (nod_pt->X_position[0]>=Position_storage)&&
+    (nod_pt->X_position[0]<Position_storage+Nposition_storage);
+  }
+
+ /// Pooled pointers to the values of each Data
+ double** Value_pt_storage;
+
+ /// Pooled values (ordered by node, value, time level)
+ double* Value_storage;
+
+ /// Pooled equation numbers
+ long* Eqn_number_storage;
+
+ /// Pooled pointers to the positions of each Node
+ double** Position_pt_storage;
+
+ /// Pooled positions (ordered by node, coordinate/type, time level)
+ double* Position_storage;
+
+ /// Total number of (current and history) values in the pool
+ unsigned long Nvalue_storage;
+
+ /// Total number of (current and history) positions in the pool
+ unsigned long Nposition_storage;
+
+};
+
+
+
+/////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+
+
+//=====================================================================
+/// A DofStoragePool holds the (current and history) values of a 
+/// collection of Data objects in a single array that is ordered by
+/// global equation number: The t-th history value of the unknown with
+/// equation number i is stored at dof_storage_pt()[i*ntstorage()+t],
+/// so that the vector of unknowns can be copied to and from the Data 
+/// without any indirection (and with a single memcpy if there are
+/// no history values). Pinned values are stored after the unknowns.
+///
+/// Only the values are moved; the Data keep their own arrays of 
+/// pointers to the values (which may be aliased, e.g. by 
+/// SolidNodes) and of equation numbers. Data that are copies of other 
+/// Data are not pooled (they point to the original's values anyway).
+/// If a pooled Data object has to re-allocate its storage (because
+/// it is resized or its timestepper is changed), it automatically 
+/// copies its values back into storage that it owns. 
+///
+/// The pool owns the memory: It must not be deleted before the Data
+/// have either been deleted or released from the pool.
+//=====================================================================
+class DofStoragePool
+{
+
+ public:
+
+ /// Constructor: Empty pool
+ DofStoragePool() : Value_storage(0), Nvalue_storage(0), Ndof(0), 
+  Ntstorage(0), Generation(0)
+  {}
+
+ /// Destructor: Free the pooled storage
+ ~DofStoragePool() {clean_up_memory();}
+
+ /// Broken copy constructor
+ DofStoragePool(const DofStoragePool&)
+  {
+   BrokenCopy::broken_copy("DofStoragePool");
+  }
+
+ /// Broken assignment operator
+ void operator=(const DofStoragePool&)
+  {
+   BrokenCopy::broken_assign("DofStoragePool");
+  }
+
+ /// \short Move the values of the specified (distinct) Data into the 
+ /// pool, given the total number of unknowns, n_dof. Any previously
+ /// pooled storage is released; Data that were stored in the previous
+ /// pool but are not contained in data_pt must have been released or
+ /// deleted. Returns false (and leaves the storage unchanged) if the
+ /// pool can't be built because the unknowns have different numbers of 
+ /// history values or their equation numbers are not a permutation of
+ /// 0,...,n_dof-1.
+ bool build(const Vector<Data*>& data_pt, const unsigned long& n_dof);
+
+ /// \short Copy the values of the specified Data that are held in this
+ /// pool back into storage owned by the Data.
+ void release(const Vector<Data*>& data_pt);
+
+ /// \short Cheap check that no Data has left any DofStoragePool since
+ /// this pool was built (or last checked by is_intact(...)). If this 
+ /// returns false, the pool may still be intact, which can be checked 
+ /// with is_intact(...).
+ bool no_data_has_left() const 
+  {return Generation==Data::Dof_pool_generation;}
+
+ /// \short Check that the values of all unknowns stored in the 
+ /// specified Data are (still) held in this pool at the position 
+ /// given by their equation numbers.
+ bool is_intact(const Vector<Data*>& data_pt);
+
+ /// Number of unknowns in the pool
+ unsigned long ndof() const {return Ndof;}
+
+ /// \short Number of (current and history) values stored for each 
+ /// unknown, i.e. the stride between successive unknowns
+ unsigned ntstorage() const {return Ntstorage;}
+
+ /// \short Pointer to the contiguous array of values: The t-th history 
+ /// value of unknown i is stored in entry i*ntstorage()+t
+ double* dof_storage_pt() {return Value_storage;}
+
+ private:
+
+ /// Free the pooled storage
+ void clean_up_memory();
+
+ /// Are the values of data_pt stored in this pool?
+ bool value_storage_is_in_pool(Data* const &data_pt) const
+  {
+   return (data_pt->Value_storage_is_in_dof_pool)&&
+    (data_pt->Value[0]>=Value_storage)&&
+    (data_pt->Value[0]<Value_storage+Nvalue_storage);
+  }
+
+ /// \short Pooled values (ordered by equation number and time level,
+ /// followed by the pinned values)
+ double* Value_storage;
+
+ /// Total number of values in the pool
+ unsigned long Nvalue_storage;
+
+ /// Number of unknowns in the pool
+ unsigned long Ndof;
+
+ /// Number of (current and history) values stored for each unknown
+ unsigned Ntstorage;
+
+ /// \short Value of Data::Dof_pool_generation when the pool was
+ /// last known to be intact
+ unsigned long Generation;
+
+};
+
 }
 
 #endif
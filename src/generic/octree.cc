@@ -3297,6 +3297,124 @@ namespace oomph
  }
 
 
+//================================================================
+/// Set the Morton key (level and integer position within the root)
+/// of the son_type-th son of father_pt
+//================================================================
+ void OcTree::set_morton_key(const OcTree* father_pt, const int& son_type)
+ {
+  Level_in_root=father_pt->Level_in_root+1;
+  const Vector<int>& son_vector=Direction_to_vector[son_type];
+  for (unsigned i=0;i<3;i++)
+  {
+   Position_in_root[i]=2*father_pt->Position_in_root[i];
+   if (son_vector[i]==1) {Position_in_root[i]+=1;}
+  }
+ }
+
+//================================================================
+/// Recompute the Morton keys of all of the octree's descendants
+/// from its own
+//================================================================
+ void OcTree::update_morton_keys_of_descendants()
+ {
+  unsigned n_son=Son_pt.size();
+  for (unsigned i_son=0;i_son<n_son;i_son++)
+  {
+   OcTree* son_pt=dynamic_cast<OcTree*>(Son_pt[i_son]);
+   son_pt->set_morton_key(this,son_pt->son_type());
+   son_pt->update_morton_keys_of_descendants();
+  }
+ }
+
+//================================================================
+/// Find `greater-or-equal-sized' face or edge neighbour in given
+/// direction from the Morton keys, provided it's in the same root:
+/// The equal-sized neighbour's position is obtained by offsetting our 
+/// own; the common ancestor is as many levels up as there are bits in 
+/// which the two positions differ, and the neighbour is found by 
+/// descending from it along the bits of the neighbour's position. 
+/// No rotation is possible within a root. s_lo and s_hi return the
+/// neighbour's local coordinates of the vertices of our face/edge 
+/// that are located at the low/high values of the local coordinates
+/// that vary along it. Returns false (without doing anything) if the 
+/// neighbour has to be found by the general algorithm.
+//================================================================
+ bool OcTree::gteq_neighbour_in_same_root(const int& direction,
+                                          Vector<double>& s_lo,
+                                          Vector<double>& s_hi,
+                                          int& diff_level,
+                                          OcTree*& neighb_pt) const
+ {
+  using namespace OcTreeNames;
+
+  // Son octant from the bits of its position in its father
+  static const int octant[8]={LDB,RDB,LUB,RUB,LDF,RDF,LUF,RUF};
+
+  // Leave very deep trees to the general algorithm
+  if (Level_in_root>30) return false;
+
+  // Offset of the equal-sized neighbour
+  const Vector<int>& offset=Direction_to_vector[direction];
+
+  // Position of the equal-sized neighbour; if it's outside the root,
+  // the general algorithm has to deal with it
+  int n_position=(1<<Level_in_root);
+  unsigned neigh_position[3];
+  unsigned differing_bits=0;
+  for (unsigned i=0;i<3;i++)
+  {
+   int position=int(Position_in_root[i])+offset[i];
+   if ((position<0)||(position>=n_position)) return false;
+   neigh_position[i]=unsigned(position);
+   differing_bits|=(Position_in_root[i]^neigh_position[i]);
+  }
+
+  // Climb up to the common ancestor (at least to the father)
+  unsigned n_up=0;
+  while (differing_bits!=0)
+  {
+   differing_bits>>=1;
+   n_up++;
+  }
+  Tree* tree_pt=Father_pt;
+  for (unsigned k=1;k<n_up;k++)
+  {
+   tree_pt=tree_pt->father_pt();
+  }
+
+  // Descend towards the neighbour until we hit a leaf or our own level
+  unsigned n_down=0;
+  while ((n_down<n_up)&&(tree_pt->nsons()>0))
+  {
+   n_down++;
+   unsigned shift=n_up-n_down;
+   unsigned index=((neigh_position[0]>>shift)&1)+
+    2*((neigh_position[1]>>shift)&1)+4*((neigh_position[2]>>shift)&1);
+   tree_pt=tree_pt->son_pt(octant[index]);
+  }
+  neighb_pt=dynamic_cast<OcTree*>(tree_pt);
+
+  // Difference in level and ratio of our size to the neighbour's
+  diff_level=int(n_down)-int(n_up);
+  double size_ratio=pow(2.0,diff_level);
+
+  // The vertices of our face/edge, mapped into the neighbour's 
+  // local coordinates
+  for (unsigned i=0;i<3;i++)
+  {
+   double lo=(offset[i]!=0) ? double(offset[i]) : -1.0;
+   double hi=(offset[i]!=0) ? double(offset[i]) : 1.0;
+   double neigh_ldb=double(neigh_position[i]>>(n_up-n_down));
+   s_lo[i]=2.0*((double(Position_in_root[i])+0.5*(lo+1.0))*size_ratio-
+		neigh_ldb)-1.0;
+   s_hi[i]=2.0*((double(Position_in_root[i])+0.5*(hi+1.0))*size_ratio-
+		neigh_ldb)-1.0;
+  }
+
+  return true;
+ }
+
 //================================================================
 /// Find (pointer to) `greater-or-equal-sized face neighbour' in
 /// given direction (L/R/U/D/F/B).
@@ -3367,6 +3485,19 @@ namespace oomph
   // Initialise in_neighbouring tree to false. It will be set to true
   // during the recursion if we do actually hop over in to the neighbour
   in_neighbouring_tree=false;
+
+  // Neighbours in the same root can be found from the Morton keys
+  OcTree* same_root_neighb_pt=0;
+  if (gteq_neighbour_in_same_root(direction,s_sw,s_ne,diff_level,
+                                  same_root_neighb_pt))
+  {
+   for (unsigned i=0;i<3;i++)
+   {
+    translate_s[i]=i;
+   }
+   face=Reflect_face[direction];
+   return same_root_neighb_pt;
+  }
  
   // Maximum level to which we're allowed to descend (we only want
   // greater-or-equal-sized neighbours)
@@ -3615,6 +3746,27 @@ namespace oomph
   }
 #endif
  
+  // Neighbours in the same root can be found from the Morton keys
+  // (there's only one edge neighbour then)
+  OcTree* same_root_neighb_pt=0;
+  if (gteq_neighbour_in_same_root(direction,s_lo,s_hi,diff_level,
+                                  same_root_neighb_pt))
+  {
+   nroot_edge_neighbour=0;
+   for (unsigned i=0;i<3;i++)
+   {
+    translate_s[i]=i;
+   }
+   edge=Reflect_edge[direction];
+
+   // Only use "true" edge neighbours
+   if (edge_neighbour_is_face_neighbour(direction,same_root_neighb_pt))
+   {
+    return 0;
+   }
+   return same_root_neighb_pt;
+  }
+
   // Maximum level to which we're allowed to descend (we only want
   // greater-or-equal-sized neighbours)
   int max_level=Level;
@@ -122,6 +122,11 @@ class OcTree : public virtual Tree
    return temp_oc_pt;
   }
 
+ /// \short Recompute the Morton keys (level and integer position within
+ /// the root) of all of the octree's descendants from its own. This is
+ /// required if an existing subtree has been given a new root.
+ void update_morton_keys_of_descendants();
+
  /// Function that, given an edge, returns the two faces on which it
  // lies between, i.e. the faces to which it is a common edge
  static Vector<int> faces_of_common_edge(const int& edge);
@@ -377,7 +382,13 @@ class OcTree : public virtual Tree
  /// protected because OcTrees can only be created internally,
  /// during the split operation. Only OcTreeRoots can be
  /// created externally. 
- OcTree(RefineableElement* const &object_pt) : Tree(object_pt) {}
+ OcTree(RefineableElement* const &object_pt) : Tree(object_pt),
+  Level_in_root(0)
+  {
+   Position_in_root[0]=0;
+   Position_in_root[1]=0;
+   Position_in_root[2]=0;
+  }
 
 
  /// \short Constructor for tree that has a father: Pass it the pointer 
@@ -388,7 +399,10 @@ class OcTree : public virtual Tree
  /// created externally. 
  OcTree(RefineableElement* const &object_pt, 
         Tree* const &father_pt, const int& son_type) :
-  Tree(object_pt,father_pt,son_type) {}
+  Tree(object_pt,father_pt,son_type)
+  {
+   set_morton_key(dynamic_cast<OcTree*>(father_pt),son_type);
+  }
 
  /// Bool indicating that static member data has been setup
  static bool Static_data_has_been_setup;
@@ -474,6 +488,31 @@ class OcTree : public virtual Tree
  bool edge_neighbour_is_face_neighbour(const int& edge,
                                        OcTree* edge_neighb_pt) const;
 
+ /// \short Find `greater-or-equal-sized' face or edge neighbour in 
+ /// given direction from the Morton keys if it's in the same root. 
+ /// s_lo and s_hi return the neighbour's local coordinates of the
+ /// vertices of our face/edge in the given direction that are located 
+ /// at the low/high values of the local coordinates that vary along it.
+ /// Returns false (without doing anything) if the neighbour has to be 
+ /// found by the general algorithm.
+ bool gteq_neighbour_in_same_root(const int& direction,
+                                  Vector<double>& s_lo,
+                                  Vector<double>& s_hi,
+                                  int& diff_level,
+                                  OcTree*& neighb_pt) const;
+
+ /// \short Set the Morton key of the son_type-th son of father_pt
+ void set_morton_key(const OcTree* father_pt, const int& son_type);
+
+ /// \short Level of the octree within its root. This is the same as
+ /// Level unless the root was made from a son of a deeper tree.
+ unsigned Level_in_root;
+
+ /// \short Integer coordinates of the octree's LDB vertex within its
+ /// root, in units of the octree's size. Together with Level_in_root,
+ /// they form the octree's Morton key.
+ unsigned Position_in_root[3];
+
 
 
 
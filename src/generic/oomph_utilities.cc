@@ -29,12 +29,17 @@
 
 #include <algorithm>
 #include <limits.h>
+#include <float.h>
 #include <cstring>
 
 #ifdef OOMPH_HAS_UNISTDH
 #include <unistd.h> // for getpid()
 #endif
 
+#ifdef OOMPH_HAS_PTHREADS
+#include <pthread.h>
+#endif
+
 #include "oomph_utilities.h"
 #include "Vector.h"
 #include "matrices.h"
@@ -1318,6 +1323,556 @@ namespace oomph
   }//end of namespace TimingHelpers
 
 
+
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+
+
+
+  //===============================================================
+  /// Helper functions for reorderings that improve the locality of
+  /// memory accesses: keys along space-filling curves and reverse
+  /// Cuthill-McKee orderings.
+  //===============================================================
+  namespace LocalityReorderingHelpers
+  {
+
+   /// \short Helper: Number of bits per coordinate used in the keys
+   /// (so that the keys fit into 63 bits)
+   unsigned nbit_per_coordinate(const unsigned& dim)
+   {
+    if (dim==1) {return 62;}
+    else if (dim==2) {return 31;}
+    return 21;
+   }
+
+   /// \short Helper: Quantise the scaled coordinates s (in [0,1]) 
+   /// to integers with n_bit bits
+   void quantise(const Vector<double>& s, const unsigned& n_bit,
+                 unsigned long long* q)
+   {
+    const unsigned dim=s.size();
+    const double n_cell=double((1ULL<<n_bit)-1);
+    for (unsigned i=0;i<dim;i++)
+     {
+      double s_i=std::min(1.0,std::max(0.0,s[i]));
+      q[i]=(unsigned long long)(s_i*n_cell);
+     }
+   }
+
+   /// \short Helper: Interleave the bits of the dim integers q 
+   /// (most significant bits first)
+   unsigned long long interleave(const unsigned& dim, const unsigned& n_bit,
+                                 const unsigned long long* q)
+   {
+    unsigned long long key=0;
+    for (unsigned b=n_bit;b>0;b--)
+     {
+      for (unsigned i=0;i<dim;i++)
+       {
+        key=(key<<1)|((q[i]>>(b-1))&1ULL);
+       }
+     }
+    return key;
+   }
+
+   //===============================================================
+   /// Key of the point with (scaled) coordinates s (in [0,1]^dim, 
+   /// dim<=3) along the Morton (Z-order) space-filling curve
+   //===============================================================
+   unsigned long long morton_key(const Vector<double>& s)
+   {
+    const unsigned dim=s.size();
+#ifdef PARANOID
+    if ((dim==0)||(dim>3))
+     {
+      std::ostringstream error_stream;
+      error_stream << "Morton keys can only be computed for 1, 2 or 3 "
+                   << "coordinates, not " << dim << std::endl;
+      throw OomphLibError(error_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+     }
+#endif
+    const unsigned n_bit=nbit_per_coordinate(dim);
+    unsigned long long q[3];
+    quantise(s,n_bit,q);
+    return interleave(dim,n_bit,q);
+   }
+
+   //===============================================================
+   /// Key of the point with (scaled) coordinates s (in [0,1]^dim, 
+   /// dim<=3) along the Hilbert space-filling curve. Uses
+   /// J. Skilling's transposition algorithm ("Programming the 
+   /// Hilbert curve", AIP Conf. Proc. 707, 2004).
+   //===============================================================
+   unsigned long long hilbert_key(const Vector<double>& s)
+   {
+    const unsigned dim=s.size();
+#ifdef PARANOID
+    if ((dim==0)||(dim>3))
+     {
+      std::ostringstream error_stream;
+      error_stream << "Hilbert keys can only be computed for 1, 2 or 3 "
+                   << "coordinates, not " << dim << std::endl;
+      throw OomphLibError(error_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+     }
+#endif
+    const unsigned n_bit=nbit_per_coordinate(dim);
+    unsigned long long x[3];
+    quantise(s,n_bit,x);
+
+    // Inverse undo
+    const unsigned long long m=1ULL<<(n_bit-1);
+    for (unsigned long long q=m;q>1;q>>=1)
+     {
+      const unsigned long long p=q-1;
+      for (unsigned i=0;i<dim;i++)
+       {
+        if (x[i]&q)
+         {
+          // Invert
+          x[0]^=p;
+         }
+        else
+         {
+          // Exchange
+          const unsigned long long t=(x[0]^x[i])&p;
+          x[0]^=t;
+          x[i]^=t;
+         }
+       }
+     }
+
+    // Gray encode
+    for (unsigned i=1;i<dim;i++) {x[i]^=x[i-1];}
+    unsigned long long t=0;
+    for (unsigned long long q=m;q>1;q>>=1)
+     {
+      if (x[dim-1]&q) {t^=q-1;}
+     }
+    for (unsigned i=0;i<dim;i++) {x[i]^=t;}
+
+    return interleave(dim,n_bit,x);
+   }
+
+   /// \short Helper: Comparison of vertices by their degree (ties are
+   /// broken by the vertex index to make the ordering deterministic)
+   class DegreeComparison
+   {
+   public:
+
+    /// Constructor: Pass the degrees of the vertices
+    DegreeComparison(const Vector<unsigned long>& degree) : Degree(degree) {}
+
+    /// Comparison operator
+    bool operator()(const unsigned long& v, const unsigned long& w) const
+    {
+     if (Degree[v]!=Degree[w]) {return Degree[v]<Degree[w];}
+     return v<w;
+    }
+
+   private:
+
+    /// Degrees of the vertices
+    const Vector<unsigned long>& Degree;
+   };
+
+   /// \short Helper: Breadth-first search from the root vertex through 
+   /// its connected component. Returns the number of levels; the 
+   /// vertices in the last level are returned in last_level and all
+   /// vertices in the component in component. The (work) arrays level 
+   /// and group_is_touched must be unset/false on entry and are reset on 
+   /// exit.
+   unsigned long level_structure(const unsigned long& root,
+                                 const Vector<unsigned long>& group_start,
+                                 const Vector<unsigned long>& group_vertex,
+                                 const Vector<unsigned long>& vertex_start,
+                                 const Vector<unsigned long>& vertex_group,
+                                 Vector<unsigned long>& level,
+                                 std::vector<bool>& group_is_touched,
+                                 Vector<unsigned long>& component,
+                                 Vector<unsigned long>& last_level)
+   {
+    const unsigned long unset=ULONG_MAX;
+    Vector<unsigned long> touched_group;
+    component.clear();
+    component.push_back(root);
+    level[root]=0;
+    unsigned long head=0;
+    while (head<component.size())
+     {
+      const unsigned long v=component[head++];
+      for (unsigned long j=vertex_start[v];j<vertex_start[v+1];j++)
+       {
+        const unsigned long g=vertex_group[j];
+        if (!group_is_touched[g])
+         {
+          group_is_touched[g]=true;
+          touched_group.push_back(g);
+          for (unsigned long k=group_start[g];k<group_start[g+1];k++)
+           {
+            const unsigned long w=group_vertex[k];
+            if (level[w]==unset)
+             {
+              level[w]=level[v]+1;
+              component.push_back(w);
+             }
+           }
+         }
+       }
+     }
+
+    // Extract the last level and reset the work arrays
+    const unsigned long n_level=level[component.back()]+1;
+    last_level.clear();
+    const unsigned long n_component=component.size();
+    for (unsigned long i=0;i<n_component;i++)
+     {
+      if (level[component[i]]==n_level-1) 
+       {
+        last_level.push_back(component[i]);
+       }
+      level[component[i]]=unset;
+     }
+    const unsigned long n_touched=touched_group.size();
+    for (unsigned long i=0;i<n_touched;i++)
+     {
+      group_is_touched[touched_group[i]]=false;
+     }
+    return n_level;
+   }
+
+   //===============================================================
+   /// Reverse Cuthill-McKee ordering of n_vertex vertices that are
+   /// connected if they are members of the same group. The vertices in
+   /// group g are group_vertex[group_start[g]],...,
+   /// group_vertex[group_start[g+1]-1]. On return, ordering[k] is
+   /// the (old) index of the vertex that is k-th in the new ordering.
+   /// Each connected component is started from a pseudo-peripheral
+   /// vertex (George & Liu).
+   //===============================================================
+   void reverse_cuthill_mckee(const unsigned long& n_vertex,
+                              const Vector<unsigned long>& group_start,
+                              const Vector<unsigned long>& group_vertex,
+                              Vector<unsigned long>& ordering)
+   {
+    const unsigned long n_group=
+     (group_start.size()>0) ? group_start.size()-1 : 0;
+    const unsigned long n_entry=(n_group>0) ? group_start[n_group] : 0;
+
+    // Set up the groups of each vertex
+    Vector<unsigned long> vertex_start(n_vertex+1,0);
+    for (unsigned long k=0;k<n_entry;k++) {vertex_start[group_vertex[k]+1]++;}
+    for (unsigned long v=0;v<n_vertex;v++) 
+     {
+      vertex_start[v+1]+=vertex_start[v];
+     }
+    Vector<unsigned long> vertex_group(n_entry);
+    Vector<unsigned long> next(vertex_start);
+    for (unsigned long g=0;g<n_group;g++)
+     {
+      for (unsigned long k=group_start[g];k<group_start[g+1];k++)
+       {
+        vertex_group[next[group_vertex[k]]++]=g;
+       }
+     }
+
+    // (Upper bound for) the degree of the vertices
+    Vector<unsigned long> degree(n_vertex,0);
+    for (unsigned long g=0;g<n_group;g++)
+     {
+      const unsigned long n=group_start[g+1]-group_start[g];
+      for (unsigned long k=group_start[g];k<group_start[g+1];k++)
+       {
+        degree[group_vertex[k]]+=n-1;
+       }
+     }
+    DegreeComparison compare(degree);
+
+    // Work arrays for the level structures
+    Vector<unsigned long> level(n_vertex,ULONG_MAX);
+    std::vector<bool> group_is_touched(n_group,false);
+    Vector<unsigned long> component;
+    Vector<unsigned long> last_level;
+
+    // Cuthill-McKee ordering, one connected component at a time
+    std::vector<bool> vertex_is_numbered(n_vertex,false);
+    std::vector<bool> group_is_expanded(n_group,false);
+    ordering.clear();
+    ordering.reserve(n_vertex);
+    for (unsigned long seed=0;seed<n_vertex;seed++)
+     {
+      if (vertex_is_numbered[seed]) {continue;}
+
+      // Find a pseudo-peripheral vertex, starting from the vertex 
+      // of minimum degree in the component
+      unsigned long root=seed;
+      unsigned long n_level=
+       level_structure(root,group_start,group_vertex,vertex_start,
+                       vertex_group,level,group_is_touched,
+                       component,last_level);
+      root=*std::min_element(component.begin(),component.end(),compare);
+      n_level=level_structure(root,group_start,group_vertex,vertex_start,
+                              vertex_group,level,group_is_touched,
+                              component,last_level);
+      for (unsigned iter=0;iter<10;iter++)
+       {
+        const unsigned long candidate=
+         *std::min_element(last_level.begin(),last_level.end(),compare);
+        Vector<unsigned long> candidate_last_level;
+        const unsigned long candidate_n_level=
+         level_structure(candidate,group_start,group_vertex,vertex_start,
+                         vertex_group,level,group_is_touched,
+                         component,candidate_last_level);
+        if (candidate_n_level<=n_level) {break;}
+        root=candidate;
+        n_level=candidate_n_level;
+        last_level=candidate_last_level;
+       }
+
+      // Breadth-first numbering; the new neighbours of each vertex are 
+      // numbered in order of increasing degree
+      unsigned long head=ordering.size();
+      ordering.push_back(root);
+      vertex_is_numbered[root]=true;
+      while (head<ordering.size())
+       {
+        const unsigned long v=ordering[head++];
+        const unsigned long first_new=ordering.size();
+        for (unsigned long j=vertex_start[v];j<vertex_start[v+1];j++)
+         {
+          const unsigned long g=vertex_group[j];
+          if (!group_is_expanded[g])
+           {
+            group_is_expanded[g]=true;
+            for (unsigned long k=group_start[g];k<group_start[g+1];k++)
+             {
+              const unsigned long w=group_vertex[k];
+              if (!vertex_is_numbered[w])
+               {
+                vertex_is_numbered[w]=true;
+                ordering.push_back(w);
+               }
+             }
+           }
+         }
+        std::sort(ordering.begin()+first_new,ordering.end(),compare);
+       }
+     }
+
+    // Reverse
+    std::reverse(ordering.begin(),ordering.end());
+   }
+
+   //===============================================================
+   /// Order the points with coordinates x[i] (of any dimension 
+   /// <=3) along the Hilbert (if use_hilbert_curve is true) or the 
+   /// Morton space-filling curve through their bounding box. Points with
+   /// an empty coordinate vector are placed at the end, in their 
+   /// original order. On return, ordering[k] is the (old) index of the
+   /// point that is k-th in the new ordering.
+   //===============================================================
+   void space_filling_curve_ordering(const Vector<Vector<double> >& x,
+                                     const bool& use_hilbert_curve,
+                                     Vector<unsigned long>& ordering)
+   {
+    const unsigned long n_point=x.size();
+
+    // Bounding box (coordinates beyond a point's dimension are zero)
+    unsigned dim=0;
+    for (unsigned long i=0;i<n_point;i++)
+     {
+      dim=std::max(dim,unsigned(x[i].size()));
+     }
+#ifdef PARANOID
+    if (dim>3)
+     {
+      std::ostringstream error_stream;
+      error_stream << "Space-filling curves are only implemented for up to "
+                   << "three coordinates, not " << dim << std::endl;
+      throw OomphLibError(error_stream.str(),
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+     }
+#endif
+    Vector<double> x_min(dim,DBL_MAX);
+    Vector<double> x_max(dim,-DBL_MAX);
+    for (unsigned long i=0;i<n_point;i++)
+     {
+      if (x[i].size()==0) {continue;}
+      for (unsigned j=0;j<dim;j++)
+       {
+        const double x_j=(j<x[i].size()) ? x[i][j] : 0.0;
+        x_min[j]=std::min(x_min[j],x_j);
+        x_max[j]=std::max(x_max[j],x_j);
+       }
+     }
+
+    // Scale isotropically by the largest extent of the bounding box
+    // so that the curve doesn't get distorted in elongated domains
+    double extent=0.0;
+    for (unsigned j=0;j<dim;j++) 
+     {
+      extent=std::max(extent,x_max[j]-x_min[j]);
+     }
+    if (extent==0.0) {extent=1.0;}
+
+    // Sort by key (ties are broken by the original index)
+    Vector<std::pair<unsigned long long,unsigned long> > key(n_point);
+    Vector<double> s(dim);
+    unsigned long n_with_key=0;
+    for (unsigned long i=0;i<n_point;i++)
+     {
+      if (x[i].size()==0) {continue;}
+      for (unsigned j=0;j<dim;j++)
+       {
+        const double x_j=(j<x[i].size()) ? x[i][j] : 0.0;
+        s[j]=(x_j-x_min[j])/extent;
+       }
+      if (use_hilbert_curve)
+       {
+        key[n_with_key]=std::make_pair(hilbert_key(s),i);
+       }
+      else
+       {
+        key[n_with_key]=std::make_pair(morton_key(s),i);
+       }
+      n_with_key++;
+     }
+    std::sort(key.begin(),key.begin()+n_with_key);
+
+    ordering.resize(n_point);
+    for (unsigned long k=0;k<n_with_key;k++) {ordering[k]=key[k].second;}
+    unsigned long count=n_with_key;
+    for (unsigned long i=0;i<n_point;i++)
+     {
+      if (x[i].size()==0) {ordering[count++]=i;}
+     }
+   }
+
+  }//end of namespace LocalityReorderingHelpers
+
+
+#ifdef OOMPH_HAS_PTHREADS
+
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+  ////////////////////////////////////////////////////////////////////
+
+
+  //===============================================================
+  /// Helpers for splitting work between pthreads
+  //===============================================================
+  namespace ThreadingHelpers
+  {
+
+   //============================================================
+   /// \short The work for one thread: A chunk and the function
+   /// that processes it, and the message of any exception thrown
+   //============================================================
+   class ThreadTask
+   {
+
+     public:
+
+    /// Constructor: Everything is set up by the caller
+    ThreadTask() : Work_fct_pt(0), Chunk_pt(0) {}
+
+    /// The function that does the work
+    ChunkWorkFctPt Work_fct_pt;
+
+    /// The chunk
+    void* Chunk_pt;
+
+    /// Error message (empty if all went well)
+    std::string Error_message;
+
+   };
+
+
+   //============================================================
+   /// \short Entry point for the threads; the argument is a pointer
+   /// to a ThreadTask. Exceptions are caught and their message is 
+   /// stored in the task.
+   //============================================================
+   void* thread_entry(void* task_pt)
+   {
+    ThreadTask* t_pt=static_cast<ThreadTask*>(task_pt);
+    try
+     {
+      t_pt->Work_fct_pt(t_pt->Chunk_pt);
+     }
+    catch (std::exception& error)
+     {
+      t_pt->Error_message=error.what();
+     }
+    catch (...)
+     {
+      t_pt->Error_message="Unknown error";
+     }
+    return 0;
+   }
+
+
+   //============================================================
+   /// \short Call work_fct_pt(chunk_pt[t]) for all chunks 
+   /// concurrently, one thread per chunk. The first chunk is done
+   /// by the calling thread, as are any chunks whose thread can't
+   /// be started. Returns the collated messages of any exceptions
+   /// thrown (empty if there weren't any).
+   //============================================================
+   std::string do_work_in_threads_for_chunk_pointers(
+    ChunkWorkFctPt work_fct_pt, const Vector<void*>& chunk_pt)
+   {
+    unsigned n_thread=chunk_pt.size();
+    Vector<ThreadTask> task(n_thread);
+    for (unsigned t=0;t<n_thread;t++)
+     {
+      task[t].Work_fct_pt=work_fct_pt;
+      task[t].Chunk_pt=chunk_pt[t];
+     }
+    Vector<pthread_t> thread(n_thread);
+    std::vector<bool> thread_was_started(n_thread,false);
+    for (unsigned t=1;t<n_thread;t++)
+     {
+      thread_was_started[t]=
+       (pthread_create(&thread[t],0,&thread_entry,&task[t])==0);
+     }
+    if (n_thread>0)
+     {
+      thread_entry(&task[0]);
+     }
+
+    // Wait for the others (and do their work if they couldn't be started)
+    std::string error_message;
+    for (unsigned t=0;t<n_thread;t++)
+     {
+      if (thread_was_started[t])
+       {
+        pthread_join(thread[t],0);
+       }
+      else if (t>0)
+       {
+        thread_entry(&task[t]);
+       }
+      if (!task[t].Error_message.empty())
+       {
+        if (!error_message.empty()) error_message+="\n";
+        error_message+=task[t].Error_message;
+       }
+     }
+    return error_message;
+   }
+
+  }//end of namespace ThreadingHelpers
+
+#endif
+
+
   ////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////
   ////////////////////////////////////////////////////////////////////
@@ -926,6 +926,109 @@ namespace oomph
 
 
 
+////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////
+
+
+
+//=============================================================================
+/// Helper functions for reorderings that improve the locality of
+/// memory accesses: keys along space-filling curves and reverse
+/// Cuthill-McKee orderings.
+//=============================================================================
+ namespace LocalityReorderingHelpers
+ {
+
+  /// \short Key of the point with (scaled) coordinates s (in [0,1]^dim,
+  /// dim<=3) along the Morton (Z-order) space-filling curve
+  unsigned long long morton_key(const Vector<double>& s);
+
+  /// \short Key of the point with (scaled) coordinates s (in [0,1]^dim,
+  /// dim<=3) along the Hilbert space-filling curve
+  unsigned long long hilbert_key(const Vector<double>& s);
+
+  /// \short Reverse Cuthill-McKee ordering of n_vertex vertices that are
+  /// connected if they are members of the same group. The vertices in
+  /// group g are group_vertex[group_start[g]],...,
+  /// group_vertex[group_start[g+1]-1] (e.g. the groups are the elements
+  /// and the vertices their nodes or dofs). On return, ordering[k] is
+  /// the (old) index of the vertex that is k-th in the new ordering.
+  /// Working with the groups rather than the assembled graph keeps the
+  /// cost linear in the size of the groups.
+  void reverse_cuthill_mckee(const unsigned long& n_vertex,
+                             const Vector<unsigned long>& group_start,
+                             const Vector<unsigned long>& group_vertex,
+                             Vector<unsigned long>& ordering);
+
+  /// \short Order the points with coordinates x[i] (of any dimension 
+  /// <=3) along the Hilbert (if use_hilbert_curve is true) or the Morton 
+  /// space-filling curve through their bounding box. Points with an 
+  /// empty coordinate vector are placed at the end, in their original
+  /// order. On return, ordering[k] is the (old) index of the point 
+  /// that is k-th in the new ordering.
+  void space_filling_curve_ordering(const Vector<Vector<double> >& x,
+                                    const bool& use_hilbert_curve,
+                                    Vector<unsigned long>& ordering);
+
+ }//end of namespace LocalityReorderingHelpers
+
+
+
+#ifdef OOMPH_HAS_PTHREADS
+
+////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////
+
+
+
+//=============================================================================
+/// Helpers for splitting work between pthreads. The threaded code 
+/// (equation numbering, mesh adaptation, Z2 patch recovery, batched
+/// locate_zeta and asynchronous output) is only compiled if 
+/// OOMPH_HAS_PTHREADS is defined, which isn't done by default: Enable it
+/// by configuring with CPPFLAGS="-DOOMPH_HAS_PTHREADS" LIBS="-lpthread"
+/// (or by adding these to the compiler/linker flags used for the library
+/// and the driver codes). The number of threads is then set with
+/// the nthread() functions of the relevant objects.
+//=============================================================================
+ namespace ThreadingHelpers
+ {
+
+  /// \short Function that does the work for one chunk, passed in 
+  /// as a void pointer. It may throw.
+  typedef void (*ChunkWorkFctPt)(void* chunk_pt);
+
+  /// \short Call work_fct_pt(chunk_pt[t]) for all chunks concurrently,
+  /// one thread per chunk. The first chunk is done by the calling thread,
+  /// as are any chunks whose thread can't be started. Returns the 
+  /// collated messages of any exceptions thrown (empty if there 
+  /// weren't any).
+  std::string do_work_in_threads_for_chunk_pointers(
+   ChunkWorkFctPt work_fct_pt, const Vector<void*>& chunk_pt);
+
+  /// \short Call work_fct_pt(&chunk[t]) for all chunks concurrently
+  /// (see do_work_in_threads_for_chunk_pointers(...))
+  template<class CHUNK>
+  std::string do_work_in_threads(ChunkWorkFctPt work_fct_pt,
+                                 Vector<CHUNK>& chunk)
+  {
+   unsigned n_chunk=chunk.size();
+   Vector<void*> chunk_pt(n_chunk);
+   for (unsigned t=0;t<n_chunk;t++)
+    {
+     chunk_pt[t]=&chunk[t];
+    }
+   return do_work_in_threads_for_chunk_pointers(work_fct_pt,chunk_pt);
+  }
+
+ }//end of namespace ThreadingHelpers
+
+#endif
+
+
+
 
 
 ////////////////////////////////////////////////////////////////////
@@ -0,0 +1,364 @@
+//LIC// ====================================================================
+//LIC// This file forms part of oomph-lib, the object-oriented, 
+//LIC// multi-physics finite-element library, available 
+//LIC// at http://www.oomph-lib.org.
+//LIC// 
+//LIC// Copyright (C) 2006-2021 Matthias Heil and Andrew Hazel
+//LIC// 
+//LIC// This library is free software; you can redistribute it and/or
+//LIC// modify it under the terms of the GNU Lesser General Public
+//LIC// License as published by the Free Software Foundation; either
+//LIC// version 2.1 of the License, or (at your option) any later version.
+//LIC// 
+//LIC// This library is distributed in the hope that it will be useful,
+//LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//LIC// Lesser General Public License for more details.
+//LIC// 
+//LIC// You should have received a copy of the GNU Lesser General Public
+//LIC// License along with this library; if not, write to the Free Software
+//LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//LIC// 02110-1301  USA.
+//LIC// 
+//LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+//LIC// 
+//LIC//====================================================================
+#include "parareal.h"
+
+
+namespace oomph
+{
+
+
+//=============================================================================
+/// \short Constructor: Pass pointer to the Problem used for the fine
+/// propagation and (optionally) to the Problem used for the coarse
+/// propagation (defaults to the fine Problem).
+//=============================================================================
+PararealDriver::PararealDriver(Problem* fine_problem_pt, 
+                               Problem* coarse_problem_pt) :
+ Fine_problem_pt(fine_problem_pt), Coarse_problem_pt(coarse_problem_pt),
+ Fine_problem_original_communicator_pt(0),
+ Coarse_problem_original_communicator_pt(0),
+ Tolerance(1.0e-8), Niter(0), Doc_convergence(false)
+{
+ // Use the fine problem for the coarse propagation too?
+ if (Coarse_problem_pt==0) {Coarse_problem_pt=Fine_problem_pt;}
+
+ // The time slices are distributed over the processors in the 
+ // communicator of the fine problem
+ Communicator_pt=new OomphCommunicator(Fine_problem_pt->communicator_pt());
+
+ // Default: One time slice per processor; Parareal is exact after 
+ // nslice iterations
+ Nslice=Communicator_pt->nproc();
+ Max_iter=Nslice;
+
+ // Decouple the spatial solves on the different processors
+ Fine_problem_original_communicator_pt=
+  make_problem_serial(Fine_problem_pt);
+ if (Coarse_problem_pt!=Fine_problem_pt)
+  {
+   Coarse_problem_original_communicator_pt=
+    make_problem_serial(Coarse_problem_pt);
+  }
+
+#ifdef PARANOID
+ if (Coarse_problem_pt->ndof()!=Fine_problem_pt->ndof())
+  {
+   std::ostringstream error_stream;
+   error_stream << "Number of dofs in coarse problem ("
+                << Coarse_problem_pt->ndof() 
+                << ") does not match number of dofs in fine problem ("
+                << Fine_problem_pt->ndof() << ")\n";
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+}
+
+
+//=============================================================================
+/// \short Destructor: Restore the Problems' original communicators
+/// (re-assigning their equation numbers) and delete the time-parallel
+/// communicator
+//=============================================================================
+PararealDriver::~PararealDriver()
+{
+ restore_problem_communicator(Fine_problem_pt,
+                              Fine_problem_original_communicator_pt);
+ if (Coarse_problem_pt!=Fine_problem_pt)
+  {
+   restore_problem_communicator(Coarse_problem_pt,
+                                Coarse_problem_original_communicator_pt);
+  }
+ delete Communicator_pt;
+}
+
+
+//=============================================================================
+/// \short Make the problem's solves independent on each processor
+/// by giving it a serial communicator (and re-assigning the equation 
+/// numbers so the dof distribution refers to the new communicator).
+/// Returns the problem's original communicator, or null if it was 
+/// left unchanged.
+//=============================================================================
+OomphCommunicator* PararealDriver::make_problem_serial(
+ Problem* const& problem_pt)
+{
+#ifdef OOMPH_HAS_MPI
+ if (problem_pt->communicator_pt()->nproc()>1)
+  {
+   if (problem_pt->problem_has_been_distributed())
+    {
+     throw OomphLibError(
+      "The PararealDriver requires a Problem that has not been distributed",
+      OOMPH_CURRENT_FUNCTION,
+      OOMPH_EXCEPTION_LOCATION);
+    }
+
+   OomphCommunicator* original_pt=problem_pt->Communicator_pt;
+   problem_pt->Communicator_pt=new OomphCommunicator(MPI_COMM_SELF);
+   problem_pt->assign_eqn_numbers();
+   return original_pt;
+  }
+#endif
+ return 0;
+}
+
+
+//=============================================================================
+/// \short Restore the problem's original communicator (as returned by
+/// make_problem_serial(...)) and re-assign its equation numbers. 
+/// Nothing is done if original_pt is null.
+//=============================================================================
+void PararealDriver::restore_problem_communicator(
+ Problem* const& problem_pt, OomphCommunicator* const& original_pt)
+{
+ if (original_pt!=0)
+  {
+   delete problem_pt->Communicator_pt;
+   problem_pt->Communicator_pt=original_pt;
+   problem_pt->assign_eqn_numbers();
+  }
+}
+
+
+//=============================================================================
+/// \short Propagate the solution u from t_start to t_end using 
+/// (impulsively started) timesteps of size (at most) dt with
+/// the specified problem. Overwrites u with the solution at t_end.
+//=============================================================================
+void PararealDriver::propagate(Problem* const& problem_pt, 
+                               const double& t_start, const double& t_end,
+                               const double& dt, DoubleVector& u)
+{
+ // Adjust the timestep so that it subdivides the interval exactly
+ unsigned nstep=unsigned(std::ceil((t_end-t_start)/dt-1.0e-8));
+ if (nstep==0) {nstep=1;}
+ double dt_actual=(t_end-t_start)/double(nstep);
+
+ // Impulsive start from u at t_start
+ problem_pt->time_pt()->time()=t_start;
+ problem_pt->set_dofs(u);
+ problem_pt->assign_initial_values_impulsive(dt_actual);
+
+ // Timestep
+ for (unsigned i=0;i<nstep;i++)
+  {
+   problem_pt->unsteady_newton_solve(dt_actual);
+  }
+
+ problem_pt->get_dofs(u);
+}
+
+
+//=============================================================================
+/// \short Gather the fine solutions of all slices onto all processors
+//=============================================================================
+void PararealDriver::gather_fine_solutions(Vector<DoubleVector>& 
+                                           fine_solution)
+{
+#ifdef OOMPH_HAS_MPI
+ unsigned nproc=Communicator_pt->nproc();
+ if (nproc==1) {return;}
+
+ unsigned my_rank=Communicator_pt->my_rank();
+ unsigned n_dof=Fine_problem_pt->ndof();
+
+ // Number of values sent by each processor and offsets
+ Vector<int> count(nproc);
+ Vector<int> displacement(nproc);
+ for (unsigned p=0;p<nproc;p++)
+  {
+   count[p]=(first_slice(p+1)-first_slice(p))*n_dof;
+   displacement[p]=first_slice(p)*n_dof;
+  }
+
+ // Pack my slices
+ unsigned first=first_slice(my_rank);
+ unsigned last=first_slice(my_rank+1);
+ Vector<double> send_data(count[my_rank]);
+ for (unsigned n=first;n<last;n++)
+  {
+   const double* values_pt=fine_solution[n].values_pt();
+   for (unsigned i=0;i<n_dof;i++)
+    {
+     send_data[(n-first)*n_dof+i]=values_pt[i];
+    }
+  }
+
+ // Gather
+ Vector<double> receive_data(Nslice*n_dof);
+ MPI_Allgatherv(send_data.empty() ? 0 : &send_data[0],
+                count[my_rank],MPI_DOUBLE,
+                &receive_data[0],&count[0],&displacement[0],MPI_DOUBLE,
+                Communicator_pt->mpi_comm());
+
+ // Unpack
+ for (unsigned n=0;n<Nslice;n++)
+  {
+   if ((n<first)||(n>=last))
+    {
+     if (!fine_solution[n].built())
+      {
+       fine_solution[n].build(Slice_solution[0].distribution_pt(),0.0);
+      }
+     double* values_pt=fine_solution[n].values_pt();
+     for (unsigned i=0;i<n_dof;i++)
+      {
+       values_pt[i]=receive_data[n*n_dof+i];
+      }
+    }
+  }
+#endif
+}
+
+
+//=============================================================================
+/// \short Integrate the fine problem from its current time and 
+/// dofs to t_end, using the fine timestep dt_fine and the coarse 
+/// timestep dt_coarse. On return the fine problem holds the solution
+/// at t_end (with impulsive history values).
+//=============================================================================
+void PararealDriver::solve(const double& t_end, const double& dt_fine, 
+                           const double& dt_coarse)
+{
+ double t_start=Fine_problem_pt->time_pt()->time();
+
+#ifdef PARANOID
+ if (Nslice==0)
+  {
+   throw OomphLibError("Number of time slices must be positive",
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ if (t_end<=t_start)
+  {
+   std::ostringstream error_stream;
+   error_stream << "End time " << t_end 
+                << " must be larger than the current time " 
+                << t_start << std::endl;
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ double dt_slice=(t_end-t_start)/double(Nslice);
+ unsigned n_dof=Fine_problem_pt->ndof();
+
+ // Initial condition
+ Slice_solution.resize(Nslice+1);
+ Fine_problem_pt->get_dofs(Slice_solution[0]);
+
+ // Storage for the coarse and fine propagations of the slice solutions
+ // from the previous iteration
+ Vector<DoubleVector> coarse_solution(Nslice);
+ Vector<DoubleVector> fine_solution(Nslice);
+
+ // Initial coarse sweep
+ for (unsigned n=0;n<Nslice;n++)
+  {
+   coarse_solution[n]=Slice_solution[n];
+   propagate(Coarse_problem_pt,t_start+double(n)*dt_slice,
+             t_start+double(n+1)*dt_slice,dt_coarse,coarse_solution[n]);
+   Slice_solution[n+1]=coarse_solution[n];
+  }
+
+ // Slices handled by this processor
+ unsigned my_rank=Communicator_pt->my_rank();
+ unsigned first=first_slice(my_rank);
+ unsigned last=first_slice(my_rank+1);
+
+ // Parareal iteration (exact after Nslice iterations so there's no
+ // point in doing more)
+ Niter=0;
+ unsigned max_iter=std::min(Max_iter,Nslice);
+ for (unsigned k=0;k<max_iter;k++)
+  {
+   // Fine propagation of my slices (the solutions at the start 
+   // of the slices before the k-th one have converged)
+   for (unsigned n=std::max(first,k);n<last;n++)
+    {
+     fine_solution[n]=Slice_solution[n];
+     propagate(Fine_problem_pt,t_start+double(n)*dt_slice,
+               t_start+double(n+1)*dt_slice,dt_fine,fine_solution[n]);
+    }
+
+   // Share them
+   gather_fine_solutions(fine_solution);
+
+   // Sequential coarse correction sweep
+   double max_change=0.0;
+   DoubleVector new_solution;
+   for (unsigned n=k;n<Nslice;n++)
+    {
+     new_solution=fine_solution[n];
+
+     // The solution at the start of the k-th slice is exact so the 
+     // fine solution at its end doesn't need a correction
+     if (n>k)
+      {
+       DoubleVector coarse(Slice_solution[n]);
+       propagate(Coarse_problem_pt,t_start+double(n)*dt_slice,
+                 t_start+double(n+1)*dt_slice,dt_coarse,coarse);
+
+       double* new_pt=new_solution.values_pt();
+       const double* coarse_pt=coarse.values_pt();
+       const double* old_coarse_pt=coarse_solution[n].values_pt();
+       for (unsigned i=0;i<n_dof;i++)
+        {
+         new_pt[i]+=coarse_pt[i]-old_coarse_pt[i];
+        }
+       coarse_solution[n]=coarse;
+      }
+
+     const double* new_pt=new_solution.values_pt();
+     const double* old_pt=Slice_solution[n+1].values_pt();
+     for (unsigned i=0;i<n_dof;i++)
+      {
+       max_change=std::max(max_change,std::fabs(new_pt[i]-old_pt[i]));
+      }
+     Slice_solution[n+1]=new_solution;
+    }
+
+   Niter=k+1;
+   if (Doc_convergence)
+    {
+     oomph_info << "Parareal iteration " << Niter 
+                << ": max. change in slice solutions " 
+                << max_change << std::endl;
+    }
+
+   if (max_change<Tolerance) {break;}
+  }
+
+ // Leave the fine problem at the end time
+ Fine_problem_pt->time_pt()->time()=t_end;
+ Fine_problem_pt->set_dofs(Slice_solution[Nslice]);
+ Fine_problem_pt->assign_initial_values_impulsive(dt_fine);
+}
+
+}
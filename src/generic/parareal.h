@@ -0,0 +1,238 @@
+//LIC// ====================================================================
+//LIC// This file forms part of oomph-lib, the object-oriented, 
+//LIC// multi-physics finite-element library, available 
+//LIC// at http://www.oomph-lib.org.
+//LIC// 
+//LIC// Copyright (C) 2006-2021 Matthias Heil and Andrew Hazel
+//LIC// 
+//LIC// This library is free software; you can redistribute it and/or
+//LIC// modify it under the terms of the GNU Lesser General Public
+//LIC// License as published by the Free Software Foundation; either
+//LIC// version 2.1 of the License, or (at your option) any later version.
+//LIC// 
+//LIC// This library is distributed in the hope that it will be useful,
+//LIC// but WITHOUT ANY WARRANTY; without even the implied warranty of
+//LIC// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//LIC// Lesser General Public License for more details.
+//LIC// 
+//LIC// You should have received a copy of the GNU Lesser General Public
+//LIC// License along with this library; if not, write to the Free Software
+//LIC// Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+//LIC// 02110-1301  USA.
+//LIC// 
+//LIC// The authors may be contacted at oomph-lib@maths.man.ac.uk.
+//LIC// 
+//LIC//====================================================================
+//Include guards
+#ifndef OOMPH_PARAREAL_HEADER
+#define OOMPH_PARAREAL_HEADER
+
+
+// Config header generated by autoconfig
+#ifdef HAVE_CONFIG_H
+  #include <oomph-lib-config.h>
+#endif
+
+#include "Vector.h"
+#include "double_vector.h"
+#include "communicator.h"
+#include "problem.h"
+
+
+namespace oomph
+{
+
+
+//=============================================================================
+/// \short Parareal driver for the parallel-in-time integration of an
+/// unsteady (non-distributed) Problem from its current time to a 
+/// specified end time. The time interval is split into a number of
+/// time slices (by default one per processor). Parareal iterates on
+/// the solutions U_n at the start of the slices:
+/// \f[ U_{n+1}^{k+1} = G(U_n^{k+1}) + F(U_n^k) - G(U_n^k) \f]
+/// where the fine propagator F and the coarse propagator G perform
+/// Problem::unsteady_newton_solve(...) across a slice with the fine and
+/// coarse timesteps, respectively. The fine propagations of the 
+/// different slices are independent and are performed concurrently
+/// on the processors; the (cheap) sequential coarse sweep is performed
+/// redundantly on every processor so the only communication required
+/// is a single gather of the fine solutions per iteration. 
+///
+/// The coarse propagator can use a separate Problem (e.g. the same 
+/// discretisation with a BDF<1> timestepper) as long as its degrees 
+/// of freedom are numbered identically to those of the fine Problem.
+/// If no coarse problem is specified the fine Problem is used with 
+/// the coarse timestep.
+///
+/// The state carried between the slices is the vector of (current)
+/// dofs; each propagation starts impulsively, i.e. the history values
+/// are set to the current values at the start of the slice. Nodal
+/// positions that are not dofs (e.g. in algebraic node updates) must
+/// be updated in the problem's actions_before_implicit_timestep(). 
+///
+/// In an MPI build each processor must store the entire Problem (i.e.
+/// the Problem must not have been distributed); the constructor 
+/// replaces the Problems' communicators by MPI_COMM_SELF so that their
+/// Newton/linear solves are performed independently on each 
+/// processor, and re-assigns the equation numbers. The original
+/// communicators are restored (and the equation numbers re-assigned
+/// again) when the driver is destroyed.
+//=============================================================================
+class PararealDriver
+{
+
+ public:
+
+ /// \short Constructor: Pass pointer to the Problem used for the fine
+ /// propagation and (optionally) to the Problem used for the coarse
+ /// propagation (defaults to the fine Problem).
+ PararealDriver(Problem* fine_problem_pt, Problem* coarse_problem_pt=0);
+
+ /// \short Destructor: Restore the Problems' original communicators
+ /// and delete the time-parallel communicator
+ ~PararealDriver();
+
+ /// Broken copy constructor
+ PararealDriver(const PararealDriver&)
+  {
+   BrokenCopy::broken_copy("PararealDriver");
+  }
+
+ /// Broken assignment operator
+ void operator=(const PararealDriver&)
+  {
+   BrokenCopy::broken_assign("PararealDriver");
+  }
+
+ /// \short Integrate the fine problem from its current time and 
+ /// dofs to t_end, using the fine timestep dt_fine and the coarse 
+ /// timestep dt_coarse (both are adjusted downwards so that they 
+ /// subdivide the slices exactly). On return the fine problem holds 
+ /// the solution at t_end (with impulsive history values).
+ void solve(const double& t_end, const double& dt_fine, 
+            const double& dt_coarse);
+
+ /// \short Number of time slices (defaults to the number of processors 
+ /// in the time-parallel communicator)
+ unsigned nslice() const {return Nslice;}
+
+ /// \short Set the number of time slices. This also resets the maximum
+ /// number of Parareal iterations to the new number of slices, so
+ /// call max_iter() afterwards to use a different limit.
+ void set_nslice(const unsigned& nslice)
+  {
+   Nslice=nslice;
+   Max_iter=nslice;
+  }
+
+ /// \short Access function for the tolerance on the max. change of 
+ /// the slice solutions between two Parareal iterations (default 1e-8)
+ double& tolerance() {return Tolerance;}
+
+ /// \short Access function for the maximum number of Parareal
+ /// iterations (the iteration is exact after nslice iterations, which is
+ /// the default)
+ unsigned& max_iter() {return Max_iter;}
+
+ /// Number of Parareal iterations taken during the most recent solve
+ unsigned niter() const {return Niter;}
+
+ /// Enable documentation of the convergence of the Parareal iteration
+ void enable_doc_convergence() {Doc_convergence=true;}
+
+ /// Disable documentation of the convergence of the Parareal iteration
+ void disable_doc_convergence() {Doc_convergence=false;}
+
+ /// \short Solution at the start of slice i (i=0,...,nslice; the last
+ /// entry is the solution at the end time) after the most recent solve
+ const DoubleVector& slice_solution(const unsigned& i) const
+  {
+#ifdef RANGE_CHECKING
+   if(i>=Slice_solution.size())
+    {
+     std::ostringstream error_message;
+     error_message << "Range Error: Slice " << i 
+                   << " is not in the range (0,"
+                   << Slice_solution.size()-1 << ")";
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+   return Slice_solution[i];
+  }
+
+ /// Access function to the time-parallel communicator
+ const OomphCommunicator* communicator_pt() const {return Communicator_pt;}
+
+ protected:
+
+ /// \short Propagate the solution u from t_start to t_end using 
+ /// (impulsively started) timesteps of size (at most) dt with
+ /// the specified problem. Overwrites u with the solution at t_end.
+ /// Can be overloaded, e.g. to use adaptive timestepping.
+ virtual void propagate(Problem* const& problem_pt, 
+                        const double& t_start, const double& t_end,
+                        const double& dt, DoubleVector& u);
+
+ private:
+
+ /// \short Gather the fine solutions of all slices onto all processors
+ void gather_fine_solutions(Vector<DoubleVector>& fine_solution);
+
+ /// \short Make the problem's solves independent on each processor
+ /// by giving it a serial communicator. Returns the problem's original
+ /// communicator, or null if it was left unchanged.
+ OomphCommunicator* make_problem_serial(Problem* const& problem_pt);
+
+ /// \short Restore the problem's original communicator (as returned by
+ /// make_problem_serial(...); nothing is done if it's null)
+ void restore_problem_communicator(Problem* const& problem_pt,
+                                   OomphCommunicator* const& original_pt);
+
+ /// First slice handled by processor p
+ unsigned first_slice(const unsigned& p) const
+  {
+   return (p*Nslice)/Communicator_pt->nproc();
+  }
+
+ /// Pointer to the problem used for the fine propagation
+ Problem* Fine_problem_pt;
+
+ /// Pointer to the problem used for the coarse propagation
+ Problem* Coarse_problem_pt;
+
+ /// The communicator across which the time slices are distributed
+ OomphCommunicator* Communicator_pt;
+
+ /// \short The fine problem's original communicator (null if it
+ /// wasn't replaced)
+ OomphCommunicator* Fine_problem_original_communicator_pt;
+
+ /// \short The coarse problem's original communicator (null if it
+ /// wasn't replaced)
+ OomphCommunicator* Coarse_problem_original_communicator_pt;
+
+ /// Number of time slices
+ unsigned Nslice;
+
+ /// Convergence tolerance
+ double Tolerance;
+
+ /// Maximum number of Parareal iterations
+ unsigned Max_iter;
+
+ /// Number of Parareal iterations taken during the most recent solve
+ unsigned Niter;
+
+ /// Document convergence?
+ bool Doc_convergence;
+
+ /// Solutions at the start of the slices (and at the end time)
+ Vector<DoubleVector> Slice_solution;
+
+};
+
+}
+
+#endif
@@ -57,7 +57,335 @@ namespace METIS
  /// \short Function pointer to to function that translates spatial
  /// error into weight for METIS partitioning.
  ErrorToWeightFctPt Error_to_weight_fct_pt=&default_error_to_weight_fct;
- 
+
+ /// \short Default prediction for the preconditioner cost of an
+ /// element: the square of its number of dofs, i.e. the number of entries
+ /// it contributes to the Jacobian.
+ double default_preconditioner_cost_fct(GeneralisedElement* const& el_pt)
+ {
+  double n_dof=double(el_pt->ndof());
+  return n_dof*n_dof;
+ }
+
+ /// \short Function pointer to function that predicts the preconditioner
+ /// cost of an element
+ ElementCostFctPt Preconditioner_cost_fct_pt=&default_preconditioner_cost_fct;
+
+ /// Balance the measured elemental assembly times?
+ bool Balance_assembly_time=false;
+
+ /// Balance the number of dofs of the elements?
+ bool Balance_ndof=false;
+
+ /// Balance the predicted preconditioner cost of the elements?
+ bool Balance_preconditioner_cost=false;
+
+ /// Permitted load imbalance for each constraint
+ double Multi_constraint_imbalance_tolerance=1.05;
+
+ /// Use recursive coordinate bisection rather than METIS?
+ bool Use_recursive_coordinate_bisection=false;
+
+ /// \short Helper to sort elements by the coordinate of their centroid
+ /// in a given direction
+ class CentroidComparison
+ {
+ public:
+
+  /// Constructor: Pass centroids and direction
+  CentroidComparison(const Vector<Vector<double> >& centroid,
+                     const unsigned& direction) :
+   Centroid(centroid), Direction(direction) {}
+
+  /// Comparison of elements e1 and e2 (ties broken by element number)
+  bool operator()(const unsigned& e1, const unsigned& e2) const
+  {
+   if (Centroid[e1][Direction]!=Centroid[e2][Direction])
+    {
+     return Centroid[e1][Direction]<Centroid[e2][Direction];
+    }
+   return e1<e2;
+  }
+
+ private:
+
+  /// The centroids of the elements
+  const Vector<Vector<double> >& Centroid;
+
+  /// The direction in which the elements are compared
+  unsigned Direction;
+ };
+
+ /// \short Recursive coordinate bisection of the elements listed in
+ /// element over the domains first_domain,...,first_domain+ndomain-1
+ void recursive_coordinate_bisection_helper(
+  const Vector<Vector<double> >& centroid,
+  const Vector<double>& element_weight,
+  Vector<unsigned>& element,
+  const unsigned& first_domain,
+  const unsigned& ndomain,
+  Vector<unsigned>& element_domain)
+ {
+  const unsigned n_element=element.size();
+
+  // Done?
+  if ((ndomain==1)||(n_element==0))
+   {
+    for (unsigned i=0;i<n_element;i++)
+     {
+      element_domain[element[i]]=first_domain;
+     }
+    return;
+   }
+
+  // Split along the longest extent of the bounding box
+  const unsigned dim=centroid[element[0]].size();
+  unsigned direction=0;
+  double max_extent=-1.0;
+  for (unsigned i=0;i<dim;i++)
+   {
+    double x_min=DBL_MAX;
+    double x_max=-DBL_MAX;
+    for (unsigned j=0;j<n_element;j++)
+     {
+      double x=centroid[element[j]][i];
+      if (x<x_min) {x_min=x;}
+      if (x>x_max) {x_max=x;}
+     }
+    if (x_max-x_min>max_extent)
+     {
+      max_extent=x_max-x_min;
+      direction=i;
+     }
+   }
+  std::sort(element.begin(),element.end(),
+            CentroidComparison(centroid,direction));
+
+  // Split the weight in proportion to the number of domains on each side
+  const unsigned ndomain_left=ndomain/2;
+  const unsigned ndomain_right=ndomain-ndomain_left;
+  double total_weight=0.0;
+  for (unsigned j=0;j<n_element;j++)
+   {
+    total_weight+=element_weight[element[j]];
+   }
+  const double target_weight=
+   total_weight*double(ndomain_left)/double(ndomain);
+  unsigned n_left=0;
+  double left_weight=0.0;
+  while ((n_left<n_element)&&
+         (left_weight+0.5*element_weight[element[n_left]]<target_weight))
+   {
+    left_weight+=element_weight[element[n_left]];
+    n_left++;
+   }
+
+  // Leave at least one element for each domain (if possible)
+  if (n_element>=ndomain)
+   {
+    n_left=std::max(n_left,ndomain_left);
+    n_left=std::min(n_left,n_element-ndomain_right);
+   }
+
+  // Recurse
+  Vector<unsigned> left_element(n_left);
+  for (unsigned j=0;j<n_left;j++)
+   {
+    left_element[j]=element[j];
+   }
+  Vector<unsigned> right_element(n_element-n_left);
+  for (unsigned j=n_left;j<n_element;j++)
+   {
+    right_element[j-n_left]=element[j];
+   }
+  recursive_coordinate_bisection_helper(centroid,element_weight,
+                                        left_element,first_domain,
+                                        ndomain_left,element_domain);
+  recursive_coordinate_bisection_helper(centroid,element_weight,
+                                        right_element,
+                                        first_domain+ndomain_left,
+                                        ndomain_right,element_domain);
+ }
+
+ /// \short Convert the element costs into the positive integer weights
+ /// required by METIS (scaled to the range [1,1000])
+ void convert_element_cost_to_metis_weight(const Vector<double>& cost,
+                                           Vector<int>& weight)
+ {
+  const unsigned n=cost.size();
+  double max_cost=0.0;
+  for (unsigned e=0;e<n;e++)
+   {
+    max_cost=std::max(max_cost,cost[e]);
+   }
+  weight.resize(n);
+  for (unsigned e=0;e<n;e++)
+   {
+    weight[e]=1;
+    if (max_cost>0.0)
+     {
+      weight[e]+=int(999.0*std::max(cost[e],0.0)/max_cost+0.5);
+     }
+   }
+ }
+
+}
+
+
+
+
+//==================================================================
+/// Get the element costs that are to be balanced by
+/// partition_mesh(...), according to the flags Balance_assembly_time,
+/// Balance_ndof and Balance_preconditioner_cost: on return,
+/// element_cost[c][e] contains the cost of element e (in the Problem's
+/// mesh) for the c-th enabled constraint. The assembly times are
+/// only used if they are available for all elements.
+//==================================================================
+void METIS::get_element_costs(Problem* problem_pt,
+                              Vector<Vector<double> >& element_cost)
+{
+ element_cost.clear();
+
+ // Global mesh
+ Mesh* mesh_pt=problem_pt->mesh_pt();
+
+ // Number of elements
+ unsigned nelem=mesh_pt->nelement();
+
+ // Measured assembly times
+ if (Balance_assembly_time)
+  {
+#ifdef OOMPH_HAS_MPI
+   Vector<double> elemental_assembly_time=
+    problem_pt->elemental_assembly_time();
+   double total_time=0.0;
+   unsigned n=elemental_assembly_time.size();
+   for (unsigned e=0;e<n;e++)
+    {
+     total_time+=elemental_assembly_time[e];
+    }
+   if ((n==nelem)&&(total_time>0.0))
+    {
+     element_cost.push_back(elemental_assembly_time);
+    }
+   else
+#endif
+    {
+     oomph_info << "No elemental assembly times available; "
+                << "not balancing them in the partitioning\n";
+    }
+  }
+
+ // Number of dofs
+ if (Balance_ndof)
+  {
+   Vector<double> ndof(nelem);
+   for (unsigned e=0;e<nelem;e++)
+    {
+     ndof[e]=double(mesh_pt->element_pt(e)->ndof());
+    }
+   element_cost.push_back(ndof);
+  }
+
+ // Predicted preconditioner cost
+ if (Balance_preconditioner_cost)
+  {
+   Vector<double> cost(nelem);
+   for (unsigned e=0;e<nelem;e++)
+    {
+     cost[e]=Preconditioner_cost_fct_pt(mesh_pt->element_pt(e));
+    }
+   element_cost.push_back(cost);
+  }
+}
+
+
+
+
+//==================================================================
+/// Partition mesh by recursive coordinate bisection: the elements
+/// (represented by the centroids of their nodes) are recursively split
+/// along the longest extent of their bounding box, such that the total
+/// element_weight in each half is proportional to the number of domains
+/// assigned to it. If element_weight is empty, all elements have the
+/// same weight.
+//==================================================================
+void METIS::recursive_coordinate_bisection(
+ Mesh* mesh_pt, const unsigned& ndomain,
+ const Vector<double>& element_weight,
+ Vector<unsigned>& element_domain)
+{
+ // Number of elements
+ unsigned nelem=mesh_pt->nelement();
+
+#ifdef PARANOID
+ if (nelem!=element_domain.size())
+  {
+   std::ostringstream error_stream;
+   error_stream << "element_domain Vector has wrong length "
+                << nelem << " " << element_domain.size() << std::endl;
+
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ if ((element_weight.size()!=0)&&(element_weight.size()!=nelem))
+  {
+   std::ostringstream error_stream;
+   error_stream << "element_weight Vector has wrong length "
+                << nelem << " " << element_weight.size() << std::endl;
+
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+#endif
+
+ // Centroids of the elements (elements without nodes sit at the origin)
+ unsigned dim=1;
+ for (unsigned e=0;e<nelem;e++)
+  {
+   FiniteElement* el_pt=dynamic_cast<FiniteElement*>(mesh_pt->element_pt(e));
+   if ((el_pt!=0)&&(el_pt->nnode()!=0))
+    {
+     dim=std::max(dim,el_pt->node_pt(0)->ndim());
+    }
+  }
+ Vector<Vector<double> > centroid(nelem,Vector<double>(dim,0.0));
+ for (unsigned e=0;e<nelem;e++)
+  {
+   FiniteElement* el_pt=dynamic_cast<FiniteElement*>(mesh_pt->element_pt(e));
+   if (el_pt!=0)
+    {
+     unsigned n_node=el_pt->nnode();
+     for (unsigned j=0;j<n_node;j++)
+      {
+       Node* nod_pt=el_pt->node_pt(j);
+       unsigned n_dim=std::min(nod_pt->ndim(),dim);
+       for (unsigned i=0;i<n_dim;i++)
+        {
+         centroid[e][i]+=nod_pt->x(i)/double(n_node);
+        }
+      }
+    }
+  }
+
+ // Unit weights by default
+ Vector<double> weight(element_weight);
+ if (weight.size()==0)
+  {
+   weight.resize(nelem,1.0);
+  }
+
+ // Bisect recursively
+ Vector<unsigned> element(nelem);
+ for (unsigned e=0;e<nelem;e++)
+  {
+   element[e]=e;
+  }
+ recursive_coordinate_bisection_helper(centroid,weight,element,0,ndomain,
+                                       element_domain);
 }
 
 
@@ -404,19 +732,117 @@ void METIS::partition_mesh(Problem* problem_pt, const unsigned& ndomain,
     }
   }
 
+ // Collect the constraints to be balanced: the error-biased weights
+ // (if any) followed by the element costs selected via the flags
+ Vector<Vector<int> > constraint_weight;
+ if (vwgt!=0)
+  {
+   Vector<int> weight(nelem);
+   for (unsigned e=0;e<nelem;e++)
+    {
+     weight[e]=vwgt[e];
+    }
+   constraint_weight.push_back(weight);
+  }
+ Vector<Vector<double> > element_cost;
+ get_element_costs(problem_pt,element_cost);
+ unsigned n_cost=element_cost.size();
+ for (unsigned c=0;c<n_cost;c++)
+  {
+   Vector<int> weight;
+   convert_element_cost_to_metis_weight(element_cost[c],weight);
+   constraint_weight.push_back(weight);
+  }
+ int ncon=constraint_weight.size();
+
  // Call partitioner
- if (objective==0)
+ if (Use_recursive_coordinate_bisection)
   {
-   // Partition with the objective of minimising the edge cut
-   METIS_PartGraphKway(&nvertex, xadj, &adjacency_vector[0], vwgt, adjwgt, 
-                       &wgtflag, &numflag, &nparts, options, edgecut, part);
+   oomph_info << "Partitioning by recursive coordinate bisection\n";
+
+   // Combine the constraints into a single weight, normalising each
+   // by its total so that they contribute equally
+   Vector<double> combined_weight;
+   if (ncon>0)
+    {
+     combined_weight.resize(nelem,0.0);
+     for (int c=0;c<ncon;c++)
+      {
+       double total=0.0;
+       for (unsigned e=0;e<nelem;e++)
+        {
+         total+=double(constraint_weight[c][e]);
+        }
+       for (unsigned e=0;e<nelem;e++)
+        {
+         combined_weight[e]+=double(constraint_weight[c][e])/total;
+        }
+      }
+    }
+   Vector<unsigned> rcb_domain(nelem);
+   recursive_coordinate_bisection(mesh_pt,ndomain,combined_weight,
+                                  rcb_domain);
+   for (unsigned e=0;e<nelem;e++)
+    {
+     part[e]=rcb_domain[e];
+    }
+  }
+ else if ((ncon>1)&&((objective==0)||(objective==1)))
+  {
+   oomph_info << "Balancing " << ncon 
+              << " constraints in METIS partitioning\n";
+   if (objective==1)
+    {
+     oomph_info << "Note: Multi-constraint partitioning minimises "
+                << "the edge cut rather than the communication volume\n";
+    }
+
+   // Interleave the weights: vwgt[e*ncon+c] is the weight of element e
+   // for constraint c
+   delete [] vwgt;
+   wgtflag=2;
+   vwgt=new int[nelem*ncon];
+   for (unsigned e=0;e<nelem;e++)
+    {
+     for (int c=0;c<ncon;c++)
+      {
+       vwgt[e*ncon+c]=constraint_weight[c][e];
+      }
+    }
+
+   // Same tolerance for all constraints
+   Vector<float> ubvec(ncon,float(Multi_constraint_imbalance_tolerance));
+
+   METIS_mCPartGraphKway(&nvertex, &ncon, xadj, &adjacency_vector[0], 
+                         vwgt, adjwgt, &wgtflag, &numflag, &nparts,
+                         &ubvec[0], options, edgecut, part);
   }
- else if (objective==1)
+ else if ((objective==0)||(objective==1))
   {
-   // Partition with the objective of minimising the total communication 
-   // volume  
-   METIS_PartGraphVKway(&nvertex, xadj, &adjacency_vector[0], vwgt, adjwgt, 
-                        &wgtflag, &numflag, &nparts, options, edgecut, part);
+   // Single weight from the element costs?
+   if ((ncon==1)&&(vwgt==0))
+    {
+     wgtflag=2;
+     vwgt=new int[nelem];
+     for (unsigned e=0;e<nelem;e++)
+      {
+       vwgt[e]=constraint_weight[0][e];
+      }
+    }
+
+   if (objective==0)
+    {
+     // Partition with the objective of minimising the edge cut
+     METIS_PartGraphKway(&nvertex, xadj, &adjacency_vector[0], vwgt, adjwgt, 
+                         &wgtflag, &numflag, &nparts, options, edgecut, part);
+    }
+   else
+    {
+     // Partition with the objective of minimising the total communication 
+     // volume  
+     METIS_PartGraphVKway(&nvertex, xadj, &adjacency_vector[0], vwgt, adjwgt, 
+                          &wgtflag, &numflag, &nparts, options, edgecut, part);
+    }
   }
  else
   {
@@ -483,6 +909,7 @@ void METIS::partition_mesh(Problem* problem_pt, const unsigned& ndomain,
  // Cleanup
  delete [] xadj;
  delete [] part;
+ delete [] vwgt;
  delete [] edgecut;
  delete [] options;
 
@@ -1288,6 +1715,477 @@ void METIS::partition_mesh(Problem* problem_pt, const unsigned& ndomain,
 
 
 
+ //==================================================================
+ /// Incremental (diffusive) repartitioning of an already-distributed
+ /// mesh: Diffuse the load imbalance over the graph of neighbouring
+ /// processors and hand over clusters of elements (all leaves of the
+ /// same tree root) across the processor boundaries to satisfy the
+ /// resulting flows. On return, element_domain_on_this_proc[e] contains
+ /// the number of the domain to which non-halo element e on THE CURRENT
+ /// PROCESSOR ONLY has been assigned. Returns the total number of
+ /// elements that change domain.
+ //==================================================================
+ unsigned METIS::diffusive_partition_distributed_mesh
+ (Problem* problem_pt,const double& imbalance_tolerance,
+  Vector<unsigned>& element_domain_on_this_proc,
+  const bool& report_stats)
+ {
+  // Start timer
+  double t_start=TimingHelpers::timer();
+
+  // Communicator
+  OomphCommunicator* comm_pt=problem_pt->communicator_pt();
+
+  // Number of processors / domains
+  const unsigned n_proc=comm_pt->nproc();
+  const unsigned my_rank=comm_pt->my_rank();
+
+  // Global mesh
+  Mesh* mesh_pt=problem_pt->mesh_pt();
+
+  // Total number of elements (halo and nonhalo) on this proc
+  const unsigned n_elem=mesh_pt->nelement();
+
+  // Get elemental assembly times
+  Vector<double> elemental_assembly_time=
+   problem_pt->elemental_assembly_time();
+
+  // Can we base load balancing on assembly times? Only if they're
+  // available everywhere, otherwise the loads aren't comparable
+  int local_have_times=1;
+  if ((elemental_assembly_time.size()!=n_elem)||(n_elem==0))
+   {
+    local_have_times=0;
+   }
+  int have_times=0;
+  MPI_Allreduce(&local_have_times,&have_times,1,MPI_INT,MPI_MIN,
+                comm_pt->mpi_comm());
+  const bool use_assembly_times=(have_times==1);
+
+
+  // Group the non-halo elements into clusters associated with the
+  //---------------------------------------------------------------
+  // same root element (non-refineable elements are their own roots).
+  //------------------------------------------------------------------
+  // These are the units of migration.
+  //----------------------------------
+  std::map<GeneralisedElement*,unsigned> root_el_number_plus_one;
+  Vector<unsigned> root_for_non_halo_element;
+  root_for_non_halo_element.reserve(n_elem);
+  Vector<double> root_weight;
+  Vector<unsigned> root_nelement;
+  Vector<Vector<Node*> > root_node_pt;
+  for (unsigned e=0;e<n_elem;e++)
+   {
+    GeneralisedElement* el_pt=mesh_pt->element_pt(e);
+    if (!el_pt->is_halo())
+     {
+      // Get the associated root element
+      GeneralisedElement* root_el_pt=el_pt;
+      RefineableElement* ref_el_pt=dynamic_cast<RefineableElement*>(el_pt);
+      if (ref_el_pt!=0)
+       {
+        root_el_pt=ref_el_pt->root_element_pt();
+       }
+
+      // Number of root element (offset by one)
+      unsigned root_number=root_el_number_plus_one[root_el_pt];
+      if (root_number==0)
+       {
+        root_weight.push_back(0.0);
+        root_nelement.push_back(0);
+        root_node_pt.push_back(Vector<Node*>());
+        root_number=root_weight.size();
+        root_el_number_plus_one[root_el_pt]=root_number;
+       }
+      root_number-=1;
+      root_for_non_halo_element.push_back(root_number);
+
+      // Weight
+      if (use_assembly_times)
+       {
+        root_weight[root_number]+=elemental_assembly_time[e];
+       }
+      else
+       {
+        root_weight[root_number]+=1.0;
+       }
+      root_nelement[root_number]++;
+
+      // Nodes
+      FiniteElement* fe_pt=dynamic_cast<FiniteElement*>(el_pt);
+      if (fe_pt!=0)
+       {
+        unsigned n_node=fe_pt->nnode();
+        for (unsigned j=0;j<n_node;j++)
+         {
+          root_node_pt[root_number].push_back(fe_pt->node_pt(j));
+         }
+       }
+     }
+   }
+  const unsigned n_root=root_weight.size();
+  const unsigned n_non_halo_element=root_for_non_halo_element.size();
+
+  // By default everything stays where it is
+  element_domain_on_this_proc.assign(n_non_halo_element,my_rank);
+
+
+  // Nodes shared with each of the other processors (halo nodes whose
+  //------------------------------------------------------------------
+  // non-halo counterparts live there and nodes that are haloed there)
+  //------------------------------------------------------------------
+  Vector<std::set<Node*> > shared_node_pt(n_proc);
+  unsigned n_mesh_loop=1;
+  unsigned nmesh=problem_pt->nsub_mesh();
+  if (nmesh>0)
+   {
+    n_mesh_loop=nmesh;
+   }
+  for (unsigned imesh=0;imesh<n_mesh_loop;imesh++)
+   {
+    Mesh* my_mesh_pt=mesh_pt;
+    if (nmesh!=0)
+     {
+      my_mesh_pt=problem_pt->mesh_pt(imesh);
+     }
+    for (unsigned d=0;d<n_proc;d++)
+     {
+      if (d!=my_rank)
+       {
+        unsigned n_halo=my_mesh_pt->nhalo_node(d);
+        for (unsigned j=0;j<n_halo;j++)
+         {
+          shared_node_pt[d].insert(my_mesh_pt->halo_node_pt(d,j));
+         }
+        unsigned n_haloed=my_mesh_pt->nhaloed_node(d);
+        for (unsigned j=0;j<n_haloed;j++)
+         {
+          shared_node_pt[d].insert(my_mesh_pt->haloed_node_pt(d,j));
+         }
+       }
+     }
+   }
+
+
+  // Loads and processor graph (available on all processors)
+  //---------------------------------------------------------
+  double my_load=0.0;
+  for (unsigned r=0;r<n_root;r++)
+   {
+    my_load+=root_weight[r];
+   }
+  Vector<double> load(n_proc,0.0);
+  MPI_Allgather(&my_load,1,MPI_DOUBLE,&load[0],1,MPI_DOUBLE,
+                comm_pt->mpi_comm());
+  double total_load=0.0;
+  double max_load=0.0;
+  for (unsigned d=0;d<n_proc;d++)
+   {
+    total_load+=load[d];
+    max_load=std::max(max_load,load[d]);
+   }
+  const double average_load=total_load/double(n_proc);
+
+  // Imbalance (maximum excess over average load, as a fraction)
+  double imbalance_before=0.0;
+  if (average_load>0.0)
+   {
+    imbalance_before=max_load/average_load-1.0;
+   }
+
+  // Already balanced well enough?
+  if (imbalance_before<=imbalance_tolerance)
+   {
+    if (report_stats)
+     {
+      oomph_info
+       << "Diffusive load balancing: imbalance "
+       << imbalance_before*100.0 << "% is within tolerance ("
+       << imbalance_tolerance*100.0 << "%); no elements migrated.\n"
+       << "CPU time for diffusive partitioning: "
+       << TimingHelpers::timer()-t_start << " sec" << std::endl;
+     }
+    return 0;
+   }
+
+  // Who are my neighbours?
+  Vector<int> my_neighbour;
+  for (unsigned d=0;d<n_proc;d++)
+   {
+    if (shared_node_pt[d].size()!=0)
+     {
+      my_neighbour.push_back(d);
+     }
+   }
+  int my_n_neighbour=my_neighbour.size();
+  Vector<int> n_neighbour(n_proc,0);
+  MPI_Allgather(&my_n_neighbour,1,MPI_INT,&n_neighbour[0],1,MPI_INT,
+                comm_pt->mpi_comm());
+  Vector<int> neighbour_start(n_proc,0);
+  int n_neighbour_total=0;
+  for (unsigned d=0;d<n_proc;d++)
+   {
+    neighbour_start[d]=n_neighbour_total;
+    n_neighbour_total+=n_neighbour[d];
+   }
+  Vector<int> all_neighbour(std::max(n_neighbour_total,1),0);
+  if (my_neighbour.size()==0)
+   {
+    my_neighbour.resize(1);
+   }
+  MPI_Allgatherv(&my_neighbour[0],my_n_neighbour,MPI_INT,
+                 &all_neighbour[0],&n_neighbour[0],&neighbour_start[0],
+                 MPI_INT,comm_pt->mpi_comm());
+
+  // Edges of the processor graph (p<q, listed by both processors)
+  Vector<unsigned> edge_first;
+  Vector<unsigned> edge_second;
+  std::set<std::pair<unsigned,unsigned> > listed_pair;
+  for (unsigned p=0;p<n_proc;p++)
+   {
+    for (int i=0;i<n_neighbour[p];i++)
+     {
+      unsigned q=all_neighbour[neighbour_start[p]+i];
+      listed_pair.insert(std::make_pair(p,q));
+     }
+   }
+  Vector<unsigned> degree(n_proc,0);
+  for (std::set<std::pair<unsigned,unsigned> >::iterator it=
+        listed_pair.begin();it!=listed_pair.end();it++)
+   {
+    unsigned p=it->first;
+    unsigned q=it->second;
+    if ((p<q)&&(listed_pair.count(std::make_pair(q,p))!=0))
+     {
+      edge_first.push_back(p);
+      edge_second.push_back(q);
+      degree[p]++;
+      degree[q]++;
+     }
+   }
+  const unsigned n_edge=edge_first.size();
+
+
+  // First-order diffusion of the load over the processor graph; the
+  //-----------------------------------------------------------------
+  // accumulated flow along each edge is the load to be migrated
+  //-------------------------------------------------------------
+  // (identical on all processors since the input is)
+  //-------------------------------------------------
+  Vector<double> edge_alpha(n_edge,0.0);
+  for (unsigned i=0;i<n_edge;i++)
+   {
+    edge_alpha[i]=1.0/double(1+std::max(degree[edge_first[i]],
+                                        degree[edge_second[i]]));
+   }
+  Vector<double> edge_flow(n_edge,0.0);
+  Vector<double> diffused_load(load);
+  Vector<double> delta(n_edge,0.0);
+  const unsigned max_iter=1000;
+  unsigned n_iter=0;
+  for (n_iter=0;n_iter<max_iter;n_iter++)
+   {
+    double max_diffused_load=0.0;
+    for (unsigned d=0;d<n_proc;d++)
+     {
+      max_diffused_load=std::max(max_diffused_load,diffused_load[d]);
+     }
+    if (max_diffused_load<=(1.0+0.1*imbalance_tolerance)*average_load)
+     {
+      break;
+     }
+    for (unsigned i=0;i<n_edge;i++)
+     {
+      delta[i]=edge_alpha[i]*(diffused_load[edge_first[i]]-
+                              diffused_load[edge_second[i]]);
+     }
+    for (unsigned i=0;i<n_edge;i++)
+     {
+      edge_flow[i]+=delta[i];
+      diffused_load[edge_first[i]]-=delta[i];
+      diffused_load[edge_second[i]]+=delta[i];
+     }
+   }
+
+  // Load to be sent to each of my neighbours
+  std::map<unsigned,double> outflow;
+  for (unsigned i=0;i<n_edge;i++)
+   {
+    if ((edge_first[i]==my_rank)&&(edge_flow[i]>0.0))
+     {
+      outflow[edge_second[i]]=edge_flow[i];
+     }
+    else if ((edge_second[i]==my_rank)&&(edge_flow[i]<0.0))
+     {
+      outflow[edge_first[i]]=-edge_flow[i];
+     }
+   }
+
+
+  // Select the root clusters to be migrated: start with those that touch
+  //----------------------------------------------------------------------
+  // the receiving processor and grow inwards, layer by layer
+  //---------------------------------------------------------
+  Vector<int> target_for_root(n_root,-1);
+  unsigned n_root_remaining=n_root;
+  if (outflow.size()!=0)
+   {
+    // Root clusters connected with each of my nodes
+    std::map<Node*,Vector<unsigned> > roots_of_node;
+    for (unsigned r=0;r<n_root;r++)
+     {
+      unsigned n_node=root_node_pt[r].size();
+      for (unsigned j=0;j<n_node;j++)
+       {
+        Vector<unsigned>& roots=roots_of_node[root_node_pt[r][j]];
+        if ((roots.size()==0)||(roots.back()!=r))
+         {
+          roots.push_back(r);
+         }
+       }
+     }
+
+    for (std::map<unsigned,double>::iterator it=outflow.begin();
+         it!=outflow.end();it++)
+     {
+      const unsigned d=it->first;
+      const double flow=it->second;
+      double moved=0.0;
+
+      // First layer: roots that touch nodes shared with processor d
+      std::vector<bool> queued(n_root,false);
+      Vector<unsigned> front;
+      for (std::set<Node*>::iterator it_nod=shared_node_pt[d].begin();
+           it_nod!=shared_node_pt[d].end();it_nod++)
+       {
+        std::map<Node*,Vector<unsigned> >::iterator it_root=
+         roots_of_node.find(*it_nod);
+        if (it_root!=roots_of_node.end())
+         {
+          unsigned n=it_root->second.size();
+          for (unsigned i=0;i<n;i++)
+           {
+            unsigned r=it_root->second[i];
+            if ((!queued[r])&&(target_for_root[r]==-1))
+             {
+              queued[r]=true;
+              front.push_back(r);
+             }
+           }
+         }
+       }
+
+      // Hand over clusters (keeping at least one) until the flow
+      // has been satisfied; stop growing when the front is exhausted
+      while ((front.size()!=0)&&(moved<flow)&&(n_root_remaining>1))
+       {
+        Vector<unsigned> next_front;
+        unsigned n_front=front.size();
+        for (unsigned i=0;i<n_front;i++)
+         {
+          if ((moved>=flow)||(n_root_remaining==1)) {break;}
+          unsigned r=front[i];
+
+          // Don't overshoot by more than half a cluster
+          if (target_for_root[r]!=-1) {continue;}
+          if (moved+0.5*root_weight[r]>flow) {continue;}
+
+          target_for_root[r]=d;
+          moved+=root_weight[r];
+          n_root_remaining--;
+
+          // Unqueued neighbours of this cluster form the next layer
+          unsigned n_node=root_node_pt[r].size();
+          for (unsigned j=0;j<n_node;j++)
+           {
+            Vector<unsigned>& roots=roots_of_node[root_node_pt[r][j]];
+            unsigned n=roots.size();
+            for (unsigned k=0;k<n;k++)
+             {
+              unsigned r2=roots[k];
+              if ((!queued[r2])&&(target_for_root[r2]==-1))
+               {
+                queued[r2]=true;
+                next_front.push_back(r2);
+               }
+             }
+           }
+         }
+        front=next_front;
+       }
+     }
+   }
+
+  // Target domains of the non-halo elements and migration stats
+  unsigned n_migrated_local=0;
+  Vector<double> incoming_load(n_proc,0.0);
+  for (unsigned r=0;r<n_root;r++)
+   {
+    if (target_for_root[r]!=-1)
+     {
+      n_migrated_local+=root_nelement[r];
+      incoming_load[target_for_root[r]]+=root_weight[r];
+      incoming_load[my_rank]-=root_weight[r];
+     }
+   }
+  for (unsigned e=0;e<n_non_halo_element;e++)
+   {
+    int target=target_for_root[root_for_non_halo_element[e]];
+    if (target!=-1)
+     {
+      element_domain_on_this_proc[e]=unsigned(target);
+     }
+   }
+
+  unsigned n_migrated=0;
+  MPI_Allreduce(&n_migrated_local,&n_migrated,1,MPI_UNSIGNED,MPI_SUM,
+                comm_pt->mpi_comm());
+
+  // Doc
+  if (report_stats)
+   {
+    Vector<double> load_change(n_proc,0.0);
+    MPI_Allreduce(&incoming_load[0],&load_change[0],n_proc,
+                  MPI_DOUBLE,MPI_SUM,comm_pt->mpi_comm());
+    double max_load_after=0.0;
+    double migrated_load=0.0;
+    for (unsigned d=0;d<n_proc;d++)
+     {
+      max_load_after=std::max(max_load_after,load[d]+load_change[d]);
+      if (load_change[d]<0.0) {migrated_load-=load_change[d];}
+     }
+    unsigned n_non_halo_total=0;
+    MPI_Allreduce(&n_non_halo_element,&n_non_halo_total,1,MPI_UNSIGNED,
+                  MPI_SUM,comm_pt->mpi_comm());
+
+    oomph_info
+     << "Diffusive load balancing [" << n_edge << " processor pairs, "
+     << n_iter << " diffusion iterations]:\n"
+     << "   imbalance before/expected after: "
+     << imbalance_before*100.0 << "% / "
+     << (max_load_after/average_load-1.0)*100.0 << "%\n"
+     << "   elements migrated: " << n_migrated << " of "
+     << n_non_halo_total << " (" << migrated_load/total_load*100.0
+     << "% of the load";
+    if (use_assembly_times)
+     {
+      oomph_info << ", based on assembly times)\n";
+     }
+    else
+     {
+      oomph_info << ", based on element counts)\n";
+     }
+    oomph_info
+     << "   elements migrated from this processor: "
+     << n_migrated_local << "\n"
+     << "CPU time for diffusive partitioning: "
+     << TimingHelpers::timer()-t_start << " sec" << std::endl;
+   }
+
+  return n_migrated;
+ }
+
 
 #endif
 
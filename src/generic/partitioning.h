@@ -60,6 +60,11 @@ extern "C"
 /// nodal graph based on minimum communication volume
 void METIS_PartGraphVKway(int *, int *, int *, int *, int *,
                           int *, int *, int *, int *, int *, int *);
+
+/// \short Metis multi-constraint graph partitioning function -- decomposes
+/// nodal graph based on minimum edgecut, balancing several vertex weights
+void METIS_mCPartGraphKway(int *, int *, int *, int *, int *, int *,
+                           int *, int *, int *, float *, int *, int *, int *);
 }
 
 
@@ -95,6 +100,63 @@ namespace METIS
  /// \short Function pointer to to function that translates spatial
  /// error into weight for METIS partitioning.
  extern ErrorToWeightFctPt Error_to_weight_fct_pt;
+
+ /// \short Typedef for function pointer to function that returns the
+ /// (predicted) cost of an element, used as a weight in the partitioning.
+ typedef double (*ElementCostFctPt)(GeneralisedElement* const& el_pt);
+
+ /// \short Default prediction for the preconditioner cost of an
+ /// element: the square of its number of dofs, i.e. the number of entries
+ /// it contributes to the Jacobian.
+ extern double default_preconditioner_cost_fct(
+  GeneralisedElement* const& el_pt);
+
+ /// \short Function pointer to function that predicts the preconditioner
+ /// cost of an element (used if Balance_preconditioner_cost is true)
+ extern ElementCostFctPt Preconditioner_cost_fct_pt;
+
+ /// \short Balance the measured elemental assembly times
+ /// (Problem::elemental_assembly_time(), if available) in
+ /// partition_mesh(...)? Default: false.
+ extern bool Balance_assembly_time;
+
+ /// \short Balance the number of dofs of the elements in
+ /// partition_mesh(...)? Default: false.
+ extern bool Balance_ndof;
+
+ /// \short Balance the predicted preconditioner cost of the elements
+ /// (see Preconditioner_cost_fct_pt) in partition_mesh(...)?
+ /// Default: false.
+ extern bool Balance_preconditioner_cost;
+
+ /// \short Permitted load imbalance for each constraint in multi-constraint
+ /// partitioning (e.g. 1.05 allows 5% imbalance)
+ extern double Multi_constraint_imbalance_tolerance;
+
+ /// \short Use recursive coordinate bisection rather than METIS in
+ /// partition_mesh(...) (e.g. if METIS is not available). Default: false.
+ extern bool Use_recursive_coordinate_bisection;
+
+ /// \short Get the element costs that are to be balanced by
+ /// partition_mesh(...), according to the flags Balance_assembly_time,
+ /// Balance_ndof and Balance_preconditioner_cost: on return,
+ /// element_cost[c][e] contains the cost of element e (in the Problem's
+ /// mesh) for the c-th enabled constraint.
+ extern void get_element_costs(Problem* problem_pt,
+                               Vector<Vector<double> >& element_cost);
+
+ /// \short Partition mesh by recursive coordinate bisection: the
+ /// elements (represented by the centroids of their nodes) are recursively
+ /// split along the longest extent of their bounding box, such that the
+ /// total element_weight in each half is proportional to the number of
+ /// domains assigned to it. If element_weight is empty, all elements
+ /// have the same weight. On return, element_domain[ielem] contains the
+ /// number of the domain [0,1,...,ndomain-1] to which element ielem has
+ /// been assigned.
+ extern void recursive_coordinate_bisection(
+  Mesh* mesh_pt, const unsigned& ndomain,
+  const Vector<double>& element_weight,
+  Vector<unsigned>& element_domain);
  
  /// \short Partition mesh uniformly by dividing elements
  /// equally over the partitions, in the order
@@ -178,6 +240,27 @@ namespace METIS
     Vector<unsigned>& element_domain_on_this_proc,
     const bool& bypass_metis=false);
 
+  /// \short Incremental (diffusive) repartitioning of an already-distributed
+  /// mesh. The imbalance in the load (the elemental assembly times, if
+  /// available on all processors, or the number of elements otherwise) is
+  /// diffused over the graph of neighbouring processors (processors that
+  /// share nodes) to obtain the load that has to flow between each pair of
+  /// neighbours. Each processor then hands over clusters of elements that
+  /// share the same tree root, starting with those that touch the
+  /// receiving processor and growing inwards, so only elements near the
+  /// processor boundaries migrate and nothing is gathered on a
+  /// single processor. Nothing is moved if the maximum load exceeds the
+  /// average by less than the imbalance_tolerance (a fraction, e.g. 0.05).
+  /// On return, element_domain_on_this_proc[e] contains the number of the
+  /// domain to which non-halo element e on THE CURRENT PROCESSOR ONLY has
+  /// been assigned (same ordering as in partition_distributed_mesh(...)).
+  /// Returns the total number of elements (on all processors) that
+  /// change domain.
+  extern unsigned diffusive_partition_distributed_mesh
+   (Problem* problem_pt,const double& imbalance_tolerance,
+    Vector<unsigned>& element_domain_on_this_proc,
+    const bool& report_stats=false);
+
 #endif
 
 }
@@ -31,6 +31,10 @@
 #include<list>
 #include<algorithm>
 #include<string>
+#include<cstring>
+#include<set>
+#include<sstream>
+#include<iomanip>
 
 #include "oomph_utilities.h"
 #include "problem.h"
@@ -45,6 +49,8 @@
 #include "dg_elements.h"
 #include "partitioning.h"
 #include "spines.h"
+#include "element_with_external_element.h"
+#include "element_with_moving_nodes.h"
 
 //Include to fill in additional_setup_shared_node_scheme() function
 #include "refineable_mesh.template.cc"
@@ -79,6 +85,8 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
 #ifdef OOMPH_HAS_MPI
   Doc_imbalance_in_parallel_assembly(false),
   Use_default_partition_in_load_balance(false),
+  Use_diffusive_partition_in_load_balance(false),
+  Diffusive_load_balance_tolerance(0.05),
   Must_recompute_load_balance_for_assembly(true),
   Halo_scheme_pt(0),
 #endif
@@ -103,6 +111,22 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
   DTSF_max_increase(4.0),
   DTSF_min_decrease(0.8),
   Minimum_dt_but_still_proceed(-1.0),
+  Timestep_controller(Elementary_timestep_controller),
+  Timestep_controller_proportional_gain(0.0),
+  Timestep_controller_integral_gain(1.0),
+  Timestep_controller_derivative_gain(0.0),
+  Previous_temporal_error_norm(-1.0),
+  Second_previous_temporal_error_norm(-1.0),
+  Jacobian_reuse_across_timesteps_is_enabled(false),
+  Max_relative_dt_change_for_jacobian_reuse(0.2),
+  Dt_for_stored_jacobian(0.0),
+  Ndof_for_stored_jacobian(0),
+  Mesh_locality_reordering(Mesh::No_locality_reordering),
+  Equation_reordering_for_bandwidth_is_enabled(false),
+  Dof_storage_pool_pt(0),
+  Contiguous_dof_storage_is_enabled(false),
+  Nthread_for_eqn_numbering(1),
+  Binary_restart_is_enabled(false),
   Scale_arc_length(true), Desired_proportion_of_arc_length(0.5),
   Theta_squared(1.0), Sign_of_jacobian(0), Continuation_direction(1.0),
   Parameter_derivative(1.0), Parameter_current(0.0),
@@ -162,6 +186,17 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
   // DOFs
   // this is setup when assign_eqn_numbers(...) is called.
   Dof_distribution_pt = new LinearAlgebraDistribution;
+
+#ifdef OOMPH_HAS_MPI
+  // No persistent communication patterns for the synchronisation
+  // of the dofs yet
+  Dof_synchronisation_scheme_pt.resize(3,0);
+  Dof_synchronisation_in_progress=false;
+  Overlap_dof_synchronisation_with_assembly=false;
+  Noverlapped_assembly_interior_element=0;
+  Overlapped_assembly_el_lo=0;
+  Overlapped_assembly_el_hi_plus_one=0;
+#endif
  }
 
 //================================================================
@@ -187,9 +222,20 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
 
   delete Default_eigen_solver_pt;
   delete Default_assembly_handler_pt;
+#ifdef OOMPH_HAS_MPI
+  // Any exchange that's still in flight is completed by the schemes'
+  // destructors but its values are discarded: the Data have generally
+  // been deleted by now
+  Dof_synchronisation_in_progress=false;
+  flush_dof_synchronisation_schemes();
+#endif
   delete Communicator_pt;
   delete Dof_distribution_pt;
 
+  // The Data have generally been deleted by now, so we can't release
+  // them from the contiguous storage
+  delete Dof_storage_pool_pt;
+
  // Delete any copies of the problem that have been created for
  // use in adaptive bifurcation tracking.
  // ALH: This will eventually go
@@ -1997,6 +2043,11 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
    }
 #endif
 
+  // Give the Data their own storage back if some of them have left
+  // the contiguous storage of the unknowns, so that Dof_pt doesn't
+  // point into it while the equations are renumbered
+  release_contiguous_dof_storage_if_broken();
+
   // Number of submeshes
   unsigned n_sub_mesh=Sub_mesh_pt.size();
 
@@ -2005,6 +2056,10 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
   // Storage for number of processors
   int n_proc=this->communicator_pt()->nproc();
 
+  // The halo schemes may have changed so the persistent communication
+  // patterns for the synchronisation of the dofs (and the associated
+  // classification of the elements) must be rebuilt
+  flush_dof_synchronisation_schemes();
 
   if (n_proc>1)
    {
@@ -2036,6 +2091,42 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
     t_start=TimingHelpers::timer();
    }
 
+  // Has the problem been distributed?
+  bool problem_is_distributed=false;
+#ifdef OOMPH_HAS_MPI
+  problem_is_distributed=Problem_has_been_distributed;
+#endif
+
+  // Reorder the elements and nodes to improve locality (the halo
+  // lookup schemes of distributed problems rely on their order, so
+  // this is only done for undistributed problems)
+  if ((Mesh_locality_reordering!=Mesh::No_locality_reordering)&&
+      (!problem_is_distributed))
+   {
+    if (n_sub_mesh==0)
+     {
+      Mesh_pt->reorder_elements_for_locality(Mesh_locality_reordering);
+      Mesh_pt->reorder_nodes_for_locality(Mesh_locality_reordering);
+     }
+    else
+     {
+      for (unsigned i=0;i<n_sub_mesh;i++)
+       {
+        Sub_mesh_pt[i]->reorder_elements_for_locality(Mesh_locality_reordering);
+        Sub_mesh_pt[i]->reorder_nodes_for_locality(Mesh_locality_reordering);
+       }
+      rebuild_global_mesh();
+     }
+
+    if (Global_timings::Doc_comprehensive_timings)
+     {
+      oomph_info
+       << "Time for locality reordering of meshes in assign_eqn_numbers: "
+       << TimingHelpers::timer()-t_start << std::endl;
+      t_start=TimingHelpers::timer();
+     }
+   }
+
   // Loop over all elements in the mesh and set up any additional
   // dependencies that they may have (e.g. storing the geometric
   // Data, i.e. Data that affects an element's shape in elements
@@ -2106,7 +2197,8 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
      }
 
     //Call assign equation numbers on the global mesh
-    n_dof = Mesh_pt->assign_global_eqn_numbers(Dof_pt);
+    n_dof = Mesh_pt->assign_global_eqn_numbers(Dof_pt,
+                                               Nthread_for_eqn_numbering);
 
     // Deal with the spine meshes additional numbering
     //If there is only one mesh
@@ -2301,14 +2393,16 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
    {
     if (n_sub_mesh==0)
      {
-      Mesh_pt->assign_local_eqn_numbers(Store_local_dof_pt_in_elements);
+      Mesh_pt->assign_local_eqn_numbers(Store_local_dof_pt_in_elements,
+                                        Nthread_for_eqn_numbering);
      }
     else
      {
       for (unsigned i=0;i<n_sub_mesh;i++)
        {
         Sub_mesh_pt[i]->
-         assign_local_eqn_numbers(Store_local_dof_pt_in_elements);
+         assign_local_eqn_numbers(Store_local_dof_pt_in_elements,
+                                  Nthread_for_eqn_numbering);
        }
      }
    }
@@ -2322,191 +2416,722 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
      << t_end-t_start << std::endl;
    }
 
+  // Renumber the equations to reduce the bandwidth (this needs the
+  // local equation numbers)
+  if (Equation_reordering_for_bandwidth_is_enabled&&
+      assign_local_eqn_numbers&&(!problem_is_distributed))
+   {
+    reorder_equations_for_bandwidth();
+   }
+
+  // (Re-)build the contiguous storage for the unknowns
+  if (Contiguous_dof_storage_is_enabled&&(!problem_is_distributed))
+   {
+    setup_contiguous_dof_storage();
+   }
+  else if (Dof_storage_pool_pt!=0)
+   {
+    release_contiguous_dof_storage();
+   }
+
 
   // and return the total number of DOFs
   return n_dof;
 
  }
+
 //================================================================
-/// \short Function to describe the dofs in terms of the global 
-/// equation number, i.e. what type of value (nodal value of
-/// a Node; value in a Data object; value of internal Data in an 
-/// element; etc) is the unknown with a certain global equation number.
-/// Output stream defaults to oomph_info.
+/// Reorder the elements and nodes of the (sub-)meshes to improve
+/// the locality of memory accesses whenever the equations are
+/// (re-)numbered. The reordering is one of the 
+/// Mesh::Locality_reordering enums.
 //================================================================
- void Problem::describe_dofs(std::ostream& out) const
+ void Problem::enable_mesh_reordering_for_locality(const unsigned& reordering)
  {
-  //Check that the global mesh has been build
-#ifdef PARANOID
-  if(Mesh_pt==0)
-   {
-    std::ostringstream error_stream;
-    error_stream <<
-     "Global mesh does not exist, so equation numbers cannot be found.\n";
-    //Check for sub meshes
-    if(nsub_mesh()==0)
-     {
-      error_stream << "There aren't even any sub-meshes in the Problem.\n"
-                   << "You can set the global mesh directly by using\n"
-                   << "Problem::mesh_pt() = my_mesh_pt;\n"
-                   << "OR you can use Problem::add_sub_mesh(mesh_pt); "
-                   << "to add a sub mesh.\n";
-     }
-    else
-     {
-      error_stream << "There are " << nsub_mesh() << " sub-meshes.\n";
-     }
-    error_stream <<
-     "You need to call Problem::build_global_mesh() to create a global mesh\n"
-                 << "from the sub-meshes.\n\n";
+  Mesh_locality_reordering=reordering;
+ }
 
-    throw OomphLibError(error_stream.str(),
-                        OOMPH_CURRENT_FUNCTION,
-                        OOMPH_EXCEPTION_LOCATION);
-   }
-#endif
+//================================================================
+/// Reorder the elements and nodes of the (sub-)meshes along
+/// the Hilbert curve whenever the equations are (re-)numbered
+//================================================================
+ void Problem::enable_mesh_reordering_for_locality()
+ {
+  Mesh_locality_reordering=Mesh::Hilbert_reordering;
+ }
 
-  out << "Although this program will describe the degrees of freedom in the \n" 
-      << "problem, it will do so using the typedef for the elements. This is \n"
-      << "not neccesarily human readable, but there is a solution.\n"
-      << "Pipe your program's output through c++filt, with the argument -t.\n"
-      << "e.g. \"./two_d_multi_poisson | c++filt -t > ReadableOutput.txt\".\n "
-      << "(Disregarding the quotes)\n\n\n";
+//================================================================
+/// Don't reorder the elements and nodes of the meshes
+//================================================================
+ void Problem::disable_mesh_reordering_for_locality()
+ {
+  Mesh_locality_reordering=Mesh::No_locality_reordering;
+ }
 
-  out << "Classifying Global Equation Numbers" << std::endl;
-  out <<  std::string(80,'-') << std::endl;
+//================================================================
+/// Get the (distinct) Data that can hold unknowns of the problem: 
+/// The global data and, for all (sub-)meshes, the nodes (and the 
+/// variable positions of SolidNodes), the internal data of the 
+/// elements and the spine heights of SpineMeshes.
+//================================================================
+ void Problem::get_all_data_with_eqn_numbers(Vector<Data*>& data_pt) const
+ {
+  data_pt.clear();
+  std::set<Data*> data_done;
 
-  // Number of submeshes
-  unsigned n_sub_mesh=Sub_mesh_pt.size();
-  
-  // Classify Global dofs
-  unsigned Nglobal_data = nglobal_data();
-  for(unsigned i=0;i<Nglobal_data;i++)
+  unsigned n_global_data=nglobal_data();
+  for (unsigned i=0;i<n_global_data;i++)
    {
-    std::stringstream conversion;
-    conversion <<" in Global Data "<<i<<".";
-    std::string in(conversion.str());
-    Global_data_pt[i]->describe_dofs(out,in);
+    if (data_done.insert(Global_data_pt[i]).second) 
+     {
+      data_pt.push_back(Global_data_pt[i]);
+     }
    }
-  
-  // Put string in limiting scope.
-  {
-   // Descend into assignment for mesh.
-   std::string in(" in Problem's Only Mesh.");
-   Mesh_pt->describe_dofs(out,in);
-  }
 
-  // Deal with the spine meshes additional numbering:
-  // If there is only one mesh:
-  if(n_sub_mesh==0)
+  // Meshes to be considered
+  Vector<Mesh*> all_mesh_pt;
+  unsigned n_sub_mesh=nsub_mesh();
+  if (n_sub_mesh==0) {all_mesh_pt.push_back(Mesh_pt);}
+  for (unsigned m=0;m<n_sub_mesh;m++) {all_mesh_pt.push_back(Sub_mesh_pt[m]);}
+
+  unsigned n_mesh=all_mesh_pt.size();
+  for (unsigned m=0;m<n_mesh;m++)
    {
-    if(SpineMesh* const spine_mesh_pt = dynamic_cast<SpineMesh*>(Mesh_pt))     
+    Mesh* mesh_pt=all_mesh_pt[m];
+
+    // Nodal values and (for SolidNodes) positions
+    unsigned long n_node=mesh_pt->nnode();
+    for (unsigned long n=0;n<n_node;n++)
      {
-      std::string in(" in Problem's Only SpineMesh.");
-      spine_mesh_pt->describe_spine_dofs(out,in);
+      Node* nod_pt=mesh_pt->node_pt(n);
+      if (data_done.insert(nod_pt).second) {data_pt.push_back(nod_pt);}
+      SolidNode* solid_nod_pt=dynamic_cast<SolidNode*>(nod_pt);
+      if (solid_nod_pt!=0)
+       {
+        Data* position_data_pt=solid_nod_pt->variable_position_pt();
+        if (data_done.insert(position_data_pt).second) 
+         {
+          data_pt.push_back(position_data_pt);
+         }
+       }
      }
-   }
-  //Otherwise loop over the sub meshes
-  else
-   {
-    //Assign global equation numbers first
-    for(unsigned i=0;i<n_sub_mesh;i++)
+
+    // Internal data of the elements
+    unsigned long n_element=mesh_pt->nelement();
+    for (unsigned long e=0;e<n_element;e++)
      {
-      if(SpineMesh* const spine_mesh_pt =
-         dynamic_cast<SpineMesh*>(Sub_mesh_pt[i]))
+      GeneralisedElement* el_pt=mesh_pt->element_pt(e);
+      unsigned n_internal=el_pt->ninternal_data();
+      for (unsigned i=0;i<n_internal;i++)
        {
-        std::stringstream conversion;
-        conversion <<" in Sub-SpineMesh "<<i<<".";
-        std::string in(conversion.str());
-        spine_mesh_pt->describe_spine_dofs(out,in);
-       }// end if.
-     }// end for.
-   }// end else.
+        Data* internal_data_pt=el_pt->internal_data_pt(i);
+        if (data_done.insert(internal_data_pt).second) 
+         {
+          data_pt.push_back(internal_data_pt);
+         }
+       }
+     }
+
+    // Spine heights
+    SpineMesh* spine_mesh_pt=dynamic_cast<SpineMesh*>(mesh_pt);
+    if (spine_mesh_pt!=0)
+     {
+      unsigned long n_spine=spine_mesh_pt->nspine();
+      for (unsigned long i=0;i<n_spine;i++)
+       {
+        Data* spine_data_pt=spine_mesh_pt->spine_pt(i)->spine_height_pt();
+        if (data_done.insert(spine_data_pt).second) 
+         {
+          data_pt.push_back(spine_data_pt);
+         }
+       }
+     }
+   }
+ }
 
 
-  out <<  std::string(80,'\\') << std::endl;
-  out <<  std::string(80,'\\') << std::endl;
-  out <<  std::string(80,'\\') << std::endl;
-  out << "Classifying global eqn numbers in terms of elements." << std::endl;
-  out <<  std::string(80,'-') << std::endl;
-  out << "Eqns   | Source" << std::endl;
-  out << std::string(80,'-') << std::endl;
+//================================================================
+/// Store the values of the unknowns in a single array that is 
+/// ordered by equation number (set up immediately if the equations
+/// have already been numbered and then whenever they are renumbered).
+//================================================================
+ void Problem::enable_contiguous_dof_storage()
+ {
+  Contiguous_dof_storage_is_enabled=true;
+  bool problem_is_distributed=false;
+#ifdef OOMPH_HAS_MPI
+  problem_is_distributed=Problem_has_been_distributed;
+#endif
+  if ((Dof_pt.size()>0)&&(!problem_is_distributed))
+   {
+    setup_contiguous_dof_storage();
+   }
+ }
+
+//================================================================
+/// Give the Data their own storage back
+//================================================================
+ void Problem::disable_contiguous_dof_storage()
+ {
+  Contiguous_dof_storage_is_enabled=false;
+  if (Dof_storage_pool_pt!=0) {release_contiguous_dof_storage();}
+ }
 
+//================================================================
+/// (Re-)pool the nodal storage in the (sub-)meshes and renumber 
+/// the equations if they had been numbered
+//================================================================
+ void Problem::enable_pooled_nodal_storage()
+ {
+  const unsigned n_sub_mesh=nsub_mesh();
   if (n_sub_mesh==0)
    {
-    std::string in(" in Problem's Only Mesh.");
-    Mesh_pt->describe_local_dofs(out,in);
+    mesh_pt()->enable_pooled_nodal_storage(true);
    }
   else
    {
     for (unsigned i=0;i<n_sub_mesh;i++)
      {
-       std::stringstream conversion;
-       conversion <<" in Sub-Mesh "<<i<<".";
-       std::string in(conversion.str());
-       Sub_mesh_pt[i]->describe_local_dofs(out,in);
-     }// End for
-   }// End else
- } // End problem::describe_dofs(...)
+      mesh_pt(i)->enable_pooled_nodal_storage(true);
+     }
+   }
 
+  // The values of the unknowns have moved so the pointers to them
+  // must be rebuilt
+  if (Dof_pt.size()>0)
+   {
+    assign_eqn_numbers();
+   }
+ }
 
 //================================================================
-/// Get the vector of dofs, i.e. a vector containing the current
-/// values of all unknowns.
+/// Pointer to the contiguous storage of the unknowns
 //================================================================
- void Problem::get_dofs(DoubleVector& dofs) const
+ double* Problem::contiguous_dof_storage_pt()
  {
-  //Find number of dofs
-  const unsigned long n_dof = ndof();
-
-  //Resize the vector
-  dofs.build(Dof_distribution_pt,0.0);
-
-  //Copy dofs into vector
-  for(unsigned long l=0;l<n_dof;l++)
+#ifdef PARANOID
+  if (!contiguous_dof_storage_is_intact())
    {
-    dofs[l] = *Dof_pt[l];
+    throw OomphLibError("Contiguous dof storage is not active.\n",
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
    }
+#endif
+  return Dof_storage_pool_pt->dof_storage_pt();
  }
 
- /// Get history values of dofs in a double vector.
- void Problem::get_dofs(const unsigned& t, DoubleVector& dofs) const
+//================================================================
+/// Stride between successive unknowns in the contiguous storage
+//================================================================
+ unsigned Problem::contiguous_dof_storage_stride() const
  {
 #ifdef PARANOID
-  if(distributed())
+  if (!contiguous_dof_storage_is_intact())
    {
-    throw OomphLibError("Not designed for distributed problems",
-                        OOMPH_EXCEPTION_LOCATION,
-                        OOMPH_CURRENT_FUNCTION);
-    // might work, not sure
+    throw OomphLibError("Contiguous dof storage is not active.\n",
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
    }
 #endif
+  return Dof_storage_pool_pt->ntstorage();
+ }
 
-  // Resize the vector
-  dofs.build(Dof_distribution_pt, 0.0);
+//================================================================
+/// Move the values of the unknowns into contiguous storage, ordered
+/// by equation number, and redirect Dof_pt. 
+//================================================================
+ void Problem::setup_contiguous_dof_storage()
+ {
+  Vector<Data*> data_pt;
+  get_all_data_with_eqn_numbers(data_pt);
+  const unsigned long n_dof=Dof_pt.size();
 
-  // First deal with global data
-  unsigned Nglobal_data = nglobal_data();
-  for(unsigned i=0; i<Nglobal_data; i++)
+  if (Dof_storage_pool_pt==0) {Dof_storage_pool_pt=new DofStoragePool;}
+  if (!Dof_storage_pool_pt->build(data_pt,n_dof))
    {
-    for(unsigned j=0, nj=Global_data_pt[i]->nvalue(); j<nj; j++)
+    OomphLibWarning("The unknowns can't be stored contiguously because\n"
+                    "they have different numbers of history values or\n"
+                    "are not all stored in the global data, nodes,\n"
+                    "internal data or spines of the meshes.\n",
+                    OOMPH_CURRENT_FUNCTION,
+                    OOMPH_EXCEPTION_LOCATION);
+    release_contiguous_dof_storage();
+    return;
+   }
+
+  // The unknowns have moved
+  double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt();
+  const unsigned stride=Dof_storage_pool_pt->ntstorage();
+  for (unsigned long l=0;l<n_dof;l++)
+   {
+    Dof_pt[l]=dof_storage_pt+l*stride;
+   }
+  if (Store_local_dof_pt_in_elements)
+   {
+    unsigned n_sub_mesh=nsub_mesh();
+    if (n_sub_mesh==0)
      {
-      // For each data get the equation number and copy out the value.
-      int eqn_number = Global_data_pt[i]->eqn_number(j);
-      if(eqn_number >= 0)
+      Mesh_pt->assign_local_eqn_numbers(Store_local_dof_pt_in_elements);
+     }
+    else
+     {
+      for (unsigned i=0;i<n_sub_mesh;i++)
        {
-        dofs[eqn_number] = Global_data_pt[i]->value(t, j);
+        Sub_mesh_pt[i]->
+         assign_local_eqn_numbers(Store_local_dof_pt_in_elements);
        }
      }
    }
+ }
 
-  // Next element internal data
-  for(unsigned i=0, ni=mesh_pt()->nelement(); i<ni; i++)
-   {
+//================================================================
+/// Is the contiguous storage of the unknowns active and does it
+/// still hold the values of all unknowns? (Pure check; see
+/// release_contiguous_dof_storage_if_broken())
+//================================================================
+ bool Problem::contiguous_dof_storage_is_intact() const
+ {
+  if (Dof_storage_pool_pt==0) {return false;}
 
-    GeneralisedElement* ele_pt = mesh_pt()->element_pt(i);
-    for(unsigned j=0, nj=ele_pt->ninternal_data(); j<nj; j++)
-     {
+  // Cheap test: No Data has left any pool since ours was checked
+  if (Dof_storage_pool_pt->no_data_has_left()) {return true;}
+
+  // Some Data has left a pool (not necessarily ours): Check ours
+  Vector<Data*> data_pt;
+  get_all_data_with_eqn_numbers(data_pt);
+  return Dof_storage_pool_pt->is_intact(data_pt);
+ }
+
+//================================================================
+/// If some Data have copied their values out of the contiguous 
+/// storage of the unknowns, give the remaining Data their own 
+/// storage back and redirect Dof_pt, so that the callers fall back
+/// to going through the Data.
+//================================================================
+ void Problem::release_contiguous_dof_storage_if_broken()
+ {
+  if ((Dof_storage_pool_pt!=0)&&(!contiguous_dof_storage_is_intact()))
+   {
+    release_contiguous_dof_storage();
+   }
+ }
+
+//================================================================
+/// Give the Data their own storage back and redirect Dof_pt
+//================================================================
+ void Problem::release_contiguous_dof_storage()
+ {
+  if (Dof_storage_pool_pt==0) {return;}
+
+  Vector<Data*> data_pt;
+  get_all_data_with_eqn_numbers(data_pt);
+  Dof_storage_pool_pt->release(data_pt);
+  delete Dof_storage_pool_pt;
+  Dof_storage_pool_pt=0;
+
+  // Redirect the pointers to the (local) unknowns
+  const unsigned long n_dof=Dof_pt.size();
+  const unsigned long first_row=Dof_distribution_pt->first_row();
+  const unsigned long n_data=data_pt.size();
+  for (unsigned long d=0;d<n_data;d++)
+   {
+    if (data_pt[d]->is_a_copy()) {continue;}
+    unsigned n_value=data_pt[d]->nvalue();
+    for (unsigned j=0;j<n_value;j++)
+     {
+      long eqn=data_pt[d]->eqn_number(j);
+      if ((eqn>=long(first_row))&&(eqn<long(first_row+n_dof)))
+       {
+        Dof_pt[eqn-first_row]=data_pt[d]->value_pt(j);
+       }
+     }
+   }
+  if (Store_local_dof_pt_in_elements)
+   {
+    unsigned n_sub_mesh=nsub_mesh();
+    if (n_sub_mesh==0)
+     {
+      Mesh_pt->assign_local_eqn_numbers(Store_local_dof_pt_in_elements);
+     }
+    else
+     {
+      for (unsigned i=0;i<n_sub_mesh;i++)
+       {
+        Sub_mesh_pt[i]->
+         assign_local_eqn_numbers(Store_local_dof_pt_in_elements);
+       }
+     }
+   }
+ }
+
+//================================================================
+/// Renumber the equations by a reverse Cuthill-McKee ordering of 
+/// the graph of dofs that are coupled because they share elements
+/// and re-assign the local equation numbers. Must only be called 
+/// after the local equation numbers have been assigned.
+//================================================================
+ void Problem::reorder_equations_for_bandwidth()
+ {
+  double t_start=0.0;
+  if (Global_timings::Doc_comprehensive_timings)
+   {
+    t_start=TimingHelpers::timer();
+   }
+
+  const unsigned long n_dof=Dof_pt.size();
+  if (n_dof==0) {return;}
+
+  // Collect the (distinct) storage for the global equation numbers of
+  // all data: Copied data share the storage of the original ones
+  Vector<Data*> data_pt;
+  get_all_data_with_eqn_numbers(data_pt);
+  std::set<long*> eqn_number_pt;
+  const unsigned long n_data=data_pt.size();
+  for (unsigned long d=0;d<n_data;d++)
+   {
+    unsigned n_value=data_pt[d]->nvalue();
+    for (unsigned j=0;j<n_value;j++)
+     {
+      eqn_number_pt.insert(&data_pt[d]->eqn_number(j));
+     }
+   }
+
+  // Meshes to be considered
+  Vector<Mesh*> all_mesh_pt;
+  unsigned n_sub_mesh=nsub_mesh();
+  if (n_sub_mesh==0) {all_mesh_pt.push_back(Mesh_pt);}
+  for (unsigned m=0;m<n_sub_mesh;m++) {all_mesh_pt.push_back(Sub_mesh_pt[m]);}
+  unsigned n_mesh=all_mesh_pt.size();
+
+  // Check that each global equation is owned by exactly one entry;
+  // otherwise some of the data are not accessible from here and we 
+  // can't renumber safely
+  Vector<unsigned> count(n_dof,0);
+  bool numbering_is_complete=true;
+  for (std::set<long*>::iterator it=eqn_number_pt.begin();
+       it!=eqn_number_pt.end();it++)
+   {
+    long eqn=**it;
+    if (eqn<0) {continue;}
+    if ((unsigned long)(eqn)>=n_dof) {numbering_is_complete=false; break;}
+    count[eqn]++;
+   }
+  for (unsigned long i=0;(i<n_dof)&&numbering_is_complete;i++)
+   {
+    if (count[i]!=1) {numbering_is_complete=false;}
+   }
+  if (!numbering_is_complete)
+   {
+    OomphLibWarning("Not all dofs are stored in the global data, nodes,\n"
+                    "internal data or spines of the meshes, so the\n"
+                    "equations are not renumbered.\n",
+                    OOMPH_CURRENT_FUNCTION,
+                    OOMPH_EXCEPTION_LOCATION);
+    return;
+   }
+
+  // The groups are the elements; their members the dofs they 
+  // contribute to
+  Vector<unsigned long> group_start(1,0);
+  Vector<unsigned long> group_vertex;
+  for (unsigned m=0;m<n_mesh;m++)
+   {
+    unsigned long n_element=all_mesh_pt[m]->nelement();
+    for (unsigned long e=0;e<n_element;e++)
+     {
+      GeneralisedElement* el_pt=all_mesh_pt[m]->element_pt(e);
+      unsigned n_el_dof=el_pt->ndof();
+      for (unsigned j=0;j<n_el_dof;j++)
+       {
+        group_vertex.push_back(el_pt->eqn_number(j));
+       }
+      group_start.push_back(group_vertex.size());
+     }
+   }
+  Vector<unsigned long> ordering;
+  LocalityReorderingHelpers::reverse_cuthill_mckee(n_dof,group_start,
+                                                   group_vertex,ordering);
+
+  // Renumber the equations and the pointers to the dofs
+  Vector<long> new_eqn(n_dof);
+  Vector<double*> old_dof_pt(Dof_pt);
+  for (unsigned long k=0;k<n_dof;k++)
+   {
+    new_eqn[ordering[k]]=k;
+    Dof_pt[k]=old_dof_pt[ordering[k]];
+   }
+  for (std::set<long*>::iterator it=eqn_number_pt.begin();
+       it!=eqn_number_pt.end();it++)
+   {
+    if (**it>=0) {**it=new_eqn[**it];}
+   }
+
+  // Re-assign the local equation numbers
+  if (n_sub_mesh==0)
+   {
+    Mesh_pt->assign_local_eqn_numbers(Store_local_dof_pt_in_elements,
+                                      Nthread_for_eqn_numbering);
+   }
+  else
+   {
+    for (unsigned i=0;i<n_sub_mesh;i++)
+     {
+      Sub_mesh_pt[i]->assign_local_eqn_numbers(Store_local_dof_pt_in_elements,
+                                               Nthread_for_eqn_numbering);
+     }
+   }
+
+  // Stored Jacobians refer to the old numbering
+  Jacobian_has_been_computed=false;
+
+  if (Global_timings::Doc_comprehensive_timings)
+   {
+    oomph_info
+     << "Time for reverse Cuthill-McKee renumbering of equations: "
+     << TimingHelpers::timer()-t_start << std::endl;
+   }
+ }
+
+//================================================================
+/// \short Function to describe the dofs in terms of the global 
+/// equation number, i.e. what type of value (nodal value of
+/// a Node; value in a Data object; value of internal Data in an 
+/// element; etc) is the unknown with a certain global equation number.
+/// Output stream defaults to oomph_info.
+//================================================================
+ void Problem::describe_dofs(std::ostream& out) const
+ {
+  //Check that the global mesh has been build
+#ifdef PARANOID
+  if(Mesh_pt==0)
+   {
+    std::ostringstream error_stream;
+    error_stream <<
+     "Global mesh does not exist, so equation numbers cannot be found.\n";
+    //Check for sub meshes
+    if(nsub_mesh()==0)
+     {
+      error_stream << "There aren't even any sub-meshes in the Problem.\n"
+                   << "You can set the global mesh directly by using\n"
+                   << "Problem::mesh_pt() = my_mesh_pt;\n"
+                   << "OR you can use Problem::add_sub_mesh(mesh_pt); "
+                   << "to add a sub mesh.\n";
+     }
+    else
+     {
+      error_stream << "There are " << nsub_mesh() << " sub-meshes.\n";
+     }
+    error_stream <<
+     "You need to call Problem::build_global_mesh() to create a global mesh\n"
+                 << "from the sub-meshes.\n\n";
+
+    throw OomphLibError(error_stream.str(),
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+#endif
+
+  out << "Although this program will describe the degrees of freedom in the \n" 
+      << "problem, it will do so using the typedef for the elements. This is \n"
+      << "not neccesarily human readable, but there is a solution.\n"
+      << "Pipe your program's output through c++filt, with the argument -t.\n"
+      << "e.g. \"./two_d_multi_poisson | c++filt -t > ReadableOutput.txt\".\n "
+      << "(Disregarding the quotes)\n\n\n";
+
+  out << "Classifying Global Equation Numbers" << std::endl;
+  out <<  std::string(80,'-') << std::endl;
+
+  // Number of submeshes
+  unsigned n_sub_mesh=Sub_mesh_pt.size();
+  
+  // Classify Global dofs
+  unsigned Nglobal_data = nglobal_data();
+  for(unsigned i=0;i<Nglobal_data;i++)
+   {
+    std::stringstream conversion;
+    conversion <<" in Global Data "<<i<<".";
+    std::string in(conversion.str());
+    Global_data_pt[i]->describe_dofs(out,in);
+   }
+  
+  // Put string in limiting scope.
+  {
+   // Descend into assignment for mesh.
+   std::string in(" in Problem's Only Mesh.");
+   Mesh_pt->describe_dofs(out,in);
+  }
+
+  // Deal with the spine meshes additional numbering:
+  // If there is only one mesh:
+  if(n_sub_mesh==0)
+   {
+    if(SpineMesh* const spine_mesh_pt = dynamic_cast<SpineMesh*>(Mesh_pt))     
+     {
+      std::string in(" in Problem's Only SpineMesh.");
+      spine_mesh_pt->describe_spine_dofs(out,in);
+     }
+   }
+  //Otherwise loop over the sub meshes
+  else
+   {
+    //Assign global equation numbers first
+    for(unsigned i=0;i<n_sub_mesh;i++)
+     {
+      if(SpineMesh* const spine_mesh_pt =
+         dynamic_cast<SpineMesh*>(Sub_mesh_pt[i]))
+       {
+        std::stringstream conversion;
+        conversion <<" in Sub-SpineMesh "<<i<<".";
+        std::string in(conversion.str());
+        spine_mesh_pt->describe_spine_dofs(out,in);
+       }// end if.
+     }// end for.
+   }// end else.
+
+
+  out <<  std::string(80,'\\') << std::endl;
+  out <<  std::string(80,'\\') << std::endl;
+  out <<  std::string(80,'\\') << std::endl;
+  out << "Classifying global eqn numbers in terms of elements." << std::endl;
+  out <<  std::string(80,'-') << std::endl;
+  out << "Eqns   | Source" << std::endl;
+  out << std::string(80,'-') << std::endl;
+
+  if (n_sub_mesh==0)
+   {
+    std::string in(" in Problem's Only Mesh.");
+    Mesh_pt->describe_local_dofs(out,in);
+   }
+  else
+   {
+    for (unsigned i=0;i<n_sub_mesh;i++)
+     {
+       std::stringstream conversion;
+       conversion <<" in Sub-Mesh "<<i<<".";
+       std::string in(conversion.str());
+       Sub_mesh_pt[i]->describe_local_dofs(out,in);
+     }// End for
+   }// End else
+ } // End problem::describe_dofs(...)
+
+
+//================================================================
+/// Get the vector of dofs, i.e. a vector containing the current
+/// values of all unknowns.
+//================================================================
+ void Problem::get_dofs(DoubleVector& dofs) const
+ {
+  //Find number of dofs
+  const unsigned long n_dof = ndof();
+
+  //Resize the vector
+  dofs.build(Dof_distribution_pt,0.0);
+
+  //If the unknowns are stored contiguously copy them directly
+  if (contiguous_dof_storage_is_intact())
+   {
+    const double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt();
+    const unsigned stride=Dof_storage_pool_pt->ntstorage();
+    double* dofs_pt=dofs.values_pt();
+    if (stride==1)
+     {
+      std::memcpy(dofs_pt,dof_storage_pt,n_dof*sizeof(double));
+     }
+    else
+     {
+      for(unsigned long l=0;l<n_dof;l++)
+       {
+        dofs_pt[l] = dof_storage_pt[l*stride];
+       }
+     }
+    return;
+   }
+
+  //If some Data have left the contiguous storage, Dof_pt may still point
+  //into it (until release_contiguous_dof_storage_if_broken() is called),
+  //so get the values from the Data
+  if (Dof_storage_pool_pt!=0)
+   {
+    Vector<Data*> data_pt;
+    get_all_data_with_eqn_numbers(data_pt);
+    const unsigned long first_row=Dof_distribution_pt->first_row();
+    const unsigned long n_data=data_pt.size();
+    for (unsigned long d=0;d<n_data;d++)
+     {
+      if (data_pt[d]->is_a_copy()) {continue;}
+      unsigned n_value=data_pt[d]->nvalue();
+      for (unsigned j=0;j<n_value;j++)
+       {
+        long eqn=data_pt[d]->eqn_number(j);
+        if ((eqn>=long(first_row))&&(eqn<long(first_row+n_dof)))
+         {
+          dofs[eqn-first_row]=data_pt[d]->value(j);
+         }
+       }
+     }
+    return;
+   }
+
+  //Copy dofs into vector
+  for(unsigned long l=0;l<n_dof;l++)
+   {
+    dofs[l] = *Dof_pt[l];
+   }
+ }
+
+ /// Get history values of dofs in a double vector.
+ void Problem::get_dofs(const unsigned& t, DoubleVector& dofs) const
+ {
+#ifdef PARANOID
+  if(distributed())
+   {
+    throw OomphLibError("Not designed for distributed problems",
+                        OOMPH_EXCEPTION_LOCATION,
+                        OOMPH_CURRENT_FUNCTION);
+    // might work, not sure
+   }
+#endif
+
+  // Resize the vector
+  dofs.build(Dof_distribution_pt, 0.0);
+
+  // If the unknowns are stored contiguously copy the history values
+  // directly
+  if (contiguous_dof_storage_is_intact())
+   {
+    const unsigned long n_dof = ndof();
+    const unsigned stride=Dof_storage_pool_pt->ntstorage();
+    const double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt()+t;
+    double* dofs_pt=dofs.values_pt();
+    for(unsigned long l=0;l<n_dof;l++)
+     {
+      dofs_pt[l] = dof_storage_pt[l*stride];
+     }
+    return;
+   }
+
+  // First deal with global data
+  unsigned Nglobal_data = nglobal_data();
+  for(unsigned i=0; i<Nglobal_data; i++)
+   {
+    for(unsigned j=0, nj=Global_data_pt[i]->nvalue(); j<nj; j++)
+     {
+      // For each data get the equation number and copy out the value.
+      int eqn_number = Global_data_pt[i]->eqn_number(j);
+      if(eqn_number >= 0)
+       {
+        dofs[eqn_number] = Global_data_pt[i]->value(t, j);
+       }
+     }
+   }
+
+  // Next element internal data
+  for(unsigned i=0, ni=mesh_pt()->nelement(); i<ni; i++)
+   {
+
+    GeneralisedElement* ele_pt = mesh_pt()->element_pt(i);
+    for(unsigned j=0, nj=ele_pt->ninternal_data(); j<nj; j++)
+     {
 
       Data* d_pt = ele_pt->internal_data_pt(j);
       for(unsigned k=0, nk=d_pt->nvalue(); k<nk; k++)
@@ -3377,6 +4002,29 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
                         OOMPH_EXCEPTION_LOCATION);
    }
 #endif
+
+  release_contiguous_dof_storage_if_broken();
+
+  //If the unknowns are stored contiguously copy them directly
+  if (contiguous_dof_storage_is_intact())
+   {
+    double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt();
+    const unsigned stride=Dof_storage_pool_pt->ntstorage();
+    const double* dofs_pt=dofs.values_pt();
+    if (stride==1)
+     {
+      std::memcpy(dof_storage_pt,dofs_pt,n_dof*sizeof(double));
+     }
+    else
+     {
+      for(unsigned long l=0;l<n_dof;l++)
+       {
+        dof_storage_pt[l*stride] = dofs_pt[l];
+       }
+     }
+    return;
+   }
+
   for(unsigned long l=0;l<n_dof;l++)
    {
     *Dof_pt[l] = dofs[l];
@@ -3396,6 +4044,23 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
    }
 #endif
 
+  release_contiguous_dof_storage_if_broken();
+
+  // If the unknowns are stored contiguously copy the history values
+  // directly
+  if (contiguous_dof_storage_is_intact())
+   {
+    const unsigned long n_dof = ndof();
+    const unsigned stride=Dof_storage_pool_pt->ntstorage();
+    double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt()+t;
+    const double* dofs_pt=dofs.values_pt();
+    for(unsigned long l=0;l<n_dof;l++)
+     {
+      dof_storage_pt[l*stride] = dofs_pt[l];
+     }
+    return;
+   }
+
   // First deal with global data
   unsigned Nglobal_data = nglobal_data();
   for(unsigned i=0; i<Nglobal_data; i++)
@@ -3462,6 +4127,22 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
    }
 #endif
 
+   release_contiguous_dof_storage_if_broken();
+
+   // If the unknowns are stored contiguously copy the history values
+   // directly
+   if (contiguous_dof_storage_is_intact())
+    {
+     const unsigned long n_dof = ndof();
+     const unsigned stride=Dof_storage_pool_pt->ntstorage();
+     double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt()+t;
+     for(unsigned long l=0;l<n_dof;l++)
+      {
+       dof_storage_pt[l*stride] = *(dof_pt[l]);
+      }
+     return;
+    }
+
    // If we have any spine meshes I think there might be more degrees
    // of freedom there. I don't use them though so I'll let someone who
    // knows what they are doing handle it. --David Shepherd
@@ -3523,6 +4204,22 @@ ContinuationStorageScheme Problem::Continuation_time_stepper;
                            const DoubleVector &increment_dofs)
  {
   const unsigned long n_dof = this->ndof();
+
+  release_contiguous_dof_storage_if_broken();
+
+  //If the unknowns are stored contiguously update them directly
+  if (contiguous_dof_storage_is_intact())
+   {
+    double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt();
+    const unsigned stride=Dof_storage_pool_pt->ntstorage();
+    const double* increment_pt=increment_dofs.values_pt();
+    for(unsigned long l=0;l<n_dof;l++)
+     {
+      dof_storage_pt[l*stride] += lambda*increment_pt[l];
+     }
+    return;
+   }
+
   for(unsigned long l=0;l<n_dof;l++)
    {
     *Dof_pt[l] += lambda*increment_dofs[l];
@@ -6747,9 +7444,29 @@ void Problem::parallel_sparse_assemble
   Vector<Vector<double> > el_residuals(n_vector);
   Vector<DenseMatrix<double> > el_jacobian(n_matrix);
 
+  // If a split-phase synchronisation of the dofs is still in progress,
+  // assemble the elements that don't involve any halo data first and
+  // only wait for the halo values before assembling the remaining ones
+  const bool overlap_synchronisation=Dof_synchronisation_in_progress;
+  if (overlap_synchronisation)
+   {
+    setup_overlapped_assembly_element_order(el_lo,el_hi_plus_one);
+   }
+
   //Loop over the elements
-  for(unsigned long e=el_lo;e<el_hi_plus_one;e++)
+  const unsigned long n_el_assembled=el_hi_plus_one-el_lo;
+  for(unsigned long i_el=0;i_el<n_el_assembled;i_el++)
    {
+    unsigned long e=el_lo+i_el;
+    if (overlap_synchronisation)
+     {
+      if (i_el==Noverlapped_assembly_interior_element)
+       {
+        finish_synchronise_all_dofs();
+       }
+      e=Overlapped_assembly_element_order[i_el];
+     }
+
     // Time it?
     if ((!doing_residuals)&&
         Must_recompute_load_balance_for_assembly)
@@ -6971,6 +7688,9 @@ void Problem::parallel_sparse_assemble
       Elemental_assembly_time[e]=TimingHelpers::timer()-t_assemble_start;
      }
    } //End of loop over the elements
+
+  // Complete the synchronisation if all elements were free of halo data
+  finish_synchronise_all_dofs();
  } //End of vector assembly
 
 
@@ -8601,8 +9321,28 @@ void Problem::store_current_dof_values()
      //Resize the vector
      Saved_dof_pt->resize(n_dof);
 
-     //Transfer the values over
-     for(unsigned long n=0;n<n_dof;n++) {(*Saved_dof_pt)[n] = dof(n);}
+     release_contiguous_dof_storage_if_broken();
+
+     //Transfer the values over (directly if they're stored contiguously)
+     if(contiguous_dof_storage_is_intact()&&(n_dof>0))
+      {
+       const double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt();
+       const unsigned stride=Dof_storage_pool_pt->ntstorage();
+       double* saved_pt=&(*Saved_dof_pt)[0];
+       if(stride==1)
+        {
+         std::memcpy(saved_pt,dof_storage_pt,n_dof*sizeof(double));
+        }
+       else
+        {
+         for(unsigned long n=0;n<n_dof;n++) 
+          {saved_pt[n] = dof_storage_pt[n*stride];}
+        }
+      }
+     else
+      {
+       for(unsigned long n=0;n<n_dof;n++) {(*Saved_dof_pt)[n] = dof(n);}
+      }
     }
 }
 
@@ -8659,8 +9399,28 @@ OOMPH_CURRENT_FUNCTION,
         OOMPH_EXCEPTION_LOCATION);
       }
 
-     //Transfer the values over
-     for(unsigned long n=0;n<n_dof;n++) {dof(n) = (*Saved_dof_pt)[n];}
+     release_contiguous_dof_storage_if_broken();
+
+     //Transfer the values over (directly if they're stored contiguously)
+     if(contiguous_dof_storage_is_intact()&&(n_dof>0))
+      {
+       double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt();
+       const unsigned stride=Dof_storage_pool_pt->ntstorage();
+       const double* saved_pt=&(*Saved_dof_pt)[0];
+       if(stride==1)
+        {
+         std::memcpy(dof_storage_pt,saved_pt,n_dof*sizeof(double));
+        }
+       else
+        {
+         for(unsigned long n=0;n<n_dof;n++) 
+          {dof_storage_pt[n*stride] = saved_pt[n];}
+        }
+      }
+     else
+      {
+       for(unsigned long n=0;n<n_dof;n++) {dof(n) = (*Saved_dof_pt)[n];}
+      }
     }
 
    //Delete the memory
@@ -8744,6 +9504,10 @@ OOMPH_CURRENT_FUNCTION,
 void Problem::newton_solve()
 {
 
+ // Make sure that Dof_pt doesn't point into a dof storage pool that
+ // some of the Data have left
+ release_contiguous_dof_storage_if_broken();
+
  // Initialise timers
  double total_linear_solver_time=0.0;
  double t_start = TimingHelpers::timer();
@@ -8989,9 +9753,18 @@ void Problem::newton_solve()
        *Dof_pt[l] -= Relaxation_factor*dx_pt[l];
       }
     }
-#ifdef OOMPH_HAS_MPI
-   // Synchronise the solution on different processors (on each submesh)
-   this->synchronise_all_dofs();
+#ifdef OOMPH_HAS_MPI
+   // Synchronise the solution on different processors (on each submesh).
+   // If requested, only post the exchange here; it is completed while
+   // the residuals for the convergence check are assembled.
+   if (Overlap_dof_synchronisation_with_assembly&&Problem_is_nonlinear)
+    {
+     this->start_synchronise_all_dofs();
+    }
+   else
+    {
+     this->synchronise_all_dofs();
+    }
 #endif
 
    // Do any updates that are required
@@ -11039,36 +11812,102 @@ adaptive_unsteady_newton_solve(const double &dt_desired,
    //Do any updates/boundary conditions changes here
    actions_before_implicit_timestep();
 
-   //Attempt to solve the non-linear system
-   try
-    {
-     //Solve the non-linear problem at this timestep
-     newton_solve();
+   // Decide whether the Jacobian stored from a previous (accepted or
+   // rejected) timestep can be recycled: only if dt hasn't changed
+   // too much since it was assembled and the number of dofs is unchanged
+   bool recycling_jacobian=false;
+   bool user_jacobian_reuse_is_enabled=Jacobian_reuse_is_enabled;
+   Vector<double> dofs_initial_guess;
+   if(Jacobian_reuse_across_timesteps_is_enabled)
+    {
+     if(Jacobian_has_been_computed &&
+        (Ndof_for_stored_jacobian==ndof()) &&
+        (std::fabs(dt_actual-Dt_for_stored_jacobian)<=
+         Max_relative_dt_change_for_jacobian_reuse*Dt_for_stored_jacobian))
+      {
+       recycling_jacobian=true;
+       oomph_info << "Recycling Jacobian assembled with dt = "
+                  << Dt_for_stored_jacobian << std::endl;
+
+       // Backup the initial guess in case the Newton iteration fails
+       // with the recycled Jacobian
+       dofs_initial_guess.resize(n_dof_local);
+       for(unsigned i=0;i<n_dof_local;i++) dofs_initial_guess[i]=dof(i);
+      }
+     else
+      {
+       Jacobian_has_been_computed=false;
+      }
+     Jacobian_reuse_is_enabled=true;
     }
-   //Catch any exceptions thrown
-   catch(NewtonSolverError &error)
+
+   //Attempt to solve the non-linear system
+   bool retry_with_new_jacobian=false;
+   do
     {
-     //If it's a solver error then die
-     if(error.linear_solver_error || Time_adaptive_newton_crash_on_solve_fail)
+     retry_with_new_jacobian=false;
+     try
       {
-       std::string error_message =
-        "USER-DEFINED ERROR IN NEWTON SOLVER\n";
-       error_message +=  "ERROR IN THE LINEAR SOLVER\n";
-
-       //Die
-       throw OomphLibError(error_message,
-                           OOMPH_CURRENT_FUNCTION,
-                           OOMPH_EXCEPTION_LOCATION);
+       //Solve the non-linear problem at this timestep
+       newton_solve();
       }
-     else
+     //Catch any exceptions thrown
+     catch(NewtonSolverError &error)
       {
-       //Reject the timestep, if we have an exception
-       oomph_info << "TIMESTEP REJECTED" << std::endl;
-       reject_timestep=1;
+       // If the Newton iteration failed with a Jacobian recycled from a
+       // previous timestep, try again with a fresh one before rejecting
+       // the timestep
+       if(recycling_jacobian && (!error.linear_solver_error))
+        {
+         oomph_info << "Newton solver failed with recycled Jacobian. "
+                    << "Retrying with new Jacobian." << std::endl;
+         recycling_jacobian=false;
+         retry_with_new_jacobian=true;
+         Jacobian_has_been_computed=false;
+
+         //Reload the initial guess
+         for(unsigned i=0;i<n_dof_local;i++) dof(i)=dofs_initial_guess[i];
+
+#ifdef OOMPH_HAS_MPI
+         // Synchronise the solution on different processors (on each submesh)
+         this->synchronise_all_dofs();
+#endif
+        }
+       //If it's a solver error then die
+       else if(error.linear_solver_error ||
+               Time_adaptive_newton_crash_on_solve_fail)
+        {
+         std::string error_message =
+          "USER-DEFINED ERROR IN NEWTON SOLVER\n";
+         error_message +=  "ERROR IN THE LINEAR SOLVER\n";
+
+         //Die
+         throw OomphLibError(error_message,
+                             OOMPH_CURRENT_FUNCTION,
+                             OOMPH_EXCEPTION_LOCATION);
+        }
+       else
+        {
+         //Reject the timestep, if we have an exception
+         oomph_info << "TIMESTEP REJECTED" << std::endl;
+         reject_timestep=1;
          
-       // Half the time step
-       dt_rescaling_factor = Timestep_reduction_factor_after_nonconvergence;
+         // Half the time step
+         dt_rescaling_factor = Timestep_reduction_factor_after_nonconvergence;
+        }
+      }
+    }
+   while(retry_with_new_jacobian);
+
+   if(Jacobian_reuse_across_timesteps_is_enabled)
+    {
+     // Remember the dt at which a newly assembled Jacobian was computed
+     if((!recycling_jacobian) && Jacobian_has_been_computed)
+      {
+       Dt_for_stored_jacobian=dt_actual;
+       Ndof_for_stored_jacobian=ndof();
       }
+     Jacobian_reuse_is_enabled=user_jacobian_reuse_is_enabled;
     }
 
    // Run the individual timesteppers actions, these need to be before the
@@ -11083,6 +11922,7 @@ adaptive_unsteady_newton_solve(const double &dt_desired,
 
    // If we have an adapative timestepper (and we haven't already failed)
    // then calculate the error estimate and rescaling factor.
+   double error_estimate=-1.0;
    if(adaptive_flag && !reject_timestep)
     {
      //Once timestep has been accepted can do fancy error processing
@@ -11098,10 +11938,11 @@ adaptive_unsteady_newton_solve(const double &dt_desired,
      // but use absolute value just in case.
      double error = std::max(std::abs(global_temporal_error_norm()),
                              1e-12);
+     error_estimate=error;
 
      //Calculate the scaling  factor
-     dt_rescaling_factor = 
-      std::pow((epsilon/error), (1.0/(1.0+time_stepper_pt()->order())));
+     dt_rescaling_factor =
+      timestep_scaling_factor(epsilon,error,time_stepper_pt()->order());
 
      oomph_info << "Timestep scaling factor is  " 
                 << dt_rescaling_factor << std::endl;
@@ -11235,6 +12076,12 @@ adaptive_unsteady_newton_solve(const double &dt_desired,
      actions_after_implicit_timestep();
      actions_after_implicit_timestep_and_error_estimation();
     }
+   // Otherwise update the error history used by the PI/PID controllers
+   else if(error_estimate>0.0)
+    {
+     Second_previous_temporal_error_norm=Previous_temporal_error_norm;
+     Previous_temporal_error_norm=error_estimate;
+    }
 
   }
  //Keep this loop going until we accept the timestep
@@ -11246,6 +12093,48 @@ adaptive_unsteady_newton_solve(const double &dt_desired,
 }
 
 
+//========================================================================
+/// \short Compute the factor by which dt is scaled after a timestep
+/// with error estimate error (target epsilon) has been computed with a
+/// timestepper of the specified order, using the selected controller.
+/// The PI/PID controllers revert to the elementary controller if
+/// the error exceeds the tolerance (i.e. after a rejection) or if there
+/// aren't enough error estimates from previously accepted timesteps.
+//========================================================================
+double Problem::timestep_scaling_factor(const double &epsilon,
+                                        const double &error,
+                                        const unsigned &order)
+{
+ // Exponents are scaled by the order of the local error
+ double scale=1.0/(1.0+double(order));
+
+ // Elementary controller
+ if((Timestep_controller==Elementary_timestep_controller) ||
+    (error>epsilon) || (Previous_temporal_error_norm<=0.0))
+  {
+   return std::pow((epsilon/error),scale);
+  }
+
+ // PI controller
+ double factor=
+  std::pow((epsilon/error),Timestep_controller_integral_gain*scale)*
+  std::pow((Previous_temporal_error_norm/error),
+           Timestep_controller_proportional_gain*scale);
+
+ // Add derivative contribution for PID controller if we can
+ if((Timestep_controller==PID_timestep_controller) &&
+    (Second_previous_temporal_error_norm>0.0))
+  {
+   factor*=std::pow((Previous_temporal_error_norm*
+                     Previous_temporal_error_norm/
+                     (error*Second_previous_temporal_error_norm)),
+                    Timestep_controller_derivative_gain*scale);
+  }
+
+ return factor;
+}
+
+
 
 //=======================================================================
 /// Private helper function to perform
@@ -11665,14 +12554,32 @@ void Problem::calculate_predictions()
                          OOMPH_CURRENT_FUNCTION);
     }
 
-   // Get predicted values
-   DoubleVector predicted_dofs;
-   get_dofs(time_stepper_pt()->predictor_storage_index(), predicted_dofs);
+   release_contiguous_dof_storage_if_broken();
 
-   // Update dofs at current step
-   for(unsigned i=0; i<ndof(); i++)
+   // If the unknowns are stored contiguously copy the predicted 
+   // values directly
+   if(contiguous_dof_storage_is_intact())
+    {
+     const unsigned long n_dof=ndof();
+     const unsigned stride=Dof_storage_pool_pt->ntstorage();
+     const unsigned t_predictor=time_stepper_pt()->predictor_storage_index();
+     double* dof_storage_pt=Dof_storage_pool_pt->dof_storage_pt();
+     for(unsigned long i=0;i<n_dof;i++)
+      {
+       dof_storage_pt[i*stride] = dof_storage_pt[i*stride+t_predictor];
+      }
+    }
+   else
     {
-     dof(i) = predicted_dofs[i];
+     // Get predicted values
+     DoubleVector predicted_dofs;
+     get_dofs(time_stepper_pt()->predictor_storage_index(), predicted_dofs);
+
+     // Update dofs at current step
+     for(unsigned i=0; i<ndof(); i++)
+      {
+       dof(i) = predicted_dofs[i];
+      }
     }
    
   }
@@ -11907,6 +12814,141 @@ Problem* Problem::make_copy()
 
 
 
+//=========================================================================
+/// Helper functions for binary and shared restart files
+//=========================================================================
+namespace BinaryRestartHelpers
+{
+
+ /// \short Version of the binary restart format (written into the
+ /// header of binary restart files)
+ const unsigned Binary_restart_format_version=1;
+
+ /// \short Version of the format of shared (single-file, multi-processor)
+ /// restart files
+ const unsigned Shared_restart_format_version=1;
+
+ /// Tag at the start of the header of binary restart files
+ const std::string Binary_restart_tag="OOMPH_BINARY_RESTART";
+
+ /// Tag at the start of shared restart files
+ const std::string Shared_restart_tag="OOMPH_SHARED_RESTART";
+
+ /// Byte order of this machine ("little" or "big")
+ std::string byte_order()
+ {
+  const unsigned one=1;
+  if (*reinterpret_cast<const unsigned char*>(&one)==1)
+   {
+    return "little";
+   }
+  return "big";
+ }
+
+ /// \short Write a binary block: a text line with the number of 
+ /// unsigneds and doubles, followed by the raw arrays
+ void write_block(std::ofstream& dump_file, const Vector<unsigned>& size,
+                  const Vector<double>& values)
+ {
+  const unsigned long n_size=size.size();
+  const unsigned long n_value=values.size();
+  dump_file << n_size << " " << n_value 
+            << " # binary block: number of unsigneds and doubles" 
+            << std::endl;
+  if (n_size>0)
+   {
+    dump_file.write(reinterpret_cast<const char*>(&size[0]),
+                    n_size*sizeof(unsigned));
+   }
+  if (n_value>0)
+   {
+    dump_file.write(reinterpret_cast<const char*>(&values[0]),
+                    n_value*sizeof(double));
+   }
+  dump_file << std::endl;
+ }
+
+ /// Read a binary block written by write_block(...)
+ void read_block(std::ifstream& restart_file, Vector<unsigned>& size,
+                 Vector<double>& values)
+ {
+  std::string input_string;
+
+  // Read line up to termination sign
+  getline(restart_file,input_string,'#');
+
+  // Ignore rest of line
+  restart_file.ignore(80,'\n');
+
+  unsigned long n_size=0;
+  unsigned long n_value=0;
+  std::istringstream block_header(input_string);
+  block_header >> n_size >> n_value;
+  if (block_header.fail())
+   {
+    throw OomphLibError(
+     "Couldn't read the header of the binary block in the restart file",
+     OOMPH_CURRENT_FUNCTION,
+     OOMPH_EXCEPTION_LOCATION);
+   }
+
+  size.resize(n_size);
+  values.resize(n_value);
+  if (n_size>0)
+   {
+    restart_file.read(reinterpret_cast<char*>(&size[0]),
+                      n_size*sizeof(unsigned));
+   }
+  if (n_value>0)
+   {
+    restart_file.read(reinterpret_cast<char*>(&values[0]),
+                      n_value*sizeof(double));
+   }
+  if (!restart_file.good())
+   {
+    throw OomphLibError(
+     "Binary block in restart file is truncated",
+     OOMPH_CURRENT_FUNCTION,
+     OOMPH_EXCEPTION_LOCATION);
+   }
+
+  // Skip the end of line after the block
+  restart_file.ignore(1,'\n');
+ }
+
+ /// \short Header of a shared restart file with sections of the 
+ /// specified sizes. Offsets and sizes are written with a fixed width
+ /// so that the length of the header only depends on the number of
+ /// sections.
+ std::string shared_file_header(const Vector<unsigned long long>& 
+                                section_size)
+ {
+  const unsigned n_section=section_size.size();
+
+  // Length of the header: First line...
+  std::ostringstream first_line;
+  first_line << Shared_restart_tag << " " << Shared_restart_format_version 
+             << " " << n_section 
+             << " # shared restart file: version and number of sections"
+             << std::endl;
+
+  // ...and one line of two 20-digit numbers per section
+  unsigned long long offset=first_line.str().size()+42*n_section;
+
+  std::ostringstream header;
+  header << first_line.str();
+  for (unsigned p=0;p<n_section;p++)
+   {
+    header << std::setw(20) << std::setfill('0') << offset << " "
+           << std::setw(20) << std::setfill('0') << section_size[p] << "\n";
+    offset+=section_size[p];
+   }
+  return header.str();
+ }
+
+}
+
+
 //=========================================================================
 /// Dump refinement pattern of all refineable meshes and all  generic
 /// Problem data to file for restart.
@@ -11914,6 +12956,18 @@ Problem* Problem::make_copy()
 void Problem::dump(std::ofstream& dump_file) const
 {
 
+ // Header for binary restart files: format version, byte order and
+ // sizes of the binary types
+ if (Binary_restart_is_enabled)
+  {
+   dump_file << BinaryRestartHelpers::Binary_restart_tag << " " 
+             << BinaryRestartHelpers::Binary_restart_format_version << " "
+             << BinaryRestartHelpers::byte_order() << " " 
+             << sizeof(unsigned) << " " << sizeof(double) 
+             << " # binary restart: version, byte order, "
+             << "sizeof(unsigned), sizeof(double)" << std::endl;
+  }
+
  // Number of submeshes?
  unsigned n_mesh=nsub_mesh();
 
@@ -12111,6 +13165,29 @@ void Problem::dump(std::ofstream& dump_file) const
  // Loop over submeshes and dump their data
  unsigned nmesh=nsub_mesh();
  if (nmesh==0) nmesh=1;
+
+ // Number of global data
+ unsigned Nglobal=Global_data_pt.size();
+
+ // Binary restart: Collect the data of all meshes and the global
+ // data and write them as a single block
+ if (Binary_restart_is_enabled)
+  {
+   Vector<unsigned> size;
+   Vector<double> values;
+   for(unsigned m=0;m<nmesh;m++)
+    {
+     mesh_pt(m)->dump_binary(size,values);
+    }
+   size.push_back(Nglobal);
+   for (unsigned iglobal=0;iglobal<Nglobal;iglobal++)
+    {
+     Global_data_pt[iglobal]->dump_binary(size,values);
+    }
+   BinaryRestartHelpers::write_block(dump_file,size,values);
+   return;
+  }
+
  for(unsigned m=0;m<nmesh;m++)
   {
    mesh_pt(m)->dump(dump_file);
@@ -12119,7 +13196,6 @@ void Problem::dump(std::ofstream& dump_file) const
  // Dump global data
 
  // Loop over global data
- unsigned Nglobal=Global_data_pt.size();
  dump_file << Nglobal << " # number of global Data items " << std::endl;
  for (unsigned iglobal=0;iglobal<Nglobal;iglobal++)
   {
@@ -12167,6 +13243,58 @@ void Problem::read(std::ifstream& restart_file, bool& unsteady_restart)
  // Ignore rest of line
  restart_file.ignore(80,'\n');
 
+ // Is this a binary restart file? If so, check the header and move
+ // on to the number of sub-meshes
+ bool binary_restart=false;
+ if (input_string.find(BinaryRestartHelpers::Binary_restart_tag)!=
+     std::string::npos)
+  {
+   binary_restart=true;
+   std::istringstream header(input_string);
+   std::string tag;
+   unsigned version=0;
+   std::string byte_order;
+   unsigned size_of_unsigned=0;
+   unsigned size_of_double=0;
+   header >> tag >> version >> byte_order 
+          >> size_of_unsigned >> size_of_double;
+   if ((version==0)||
+       (version>BinaryRestartHelpers::Binary_restart_format_version))
+    {
+     std::ostringstream error_message;
+     error_message << "Binary restart file has format version " << version
+                   << "; this version of the library can only read\n"
+                   << "versions up to " 
+                   << BinaryRestartHelpers::Binary_restart_format_version
+                   << std::endl;
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+   if ((byte_order!=BinaryRestartHelpers::byte_order())||
+       (size_of_unsigned!=sizeof(unsigned))||
+       (size_of_double!=sizeof(double)))
+    {
+     std::ostringstream error_message;
+     error_message << "Binary restart file was written on a machine with\n"
+                   << "a different byte order or different sizes of the\n"
+                   << "basic types: " << byte_order << " " 
+                   << size_of_unsigned << " " << size_of_double 
+                   << " vs. " << BinaryRestartHelpers::byte_order() << " "
+                   << sizeof(unsigned) << " " << sizeof(double) 
+                   << std::endl;
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+
+   // Read line up to termination sign
+   getline(restart_file,input_string,'#');
+
+   // Ignore rest of line
+   restart_file.ignore(80,'\n');
+  }
+
  // Read in number of sub-meshes
  unsigned n_submesh_read;
  n_submesh_read=std::atoi(input_string.c_str());
@@ -12986,6 +14114,18 @@ void Problem::read(std::ifstream& restart_file, bool& unsteady_restart)
  // in the problem.
  if (unsteady_restart) initialise_dt(dt);
 
+ // Binary restart: Read the block that contains the data of all 
+ // meshes and the global data
+ Vector<unsigned> binary_size;
+ Vector<double> binary_values;
+ unsigned long size_index=0;
+ unsigned long value_index=0;
+ bool binary_storage_mismatch=false;
+ if (binary_restart)
+  {
+   BinaryRestartHelpers::read_block(restart_file,binary_size,binary_values);
+  }
+
  // Loop over submeshes:
  unsigned nmesh=nsub_mesh();
  if (nmesh==0) nmesh=1;
@@ -13035,7 +14175,18 @@ void Problem::read(std::ifstream& restart_file, bool& unsteady_restart)
 //    // End keep this commented out code around to debug restarts
 //    //---------------------------------------------------------
     
-    mesh_pt(m)->read(restart_file);
+    if (binary_restart)
+     {
+      if (mesh_pt(m)->read_binary(binary_size,size_index,
+                                  binary_values,value_index))
+       {
+        binary_storage_mismatch=true;
+       }
+     }
+    else
+     {
+      mesh_pt(m)->read(restart_file);
+     }
    
 #ifdef OOMPH_HAS_TRIANGLE_LIB  
     // Here update the polyline representation if working with
@@ -13053,42 +14204,322 @@ void Problem::read(std::ifstream& restart_file, bool& unsteady_restart)
 
   }
 
- // Read global data:
- //------------------
+ // Read global data:
+ //------------------
+
+ // Number of global data
+ unsigned Nglobal=Global_data_pt.size();
+
+ // Binary restart: Read global data from the block
+ if (binary_restart)
+  {
+   unsigned long check_nglobal=0;
+   if (size_index<binary_size.size())
+    {
+     check_nglobal=binary_size[size_index++];
+    }
+   if (check_nglobal!=Nglobal)
+    {
+     std::ostringstream error_message;
+     error_message << "The number of global data " << Nglobal
+                   << " is not equal to that specified in the input file "
+                   <<   check_nglobal << std::endl;
+
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+   for (unsigned iglobal=0;iglobal<Nglobal;iglobal++)
+    {
+     if (Global_data_pt[iglobal]->read_binary(binary_size,size_index,
+                                              binary_values,value_index))
+      {
+       binary_storage_mismatch=true;
+      }
+    }
+
+   // All entries in the block should have been used up
+   if ((size_index!=binary_size.size())||
+       (value_index!=binary_values.size()))
+    {
+     std::ostringstream error_message;
+     error_message << "Binary restart data does not match the problem: "
+                   << "Used " << size_index << " of " << binary_size.size()
+                   << " structural entries and " << value_index << " of "
+                   << binary_values.size() << " values.\n"
+                   << "Has the problem been set up in the same way as\n"
+                   << "when the restart file was written?\n";
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+
+   // Issue a single warning if any Data did not match its storage
+   if (binary_storage_mismatch)
+    {
+     std::ostringstream warning_stream;
+     warning_stream 
+      << "The number of (history) values in the restart file did not\n"
+      << "match the storage allocated in some Data objects. This is\n"
+      << "expected when an unsteady run is restarted from a steady one\n"
+      << "(or vice versa): Only the current values were used and any\n"
+      << "remaining history values were set to zero; extra values in\n"
+      << "the restart file were ignored.\n";
+     OomphLibWarning(warning_stream.str(),
+                     "Problem::read()",
+                     OOMPH_EXCEPTION_LOCATION);
+    }
+   return;
+  }
+
+ // Read line up to termination sign
+ getline(restart_file,input_string,'#');
+
+ // Ignore rest of line
+ restart_file.ignore(80,'\n');
+
+ // Check # of nodes:
+ unsigned long check_nglobal=atoi(input_string.c_str());
+
+
+ if (restart_file_is_open)
+  {
+   if (check_nglobal!=Nglobal)
+    {
+     std::ostringstream error_message;
+     error_message << "The number of global data " << Nglobal
+                   << " is not equal to that specified in the input file "
+                   <<   check_nglobal << std::endl;
+
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+
+ for (unsigned iglobal=0;iglobal<Nglobal;iglobal++)
+  {
+   Global_data_pt[iglobal]->read(restart_file);
+  }
+ 
+}
+
+//=========================================================================
+/// Dump the problem for restart into a single file that is shared by 
+/// all processors. Each processor's restart data is written (by
+/// the possibly overloaded dump(std::ofstream&)) into memory, and
+/// all processors then write their sections concurrently with MPI-IO.
+//=========================================================================
+void Problem::dump_to_shared_file(const std::string &dump_file_name) const
+{
+ // Write this processor's restart data into memory: The file stream
+ // is never opened; its stream buffer is replaced by a string buffer
+ // so that dump(std::ofstream&) can be used unchanged.
+ std::stringbuf section_buffer(std::ios_base::out|std::ios_base::binary);
+ std::ofstream section_stream;
+ section_stream.std::ios::rdbuf(&section_buffer);
+ dump(section_stream);
+ const std::string section=section_buffer.str();
+ unsigned long long my_section_size=section.size();
+
+ // Gather the sizes of all sections
+#ifdef OOMPH_HAS_MPI
+ const int n_proc=this->communicator_pt()->nproc();
+ const int my_rank=this->communicator_pt()->my_rank();
+ Vector<unsigned long long> section_size(n_proc);
+ MPI_Allgather(&my_section_size,1,MPI_UNSIGNED_LONG_LONG,
+               &section_size[0],1,MPI_UNSIGNED_LONG_LONG,
+               this->communicator_pt()->mpi_comm());
+#else
+ Vector<unsigned long long> section_size(1,my_section_size);
+#endif
+
+ // The header (identical on all processors)
+ const std::string header=
+  BinaryRestartHelpers::shared_file_header(section_size);
+
+#ifdef OOMPH_HAS_MPI
+
+ // Offset of this processor's section
+ unsigned long long my_offset=header.size();
+ for (int p=0;p<my_rank;p++)
+  {
+   my_offset+=section_size[p];
+  }
+
+ // Open (and truncate) the file collectively
+ MPI_File file_handle;
+ int err=MPI_File_open(this->communicator_pt()->mpi_comm(),
+                       const_cast<char*>(dump_file_name.c_str()),
+                       MPI_MODE_CREATE|MPI_MODE_WRONLY,
+                       MPI_INFO_NULL,&file_handle);
+
+ // The open may have failed on some processors only: Agree on the 
+ // outcome before anybody throws, otherwise the others would wait 
+ // forever in the (collective) calls below. (Processors that did open
+ // the file can't close it either because closing is collective too.)
+ int local_error=(err!=MPI_SUCCESS);
+ int global_error=0;
+ MPI_Allreduce(&local_error,&global_error,1,MPI_INT,MPI_MAX,
+               this->communicator_pt()->mpi_comm());
+ if (global_error!=0)
+  {
+   std::string error_message="Couldn't open file "+dump_file_name;
+   if (local_error==0) 
+    {
+     error_message+=" on (at least) one of the other processors";
+    }
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ MPI_File_set_size(file_handle,0);
+
+ // Root writes the header; everybody writes their own section
+ // (in chunks, since MPI counts are ints)
+ const unsigned long long max_chunk=1<<30;
+ local_error=0;
+ for (unsigned i=0;(i<2)&&(local_error==0);i++)
+  {
+   const char* buffer_pt=section.data();
+   unsigned long long n_byte=my_section_size;
+   unsigned long long offset=my_offset;
+   if (i==0)
+    {
+     if (my_rank!=0) continue;
+     buffer_pt=header.data();
+     n_byte=header.size();
+     offset=0;
+    }
+   unsigned long long n_written=0;
+   while (n_written<n_byte)
+    {
+     int n_chunk=int(std::min(max_chunk,n_byte-n_written));
+     MPI_Status status;
+     err=MPI_File_write_at(file_handle,MPI_Offset(offset+n_written),
+                           const_cast<char*>(buffer_pt+n_written),
+                           n_chunk,MPI_CHAR,&status);
+     if (err!=MPI_SUCCESS)
+      {
+       local_error=1;
+       break;
+      }
+     n_written+=n_chunk;
+    }
+  }
+
+ // Close the file (collectively) before anybody throws
+ MPI_Allreduce(&local_error,&global_error,1,MPI_INT,MPI_MAX,
+               this->communicator_pt()->mpi_comm());
+ MPI_File_close(&file_handle);
+ if (global_error!=0)
+  {
+   std::string error_message="Couldn't write to file "+dump_file_name;
+   if (local_error==0) 
+    {
+     error_message+=" on (at least) one of the other processors";
+    }
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+
+#else
 
- // Number of global data
- unsigned Nglobal=Global_data_pt.size();
+ std::ofstream dump_stream(dump_file_name.c_str(),
+                           std::ios_base::out|std::ios_base::binary);
+ if (!dump_stream.is_open())
+  {
+   std::string error_message="Couldn't open file "+dump_file_name;
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ dump_stream.write(header.data(),header.size());
+ dump_stream.write(section.data(),section.size());
 
- // Read line up to termination sign
- getline(restart_file,input_string,'#');
+#endif
+}
 
- // Ignore rest of line
- restart_file.ignore(80,'\n');
+//=========================================================================
+/// Read the problem from a restart file written by 
+/// dump_to_shared_file(...): Each processor positions the stream at
+/// the start of its own section and reads it with read(...).
+/// Processors for which there is no section (because the run is 
+/// restarted on a larger number of processors) pass a closed stream,
+/// exactly as if their per-processor restart file did not exist.
+//=========================================================================
+void Problem::read_from_shared_file(const std::string &restart_file_name,
+                                    bool& unsteady_restart)
+{
+ std::ifstream restart_file(restart_file_name.c_str(),
+                            std::ios_base::in|std::ios_base::binary);
+ if (!restart_file.is_open())
+  {
+   std::string error_message="Couldn't open file "+restart_file_name;
+   throw OomphLibError(error_message,
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
 
- // Check # of nodes:
- unsigned long check_nglobal=atoi(input_string.c_str());
+ // Read the header
+ std::string input_string;
+ getline(restart_file,input_string,'#');
+ restart_file.ignore(80,'\n');
+ std::istringstream header(input_string);
+ std::string tag;
+ unsigned version=0;
+ unsigned n_section=0;
+ header >> tag >> version >> n_section;
+ if ((tag!=BinaryRestartHelpers::Shared_restart_tag)||(version==0)||
+     (version>BinaryRestartHelpers::Shared_restart_format_version))
+  {
+   std::ostringstream error_message;
+   error_message << "File " << restart_file_name 
+                 << " is not a shared restart file that can be read by\n"
+                 << "this version of the library (tag: " << tag 
+                 << "; version " << version << ")" << std::endl;
+   throw OomphLibError(error_message.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+ Vector<unsigned long long> section_offset(n_section);
+ for (unsigned p=0;p<n_section;p++)
+  {
+   unsigned long long section_size=0;
+   restart_file >> section_offset[p] >> section_size;
+  }
 
+ int n_proc=1;
+ int my_rank=0;
+#ifdef OOMPH_HAS_MPI
+ n_proc=this->communicator_pt()->nproc();
+ my_rank=this->communicator_pt()->my_rank();
+#endif
 
- if (restart_file_is_open)
+ if (int(n_section)>n_proc)
   {
-   if (check_nglobal!=Nglobal)
-    {
-     std::ostringstream error_message;
-     error_message << "The number of global data " << Nglobal
-                   << " is not equal to that specified in the input file "
-                   <<   check_nglobal << std::endl;
-
-     throw OomphLibError(error_message.str(),
-                         OOMPH_CURRENT_FUNCTION,
-                         OOMPH_EXCEPTION_LOCATION);
-    }
+   std::ostringstream error_message;
+   error_message << "Shared restart file " << restart_file_name 
+                 << " was written on " << n_section << " processors;\n"
+                 << "it cannot be read on fewer (" << n_proc 
+                 << ") processors." << std::endl;
+   throw OomphLibError(error_message.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
   }
 
- for (unsigned iglobal=0;iglobal<Nglobal;iglobal++)
+ // Go to our section, or close the file if we don't have one
+ if (my_rank<int(n_section))
   {
-   Global_data_pt[iglobal]->read(restart_file);
+   restart_file.seekg(std::streamoff(section_offset[my_rank]));
   }
- 
+ else
+  {
+   restart_file.close();
+  }
+
+ read(restart_file,unsteady_restart);
 }
 
 //===================================================================
@@ -13846,6 +15277,10 @@ void Problem::adapt(unsigned &n_refined, unsigned &n_unrefined)
    t_start=TimingHelpers::timer();
   }
 
+ // Make sure that Dof_pt doesn't point into a dof storage pool that
+ // some of the Data have left
+ release_contiguous_dof_storage_if_broken();
+
  //Call the actions before adaptation
  actions_before_adapt();
 
@@ -14144,6 +15579,10 @@ void Problem::p_adapt(unsigned &n_refined, unsigned &n_unrefined)
    t_start=TimingHelpers::timer();
   }
 
+ // Make sure that Dof_pt doesn't point into a dof storage pool that
+ // some of the Data have left
+ release_contiguous_dof_storage_if_broken();
+
  //Call the actions before adaptation
  actions_before_adapt();
 
@@ -14421,6 +15860,10 @@ void Problem::adapt_based_on_error_estimates(unsigned &n_refined,
  oomph_info << "Adapting problem:" << std::endl;
  oomph_info << "=================" << std::endl;
 
+ // Make sure that Dof_pt doesn't point into a dof storage pool that
+ // some of the Data have left
+ release_contiguous_dof_storage_if_broken();
+
  //Call the actions before adaptation
  actions_before_adapt();
 
@@ -16401,6 +17844,9 @@ void Problem::check_halo_schemes(DocInfo& doc_info)
 //========================================================================
 void Problem::synchronise_all_dofs()
 {
+ // Complete any split-phase synchronisation that is still in progress
+ finish_synchronise_all_dofs();
+
  // Synchronise dofs themselves
  bool do_halos=true;
  bool do_external_halos=false;
@@ -16416,233 +17862,652 @@ void Problem::synchronise_all_dofs()
 }
 
 
+//========================================================================
+/// Split-phase version of synchronise_all_dofs(): Post the exchange
+/// of the halo values and return immediately. The synchronisation is
+/// completed by finish_synchronise_all_dofs().
+//========================================================================
+void Problem::start_synchronise_all_dofs()
+{
+ // A non-default assembly handler may have to synchronise its own
+ // data (which is likely to affect all elements) so there's nothing
+ // to overlap the exchange with
+ if (this->assembly_handler_pt()!=Default_assembly_handler_pt)
+  {
+   synchronise_all_dofs();
+   return;
+  }
+
+ // Complete any previous split-phase synchronisation first
+ finish_synchronise_all_dofs();
+
+ // Nothing to be done on a single processor
+ if (this->communicator_pt()->nproc()==1) {return;}
+
+ // Post the exchange of the halo values
+ bool do_halos=true;
+ bool do_external_halos=false;
+ start_synchronise_dofs(do_halos,do_external_halos);
+
+ // The default assembly handler doesn't need any synchronisation
+ // but call it for consistency with synchronise_all_dofs()
+ this->assembly_handler_pt()->synchronise();
+
+ Dof_synchronisation_in_progress=true;
+}
+
+
+//========================================================================
+/// Complete the synchronisation started by start_synchronise_all_dofs()
+//========================================================================
+void Problem::finish_synchronise_all_dofs()
+{
+ if (!Dof_synchronisation_in_progress) {return;}
+ Dof_synchronisation_in_progress=false;
+
+ // Overwrite the halo values
+ bool do_halos=true;
+ bool do_external_halos=false;
+ finish_synchronise_dofs(do_halos,do_external_halos);
+
+ // The external halo data may have been copied from halo data on the
+ // processor that holds their non-halo counterparts, so they can only
+ // be synchronised now
+ do_halos=false;
+ do_external_halos=true;
+ this->synchronise_dofs(do_halos,do_external_halos);
+}
+
+
+//========================================================================
+/// Synchronise the degrees of freedom by overwriting
+/// the haloed values with their non-halo counterparts held
+/// on other processors. Bools control if we deal with data associated with
+ /// external halo/ed elements/nodes or the "normal" halo/ed ones.
+//========================================================================
+void Problem::synchronise_dofs(const bool& do_halos,
+                               const bool& do_external_halos)
+{
+ start_synchronise_dofs(do_halos,do_external_halos);
+ finish_synchronise_dofs(do_halos,do_external_halos);
+}
+
+
+//========================================================================
+/// Split-phase version of synchronise_dofs(...): Pack the haloed values
+/// and post the (persistent) point-to-point exchange with all processors
+/// that share data with this one. The communication pattern is set up
+/// during the first call and re-used until the equations are renumbered.
+//========================================================================
+void Problem::start_synchronise_dofs(const bool& do_halos,
+                                     const bool& do_external_halos)
+{
+ // Local storage for number of processors and current processor
+ const int n_proc=this->communicator_pt()->nproc();
+
+ //If only one processor (or nothing to do) then return
+ if ((n_proc==1)||((!do_halos)&&(!do_external_halos))) {return;}
+
+ const int my_rank=this->communicator_pt()->my_rank();
+
+ const unsigned index=
+  dof_synchronisation_scheme_index(do_halos,do_external_halos);
+
+ // Complete any previous exchange based on the same communication pattern
+ finish_synchronise_dofs(do_halos,do_external_halos);
+
+ DofSynchronisationScheme* scheme_pt=Dof_synchronisation_scheme_pt[index];
+
+ // Set up the communication pattern from the values that are to be
+ // sent during this synchronisation
+ if (scheme_pt==0)
+  {
+   Vector<Vector<double> > send_data(n_proc);
+   for (int rank=0;rank<n_proc;rank++)
+    {
+     if (rank!=my_rank)
+      {
+       add_dof_synchronisation_data_to_vector(do_halos,do_external_halos,
+                                              rank,send_data[rank]);
+      }
+    }
+   int tag=31+index;
+   scheme_pt=new DofSynchronisationScheme(this->communicator_pt(),
+                                          tag,send_data);
+   Dof_synchronisation_scheme_pt[index]=scheme_pt;
+  }
+ // Otherwise re-pack the values into the existing send buffers
+ else
+  {
+   for (int rank=0;rank<n_proc;rank++)
+    {
+     if (rank!=my_rank)
+      {
+       Vector<double>& send_data=scheme_pt->send_data(rank);
+       send_data.clear();
+       add_dof_synchronisation_data_to_vector(do_halos,do_external_halos,
+                                              rank,send_data);
+      }
+    }
+  }
+
+ // Post the sends and receives
+ scheme_pt->start();
+}
+
+
+//========================================================================
+/// Complete the exchange posted by start_synchronise_dofs(...) and use
+/// the received values to overwrite the halo (or external halo) values.
+//========================================================================
+void Problem::finish_synchronise_dofs(const bool& do_halos,
+                                      const bool& do_external_halos)
+{
+ // Local storage for number of processors and current processor
+ const int n_proc=this->communicator_pt()->nproc();
+
+ //If only one processor (or nothing to do) then return
+ if ((n_proc==1)||((!do_halos)&&(!do_external_halos))) {return;}
+
+ const int my_rank=this->communicator_pt()->my_rank();
+
+ DofSynchronisationScheme* scheme_pt=Dof_synchronisation_scheme_pt[
+  dof_synchronisation_scheme_index(do_halos,do_external_halos)];
+
+ // Is there anything to complete?
+ if ((scheme_pt==0)||(!scheme_pt->exchange_in_progress())) {return;}
+
+ // Wait for all messages
+ scheme_pt->wait();
+
+ //Now use the received data to update the halo nodes
+ for (int send_rank=0;send_rank<n_proc;send_rank++)
+  {
+   //Don't bother to do anything for the processor corresponding to the
+   //current processor or if no data were received from this processor
+   if((send_rank != my_rank) && (scheme_pt->nreceive(send_rank) != 0))
+    {
+     read_dof_synchronisation_data_from_vector(
+      do_halos,do_external_halos,send_rank,
+      scheme_pt->receive_data(send_rank));
+    }
+  }
+} //End of synchronise
+
+
+//========================================================================
+/// Add the haloed (or external haloed) values whose halo counterparts
+/// live on processor rank to send_data (all submeshes, in the order in
+/// which they are read by read_dof_synchronisation_data_from_vector(...)
+/// on the receiving processor).
+//========================================================================
+void Problem::add_dof_synchronisation_data_to_vector(
+ const bool& do_halos, const bool& do_external_halos, const int& rank,
+ Vector<double>& send_data)
+{
+ // Do we have submeshes?
+ unsigned n_mesh_loop=1;
+ unsigned nmesh=nsub_mesh();
+ if (nmesh>0)
+  {
+   n_mesh_loop=nmesh;
+  }
+
+ // Deal with sub-meshes one-by-one if required
+ Mesh* my_mesh_pt=0;
+
+ // Loop over submeshes
+ for (unsigned imesh=0;imesh<n_mesh_loop;imesh++)
+  {
+   if (nmesh==0)
+    {
+     my_mesh_pt=mesh_pt();
+    }
+   else
+    {
+     my_mesh_pt=mesh_pt(imesh);
+    }
+
+   if (do_halos)
+    {
+     // How many of my nodes are haloed by the processor whose values
+     // are updated?
+     unsigned n_nod=my_mesh_pt->nhaloed_node(rank);
+     for (unsigned n=0;n<n_nod;n++)
+      {
+       //Add the data for each haloed node to the vector
+       my_mesh_pt->haloed_node_pt(rank,n)->add_values_to_vector(send_data);
+      }
+
+     // Now loop over haloed elements and prepare to add their
+     // internal data to the big vector to be sent
+     Vector<GeneralisedElement*>
+      haloed_elem_pt=my_mesh_pt->haloed_element_pt(rank);
+     unsigned nelem_haloed=haloed_elem_pt.size();
+     for (unsigned e=0; e<nelem_haloed; e++)
+      {
+       haloed_elem_pt[e]->
+        add_internal_data_values_to_vector(send_data);
+      }
+    }
+
+   if (do_external_halos)
+    {
+     // How many of my nodes are externally haloed by the processor whose
+     // values are updated?  NB these nodes are on the external mesh.
+     unsigned n_ext_nod=my_mesh_pt->nexternal_haloed_node(rank);
+     for (unsigned n=0;n<n_ext_nod;n++)
+      {
+       //Add data from each external haloed node to the vector
+       my_mesh_pt->external_haloed_node_pt(rank,n)->
+        add_values_to_vector(send_data);
+      }
+
+     // Now loop over haloed elements and prepare to send internal data
+     unsigned next_elem_haloed=my_mesh_pt->nexternal_haloed_element(rank);
+     for (unsigned e=0; e<next_elem_haloed; e++)
+      {
+       my_mesh_pt->external_haloed_element_pt(rank,e)->
+        add_internal_data_values_to_vector(send_data);
+      }
+    }
+  } // end of loop over meshes
+}
+
+
+//========================================================================
+/// Overwrite the halo (or external halo) values whose non-halo
+/// counterparts live on processor rank with the values received from it.
+//========================================================================
+void Problem::read_dof_synchronisation_data_from_vector(
+ const bool& do_halos, const bool& do_external_halos, const int& rank,
+ const Vector<double>& receive_data)
+{
+ // Do we have submeshes?
+ unsigned n_mesh_loop=1;
+ unsigned nmesh=nsub_mesh();
+ if (nmesh>0)
+  {
+   n_mesh_loop=nmesh;
+  }
+
+ //Counter for the data within the array
+ unsigned count=0;
+
+ // Deal with sub-meshes one-by-one if required
+ Mesh* my_mesh_pt=0;
+
+ // Loop over submeshes
+ for (unsigned imesh=0;imesh<n_mesh_loop;imesh++)
+  {
+   if (nmesh==0)
+    {
+     my_mesh_pt=mesh_pt();
+    }
+   else
+    {
+     my_mesh_pt=mesh_pt(imesh);
+    }
+
+   if (do_halos)
+    {
+     // How many of my nodes are halos whose non-halo counter
+     // parts live on processor rank?
+     unsigned n_nod=my_mesh_pt->nhalo_node(rank);
+     for (unsigned n=0;n<n_nod;n++)
+      {
+       //Read in values for each halo node
+       my_mesh_pt->halo_node_pt(rank,n)->
+        read_values_from_vector(receive_data,count);
+      }
+
+     // Get number of halo elements whose non-halo is
+     // on process rank
+     Vector<GeneralisedElement*> halo_elem_pt=my_mesh_pt->
+      halo_element_pt(rank);
+
+     unsigned nelem_halo=halo_elem_pt.size();
+     for (unsigned e=0;e<nelem_halo;e++)
+      {
+       halo_elem_pt[e]->
+        read_internal_data_values_from_vector(receive_data,count);
+      }
+    }
+
+   if (do_external_halos)
+    {
+     // How many of my nodes are external halos whose external non-halo
+     // counterparts live on processor rank?
+     unsigned n_ext_nod=my_mesh_pt->nexternal_halo_node(rank);
+
+     // Copy into the values of the external halo nodes
+     // on the present processors
+     for (unsigned n=0;n<n_ext_nod;n++)
+      {
+       //Read the data from the array into each halo node
+       my_mesh_pt->external_halo_node_pt(rank,n)->
+        read_values_from_vector(receive_data,count);
+      }
+
+     // Get number of halo elements whose non-halo is
+     // on process rank
+     unsigned next_elem_halo=my_mesh_pt->nexternal_halo_element(rank);
+     for (unsigned e=0;e<next_elem_halo;e++)
+      {
+       my_mesh_pt->external_halo_element_pt(rank,e)->
+        read_internal_data_values_from_vector(receive_data,count);
+      }
+    }
+
+  } // end of loop over meshes
+
+ // The halo scheme must not have changed since the communication
+ // pattern was set up
+ if (count!=receive_data.size())
+  {
+   std::ostringstream error_stream;
+   error_stream
+    << "Read " << count << " values during the synchronisation of the\n"
+    << "dofs but received " << receive_data.size() << " values from "
+    << "processor " << rank << ".\n"
+    << "The halo scheme appears to have changed since the equations were\n"
+    << "last numbered; call Problem::flush_dof_synchronisation_schemes()\n"
+    << "(on all processors) after changing the halo scheme.\n";
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
+}
+
 
 //========================================================================
-/// Synchronise the degrees of freedom by overwriting
-/// the haloed values with their non-halo counterparts held
-/// on other processors. Bools control if we deal with data associated with
- /// external halo/ed elements/nodes or the "normal" halo/ed ones.
+/// Flush the persistent communication patterns used to synchronise
+/// the dofs. Any synchronisation started by start_synchronise_all_dofs()
+/// is completed first so that its values aren't lost.
 //========================================================================
-void Problem::synchronise_dofs(const bool& do_halos,
-                               const bool& do_external_halos)
+void Problem::flush_dof_synchronisation_schemes()
 {
- // Do we have submeshes?
- unsigned n_mesh_loop=1;
- unsigned nmesh=nsub_mesh();
- if (nmesh>0)
+ finish_synchronise_all_dofs();
+ unsigned n_scheme=Dof_synchronisation_scheme_pt.size();
+ for (unsigned i=0;i<n_scheme;i++)
   {
-   n_mesh_loop=nmesh;
+   delete Dof_synchronisation_scheme_pt[i];
+   Dof_synchronisation_scheme_pt[i]=0;
   }
 
- // Local storage for number of processors and current processor
- const int n_proc=this->communicator_pt()->nproc();
-
- //If only one processor then return
- if(n_proc==1) {return;}
-
- const int my_rank=this->communicator_pt()->my_rank();
+ // The classification of the elements for overlapped assembly may
+ // be out of date too
+ Overlapped_assembly_element_order.clear();
+ Noverlapped_assembly_interior_element=0;
+ Overlapped_assembly_el_lo=0;
+ Overlapped_assembly_el_hi_plus_one=0;
+}
 
- // Storage for number of data to be sent to each processor
- Vector<int> send_n(n_proc,0);
 
- // Storage for all values to be sent to all processors
- Vector<double> send_data;
+//========================================================================
+/// Does the assembly of the element involve any halo (or external
+/// halo) data, i.e. values that are only up to date once the
+/// synchronisation of the dofs has been completed?
+//========================================================================
+bool Problem::element_involves_halo_data(
+ GeneralisedElement* const& elem_pt) const
+{
+ // Internal and external Data
+ unsigned n_internal=elem_pt->ninternal_data();
+ for (unsigned i=0;i<n_internal;i++)
+  {
+   if (elem_pt->internal_data_pt(i)->is_halo()) {return true;}
+  }
+ unsigned n_external=elem_pt->nexternal_data();
+ for (unsigned i=0;i<n_external;i++)
+  {
+   if (elem_pt->external_data_pt(i)->is_halo()) {return true;}
+  }
 
- // Start location within send_data for data to be sent to each processor
- Vector<int> send_displacement(n_proc,0);
+ // Multi-domain interactions may involve external halo data that
+ // isn't necessarily flagged as such
+ if (dynamic_cast<ElementWithExternalElement*>(elem_pt)!=0) {return true;}
 
- // Loop over all processors
- for(int rank=0;rank<n_proc;rank++)
+ FiniteElement* fe_pt=dynamic_cast<FiniteElement*>(elem_pt);
+ if (fe_pt!=0)
   {
-   //Set the offset for the current processor
-   send_displacement[rank] = send_data.size();
-
-   //Don't bother to do anything if the processor in the loop is the
-   //current processor
-   if(rank!=my_rank)
+   // Nodes (including the master nodes of any hanging nodes)
+   unsigned n_node=fe_pt->nnode();
+   for (unsigned j=0;j<n_node;j++)
     {
-     // Deal with sub-meshes one-by-one if required
-     Mesh* my_mesh_pt=0;
-
-     // Loop over submeshes
-     for (unsigned imesh=0;imesh<n_mesh_loop;imesh++)
+     Node* nod_pt=fe_pt->node_pt(j);
+     if (nod_pt->is_halo()) {return true;}
+     int n_value=nod_pt->nvalue();
+     for (int i=-1;i<n_value;i++)
       {
-       if (nmesh==0)
-        {
-         my_mesh_pt=mesh_pt();
-        }
-       else
-        {
-         my_mesh_pt=mesh_pt(imesh);
-        }
-
-       if (do_halos)
+       if (nod_pt->is_hanging(i))
         {
-         // How many of my nodes are haloed by the processor whose values
-         // are updated?
-         unsigned n_nod=my_mesh_pt->nhaloed_node(rank);
-         for (unsigned n=0;n<n_nod;n++)
+         HangInfo* const hang_pt=nod_pt->hanging_pt(i);
+         unsigned n_master=hang_pt->nmaster();
+         for (unsigned m=0;m<n_master;m++)
           {
-           //Add the data for each haloed node to the vector
-           my_mesh_pt->haloed_node_pt(rank,n)->add_values_to_vector(send_data);
-          }
-
-         // Now loop over haloed elements and prepare to add their
-         // internal data to the big vector to be sent
-         Vector<GeneralisedElement*>
-          haloed_elem_pt=my_mesh_pt->haloed_element_pt(rank);
-         unsigned nelem_haloed=haloed_elem_pt.size();
-         for (unsigned e=0; e<nelem_haloed; e++)
-          {
-           haloed_elem_pt[e]->
-            add_internal_data_values_to_vector(send_data);
+           if (hang_pt->master_node_pt(m)->is_halo()) {return true;}
           }
         }
+      }
+    }
 
-       if (do_external_halos)
-        {
-         // How many of my nodes are externally haloed by the processor whose
-         // values are updated?  NB these nodes are on the external mesh.
-         unsigned n_ext_nod=my_mesh_pt->nexternal_haloed_node(rank);
-         for (unsigned n=0;n<n_ext_nod;n++)
-          {
-           //Add data from each external haloed node to the vector
-           my_mesh_pt->external_haloed_node_pt(rank,n)->
-            add_values_to_vector(send_data);
-          }
+   // Geometric Data that determine the nodal positions
+   ElementWithMovingNodes* moving_el_pt=
+    dynamic_cast<ElementWithMovingNodes*>(elem_pt);
+   if (moving_el_pt!=0)
+    {
+     unsigned n_geom_data=moving_el_pt->ngeom_data();
+     for (unsigned i=0;i<n_geom_data;i++)
+      {
+       if (moving_el_pt->geom_data_pt(i)->is_halo()) {return true;}
+      }
+    }
+  }
 
-         // Now loop over haloed elements and prepare to send internal data
-         unsigned next_elem_haloed=my_mesh_pt->nexternal_haloed_element(rank);
-         for (unsigned e=0; e<next_elem_haloed; e++)
-          {
-           my_mesh_pt->external_haloed_element_pt(rank,e)->
-            add_internal_data_values_to_vector(send_data);
-          }
-        }
-      } // end of loop over meshes
+ return false;
+}
 
-    }
 
-   //Find the number of data added to the vector
-   send_n[rank] = send_data.size() - send_displacement[rank];
+//========================================================================
+/// Set up the order in which parallel_sparse_assemble(...) visits the
+/// elements el_lo,...,el_hi_plus_one-1 while a synchronisation of the
+/// dofs is in progress: elements that don't involve any halo data first
+/// (in their original order), followed by the remaining ones.
+//========================================================================
+void Problem::setup_overlapped_assembly_element_order(
+ const unsigned long& el_lo, const unsigned long& el_hi_plus_one)
+{
+ // Still up to date?
+ if ((Overlapped_assembly_el_lo==el_lo)&&
+     (Overlapped_assembly_el_hi_plus_one==el_hi_plus_one)&&
+     (Overlapped_assembly_element_order.size()==el_hi_plus_one-el_lo))
+  {
+   return;
+  }
+
+ Overlapped_assembly_element_order.clear();
+ Overlapped_assembly_element_order.reserve(el_hi_plus_one-el_lo);
+ Vector<unsigned long> boundary_element;
+ for (unsigned long e=el_lo;e<el_hi_plus_one;e++)
+  {
+   GeneralisedElement* elem_pt=mesh_pt()->element_pt(e);
 
+   // Halo elements are skipped during the assembly anyway
+   if ((!elem_pt->is_halo())&&element_involves_halo_data(elem_pt))
+    {
+     boundary_element.push_back(e);
+    }
+   else
+    {
+     Overlapped_assembly_element_order.push_back(e);
+    }
+  }
+ Noverlapped_assembly_interior_element=
+  Overlapped_assembly_element_order.size();
+ unsigned long n_boundary=boundary_element.size();
+ for (unsigned long e=0;e<n_boundary;e++)
+  {
+   Overlapped_assembly_element_order.push_back(boundary_element[e]);
   }
 
+ Overlapped_assembly_el_lo=el_lo;
+ Overlapped_assembly_el_hi_plus_one=el_hi_plus_one;
+}
+
+
+//========================================================================
+/// Constructor: Take over the packed send buffers, exchange the
+/// number of values to be sent with all processors and set up the
+/// persistent requests.
+//========================================================================
+DofSynchronisationScheme::DofSynchronisationScheme(
+ OomphCommunicator* const& comm_pt, const int& tag,
+ Vector<Vector<double> >& send_data) : Comm(comm_pt->mpi_comm()),
+ Exchange_in_progress(false)
+{
+ const int n_proc=comm_pt->nproc();
+
+ // Take over the send buffers
+ Send_data.resize(n_proc);
+ Nsend.resize(n_proc,0);
+ Send_data_pt.resize(n_proc,0);
+ Vector<int> send_n(n_proc,0);
+ for (int rank=0;rank<n_proc;rank++)
+  {
+   Send_data[rank].swap(send_data[rank]);
+   Nsend[rank]=Send_data[rank].size();
+   send_n[rank]=Nsend[rank];
+  }
+ send_data.clear();
 
  //Storage for the number of data to be received from each processor
  Vector<int> receive_n(n_proc,0);
 
  //Now send numbers of data to be sent between all processors
  MPI_Alltoall(&send_n[0],1,MPI_INT,&receive_n[0],1,MPI_INT,
-              this->communicator_pt()->mpi_comm());
+              comm_pt->mpi_comm());
 
- //We now prepare the data to be received
- //by working out the displacements from the received data
- Vector<int> receive_displacement(n_proc,0);
- int receive_data_count=0;
- for(int rank=0;rank<n_proc;++rank)
+ // Set up the persistent receives and sends
+ Receive_data.resize(n_proc);
+ for (int rank=0;rank<n_proc;rank++)
   {
-   //Displacement is number of data received so far
-   receive_displacement[rank] = receive_data_count;
-   receive_data_count += receive_n[rank];
+   if (receive_n[rank]!=0)
+    {
+     Receive_data[rank].resize(receive_n[rank]);
+     MPI_Request request;
+     MPI_Recv_init(&Receive_data[rank][0],receive_n[rank],MPI_DOUBLE,
+                   rank,tag,comm_pt->mpi_comm(),&request);
+     Request.push_back(request);
+    }
   }
-
- //Now resize the receive buffer for all data from all processors
- //Make sure that it has a size of at least one
- if(receive_data_count==0) {++receive_data_count;}
- Vector<double> receive_data(receive_data_count);
-
- //Make sure that the send buffer has size at least one
- //so that we don't get a segmentation fault
- if(send_data.size()==0) {send_data.resize(1);}
-
- //Now send the data between all the processors
- MPI_Alltoallv(&send_data[0],&send_n[0],&send_displacement[0],
-               MPI_DOUBLE,
-               &receive_data[0],&receive_n[0],
-               &receive_displacement[0],
-               MPI_DOUBLE,
-               this->communicator_pt()->mpi_comm());
-
- //Now use the received data to update the halo nodes
- for (int send_rank=0;send_rank<n_proc;send_rank++)
+ for (int rank=0;rank<n_proc;rank++)
   {
-   //Don't bother to do anything for the processor corresponding to the
-   //current processor or if no data were received from this processor
-   if((send_rank != my_rank) && (receive_n[send_rank] != 0))
+   if (send_n[rank]!=0)
     {
-     //Counter for the data within the large array
-     unsigned count=receive_displacement[send_rank];
+     Send_data_pt[rank]=&Send_data[rank][0];
+     MPI_Request request;
+     MPI_Send_init(Send_data_pt[rank],send_n[rank],MPI_DOUBLE,
+                   rank,tag,comm_pt->mpi_comm(),&request);
+     Request.push_back(request);
+    }
+  }
+}
 
-     // Deal with sub-meshes one-by-one if required
-     Mesh* my_mesh_pt=0;
 
-     // Loop over submeshes
-     for (unsigned imesh=0;imesh<n_mesh_loop;imesh++)
-      {
-       if (nmesh==0)
-        {
-         my_mesh_pt=mesh_pt();
-        }
-       else
-        {
-         my_mesh_pt=mesh_pt(imesh);
-        }
+//========================================================================
+/// Destructor: Complete any outstanding exchange and free the requests
+/// (unless MPI has already been finalised).
+//========================================================================
+DofSynchronisationScheme::~DofSynchronisationScheme()
+{
+ int finalized=0;
+ MPI_Finalized(&finalized);
+ if (finalized) {return;}
 
-       if (do_halos)
-        {
-         // How many of my nodes are halos whose non-halo counter
-         // parts live on processor send_rank?
-         unsigned n_nod=my_mesh_pt->nhalo_node(send_rank);
-         for (unsigned n=0;n<n_nod;n++)
-          {
-           //Read in values for each halo node
-           my_mesh_pt->halo_node_pt(send_rank,n)->
-            read_values_from_vector(receive_data,count);
-          }
+ wait();
+ unsigned n_request=Request.size();
+ for (unsigned i=0;i<n_request;i++)
+  {
+   MPI_Request_free(&Request[i]);
+  }
+}
 
-         // Get number of halo elements whose non-halo is
-         // on process send_rank
-         Vector<GeneralisedElement*> halo_elem_pt=my_mesh_pt->
-          halo_element_pt(send_rank);
 
-         unsigned nelem_halo=halo_elem_pt.size();
-         for (unsigned e=0;e<nelem_halo;e++)
-          {
-           halo_elem_pt[e]->
-            read_internal_data_values_from_vector(receive_data,count);
-          }
-        }
+//========================================================================
+/// Post all persistent sends and receives. The send buffers must have
+/// been refilled with the same number of values as during the setup.
+/// The check is collective so that, if the buffers don't match on any
+/// processor, all of them throw rather than block in their receives.
+//========================================================================
+void DofSynchronisationScheme::start()
+{
+ std::ostringstream error_stream;
+ int local_error=0;
+ unsigned n_proc=Send_data.size();
+ for (unsigned rank=0;rank<n_proc;rank++)
+  {
+   // The persistent requests refer to the original buffers
+   if ((Send_data[rank].size()!=Nsend[rank])||
+       ((Nsend[rank]!=0)&&(&Send_data[rank][0]!=Send_data_pt[rank])))
+    {
+     error_stream
+      << "Attempting to send " << Send_data[rank].size()
+      << " values to processor " << rank << " but the persistent\n"
+      << "communication pattern was set up for " << Nsend[rank]
+      << " values.\n";
+     local_error=1;
+    }
+  }
 
-       if (do_external_halos)
-        {
-         // How many of my nodes are external halos whose external non-halo
-         // counterparts live on processor send_rank?
-         unsigned n_ext_nod=my_mesh_pt->nexternal_halo_node(send_rank);
+ // Does any processor have a mismatch? Agreeing on this requires a
+ // global collective so it's only done in PARANOID mode; otherwise
+ // the processor(s) with the mismatch fail on their own (the others
+ // then fail when they check the number of values received in
+ // read_dof_synchronisation_data_from_vector(...) or wait for them).
+ int global_error=local_error;
+#ifdef PARANOID
+ MPI_Allreduce(&local_error,&global_error,1,MPI_INT,MPI_MAX,Comm);
+#endif
+ if (global_error!=0)
+  {
+   if (local_error==0)
+    {
+     error_stream 
+      << "The send buffers don't match the persistent communication\n"
+      << "pattern on another processor.\n";
+    }
+   error_stream
+    << "The halo scheme appears to have changed since the equations were\n"
+    << "last numbered; call Problem::flush_dof_synchronisation_schemes()\n"
+    << "(on all processors) after changing the halo scheme.\n";
+   throw OomphLibError(error_stream.str(),
+                       OOMPH_CURRENT_FUNCTION,
+                       OOMPH_EXCEPTION_LOCATION);
+  }
 
-         // Copy into the values of the external halo nodes
-         // on the present processors
-         for (unsigned n=0;n<n_ext_nod;n++)
-          {
-           //Read the data from the array into each halo node
-           my_mesh_pt->external_halo_node_pt(send_rank,n)->
-            read_values_from_vector(receive_data,count);
-          }
+ unsigned n_request=Request.size();
+ if (n_request!=0)
+  {
+   MPI_Startall(n_request,&Request[0]);
+  }
+ Exchange_in_progress=true;
+}
 
-         // Get number of halo elements whose non-halo is
-         // on process send_rank
-         unsigned next_elem_halo=my_mesh_pt->nexternal_halo_element(send_rank);
-         for (unsigned e=0;e<next_elem_halo;e++)
-          {
-           my_mesh_pt->external_halo_element_pt(send_rank,e)->
-            read_internal_data_values_from_vector(receive_data,count);
-          }
-        }
 
-      } // end of loop over meshes
-    }
-  } //End of data is received
-} //End of synchronise
+//========================================================================
+/// Wait for completion of the exchange posted by start()
+//========================================================================
+void DofSynchronisationScheme::wait()
+{
+ if (!Exchange_in_progress) {return;}
+ unsigned n_request=Request.size();
+ if (n_request!=0)
+  {
+   MPI_Waitall(n_request,&Request[0],MPI_STATUSES_IGNORE);
+  }
+ Exchange_in_progress=false;
+}
 
 
 //========================================================================
@@ -17225,6 +19090,26 @@ void Problem::load_balance(DocInfo& doc_info,
         target_domain_for_local_non_halo_element,
         bypass_metis);
       }
+     // Incremental repartitioning: only migrate elements near the
+     // processor boundaries
+     else if (Use_diffusive_partition_in_load_balance)
+      {
+       unsigned n_migrated=METIS::diffusive_partition_distributed_mesh(
+        this,Diffusive_load_balance_tolerance,
+        target_domain_for_local_non_halo_element,report_stats);
+
+       // Nothing has changed so there's no need to rebuild the problem
+       if (n_migrated==0)
+        {
+         if (report_stats)
+          {
+           oomph_info << "Partition unchanged; skipping redistribution. "
+                      << "Total time for load balancing: "
+                      << TimingHelpers::timer()-start_t << std::endl;
+          }
+         return;
+        }
+      }
      else
       {
        // Use METIS to perform the partitioning
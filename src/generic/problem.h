@@ -63,6 +63,9 @@ namespace oomph
   //Forward definition for Mesh class
   class Mesh;
 
+  //Forward definition for DofStoragePool class
+  class DofStoragePool;
+
   //Forward definition for RefineableElement class
   class RefineableElement;
 
@@ -87,6 +90,102 @@ namespace oomph
   //Forward definition for sum of matrices class
   class SumOfMatrices;
 
+#ifdef OOMPH_HAS_MPI
+
+  //=======================================================================
+  /// \short Persistent communication pattern used to overwrite the
+  /// halo (or external halo) values with those of their non-halo
+  /// counterparts. The number of values exchanged with each processor,
+  /// the send/receive buffers and the persistent MPI requests are set up
+  /// once and then re-used for every synchronisation until the halo scheme
+  /// changes, so each exchange only involves point-to-point messages
+  /// between processors that actually share data and can be overlapped
+  /// with other work between start() and wait().
+  //=======================================================================
+  class DofSynchronisationScheme
+  {
+
+  public:
+
+    /// \short Constructor: send_data[p] contains the (packed) values
+    /// to be sent to processor p; they are taken over by the scheme
+    /// and send_data is returned empty. The number of values to be received
+    /// from each processor is determined by a single all-to-all exchange.
+    /// Messages are sent with the specified tag.
+    DofSynchronisationScheme(OomphCommunicator* const& comm_pt,
+                             const int& tag,
+                             Vector<Vector<double> >& send_data);
+
+    /// Destructor: complete any outstanding exchange and free the requests
+    ~DofSynchronisationScheme();
+
+    /// Broken copy constructor
+    DofSynchronisationScheme(const DofSynchronisationScheme&)
+    {
+      BrokenCopy::broken_copy("DofSynchronisationScheme");
+    }
+
+    /// Broken assignment operator
+    void operator=(const DofSynchronisationScheme&)
+    {
+      BrokenCopy::broken_assign("DofSynchronisationScheme");
+    }
+
+    /// \short Buffer for the values to be sent to processor p. It must
+    /// contain exactly nsend(p) values when start() is called.
+    Vector<double>& send_data(const unsigned& p) {return Send_data[p];}
+
+    /// Number of values to be sent to processor p
+    unsigned nsend(const unsigned& p) const {return Nsend[p];}
+
+    /// Values received from processor p (only valid after wait())
+    const Vector<double>& receive_data(const unsigned& p) const
+    {
+      return Receive_data[p];
+    }
+
+    /// Number of values to be received from processor p
+    unsigned nreceive(const unsigned& p) const {return Receive_data[p].size();}
+
+    /// Post all persistent sends and receives
+    void start();
+
+    /// Wait for completion of the exchange posted by start()
+    void wait();
+
+    /// Has an exchange been started but not yet completed?
+    bool exchange_in_progress() const {return Exchange_in_progress;}
+
+  private:
+
+    /// Send buffers (one per processor)
+    Vector<Vector<double> > Send_data;
+
+    /// \short Number of values to be sent to each processor when the
+    /// requests were set up
+    Vector<unsigned> Nsend;
+
+    /// \short Start of the send buffers when the requests were set up
+    /// (the buffers must not be reallocated afterwards)
+    Vector<double*> Send_data_pt;
+
+    /// Receive buffers (one per processor)
+    Vector<Vector<double> > Receive_data;
+
+    /// Persistent send and receive requests
+    Vector<MPI_Request> Request;
+
+    /// \short The MPI communicator (used to agree on errors before the
+    /// exchange is started in PARANOID mode)
+    MPI_Comm Comm;
+
+    /// Has an exchange been started but not yet completed?
+    bool Exchange_in_progress;
+
+  };
+
+#endif
+
   /////////////////////////////////////////////////////////////////////
   /////////////////////////////////////////////////////////////////////
   /////////////////////////////////////////////////////////////////////
@@ -159,6 +258,9 @@ namespace oomph
     friend class AugmentedBlockPitchForkLinearSolver;
     friend class BlockHopfLinearSolver;
 
+    // The Parareal driver replaces the communicator
+    friend class PararealDriver;
+
 
   private:
 
@@ -505,6 +607,15 @@ namespace oomph
     /// Should only be set to true when run in validation mode.
     bool Use_default_partition_in_load_balance;
 
+    /// \short Flag to use the incremental (diffusive) repartitioning
+    /// rather than METIS during load balance.
+    bool Use_diffusive_partition_in_load_balance;
+
+    /// \short Imbalance (maximum load relative to the average load, minus
+    /// one) below which the diffusive load balancing leaves the
+    /// partition unchanged.
+    double Diffusive_load_balance_tolerance;
+
     /// \short First element to be assembled by given processor for
     /// non-distributed problem (only kept up to date when default assignment
     /// is used)
@@ -576,6 +687,70 @@ namespace oomph
     /// \short Function that is used to setup the halo scheme
     void setup_dof_halo_scheme();
 
+    /// \short Persistent communication patterns used by synchronise_dofs(...),
+    /// indexed by dof_synchronisation_scheme_index(...). Set up on first
+    /// use and flushed whenever the equations are (re-)numbered.
+    Vector<DofSynchronisationScheme*> Dof_synchronisation_scheme_pt;
+
+    /// \short Has start_synchronise_all_dofs() posted an exchange that
+    /// has not yet been completed by finish_synchronise_all_dofs()?
+    bool Dof_synchronisation_in_progress;
+
+    /// \short Boolean to indicate if the synchronisation of the dofs
+    /// after a Newton update is overlapped with the subsequent assembly
+    bool Overlap_dof_synchronisation_with_assembly;
+
+    /// \short Order in which parallel_sparse_assemble(...) visits the
+    /// elements while a synchronisation of the dofs is in progress: the
+    /// elements that don't involve any halo data come first.
+    Vector<unsigned long> Overlapped_assembly_element_order;
+
+    /// \short Number of entries at the start of
+    /// Overlapped_assembly_element_order that don't involve any halo data
+    unsigned long Noverlapped_assembly_interior_element;
+
+    /// \short First element of the range of elements for which
+    /// Overlapped_assembly_element_order was set up
+    unsigned long Overlapped_assembly_el_lo;
+
+    /// \short One-past-the-last element of the range of elements for which
+    /// Overlapped_assembly_element_order was set up
+    unsigned long Overlapped_assembly_el_hi_plus_one;
+
+    /// \short Index of the persistent communication pattern used
+    /// for the specified synchronisation
+    unsigned dof_synchronisation_scheme_index(
+     const bool& do_halos, const bool& do_external_halos) const
+    {
+      if (do_halos&&do_external_halos) {return 2;}
+      else if (do_external_halos) {return 1;}
+      return 0;
+    }
+
+    /// \short Add the values to be sent to processor rank during the
+    /// synchronisation of the dofs to send_data
+    void add_dof_synchronisation_data_to_vector(const bool& do_halos,
+                                                const bool& do_external_halos,
+                                                const int& rank,
+                                                Vector<double>& send_data);
+
+    /// \short Overwrite the halo (or external halo) values whose
+    /// non-halo counterparts live on processor rank with the values
+    /// received from that processor
+    void read_dof_synchronisation_data_from_vector(
+     const bool& do_halos, const bool& do_external_halos, const int& rank,
+     const Vector<double>& receive_data);
+
+    /// \short Does the assembly of the element involve any halo (or
+    /// external halo) data, i.e. values that are only up to date once the
+    /// synchronisation of the dofs has been completed?
+    bool element_involves_halo_data(GeneralisedElement* const& elem_pt) const;
+
+    /// \short Set up Overlapped_assembly_element_order for the elements
+    /// el_lo,...,el_hi_plus_one-1 (unless it's still up to date)
+    void setup_overlapped_assembly_element_order(
+     const unsigned long& el_lo, const unsigned long& el_hi_plus_one);
+
 #endif
 
     //--------------------- Newton solver parameters
@@ -714,6 +889,87 @@ namespace oomph
     /// as this value is initialised to -1.0.
     double Minimum_dt_but_still_proceed;
 
+    /// \short Enumerated flags for the controllers used to compute the
+    /// timestep scaling factor in adaptive_unsteady_newton_solve(...)
+    enum Timestep_controller_type {Elementary_timestep_controller,
+                                   PI_timestep_controller,
+                                   PID_timestep_controller};
+
+    /// \short Controller used to compute the timestep scaling factor
+    /// in adaptive timestepping. Default: Elementary_timestep_controller
+    unsigned Timestep_controller;
+
+    /// \short Proportional gain of the PI/PID timestep controllers
+    /// (the exponent is this gain divided by the order of the
+    /// timestepper plus one)
+    double Timestep_controller_proportional_gain;
+
+    /// \short Integral gain of the PI/PID timestep controllers
+    /// (the exponent is this gain divided by the order of the
+    /// timestepper plus one)
+    double Timestep_controller_integral_gain;
+
+    /// \short Derivative gain of the PID timestep controller
+    /// (the exponent is this gain divided by the order of the
+    /// timestepper plus one)
+    double Timestep_controller_derivative_gain;
+
+    /// \short Global temporal error norm of the most recently accepted
+    /// timestep (negative if not available). Used by the PI/PID controllers.
+    double Previous_temporal_error_norm;
+
+    /// \short Global temporal error norm of the timestep accepted before
+    /// the most recent one (negative if not available). Used by the PID
+    /// controller.
+    double Second_previous_temporal_error_norm;
+
+    /// \short Is re-use of the Jacobian (and its factorisation/
+    /// preconditioner) across timesteps in adaptive_unsteady_newton_solve(...)
+    /// enabled? Default: false
+    bool Jacobian_reuse_across_timesteps_is_enabled;
+
+    /// \short Maximum relative change of dt (compared to the dt at which
+    /// the stored Jacobian was assembled) for which the Jacobian is re-used
+    /// across timesteps.
+    double Max_relative_dt_change_for_jacobian_reuse;
+
+    /// \short Value of dt at which the stored Jacobian was assembled
+    /// (only used if re-use of the Jacobian across timesteps is enabled)
+    double Dt_for_stored_jacobian;
+
+    /// \short Number of dofs at the time the stored Jacobian was assembled
+    /// (only used if re-use of the Jacobian across timesteps is enabled)
+    unsigned long Ndof_for_stored_jacobian;
+
+    /// \short Locality reordering (a Mesh::Locality_reordering) applied
+    /// to the elements and nodes of the (sub-)meshes before the equations 
+    /// are numbered in assign_eqn_numbers(). 
+    /// Default: Mesh::No_locality_reordering
+    unsigned Mesh_locality_reordering;
+
+    /// \short Are the equations renumbered by a reverse Cuthill-McKee 
+    /// ordering in assign_eqn_numbers() to reduce the bandwidth of the 
+    /// Jacobian? Default: false
+    bool Equation_reordering_for_bandwidth_is_enabled;
+
+    /// \short Pool that holds the values of all Data in an array that is
+    /// ordered by equation number (null unless contiguous dof storage 
+    /// is enabled and could be set up)
+    DofStoragePool* Dof_storage_pool_pt;
+
+    /// \short Are the values of the unknowns to be stored contiguously,
+    /// in the order of their equation numbers? Default: false
+    bool Contiguous_dof_storage_is_enabled;
+
+    /// \short Number of threads used to number the equations in 
+    /// assign_eqn_numbers() (only used with pthreads). Default: 1
+    unsigned Nthread_for_eqn_numbering;
+
+    /// \short Are the nodal, internal and global values written to 
+    /// (binary) blocks of raw doubles rather than as text when dumping
+    /// the problem for restart? Default: false
+    bool Binary_restart_is_enabled;
+
 
     //---------------------  Arc-length continuation paramaters
 
@@ -1414,6 +1670,24 @@ namespace oomph
     void unset_default_partition_in_load_balance()
     {Use_default_partition_in_load_balance=false;}
 
+    /// \short Use incremental (diffusive) repartitioning in the load
+    /// balance: only clusters of elements near the processor boundaries
+    /// migrate between neighbouring processors, in proportion to the
+    /// imbalance (see METIS::diffusive_partition_distributed_mesh(...)).
+    /// Nothing is done if the load imbalance (maximum load relative to the
+    /// average, minus one) is below the specified tolerance.
+    void enable_diffusive_load_balancing(
+     const double& imbalance_tolerance=0.05)
+    {
+      Use_diffusive_partition_in_load_balance=true;
+      Diffusive_load_balance_tolerance=imbalance_tolerance;
+    }
+
+    /// \short Repartition the entire mesh with METIS in the load
+    /// balance (default)
+    void disable_diffusive_load_balancing()
+    {Use_diffusive_partition_in_load_balance=false;}
+
     /// \short Load balance helper routine: refine each new base (sub)mesh
     /// based upon the elements to be refined within each tree at each root
     /// on the current processor
@@ -1514,6 +1788,62 @@ namespace oomph
     /// \short Access function to max timestep in adaptive timestepping
     double& maximum_dt() {return Maximum_dt;}
 
+    /// \short Use the elementary controller to compute the new timestep
+    /// in adaptive timestepping (default), i.e.
+    /// dt_new = dt (epsilon/error)^{1/(order+1)}
+    void use_elementary_timestep_controller()
+    {
+      Timestep_controller=Elementary_timestep_controller;
+      Timestep_controller_proportional_gain=0.0;
+      Timestep_controller_integral_gain=1.0;
+      Timestep_controller_derivative_gain=0.0;
+      reset_timestep_controller_history();
+    }
+
+    /// \short Use a PI controller to compute the new timestep in adaptive
+    /// timestepping:
+    /// dt_new = dt (epsilon/e_n)^{k_I/(order+1)}
+    ///             (e_{n-1}/e_n)^{k_P/(order+1)}
+    /// where e_n and e_{n-1} are the error estimates of the current and
+    /// previous accepted timesteps. Default gains from Gustafsson (1991).
+    void use_pi_timestep_controller(const double& proportional_gain=0.4,
+                                    const double& integral_gain=0.3)
+    {
+      Timestep_controller=PI_timestep_controller;
+      Timestep_controller_proportional_gain=proportional_gain;
+      Timestep_controller_integral_gain=integral_gain;
+      Timestep_controller_derivative_gain=0.0;
+      reset_timestep_controller_history();
+    }
+
+    /// \short Use a PID controller to compute the new timestep in adaptive
+    /// timestepping:
+    /// dt_new = dt (epsilon/e_n)^{k_I/(order+1)}
+    ///             (e_{n-1}/e_n)^{k_P/(order+1)}
+    ///             (e_{n-1}^2/(e_n e_{n-2}))^{k_D/(order+1)}.
+    /// Default gains correspond to the exponents (0.075, 0.175, 0.01) of
+    /// Valli et al. (2002) for second-order timesteppers.
+    void use_pid_timestep_controller(const double& proportional_gain=0.225,
+                                     const double& integral_gain=0.525,
+                                     const double& derivative_gain=0.03)
+    {
+      Timestep_controller=PID_timestep_controller;
+      Timestep_controller_proportional_gain=proportional_gain;
+      Timestep_controller_integral_gain=integral_gain;
+      Timestep_controller_derivative_gain=derivative_gain;
+      reset_timestep_controller_history();
+    }
+
+    /// \short Forget the error estimates of previously accepted timesteps,
+    /// so the PI/PID controllers fall back to the elementary controller
+    /// until enough history is available again (e.g. after re-assigning
+    /// initial conditions).
+    void reset_timestep_controller_history()
+    {
+      Previous_temporal_error_norm=-1.0;
+      Second_previous_temporal_error_norm=-1.0;
+    }
+
     /// \short Access function to max Newton iterations before giving up.
     unsigned& max_newton_iterations() {return Max_newton_iterations;}
 
@@ -1871,6 +2201,130 @@ namespace oomph
       return Jacobian_reuse_is_enabled;
     }
 
+    /// \short Enable recycling of the Jacobian (and of the linear solver's
+    /// factorisation/preconditioner) across accepted and rejected timesteps
+    /// in adaptive_unsteady_newton_solve(...), as long as dt differs by
+    /// no more than the specified relative amount from the dt at which
+    /// the Jacobian was assembled. If the Newton iteration fails with a
+    /// recycled Jacobian, the step is re-tried with a fresh one before the
+    /// timestep is rejected. Requires a linear solver that can resolve.
+    void enable_jacobian_reuse_across_timesteps(
+     const double& max_relative_dt_change=0.2)
+    {
+      Jacobian_reuse_across_timesteps_is_enabled=true;
+      Max_relative_dt_change_for_jacobian_reuse=max_relative_dt_change;
+      Jacobian_has_been_computed=false;
+    }
+
+    /// \short Disable recycling of the Jacobian across timesteps
+    void disable_jacobian_reuse_across_timesteps()
+    {
+      Jacobian_reuse_across_timesteps_is_enabled=false;
+      Jacobian_has_been_computed=false;
+    }
+
+    /// \short Is recycling of the Jacobian across timesteps enabled?
+    bool jacobian_reuse_across_timesteps_is_enabled()
+    {
+      return Jacobian_reuse_across_timesteps_is_enabled;
+    }
+
+    /// \short Reorder the elements and nodes of the (sub-)meshes to 
+    /// improve the locality of memory accesses whenever the equations 
+    /// are (re-)numbered, i.e. in assign_eqn_numbers() and hence also 
+    /// after every mesh adaptation. The reordering is one of the 
+    /// Mesh::Locality_reordering enums. Note that this changes the 
+    /// order of the elements and nodes in the meshes, so code that
+    /// relies on the order in which they were created (e.g. to 
+    /// identify a specific node by its number) must not use it. Ignored 
+    /// once the problem has been distributed.
+    void enable_mesh_reordering_for_locality(const unsigned& reordering);
+
+    /// \short Reorder the elements and nodes of the (sub-)meshes along
+    /// the Hilbert curve whenever the equations are (re-)numbered
+    void enable_mesh_reordering_for_locality();
+
+    /// \short Don't reorder the elements and nodes of the meshes in
+    /// assign_eqn_numbers() (default)
+    void disable_mesh_reordering_for_locality();
+
+    /// \short Renumber the equations by a reverse Cuthill-McKee 
+    /// ordering (based on the elements' dofs) in assign_eqn_numbers() to 
+    /// reduce the bandwidth and profile of the Jacobian. Ignored once the
+    /// problem has been distributed or if the local equation numbers 
+    /// are not assigned.
+    void enable_equation_reordering_for_bandwidth()
+    {
+      Equation_reordering_for_bandwidth_is_enabled=true;
+    }
+
+    /// \short Number the equations in the order in which the data are 
+    /// encountered (default)
+    void disable_equation_reordering_for_bandwidth()
+    {
+      Equation_reordering_for_bandwidth_is_enabled=false;
+    }
+
+    /// \short Access function for the number of threads used to number
+    /// the equations in assign_eqn_numbers() (only used if oomph-lib was
+    /// built with pthreads; defaults to one). The global numbering of 
+    /// the nodes and the elements' internal data, and the local numbering
+    /// in the elements, are then done for contiguous chunks of the meshes
+    /// concurrently, so the elements' assign_local_eqn_numbers(...) must 
+    /// be thread-safe if this is increased. The equation numbers are the
+    /// same as in the serial numbering. (The local numbering remains 
+    /// serial if the pointers to the local dofs are stored in the 
+    /// elements.)
+    unsigned& nthread_for_eqn_numbering() 
+    {
+      return Nthread_for_eqn_numbering;
+    }
+
+    /// \short Number of threads used to number the equations (const 
+    /// version)
+    unsigned nthread_for_eqn_numbering() const 
+    {
+      return Nthread_for_eqn_numbering;
+    }
+
+    /// \short Store the (current and history) values of all unknowns in
+    /// a single array that is ordered by equation number and aliased by 
+    /// the Data, so that get_dofs(...), set_dofs(...), add_to_dofs(...), 
+    /// store_current_dof_values() and restore_dof_values() copy 
+    /// contiguous memory rather than going through the Data. The
+    /// storage is (re-)built whenever the equations are (re-)numbered. 
+    /// Ignored for distributed problems, and if the unknowns have 
+    /// different numbers of history values or are not all stored in 
+    /// the global data, nodes, internal data or spines of the meshes.
+    void enable_contiguous_dof_storage();
+
+    /// \short Give the Data their own storage back (default)
+    void disable_contiguous_dof_storage();
+
+    /// \short Are the values of the unknowns currently stored 
+    /// contiguously?
+    bool contiguous_dof_storage_is_active() const 
+    {
+      return contiguous_dof_storage_is_intact();
+    }
+
+    /// \short Pointer to the contiguous storage of the unknowns (only 
+    /// available if contiguous_dof_storage_is_active()): The t-th history
+    /// value of the unknown with (global) equation number i is 
+    /// contiguous_dof_storage_pt()[i*contiguous_dof_storage_stride()+t].
+    double* contiguous_dof_storage_pt();
+
+    /// \short Stride between successive unknowns in the contiguous 
+    /// storage, i.e. the number of (current and history) values stored
+    /// for each unknown
+    unsigned contiguous_dof_storage_stride() const;
+
+    /// \short (Re-)pool the storage of the nodal values and positions
+    /// in the (sub-)meshes (see Mesh::enable_pooled_nodal_storage()),
+    /// e.g. after mesh adaptation, and renumber the equations if they 
+    /// had been numbered (pooling moves the values of the unknowns).
+    void enable_pooled_nodal_storage();
+
     bool& use_predictor_values_as_initial_guess()
     {
       return Use_predictor_values_as_initial_guess;
@@ -1958,7 +2412,9 @@ namespace oomph
     /// Problem data to file for restart.
     void dump(const std::string &dump_file_name) const
     {
-      std::ofstream dump_stream(dump_file_name.c_str());
+      std::ios_base::openmode mode=std::ios_base::out;
+      if (Binary_restart_is_enabled) mode|=std::ios_base::binary;
+      std::ofstream dump_stream(dump_file_name.c_str(),mode);
 #ifdef PARANOID
       if (!dump_stream.is_open())
       {
@@ -1970,6 +2426,51 @@ namespace oomph
       dump(dump_stream);
     }
 
+    /// \short Enable binary restart files: dump(...) then writes the 
+    /// values stored at the nodes, in the elements' internal data and 
+    /// in the global data as a block of raw doubles (preceded by a 
+    /// block of unsigneds that records the structure) rather than one 
+    /// text line per value. The (small) structural parts of the restart
+    /// file -- refinement patterns, distribution, time -- remain text. 
+    /// The file starts with a header that records the format version
+    /// and byte order, and read(...) recognises the format automatically,
+    /// so text restart files remain readable. Binary restart files are 
+    /// exact (no loss of precision) and much faster to write and read.
+    /// Streams that are passed to dump(...) and read(...) should be
+    /// opened in std::ios_base::binary mode.
+    void enable_binary_restart() {Binary_restart_is_enabled=true;}
+
+    /// \short Disable binary restart files (default)
+    void disable_binary_restart() {Binary_restart_is_enabled=false;}
+
+    /// \short Are restart files written in binary format?
+    bool binary_restart_is_enabled() const {return Binary_restart_is_enabled;}
+
+    /// \short Dump the problem for restart into a single file that is 
+    /// shared by all processors: Each processor's restart data (as 
+    /// written by dump(std::ofstream&)) is stored in its own section, 
+    /// and all sections are written concurrently with MPI-IO. The file
+    /// starts with a (text) table of the sections' offsets. Without MPI,
+    /// or on a single processor, the file contains a single section.
+    void dump_to_shared_file(const std::string &dump_file_name) const;
+
+    /// \short Read the problem from a restart file that was written 
+    /// by dump_to_shared_file(...): Each processor reads its own section
+    /// with read(std::ifstream&,bool&). As with per-processor restart
+    /// files, the run may be restarted on a larger (but not a smaller)
+    /// number of processors. Returns flag to indicate if the restart was
+    /// from steady or unsteady solution.
+    void read_from_shared_file(const std::string &restart_file_name, 
+                               bool& unsteady_restart);
+
+    /// \short Read the problem from a restart file that was written 
+    /// by dump_to_shared_file(...)
+    void read_from_shared_file(const std::string &restart_file_name)
+    {
+      bool unsteady_restart;
+      read_from_shared_file(restart_file_name,unsteady_restart);
+    }
+
 #ifdef OOMPH_HAS_MPI
 
     /// \short Get pointers to all possible halo data indexed by global
@@ -1991,6 +2492,65 @@ namespace oomph
     /// \short Perform all required synchronisation in solvers
     void synchronise_all_dofs();
 
+    /// \short Split-phase version of synchronise_dofs(...): Post the
+    /// exchange of the values and return immediately. The halo values
+    /// are only updated by the matching call to finish_synchronise_dofs(...).
+    void start_synchronise_dofs(const bool& do_halos,
+                                const bool& do_external_halos);
+
+    /// \short Complete the exchange posted by start_synchronise_dofs(...)
+    /// with the same arguments and overwrite the halo values (no-op if
+    /// no such exchange is in progress).
+    void finish_synchronise_dofs(const bool& do_halos,
+                                 const bool& do_external_halos);
+
+    /// \short Split-phase version of synchronise_all_dofs(): Post the
+    /// synchronisation of the halo values and return immediately; the
+    /// synchronisation is completed by finish_synchronise_all_dofs(),
+    /// which is called automatically during the next distributed
+    /// assembly once all elements that don't involve halo data have been
+    /// assembled. Falls back to synchronise_all_dofs() if a
+    /// non-default assembly handler is in use, since its own
+    /// synchronisation may affect all elements.
+    void start_synchronise_all_dofs();
+
+    /// \short Complete the synchronisation started by
+    /// start_synchronise_all_dofs() (no-op if none is in progress).
+    void finish_synchronise_all_dofs();
+
+    /// \short Is there a synchronisation of the dofs that was started by
+    /// start_synchronise_all_dofs() but has not been completed yet?
+    bool dof_synchronisation_in_progress() const
+    {
+      return Dof_synchronisation_in_progress;
+    }
+
+    /// \short Flush the persistent communication patterns used to
+    /// synchronise the dofs. This is done automatically when the equations
+    /// are (re-)numbered but must be called explicitly if the halo schemes
+    /// are changed in any other way. Any synchronisation started by 
+    /// start_synchronise_all_dofs() is completed first.
+    void flush_dof_synchronisation_schemes();
+
+    /// \short Overlap the synchronisation of the dofs after each Newton
+    /// update with the assembly of the residuals: the halo values are
+    /// exchanged while the elements that don't involve halo data are
+    /// assembled. NOTE: Halo values are then not up to date in
+    /// actions_after_newton_step() and
+    /// actions_before_newton_convergence_check(); call
+    /// finish_synchronise_all_dofs() there if they are required.
+    void enable_overlapped_dof_synchronisation()
+    {
+      Overlap_dof_synchronisation_with_assembly=true;
+    }
+
+    /// \short Complete the synchronisation of the dofs before
+    /// proceeding with the Newton iteration (default).
+    void disable_overlapped_dof_synchronisation()
+    {
+      Overlap_dof_synchronisation_with_assembly=false;
+    }
+
     /// Check the halo/haloed node/element schemes
     void check_halo_schemes(DocInfo& doc_info);
 
@@ -2090,6 +2650,47 @@ namespace oomph
     /// adaptive_unsteady_newton_solve(...). Defaults to true.
     bool Keep_temporal_error_below_tolerance;
 
+    /// \short Compute the factor by which dt is scaled in adaptive
+    /// timestepping, given the error estimate, the required tolerance
+    /// and the order of the timestepper, using the selected timestep
+    /// controller (elementary, PI or PID).
+    double timestep_scaling_factor(const double &epsilon,
+                                   const double &error,
+                                   const unsigned &order);
+
+    /// \short Renumber the equations by a reverse Cuthill-McKee 
+    /// ordering of the graph of dofs that share elements (called from
+    /// assign_eqn_numbers() after the local equation numbers have been
+    /// assigned, which are then re-assigned)
+    void reorder_equations_for_bandwidth();
+
+    /// \short Get the (distinct) Data that can hold unknowns: The global 
+    /// data and, for all (sub-)meshes, the nodes (and the variable 
+    /// positions of SolidNodes), the internal data of the elements and 
+    /// the spine heights of SpineMeshes.
+    void get_all_data_with_eqn_numbers(Vector<Data*>& data_pt) const;
+
+    /// \short Move the values of the unknowns into contiguous storage,
+    /// ordered by equation number, and redirect Dof_pt (called from 
+    /// assign_eqn_numbers() if contiguous dof storage is enabled)
+    void setup_contiguous_dof_storage();
+
+    /// \short Give the Data their own storage back and redirect Dof_pt
+    void release_contiguous_dof_storage();
+
+    /// \short Is the contiguous storage of the unknowns active and does
+    /// it still hold the values of all unknowns? Data that re-allocate 
+    /// their storage (e.g. because they are resized or their timestepper
+    /// is changed) copy their values out of the pool. (Pure check: 
+    /// Dof_pt may still point into the pool afterwards.)
+    bool contiguous_dof_storage_is_intact() const;
+
+    /// \short If some Data have left the contiguous storage of the 
+    /// unknowns, release it (and redirect Dof_pt) so that the callers 
+    /// fall back to going through the Data. Called before the unknowns
+    /// are accessed or renumbered, and before adaptation.
+    void release_contiguous_dof_storage_if_broken();
+
     /// \short Perform a basic arc-length continuation step using Newton's
     /// method. Returns number of Newton steps taken.
     unsigned newton_solve_continuation(double* const &parameter_pt);
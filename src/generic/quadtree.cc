@@ -381,6 +381,140 @@ void QuadTree::setup_static_data()
  Reflect_edge[W]=E;
 }
 
+//================================================================
+/// Set the Morton key (level and integer position within the root)
+/// of the son_type-th son of father_pt
+//================================================================
+void QuadTree::set_morton_key(const QuadTree* father_pt, const int& son_type)
+{
+ using namespace QuadTreeNames;
+
+ Level_in_root=father_pt->Level_in_root+1;
+ Position_in_root[0]=2*father_pt->Position_in_root[0];
+ Position_in_root[1]=2*father_pt->Position_in_root[1];
+ if ((son_type==SE)||(son_type==NE)) {Position_in_root[0]+=1;}
+ if ((son_type==NW)||(son_type==NE)) {Position_in_root[1]+=1;}
+}
+
+//================================================================
+/// Recompute the Morton keys of all of the quadtree's descendants
+/// from its own
+//================================================================
+void QuadTree::update_morton_keys_of_descendants()
+{
+ unsigned n_son=Son_pt.size();
+ for (unsigned i_son=0;i_son<n_son;i_son++)
+  {
+   QuadTree* son_pt=dynamic_cast<QuadTree*>(Son_pt[i_son]);
+   son_pt->set_morton_key(this,son_pt->son_type());
+   son_pt->update_morton_keys_of_descendants();
+  }
+}
+
+//================================================================
+/// Find greater or equal-sized edge neighbour in direction from the
+/// Morton keys, provided it's in the same root (arguments as in the
+/// public version of gteq_edge_neighbour(...)): The equal-sized 
+/// neighbour's position is obtained by offsetting our own; the common
+/// ancestor is as many levels up as there are bits in which the two 
+/// positions differ, and the neighbour is found by descending from it
+/// along the bits of the neighbour's position. No rotation is possible
+/// within a root. Returns false (without doing anything) if the 
+/// neighbour has to be found by the general algorithm.
+//================================================================
+bool QuadTree::gteq_edge_neighbour_in_same_root(const int& direction, 
+                                                Vector<unsigned> &translate_s,
+                                                Vector<double>& s_lo,  
+                                                Vector<double>& s_hi, 
+                                                int& edge, int& diff_level,
+                                                QuadTree*& neighb_pt) const
+{
+ using namespace QuadTreeNames;
+
+ // Offset of the equal-sized neighbour
+ int offset[2]={0,0};
+ switch(direction)
+  {
+  case N:
+   offset[1]=1;
+   break;
+  case S:
+   offset[1]=-1;
+   break;
+  case E:
+   offset[0]=1;
+   break;
+  case W:
+   offset[0]=-1;
+   break;
+  default:
+   return false;
+  }
+
+ // Leave very deep trees to the general algorithm
+ if (Level_in_root>30) return false;
+
+ // Position of the equal-sized neighbour; if it's outside the root,
+ // the general algorithm has to deal with it
+ int n_position=(1<<Level_in_root);
+ unsigned neigh_position[2];
+ unsigned differing_bits=0;
+ for (unsigned i=0;i<2;i++)
+  {
+   int position=int(Position_in_root[i])+offset[i];
+   if ((position<0)||(position>=n_position)) return false;
+   neigh_position[i]=unsigned(position);
+   differing_bits|=(Position_in_root[i]^neigh_position[i]);
+  }
+
+ // Climb up to the common ancestor (at least to the father)
+ unsigned n_up=0;
+ while (differing_bits!=0)
+  {
+   differing_bits>>=1;
+   n_up++;
+  }
+ Tree* tree_pt=Father_pt;
+ for (unsigned k=1;k<n_up;k++)
+  {
+   tree_pt=tree_pt->father_pt();
+  }
+
+ // Descend towards the neighbour until we hit a leaf or our own level
+ unsigned n_down=0;
+ while ((n_down<n_up)&&(tree_pt->nsons()>0))
+  {
+   n_down++;
+   unsigned shift=n_up-n_down;
+   bool east=((neigh_position[0]>>shift)&1)!=0;
+   bool north=((neigh_position[1]>>shift)&1)!=0;
+   int son_quadrant=north ? (east ? NE : NW) : (east ? SE : SW);
+   tree_pt=tree_pt->son_pt(son_quadrant);
+  }
+ neighb_pt=dynamic_cast<QuadTree*>(tree_pt);
+
+ // Difference in level and ratio of our size to the neighbour's
+ diff_level=int(n_down)-int(n_up);
+ double size_ratio=pow(2.0,diff_level);
+
+ // The vertices of our edge, mapped into the neighbour's local coordinates
+ for (unsigned i=0;i<2;i++)
+  {
+   double lo=(offset[i]!=0) ? double(offset[i]) : -1.0;
+   double hi=(offset[i]!=0) ? double(offset[i]) : 1.0;
+   double neigh_sw=double(neigh_position[i]>>(n_up-n_down));
+   s_lo[i]=2.0*((double(Position_in_root[i])+0.5*(lo+1.0))*size_ratio-
+                neigh_sw)-1.0;
+   s_hi[i]=2.0*((double(Position_in_root[i])+0.5*(hi+1.0))*size_ratio-
+                neigh_sw)-1.0;
+  }
+ translate_s[0]=0;
+ translate_s[1]=1;
+ edge=Reflect_edge[direction];
+
+ return true;
+}
+
 //================================================================
 /// Return pointer to greater or equal-sized edge neighbour 
 /// in specified \c direction; also provide info regarding the relative 
@@ -440,6 +574,14 @@ gteq_edge_neighbour(const int& direction, Vector<unsigned>& translate_s,
     //during the recursion if we do actually hop over in to the neighbour
     in_neighbouring_tree=false;
 
+ // Neighbours in the same root can be found from the Morton keys
+ QuadTree* same_root_neighb_pt=0;
+ if (gteq_edge_neighbour_in_same_root(direction,translate_s,s_lo,s_hi,
+                                      edge,diff_level,same_root_neighb_pt))
+  {
+   return same_root_neighb_pt;
+  }
+
  // Maximum level to which we're allowed to descend (we only want
  // greater-or-equal-sized neighbours)
  int max_level=Level;
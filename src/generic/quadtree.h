@@ -120,6 +120,11 @@ class QuadTree : public virtual Tree
    return temp_quad_pt;
   }
 
+ /// \short Recompute the Morton keys (level and integer position within
+ /// the root) of all of the quadtree's descendants from its own. This is
+ /// required if an existing subtree has been given a new root.
+ void update_morton_keys_of_descendants();
+
  /// \short Return pointer to greater or equal-sized edge neighbour 
  /// in specified \c direction; also provide info regarding the relative 
  /// size and orientation of neighbour:
@@ -207,7 +212,12 @@ class QuadTree : public virtual Tree
  /// Protected because QuadTrees can only be created internally,
  /// during the split operation. Only QuadTreeRoots can be
  /// created externally. 
- QuadTree(RefineableElement* const &object_pt) : Tree(object_pt) {}
+ QuadTree(RefineableElement* const &object_pt) : Tree(object_pt),
+  Level_in_root(0)
+  {
+   Position_in_root[0]=0;
+   Position_in_root[1]=0;
+  }
 
  /// \short Constructor for tree that has a father: Pass it the pointer 
  /// to its object, the pointer to its father and tell it what type 
@@ -217,7 +227,10 @@ class QuadTree : public virtual Tree
  /// created externally. 
  QuadTree(RefineableElement* const &object_pt, 
           Tree* const &father_pt, const int& son_type)
-  : Tree(object_pt,father_pt,son_type) {}
+  : Tree(object_pt,father_pt,son_type)
+  {
+   set_morton_key(dynamic_cast<QuadTree*>(father_pt),son_type);
+  }
 
  /// Bool indicating that static member data has been setup
  static bool Static_data_has_been_setup;
@@ -234,6 +247,29 @@ class QuadTree : public virtual Tree
                                int max_level, 
                                QuadTreeRoot* const &orig_root_pt) const;
 
+ /// \short Find greater or equal-sized edge neighbour in direction
+ /// from the Morton keys if it's in the same root (arguments as in the
+ /// public version). Returns false (without doing anything) if the
+ /// neighbour has to be found by the general algorithm.
+ bool gteq_edge_neighbour_in_same_root(const int& direction, 
+                                       Vector<unsigned> &translate_s, 
+                                       Vector<double>& s_lo,  
+                                       Vector<double>& s_hi, 
+                                       int& edge, int& diff_level,
+                                       QuadTree*& neighb_pt) const;
+
+ /// \short Set the Morton key of the son_type-th son of father_pt
+ void set_morton_key(const QuadTree* father_pt, const int& son_type);
+
+ /// \short Level of the quadtree within its root. This is the same as
+ /// Level unless the root was made from a son of a deeper tree.
+ unsigned Level_in_root;
+
+ /// \short Integer coordinates of the quadtree's SW vertex within its
+ /// root, in units of the quadtree's size. Together with Level_in_root,
+ /// they form the quadtree's Morton key.
+ unsigned Position_in_root[2];
+
  /// Colours for neighbours in various directions
  static Vector<std::string> Colour;
 
@@ -199,6 +199,64 @@ namespace oomph
  } // setup_father_bounds()
 
 
+//==================================================================
+/// Setup static matrices of the father's shape functions at the
+/// son's nodal points:
+///
+/// Father_to_son_shape[nnode_1d][son_type](jnod_son,jnod_father)
+///
+/// These are used to transfer the solution from father to son
+/// during refinement for elements whose values are interpolated
+/// isoparametrically (see get_isoparametric_value_indices(...)).
+//==================================================================
+ void RefineableQElement<3>::setup_father_to_son_shape()
+ {
+  using namespace OcTreeNames;
+
+  //Find the number of nodes along a 1D edge
+  unsigned n_p = nnode_1d();
+  unsigned n_node = n_p*n_p*n_p;
+
+  //Allocate space for the matrices
+  Father_to_son_shape[n_p].resize(8);
+
+  Shape psi(n_node);
+  Vector<double> s_lo(3);
+  Vector<double> s(3);
+  for (int i_son=LDB;i_son<=RUF;i_son++)
+  {
+   // Lower left vertex of the son in the father element
+   for (unsigned i=0;i<3;i++)
+   {
+    s_lo[i]=(OcTree::Direction_to_vector[i_son][i]+1)/2-1;
+   }
+
+   DenseMatrix<double>& father_to_son_shape=
+    Father_to_son_shape[n_p][i_son];
+   father_to_son_shape.resize(n_node,n_node);
+   for (unsigned i0=0;i0<n_p;i0++)
+   {
+    s[0] = s_lo[0] + local_one_d_fraction_of_node(i0,0);
+    for (unsigned i1=0;i1<n_p;i1++)
+    {
+     s[1] = s_lo[1] + local_one_d_fraction_of_node(i1,1);
+     for (unsigned i2=0;i2<n_p;i2++)
+     {
+      s[2] = s_lo[2] + local_one_d_fraction_of_node(i2,2);
+
+      // Father's shape functions at the son's node
+      shape(s,psi);
+      for (unsigned l=0;l<n_node;l++)
+      {
+       father_to_son_shape(i0+n_p*i1+n_p*n_p*i2,l)=psi[l];
+      }
+     }
+    }
+   }
+  }
+ }
+
+
 
 //==================================================================
 /// Determine Vector of boundary conditions along the element's boundary 
@@ -1342,6 +1400,21 @@ namespace oomph
    {
     unsigned jnod=0;
     Vector<double> s_fraction(n_dim);
+
+    // If the father interpolates its values isoparametrically, transfer
+    // them to all of our nodes and history levels in one go, using the
+    // precomputed father-to-son interpolation matrix
+    Vector<unsigned> value_index;
+    bool batched_transfer=
+     father_el_pt->batched_value_transfer_is_possible(value_index);
+    DenseMatrix<double> son_values;
+    if (batched_transfer)
+    {
+     if (Father_to_son_shape[n_p].size()==0) {setup_father_to_son_shape();}
+     interpolate_father_values_to_son_nodes(
+      father_el_pt,Father_to_son_shape[n_p][son_type],
+      value_index,ntstorage,son_values);
+    }
     
     // Loop over nodes in element
     for (unsigned i0=0;i0<n_p;i0++)
@@ -1393,25 +1466,33 @@ namespace oomph
 	//This is only need for mixed interpolation where the value
 	//at the father could now become active.
              
-	// Loop over all history values
-	for (unsigned t=0;t<ntstorage;t++)
+	if (batched_transfer)
 	{
-	 // Get values from father element
-	 // Note: get_interpolated_values() sets Vector size itself.
-	 Vector<double> prev_values;
-	 father_el_pt->get_interpolated_values(t,s,prev_values);
-	 //Find the minimum number of values
-	 //(either those stored at the node, or those returned by
-	 // the function)
-	 unsigned n_val_at_node = created_node_pt->nvalue();
-	 unsigned n_val_from_function = prev_values.size(); 
-	 //Use the ternary conditional operator here
-	 unsigned n_var = n_val_at_node < n_val_from_function ?
-					  n_val_at_node : n_val_from_function;
-	 //Assign the values that we can
-	 for (unsigned k=0;k<n_var;k++)
+	 set_nodal_values_from_son_values(created_node_pt,jnod,
+						  son_values,ntstorage);
+	}
+	else
+	{
+	 // Loop over all history values
+	 for (unsigned t=0;t<ntstorage;t++)
 	 {
-	  created_node_pt->set_value(t,k,prev_values[k]);
+	  // Get values from father element
+	  // Note: get_interpolated_values() sets Vector size itself.
+	  Vector<double> prev_values;
+	  father_el_pt->get_interpolated_values(t,s,prev_values);
+	  //Find the minimum number of values
+	  //(either those stored at the node, or those returned by
+	  // the function)
+	  unsigned n_val_at_node = created_node_pt->nvalue();
+	  unsigned n_val_from_function = prev_values.size(); 
+	  //Use the ternary conditional operator here
+	  unsigned n_var = n_val_at_node < n_val_from_function ?
+					   n_val_at_node : n_val_from_function;
+	  //Assign the values that we can
+	  for (unsigned k=0;k<n_var;k++)
+	  {
+	   created_node_pt->set_value(t,k,prev_values[k]);
+	  }
 	 }
 	}
 
@@ -1836,19 +1917,27 @@ namespace oomph
 	 }
                
 	 // Now set the values
-	 // Loop over all history values
-	 for (unsigned t=0;t<ntstorage;t++)
+	 if (batched_transfer)
 	 {
-	  // Get values from father element
-	  // Note: get_interpolated_values() sets Vector size itself.
-	  Vector<double> prev_values;
-	  father_el_pt->get_interpolated_values(t,s,prev_values);
-                 
-	  //Initialise the values at the new node
-	  unsigned n_value = created_node_pt->nvalue();
-	  for (unsigned k=0;k<n_value;k++)
+	  set_nodal_values_from_son_values(created_node_pt,jnod,
+					   son_values,ntstorage);
+	 }
+	 else
+	 {
+	  // Loop over all history values
+	  for (unsigned t=0;t<ntstorage;t++)
 	  {
-	   created_node_pt->set_value(t,k,prev_values[k]);
+	   // Get values from father element
+	   // Note: get_interpolated_values() sets Vector size itself.
+	   Vector<double> prev_values;
+	   father_el_pt->get_interpolated_values(t,s,prev_values);
+                 
+	   //Initialise the values at the new node
+	   unsigned n_value = created_node_pt->nvalue();
+	   for (unsigned k=0;k<n_value;k++)
+	   {
+	    created_node_pt->set_value(t,k,prev_values[k]);
+	   }
 	  }
 	 }
 
@@ -2051,6 +2140,33 @@ namespace oomph
   oc_hang_helper(value_id,F,dummy_hangfile);
  }
 
+//====================================================================
+/// Compute the changes that setup_hanging_nodes(...) would make to the
+/// geometric hanging node schemes and nodal positions, without changing
+/// any nodes. Returns false for solid and p-refineable elements, whose
+/// overloaded oc_hang_helper(...) isn't covered.
+//====================================================================
+ bool RefineableQElement<3>::get_pending_geometric_hanging_nodes(
+  Vector<PendingHangingNode>& pending)
+ {
+  if ((dynamic_cast<RefineableSolidElement*>(this)!=0)||
+      (dynamic_cast<PRefineableElement*>(this)!=0))
+  {
+   return false;
+  }
+
+  using namespace OcTreeNames;
+
+  std::ofstream dummy_hangfile;
+  face_hang_helper(-1,U,dummy_hangfile,&pending);
+  face_hang_helper(-1,D,dummy_hangfile,&pending);
+  face_hang_helper(-1,L,dummy_hangfile,&pending);
+  face_hang_helper(-1,R,dummy_hangfile,&pending);
+  face_hang_helper(-1,B,dummy_hangfile,&pending);
+  face_hang_helper(-1,F,dummy_hangfile,&pending);
+  return true;
+ }
+
 //=================================================================
 /// Internal function to set up the hanging nodes on a particular
 /// face of the element
@@ -2058,6 +2174,19 @@ namespace oomph
  void RefineableQElement<3>::
  oc_hang_helper(const int &value_id, 
 		const int &my_face, std::ofstream& output_hangfile)
+ {
+  face_hang_helper(value_id,my_face,output_hangfile,0);
+ }
+
+//=================================================================
+/// Implementation of oc_hang_helper(...). If pending_pt is non-null,
+/// the changes to the nodes are appended to *pending_pt rather than
+/// being made.
+//=================================================================
+ void RefineableQElement<3>::
+ face_hang_helper(const int &value_id, 
+		  const int &my_face, std::ofstream& output_hangfile,
+		  Vector<PendingHangingNode>* pending_pt)
  {
   using namespace OcTreeNames;
 
@@ -2267,9 +2396,15 @@ namespace oomph
        //initially
        bool make_hanging_node = false;
            
+       //If the change is only recorded, the check whether the node is
+       //already hanging geometrically is deferred until it is applied
+       if (pending_pt!=0)
+       {
+	make_hanging_node = true;
+       }
        //If the node is not hanging geometrically, then we must make it 
        //hang
-       if (!local_node_pt->is_hanging())
+       else if (!local_node_pt->is_hanging())
        {
 	make_hanging_node = true;
        }
@@ -2353,7 +2488,18 @@ namespace oomph
 	//Now set the hanging data for the position
 	//This also constrains the data values associated with the
 	//value id
-	local_node_pt->set_hanging_pt(hang_pt,value_id);
+	if (pending_pt!=0)
+	{
+	 PendingHangingNode pending;
+	 pending.Node_pt=local_node_pt;
+	 pending.Hang_pt=hang_pt;
+	 pending.Only_if_not_hanging=true;
+	 pending_pt->push_back(pending);
+	}
+	else
+	{
+	 local_node_pt->set_hanging_pt(hang_pt,value_id);
+	}
        }
                  
        if (output_hangfile.is_open()) 
@@ -2366,7 +2512,16 @@ namespace oomph
       else
       {
 #ifdef PARANOID
-       if (local_node_pt!=neighbouring_node_pt)
+       //If the change is only recorded (possibly by a worker thread)
+       //the mismatch is reported when it's applied
+       if ((pending_pt!=0)&&(local_node_pt!=neighbouring_node_pt))
+       {
+	PendingHangingNode pending;
+	pending.Node_pt=local_node_pt;
+	pending.Neighbouring_node_pt=neighbouring_node_pt;
+	pending_pt->push_back(pending);
+       }
+       else if (local_node_pt!=neighbouring_node_pt)
        {
 	std::ofstream reportage("dodgy.dat",std::ios_base::app);
 	reportage << local_node_pt->x(0) << " "
@@ -2400,16 +2555,29 @@ namespace oomph
       //If we are doing the position then
       if (value_id==-1)
       {
+       // If the change is only recorded, the position is interpolated
+       // from the neighbour when it's applied (the neighbour's nodes
+       // may be fine-adjusted before then)
+       if (pending_pt!=0)
+       {
+	PendingHangingNode pending;
+	pending.Node_pt=local_node_pt;
+	pending.Neighbour_pt=neigh_pt->object_pt();
+	pending.S_in_neighbour=s_in_neighb;
+	pending_pt->push_back(pending);
+       }
+       else
+       {
+	// Get the nodal position from neighbour element
+	Vector<double> x_in_neighb(n_dim);
+	neigh_pt->object_pt()->interpolated_x(s_in_neighb,x_in_neighb);
            
-       // Get the nodal position from neighbour element
-       Vector<double> x_in_neighb(n_dim);
-       neigh_pt->object_pt()->interpolated_x(s_in_neighb,x_in_neighb);
-           
-       // Fine adjust the coordinates (macro map will pick up boundary
-       // accurately but will lead to different element edges)
-       local_node_pt->x(0)=x_in_neighb[0];
-       local_node_pt->x(1)=x_in_neighb[1];
-       local_node_pt->x(2)=x_in_neighb[2];
+	// Fine adjust the coordinates (macro map will pick up boundary
+	// accurately but will lead to different element edges)
+	local_node_pt->x(0)=x_in_neighb[0];
+	local_node_pt->x(1)=x_in_neighb[1];
+	local_node_pt->x(2)=x_in_neighb[2];
+       }
       }
      }
     }
@@ -2901,5 +3069,12 @@ namespace oomph
 //========================================================================
  std::map<unsigned,DenseMatrix<int> > RefineableQElement<3>::Father_bound;
 
+//========================================================================
+/// Static matrices of the father's shape functions at the son's
+/// nodal points
+//========================================================================
+ std::map<unsigned, Vector<DenseMatrix<double> > > 
+  RefineableQElement<3>::Father_to_son_shape;
+
 
 }
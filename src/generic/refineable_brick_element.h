@@ -160,6 +160,12 @@ public:
  /// as for the pressure in Taylor Hood). 
  virtual void further_setup_hanging_nodes()=0;
 
+ /// \short Compute the changes that setup_hanging_nodes(...) would make
+ /// to the geometric hanging node schemes and nodal positions, without
+ /// changing any nodes. Not implemented (returns false) for solid and
+ /// p-refineable elements, which overload oc_hang_helper(...).
+ bool get_pending_geometric_hanging_nodes(Vector<PendingHangingNode>& pending);
+
   protected:
  
  /// \short Coincidence between son nodal points and father boundaries:  
@@ -173,6 +179,17 @@ public:
  /// \short Setup static matrix for coincidence between son 
  /// nodal points and father boundaries
  void setup_father_bounds();
+
+ /// \short Father's shape functions at the son's nodal points:
+ /// Father_to_son_shape[node_1d][son_type](jnod_son,jnod_father) 
+ /// (only set up for elements that interpolate their values 
+ /// isoparametrically, see get_isoparametric_value_indices(...))
+ static std::map<unsigned, Vector<DenseMatrix<double> > > 
+  Father_to_son_shape;
+
+ /// \short Setup static matrices of the father's shape functions
+ /// at the son's nodal points
+ void setup_father_to_son_shape();
  
  /// \short Determine Vector of boundary conditions along the element's 
  /// face (R/L/U/D/B/F) -- BC is the least restrictive combination 
@@ -225,6 +242,13 @@ public:
  virtual void oc_hang_helper(const int &value_id,
                              const int &my_edge, std::ofstream &output_hangfile);
 
+ /// \short Implementation of oc_hang_helper(...). If pending_pt is
+ /// non-null, the changes to the nodes are appended to *pending_pt 
+ /// rather than being made.
+ void face_hang_helper(const int &value_id,
+                       const int &my_face, std::ofstream &output_hangfile,
+                       Vector<PendingHangingNode>* pending_pt);
+
 };
 
 
@@ -31,11 +31,83 @@
 
 namespace oomph
 {
+ //=====================================================================
+ /// Make the change to the node's geometric hanging node scheme
+ /// and/or position
+ //=====================================================================
+ void PendingHangingNode::apply()
+ {
+  if (Hang_pt!=0)
+   {
+    if (Only_if_not_hanging && Node_pt->is_hanging())
+     {
+      delete Hang_pt;
+     }
+    else
+     {
+      Node_pt->set_hanging_pt(Hang_pt,-1);
+     }
+    Hang_pt=0;
+   }
+
+#ifdef PARANOID
+  if (Neighbouring_node_pt!=0)
+   {
+    unsigned n_dim=Node_pt->ndim();
+
+    // Record the position (as RefineableQElement<3>::oc_hang_helper(...)
+    // does)
+    if (n_dim==3)
+     {
+      std::ofstream reportage("dodgy.dat",std::ios_base::app);
+      reportage << Node_pt->x(0) << " "
+                << Node_pt->x(1) << " "
+                << Node_pt->x(2) << std::endl;
+      reportage.close();
+     }
+
+    std::ostringstream warning_stream;
+    warning_stream << "SANITY CHECK in hanging node setup      \n"
+                   << "Current node      " << Node_pt << " at (";
+    for (unsigned i=0;i<n_dim;i++)
+     {
+      warning_stream << Node_pt->x(i) << (i+1<n_dim ? ", " : ")");
+     }
+    warning_stream << std::endl << " is not hanging and has " << std::endl
+                   << "Neighbour's node  " << Neighbouring_node_pt 
+                   << " at (";
+    for (unsigned i=0;i<n_dim;i++)
+     {
+      warning_stream << Neighbouring_node_pt->x(i) 
+                     << (i+1<n_dim ? ", " : ")");
+     }
+    warning_stream << std::endl << "even though the two should be "
+                   << "identical" << std::endl;
+    OomphLibWarning(warning_stream.str(),
+                    OOMPH_CURRENT_FUNCTION,
+                    OOMPH_EXCEPTION_LOCATION);
+   }
+#endif
+
+  // Fine adjust the (first dim()) coordinates from the neighbour's 
+  // current nodal positions
+  if (Neighbour_pt!=0)
+   {
+    unsigned n_dim=Neighbour_pt->dim();
+    Vector<double> x_in_neighb(std::max(n_dim,
+                                        Neighbour_pt->nodal_dimension()));
+    Neighbour_pt->interpolated_x(S_in_neighbour,x_in_neighb);
+    for (unsigned i=0;i<n_dim;i++)
+     {
+      Node_pt->x(i)=x_in_neighb[i];
+     }
+   }
+ }
+
  //=====================================================================
  /// Destructor (needed here because of IBM xlC compiler under AIX)
- /// Delete the storage allocated for the local equations.
  //====================================================================
- RefineableElement::~RefineableElement() {delete[] Local_hang_eqn;}
+ RefineableElement::~RefineableElement() {}
 
 //========================================================================
 /// Max. allowed discrepancy in element integrity check
@@ -318,17 +390,36 @@ namespace oomph
     //Find the number of continuously interpolated values
     const unsigned n_cont_values = ncont_interpolated_values();
 
-    //Delete the storage associated with the local hanging equation schemes
-    delete[] Local_hang_eqn;
-    //Allocate new storage
-    Local_hang_eqn = new std::map<Node*,int>[n_cont_values];
-
-    //Boolean that is set to true if there are hanging equation numbers
-    bool hanging_eqn_numbers = false;
+    //Collect the distinct master nodes of all hanging nodes
+    Hang_master_node_pt.clear();
+    for(unsigned n=0;n<n_node;n++)
+     {
+      for(unsigned j=0;j<n_cont_values;j++)
+       {
+        if(node_pt(n)->is_hanging(j))
+         {
+          HangInfo* hang_info_pt = node_pt(n)->hanging_pt(j);
+          unsigned n_master = hang_info_pt->nmaster();
+          for(unsigned m=0;m<n_master;m++)
+           {
+            Hang_master_node_pt.push_back(hang_info_pt->master_node_pt(m));
+           }
+         }
+       }
+     }
 
-    //Maps that store whether the node's local equation number for a
-    //particular value has already been assigned
-    Vector<std::map<Node*,bool> > local_eqn_number_done(n_cont_values);
+    //Sort them so that they can be found by binary search and 
+    //remove duplicates
+    std::sort(Hang_master_node_pt.begin(),Hang_master_node_pt.end());
+    Hang_master_node_pt.erase(std::unique(Hang_master_node_pt.begin(),
+                                          Hang_master_node_pt.end()),
+                              Hang_master_node_pt.end());
+
+    //Allocate the flat table of local equation numbers; entries
+    //that are still unclassified haven't been assigned yet
+    Nhang_value = n_cont_values;
+    Local_hang_eqn.assign(Hang_master_node_pt.size()*n_cont_values,
+                          static_cast<int>(Data::Is_unclassified));
     
     //Get number of dofs assigned thus far
     unsigned local_eqn_number = ndof();
@@ -355,10 +446,16 @@ namespace oomph
            {
             //Get the m-th master node
             Node* Master_node_pt = hang_info_pt->master_node_pt(m);
+
+            //Get the entry in the flat table
+            int &local_hang_eqn_entry = Local_hang_eqn[
+             (std::lower_bound(Hang_master_node_pt.begin(),
+                               Hang_master_node_pt.end(),Master_node_pt)
+              - Hang_master_node_pt.begin())*n_cont_values + j];
            
             //If the master node's value has not been considered already,
             //give it a local equation number
-            if(local_eqn_number_done[j][Master_node_pt] == false)
+            if(local_hang_eqn_entry == Data::Is_unclassified)
              {
 #ifdef PARANOID
               //Check that the value is stored at the master node
@@ -404,8 +501,7 @@ namespace oomph
                {
                 //Copy the local equation number to the 
                 //pointer-based look-up scheme
-                Local_hang_eqn[j][Master_node_pt] = 
-                 nodal_local_eqn(local_node_index,j);
+                local_hang_eqn_entry = nodal_local_eqn(local_node_index,j);
                }
               //Otherwise it's a new master node
               else
@@ -424,21 +520,16 @@ namespace oomph
                      Master_node_pt->value_pt(j));
                    }
                   //Add to pointer based scheme
-                  Local_hang_eqn[j][Master_node_pt] = local_eqn_number;
+                  local_hang_eqn_entry = local_eqn_number;
                   //Increase number of local variables
                   local_eqn_number++;
                  }
                 //Otherwise the value is pinned
                 else
                  {
-                  Local_hang_eqn[j][Master_node_pt] = Data::Is_pinned;
+                  local_hang_eqn_entry = Data::Is_pinned;
                  }
-                //There are now hanging equation numbers
                }
-              //The value at this node has now been done
-              local_eqn_number_done[j][Master_node_pt] = true;
-              //There are hanging equation numbers
-              hanging_eqn_numbers = true;
             }
            }
          }
@@ -453,14 +544,6 @@ namespace oomph
      {std::deque<double*>().swap(GeneralisedElement::Dof_pt_deque);}
     
 
-    //If there are no hanging_eqn_numbers delete the (empty) stored maps
-    if(!hanging_eqn_numbers) 
-     {
-      delete[] Local_hang_eqn; 
-      Local_hang_eqn=0;
-     }
-    
-
     // Setup map that associates a unique number with any of the nodes 
     // that actively control the shape of the element (i.e. they are 
     // either non-hanging nodes of this element or master nodes 
@@ -665,6 +748,135 @@ void RefineableElement::identify_field_data_for_interactions(
  }
 
 
+//============================================================================
+/// Check whether the batched father-to-son solution transfer can be used
+/// (see get_isoparametric_value_indices(...)): The element has to opt in
+/// and its nodal indices have to cover all continuously interpolated
+/// values and all values stored at its nodes; otherwise we fall back to
+/// the node-by-node transfer via get_interpolated_values(...).
+//============================================================================
+ bool RefineableElement::batched_value_transfer_is_possible(
+  Vector<unsigned>& value_index) const
+ {
+  if (!get_isoparametric_value_indices(value_index)) {return false;}
+  
+  // Does the element interpolate more (or fewer) values than it told us
+  // about?
+  const unsigned n_cont = value_index.size();
+  if (n_cont!=ncont_interpolated_values()) {return false;}
+
+  // Do any of the nodes store additional values?
+  const unsigned n_node = nnode();
+  for(unsigned l=0;l<n_node;l++)
+   {
+    if (node_pt(l)->nvalue()>n_cont) {return false;}
+   }
+  return true;
+ }
+
+//============================================================================
+/// Batched father-to-son solution transfer: Gather the father's nodal 
+/// values (at the nodal indices value_index and all ntstorage history
+/// levels) into the columns of a dense matrix and multiply it by the
+/// father-to-son interpolation matrix father_to_son_shape(j,l)=psi_l(s_j),
+/// where s_j is the position of the son's j-th node in the father.
+/// The result is son_values(j,t*n_cont+k), the k-th continuously 
+/// interpolated value at the son's j-th node at history level t. 
+/// This is equivalent to calling the father's get_interpolated_values(...)
+/// at every son node and history level if the values are interpolated
+/// isoparametrically (see get_isoparametric_value_indices(...)).
+//============================================================================
+ void RefineableElement::interpolate_father_values_to_son_nodes(
+  RefineableElement* const &father_el_pt, 
+  const DenseMatrix<double>& father_to_son_shape,
+  const Vector<unsigned>& value_index, const unsigned& ntstorage,
+  DenseMatrix<double>& son_values)
+ {
+  const unsigned n_son_node = father_to_son_shape.nrow();
+  const unsigned n_father_node = father_to_son_shape.ncol();
+  const unsigned n_cont = value_index.size();
+  const unsigned n_col = ntstorage*n_cont;
+
+#ifdef PARANOID
+  if (n_father_node!=father_el_pt->nnode())
+   {
+    std::ostringstream error_message;
+    error_message << "Father-to-son interpolation matrix has " 
+                  << n_father_node << " columns but the father element has "
+                  << father_el_pt->nnode() << " nodes.\n";
+    throw OomphLibError(error_message.str(),
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+  if (n_cont!=father_el_pt->ncont_interpolated_values())
+   {
+    std::ostringstream error_message;
+    error_message << "get_isoparametric_value_indices(...) returned "
+                  << n_cont << " nodal indices but the element has "
+                  << father_el_pt->ncont_interpolated_values() 
+                  << " continuously interpolated values.\n"
+                  << "It probably needs to be overloaded (to return false)"
+                  << " in a derived element.\n";
+    throw OomphLibError(error_message.str(),
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+#endif
+
+  // Gather the father's nodal values (this takes hanging nodes into 
+  // account) for all history levels
+  DenseMatrix<double> father_values(n_father_node,n_col);
+  for(unsigned l=0;l<n_father_node;l++)
+   {
+    for(unsigned t=0;t<ntstorage;t++)
+     {
+      for(unsigned k=0;k<n_cont;k++)
+       {
+        father_values(l,t*n_cont+k)=
+         father_el_pt->nodal_value(t,l,value_index[k]);
+       }
+     }
+   }
+
+  // Interpolate to the son's nodes
+  son_values.resize(n_son_node,n_col);
+  son_values.initialise(0.0);
+  for(unsigned j=0;j<n_son_node;j++)
+   {
+    for(unsigned l=0;l<n_father_node;l++)
+     {
+      const double psi=father_to_son_shape(j,l);
+      for(unsigned c=0;c<n_col;c++)
+       {
+        son_values(j,c)+=father_values(l,c)*psi;
+       }
+     }
+   }
+ }
+
+//============================================================================
+/// Assign the values (at all ntstorage history levels) at the son's j-th 
+/// node from the matrix computed by 
+/// interpolate_father_values_to_son_nodes(...). If the node stores fewer
+/// values than are interpolated only its nvalue() values are assigned.
+//============================================================================
+ void RefineableElement::set_nodal_values_from_son_values(
+  Node* const &nod_pt, const unsigned& j, 
+  const DenseMatrix<double>& son_values, const unsigned& ntstorage)
+ {
+  const unsigned n_cont = son_values.ncol()/ntstorage;
+  const unsigned n_val_at_node = nod_pt->nvalue();
+  const unsigned n_var = n_val_at_node < n_cont ? n_val_at_node : n_cont;
+  for(unsigned t=0;t<ntstorage;t++)
+   {
+    for(unsigned k=0;k<n_var;k++)
+     {
+      nod_pt->set_value(t,k,son_values(j,t*n_cont+k));
+     }
+   }
+ }
+
+
 //============================================================================
 /// This function calculates the entries of Jacobian matrix, used in 
 /// the Newton method, associated with the nodal degrees of freedom. 
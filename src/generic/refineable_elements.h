@@ -34,6 +34,8 @@
   #include <oomph-lib-config.h>
 #endif
 
+#include <algorithm>
+
 #include "elements.h"
 #include "tree.h"
 
@@ -42,6 +44,53 @@ namespace oomph
 
 class Mesh;
 
+//=======================================================================
+/// \short A change to the geometric hanging node scheme (and/or the
+/// fine-adjusted position) of a node, as computed (but not yet made) by
+/// RefineableElement::get_pending_geometric_hanging_nodes(...).
+/// Anything that depends on the current state of the nodes (their
+/// hanging status and positions) is only evaluated when the change is
+/// made, so applying the elements' changes in order has the same effect
+/// as calling their setup_hanging_nodes(...) in that order.
+//=======================================================================
+class PendingHangingNode
+{
+
+  public:
+
+ /// Constructor: Nothing to change yet
+ PendingHangingNode() : Node_pt(0), Hang_pt(0), Only_if_not_hanging(false),
+  Neighbour_pt(0), Neighbouring_node_pt(0)
+  {}
+
+ /// Make the change. The HangInfo is handed over to the node (or deleted)
+ void apply();
+
+ /// The node to be changed
+ Node* Node_pt;
+
+ /// \short New geometric hanging node scheme of the node (null if its
+ /// hanging status isn't to be changed)
+ HangInfo* Hang_pt;
+
+ /// \short Only make the node hang if it isn't hanging already
+ /// (otherwise Hang_pt is deleted)
+ bool Only_if_not_hanging;
+
+ /// \short Element from which the node's fine-adjusted position is 
+ /// interpolated (null if the position isn't to be changed)
+ FiniteElement* Neighbour_pt;
+
+ /// Local coordinate of the node in Neighbour_pt
+ Vector<double> S_in_neighbour;
+
+ /// \short Node in the neighbouring element that should be identical
+ /// to Node_pt but isn't (only recorded under PARANOID; a warning is
+ /// issued when the change is made)
+ Node* Neighbouring_node_pt;
+
+};
+
 //=======================================================================
 /// RefineableElements are FiniteElements that may be subdivided into 
 /// children to provide a better local approximation to the solution. 
@@ -161,12 +210,26 @@ class RefineableElement : public virtual FiniteElement
 
   private:
 
+ /// \short Sorted (by address) list of all distinct master nodes of the
+ /// element's hanging nodes. It is essential that the hanging equations
+ /// are indexed by a Node pointer because the Node may be internal or
+ /// external to the element; the position of the master node in this
+ /// list provides the row in the flat Local_hang_eqn table.
+ Vector<Node*> Hang_master_node_pt;
+
  /// \short Storage for local equation numbers of hanging node variables
- /// (values stored at master nodes). It is
- /// essential that these are indexed by a Node pointer because the Node 
- /// may be internal or external to the element.
- /// local equation number = Local_hang_eqn(master_node_pt,ival)
-  std::map<Node*,int> *Local_hang_eqn;
+ /// (values stored at master nodes), stored contiguously in a flat
+ /// table with one row of ncont_interpolated_values() entries per
+ /// master node in Hang_master_node_pt:
+ /// local equation number = Local_hang_eqn[m*Nhang_value+ival],
+ /// where m is the index of the master node in Hang_master_node_pt.
+ /// Entries for values in which the node does not act as a master
+ /// are Data::Is_unclassified.
+ Vector<int> Local_hang_eqn;
+
+ /// \short Number of values per master node in the Local_hang_eqn table
+ /// (the number of continuously interpolated values when it was set up)
+ unsigned Nhang_value;
 
  /// \short Lookup scheme for unique number associated with any of the nodes
  /// that actively control the shape of the element (i.e. they are either
@@ -175,6 +238,26 @@ class RefineableElement : public virtual FiniteElement
 
   protected:
  
+ /// \short Batched father-to-son solution transfer for elements whose
+ /// get_isoparametric_value_indices(value_index) returns true: Given
+ /// the father's shape functions evaluated at the son's nodes,
+ /// father_to_son_shape(j,l)=psi_l(s_j), return the values at all the
+ /// son's nodes and history levels as 
+ /// son_values(j,t*value_index.size()+k), computed as one dense
+ /// matrix product with the father's nodal values.
+ static void interpolate_father_values_to_son_nodes(
+  RefineableElement* const &father_el_pt, 
+  const DenseMatrix<double>& father_to_son_shape,
+  const Vector<unsigned>& value_index, const unsigned& ntstorage,
+  DenseMatrix<double>& son_values);
+
+ /// \short Assign the values at the son's j-th node from the matrix
+ /// computed by interpolate_father_values_to_son_nodes(...), for all
+ /// ntstorage history levels. Only the first nvalue() values are assigned
+ /// if the node stores fewer values than are interpolated.
+ static void set_nodal_values_from_son_values(
+  Node* const &nod_pt, const unsigned& j, 
+  const DenseMatrix<double>& son_values, const unsigned& ntstorage);
 
  /// \short Assign the local equation numbers for hanging node variables
  void assign_hanging_local_eqn_numbers(const bool &store_local_dof_pt);
@@ -193,9 +276,9 @@ class RefineableElement : public virtual FiniteElement
  RefineableElement() : FiniteElement(), Tree_pt(0), Refine_level(0),
   To_be_refined(false), Refinement_is_enabled(true),
   Sons_to_be_unrefined(false), Number(-1),
-  Local_hang_eqn(0) {}
+  Nhang_value(0) {}
 
- /// Destructor, delete the allocated storage for the hanging equations
+ /// Destructor
  // (The body is now in the cc file to keep the xlC compiler happy under AIX)
  virtual ~RefineableElement();
 
@@ -276,7 +359,45 @@ class RefineableElement : public virtual FiniteElement
     }
 #endif
 
-   return Local_hang_eqn[i][node_pt];
+   //Binary search for the master node in the sorted list
+   Vector<Node*>::const_iterator it=
+    std::lower_bound(Hang_master_node_pt.begin(),
+                     Hang_master_node_pt.end(),node_pt);
+
+   //Node isn't a master node of any of the element's hanging nodes
+   if((it==Hang_master_node_pt.end()) || (*it!=node_pt))
+    {
+#ifdef PARANOID
+     std::ostringstream error_message;
+     error_message << "Node " << node_pt 
+                   << " is not a master node of any of the hanging nodes\n"
+                   << "in this element. Have the local equation numbers\n"
+                   << "been assigned?";
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+#endif
+     return static_cast<int>(Data::Is_unclassified);
+    }
+
+   //Return the entry in the flat table
+   const int local_eqn=
+    Local_hang_eqn[(it-Hang_master_node_pt.begin())*Nhang_value+i];
+
+#ifdef PARANOID
+   if(local_eqn==Data::Is_unclassified)
+    {
+     std::ostringstream error_message;
+     error_message << "Node " << node_pt 
+                   << " is not a master node for value " << i 
+                   << " of any of the hanging nodes in this element.";
+     throw OomphLibError(error_message.str(),
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+
+   return local_eqn;
   }
 
  /// \short Interface to function that builds the element: i.e.  construct
@@ -376,6 +497,30 @@ class RefineableElement : public virtual FiniteElement
                                       const Vector<double>&s, 
                                       Vector<double>& values)=0;
 
+ /// \short Return true if the element's continuously interpolated values
+ /// are all stored at its nodes and interpolated with its geometric shape
+ /// functions (at all history levels), so that get_interpolated_values(...)
+ /// returns value k as the shape-function weighted sum of 
+ /// nodal_value(t,l,value_index[k]). The solution is then transferred
+ /// from father to son during refinement with a precomputed interpolation
+ /// matrix that is cached per nnode_1d and son type, so this may only
+ /// be overloaded by elements whose shape functions are fully determined by
+ /// nnode_1d (e.g. the Lagrange-interpolated QElements).
+ /// Default: false, i.e. the transfer calls get_interpolated_values(...)
+ /// for every node and history level.
+ virtual bool get_isoparametric_value_indices(
+  Vector<unsigned>& /*value_index*/) const {return false;}
+
+ /// \short Return true if the solution can be transferred to the sons
+ /// with the batched father-to-son interpolation, i.e. if 
+ /// get_isoparametric_value_indices(value_index) returns true and the
+ /// indices cover all ncont_interpolated_values() values and all values
+ /// stored at the element's nodes. This guards against derived elements
+ /// that inherit the opt-in but add nodal values (or overload 
+ /// get_interpolated_values(...)); their values are then transferred
+ /// node by node.
+ bool batched_value_transfer_is_possible(Vector<unsigned>& value_index) const;
+
  /// \short In mixed elements, different sets of nodes are used to interpolate
  /// different unknowns. This function returns the n-th node that interpolates
  /// the value_id-th unknown. Default implementation is that all
@@ -524,6 +669,17 @@ class RefineableElement : public virtual FiniteElement
  /// for the pressure in Taylor Hood). 
  virtual void further_setup_hanging_nodes() { }
 
+ /// \short Compute the changes that setup_hanging_nodes(...) would make
+ /// to the geometric hanging node schemes and nodal positions, without
+ /// changing any nodes, so that this can be done for several elements
+ /// concurrently. The changes are appended to pending in the order in
+ /// which setup_hanging_nodes(...) would make them; the fine-adjusted
+ /// positions are based on the current nodal positions. Returns false 
+ /// (without doing anything) if this isn't implemented for the element,
+ /// in which case setup_hanging_nodes(...) has to be used.
+ virtual bool get_pending_geometric_hanging_nodes(
+  Vector<PendingHangingNode>& /*pending*/) {return false;}
+
  /// \short Compute derivatives of elemental residual vector with respect
  /// to nodal coordinates. Default implementation by FD can be overwritten
  /// for specific elements. 
@@ -82,6 +82,51 @@ namespace oomph
 
   // Other boundary is in the interior
  }
+
+ //==========================================================================
+ /// Setup static matrices of the father's shape functions at the son's
+ /// nodal points:
+ ///
+ /// Father_to_son_shape[nnode_1d][son_type](nnode_son,nnode_father)
+ ///
+ /// These are used to transfer the solution from father to son during
+ /// refinement for elements whose values are interpolated isoparametrically
+ /// (see get_isoparametric_value_indices(...)).
+ //==========================================================================
+ void RefineableQElement<1>::setup_father_to_son_shape()
+ {
+  using namespace BinaryTreeNames;
+
+  // Find the number of nodes along a 1D edge (which is the number of nodes
+  // in the element for a 1D element!)
+  const unsigned n_node = nnode_1d();
+
+  // Allocate space for the matrices
+  Father_to_son_shape[n_node].resize(2);
+
+  Shape psi(n_node);
+  Vector<double> s_in_father(1);
+  for(int son_type=L;son_type<=R;son_type++)
+   {
+    // Left-hand vertex of the son in the father element
+    const double s_left = (son_type==L) ? -1.0 : 0.0;
+
+    DenseMatrix<double>& father_to_son_shape = 
+     Father_to_son_shape[n_node][son_type];
+    father_to_son_shape.resize(n_node,n_node);
+    for(unsigned n=0;n<n_node;n++)
+     {
+      s_in_father[0] = s_left + local_one_d_fraction_of_node(n,0);
+
+      // Father's shape functions at the son's node
+      shape(s_in_father,psi);
+      for(unsigned l=0;l<n_node;l++)
+       {
+        father_to_son_shape(n,l) = psi[l];
+       }
+     }
+   }
+ }
  
  //==========================================================================
  /// If a neighbouring element has already created a node at a position
@@ -329,6 +374,24 @@ namespace oomph
       // element) of the node in the direction of s[0]
       Vector<double> s_fraction(1);
 
+      // If the father interpolates its values isoparametrically, transfer
+      // them to all of the current element's nodes and history levels in
+      // one go, using the precomputed father-to-son interpolation matrix
+      Vector<unsigned> value_index;
+      const bool batched_transfer =
+       father_el_pt->batched_value_transfer_is_possible(value_index);
+      DenseMatrix<double> son_values;
+      if(batched_transfer)
+       {
+        if(Father_to_son_shape[n_node].size()==0)
+         {
+          setup_father_to_son_shape();
+         }
+        interpolate_father_values_to_son_nodes(
+         father_el_pt,Father_to_son_shape[n_node][son_type],
+         value_index,ntstorage,son_values);
+       }
+
       // Loop over all nodes in the element
       for(unsigned n=0;n<n_node;n++)
        {
@@ -361,27 +424,35 @@ namespace oomph
           // needed for mixed interpolation where the value at the father
           // could now become active.
 
-          // Loop over all history values
-          for(unsigned t=0;t<ntstorage;t++)
+          if(batched_transfer)
            {
-            // Get values from father element
-            // Note: get_interpolated_values() sets Vector size itself
-            Vector<double> prev_values;
-            father_el_pt->get_interpolated_values(t,s_in_father,prev_values);
-
-            // Find the minimum number of values (either those stored at the
-            // node, or those returned by the function)
-            unsigned n_val_at_node = created_node_pt->nvalue();
-            unsigned n_val_from_function = prev_values.size(); 
-
-            // Use the ternary conditional operator here
-            unsigned n_var = n_val_at_node < n_val_from_function ?
-             n_val_at_node : n_val_from_function;
-
-            // Assign the values that we can
-            for(unsigned k=0;k<n_var;k++)
+            set_nodal_values_from_son_values(created_node_pt,n,
+                                             son_values,ntstorage);
+           }
+          else
+           {
+            // Loop over all history values
+            for(unsigned t=0;t<ntstorage;t++)
              {
-              created_node_pt->set_value(t,k,prev_values[k]);
+              // Get values from father element
+              // Note: get_interpolated_values() sets Vector size itself
+              Vector<double> prev_values;
+              father_el_pt->get_interpolated_values(t,s_in_father,prev_values);
+  
+              // Find the minimum number of values (either those stored at the
+              // node, or those returned by the function)
+              unsigned n_val_at_node = created_node_pt->nvalue();
+              unsigned n_val_from_function = prev_values.size(); 
+  
+              // Use the ternary conditional operator here
+              unsigned n_var = n_val_at_node < n_val_from_function ?
+               n_val_at_node : n_val_from_function;
+  
+              // Assign the values that we can
+              for(unsigned k=0;k<n_var;k++)
+               {
+                created_node_pt->set_value(t,k,prev_values[k]);
+               }
              }
            }
           
@@ -472,27 +543,39 @@ namespace oomph
             // Set the previous position of the new node
             created_node_pt->x(t,0) = x_prev[0];
 
-            // Allocate storage for the previous values at the node
-            // NOTE: the size of this vector is equal to the number of values
-            // (e.g. 3 velocity components and 1 pressure, say)
-            // associated with each node and NOT the number of history values
-            // which the node stores!
-            Vector<double> prev_values;
+            // Unless they are transferred in one go (below), get the values
+            // from the father element
+            if(!batched_transfer)
+             {
+              // Allocate storage for the previous values at the node
+              // NOTE: the size of this vector is equal to the number of values
+              // (e.g. 3 velocity components and 1 pressure, say)
+              // associated with each node and NOT the number of history values
+              // which the node stores!
+              Vector<double> prev_values;
             
-            // Get values from father element
-            // Note: get_interpolated_values() sets Vector size itself.
-            father_el_pt->get_interpolated_values(t,s_in_father,prev_values);
+              // Get values from father element
+              // Note: get_interpolated_values() sets Vector size itself.
+              father_el_pt->get_interpolated_values(t,s_in_father,prev_values);
             
-            // Determine the number of values at the new node
-            const unsigned n_value = created_node_pt->nvalue();
+              // Determine the number of values at the new node
+              const unsigned n_value = created_node_pt->nvalue();
             
-            // Loop over all values and set the previous values
-            for(unsigned v=0;v<n_value;v++)
-             {
-              created_node_pt->set_value(t,v,prev_values[v]);
+              // Loop over all values and set the previous values
+              for(unsigned v=0;v<n_value;v++)
+               {
+                created_node_pt->set_value(t,v,prev_values[v]);
+               }
              }
            } // End of loop over history values
           
+          // Set the values at the new node
+          if(batched_transfer)
+           {
+            set_nodal_values_from_son_values(created_node_pt,n,
+                                             son_values,ntstorage);
+           }
+
           // Add new node to mesh
           mesh_pt->add_node_pt(created_node_pt);
          
@@ -865,4 +948,11 @@ namespace oomph
  //==========================================================================
  std::map<unsigned,DenseMatrix<int> > RefineableQElement<1>::Father_bound;
 
+ //==========================================================================
+ /// Static matrices of the father's shape functions at the son's nodal
+ /// points
+ //==========================================================================
+ std::map<unsigned, Vector<DenseMatrix<double> > > 
+  RefineableQElement<1>::Father_to_son_shape;
+
 } // End of namespace
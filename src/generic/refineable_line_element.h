@@ -164,6 +164,17 @@ namespace oomph
    /// \short Setup static matrix for coincidence between son nodal points
    /// and father boundaries
    void setup_father_bounds();
+
+   /// \short Father's shape functions at the son's nodal points:
+   /// Father_to_son_shape[node_1d][son_type](jnod_son,jnod_father) 
+   /// (only set up for elements that interpolate their values 
+   /// isoparametrically, see get_isoparametric_value_indices(...))
+   static std::map<unsigned, Vector<DenseMatrix<double> > > 
+    Father_to_son_shape;
+
+   /// \short Setup static matrices of the father's shape functions
+   /// at the son's nodal points
+   void setup_father_to_son_shape();
    
    /// Line elements have no hanging nodes so this is deliberately left empty
    void setup_hang_for_value(const int &value_id) {}
@@ -40,6 +40,264 @@
 namespace oomph
 {
 
+#ifdef OOMPH_HAS_PTHREADS
+
+//======================================================================
+/// Helpers for the threaded parts of 
+/// TreeBasedRefineableMeshBase::adapt_mesh(...)
+//======================================================================
+namespace TreeBasedRefineableMeshHelpers
+{
+
+ //======================================================================
+ /// \short The leaves first to last-1 for which one thread calls the
+ /// member function in TreeBasedRefineableMeshBase::call_for_all_leaves(...)
+ //======================================================================
+ class LeafChunk
+ {
+
+   public:
+
+  /// Constructor: Everything is set up by the caller
+  LeafChunk() : Leaf_pt(0), Member_function(0), First(0), Last(0) {}
+
+  /// Do the work
+  void do_work()
+   {
+    for (unsigned k=First;k<Last;k++)
+     {
+      ((*Leaf_pt)[k]->*Member_function)();
+     }
+   }
+
+  /// The leaves of the forest
+  Vector<Tree*>* Leaf_pt;
+
+  /// The member function to be called
+  Tree::VoidMemberFctPt Member_function;
+
+  /// First leaf
+  unsigned First;
+
+  /// One after the last leaf
+  unsigned Last;
+
+ };
+
+
+ //======================================================================
+ /// \short The elements first to last-1 whose pending geometric hanging
+ /// nodes are computed by one thread in 
+ /// TreeBasedRefineableMeshBase::setup_hanging_nodes_with_threads(...)
+ //======================================================================
+ class PendingHangingNodeChunk
+ {
+
+   public:
+
+  /// Constructor: Everything is set up by the caller
+  PendingHangingNodeChunk() : Tree_nodes_pt(0), Pending_pt(0), First(0),
+   Last(0), All_supported(true) {}
+
+  /// Do the work
+  void do_work()
+   {
+    for (unsigned k=First;k<Last;k++)
+     {
+      if (!(*Tree_nodes_pt)[k]->object_pt()->
+          get_pending_geometric_hanging_nodes((*Pending_pt)[k]))
+       {
+        All_supported=false;
+        return;
+       }
+     }
+   }
+
+  /// The leaves of the forest
+  Vector<Tree*>* Tree_nodes_pt;
+
+  /// The pending changes for each element
+  Vector<Vector<PendingHangingNode> >* Pending_pt;
+
+  /// First element
+  unsigned First;
+
+  /// One after the last element
+  unsigned Last;
+
+  /// \short Was get_pending_geometric_hanging_nodes(...) implemented 
+  /// for all the elements?
+  bool All_supported;
+
+ };
+
+
+ //======================================================================
+ /// Work for one thread; the argument is a pointer to a CHUNK
+ //======================================================================
+ template<class CHUNK>
+ void do_chunk_work(void* chunk_pt)
+ {
+  static_cast<CHUNK*>(chunk_pt)->do_work();
+ }
+
+}
+
+#endif
+
+
+/// Min. number of elements per thread in the threaded parts of the 
+/// mesh adaptation
+unsigned TreeBasedRefineableMeshBase::Min_nelement_per_thread=64;
+
+
+//========================================================================
+/// Call the member function for all the leaves in the forest. With
+/// pthreads, contiguous chunks of leaves are processed concurrently by
+/// up to Nthread threads.
+//========================================================================
+void TreeBasedRefineableMeshBase::call_for_all_leaves(
+ Tree::VoidMemberFctPt member_function)
+{
+#ifdef OOMPH_HAS_PTHREADS
+
+ if (Nthread>1)
+  {
+   Vector<Tree*> leaf_pt;
+   Forest_pt->stick_leaves_into_vector(leaf_pt);
+   unsigned n_leaf=leaf_pt.size();
+
+   // How many threads are worth it?
+   unsigned n_thread=Nthread;
+   if (Min_nelement_per_thread>0)
+    {
+     n_thread=std::min(n_thread,n_leaf/Min_nelement_per_thread);
+    }
+   if (n_thread>1)
+    {
+     Vector<TreeBasedRefineableMeshHelpers::LeafChunk> chunk(n_thread);
+     for (unsigned t=0;t<n_thread;t++)
+      {
+       chunk[t].Leaf_pt=&leaf_pt;
+       chunk[t].Member_function=member_function;
+       chunk[t].First=(t*n_leaf)/n_thread;
+       chunk[t].Last=((t+1)*n_leaf)/n_thread;
+      }
+     std::string error_message=ThreadingHelpers::do_work_in_threads(
+      &TreeBasedRefineableMeshHelpers::do_chunk_work<
+      TreeBasedRefineableMeshHelpers::LeafChunk>,chunk);
+     if (!error_message.empty())
+      {
+       throw OomphLibError(error_message,
+                           OOMPH_CURRENT_FUNCTION,
+                           OOMPH_EXCEPTION_LOCATION);
+      }
+     return;
+    }
+  }
+
+#endif
+
+ // Serial
+ unsigned n_tree=Forest_pt->ntree();
+ for (unsigned e=0;e<n_tree;e++)
+  {
+   Forest_pt->tree_pt(e)->traverse_leaves(member_function);
+  }
+}
+
+
+//========================================================================
+/// Set up the hanging nodes for the elements in tree_nodes_pt (the leaves
+/// of the forest). The changes to the geometric hanging node schemes and
+/// nodal positions are computed concurrently by up to Nthread threads,
+/// then made (followed by the elements' further_setup_hanging_nodes())
+/// in the same order as by the elements' setup_hanging_nodes(...).
+/// Returns false (without changing anything) if this isn't supported
+/// by all elements or if there aren't enough elements to make threading
+/// worthwhile.
+//========================================================================
+bool TreeBasedRefineableMeshBase::setup_hanging_nodes_with_threads(
+ Vector<Tree*>& tree_nodes_pt)
+{
+#ifdef OOMPH_HAS_PTHREADS
+
+ unsigned n_element=tree_nodes_pt.size();
+
+ // How many threads are worth it?
+ unsigned n_thread=Nthread;
+ if (Min_nelement_per_thread>0)
+  {
+   n_thread=std::min(n_thread,n_element/Min_nelement_per_thread);
+  }
+ if (n_thread<2)
+  {
+   return false;
+  }
+
+ // Compute the changes for each element
+ Vector<Vector<PendingHangingNode> > pending(n_element);
+ Vector<TreeBasedRefineableMeshHelpers::PendingHangingNodeChunk> 
+  chunk(n_thread);
+ for (unsigned t=0;t<n_thread;t++)
+  {
+   chunk[t].Tree_nodes_pt=&tree_nodes_pt;
+   chunk[t].Pending_pt=&pending;
+   chunk[t].First=(t*n_element)/n_thread;
+   chunk[t].Last=((t+1)*n_element)/n_thread;
+  }
+ std::string error_message=ThreadingHelpers::do_work_in_threads(
+  &TreeBasedRefineableMeshHelpers::do_chunk_work<
+  TreeBasedRefineableMeshHelpers::PendingHangingNodeChunk>,chunk);
+ bool all_supported=true;
+ for (unsigned t=0;t<n_thread;t++)
+  {
+   if (!chunk[t].All_supported) all_supported=false;
+  }
+
+ // Discard the changes if we can't use them
+ if (!all_supported || !error_message.empty())
+  {
+   for (unsigned e=0;e<n_element;e++)
+    {
+     unsigned n_pending=pending[e].size();
+     for (unsigned k=0;k<n_pending;k++)
+      {
+       delete pending[e][k].Hang_pt;
+      }
+    }
+   if (!error_message.empty())
+    {
+     throw OomphLibError(error_message,
+                         OOMPH_CURRENT_FUNCTION,
+                         OOMPH_EXCEPTION_LOCATION);
+    }
+   return false;
+  }
+
+ // Make the changes in the serial order
+ for (unsigned e=0;e<n_element;e++)
+  {
+   unsigned n_pending=pending[e].size();
+   for (unsigned k=0;k<n_pending;k++)
+    {
+     pending[e][k].apply();
+    }
+   //Element specific setup
+   tree_nodes_pt[e]->object_pt()->further_setup_hanging_nodes();
+  }
+ return true;
+
+#else
+
+ // Can't do anything without pthreads
+ (void)tree_nodes_pt;
+ return false;
+
+#endif
+}
+
+
 //========================================================================
 /// Get refinement pattern of mesh: Consider the hypothetical mesh
 /// obtained by truncating the refinement of the current mesh to a given level 
@@ -1191,12 +1449,19 @@ void TreeBasedRefineableMeshBase::adapt_mesh(DocInfo& doc_info)
    //actually be opened if doc_info.is_doc_enabled() is true
    Forest_pt->open_hanging_node_files(doc_info,hanging_output_files);
 
-   for(unsigned long e=0;e<num_tree_nodes;e++)
+   // Use threads for the geometric hanging nodes if we can (the
+   // hanging nodes can only be documented in serial)
+   if (doc_info.is_doc_enabled() || 
+       !setup_hanging_nodes_with_threads(tree_nodes_pt))
     {
-     //Generic setup
-     tree_nodes_pt[e]->object_pt()->setup_hanging_nodes(hanging_output_files);
-     //Element specific setup
-     tree_nodes_pt[e]->object_pt()->further_setup_hanging_nodes();
+     for(unsigned long e=0;e<num_tree_nodes;e++)
+      {
+       //Generic setup
+       tree_nodes_pt[e]->object_pt()->
+        setup_hanging_nodes(hanging_output_files);
+       //Element specific setup
+       tree_nodes_pt[e]->object_pt()->further_setup_hanging_nodes();
+      }
     }
 
    //Close the hanging node files and delete the memory allocated 
@@ -2333,7 +2598,6 @@ void TreeBasedRefineableMeshBase::synchronise_hanging_nodes
 (const unsigned& ncont_interpolated_values)
 {
  // Store number of processors and current process
- MPI_Status status;
  int n_proc=Comm_pt->nproc();
  int my_rank=Comm_pt->my_rank();
 
@@ -2355,129 +2619,105 @@ void TreeBasedRefineableMeshBase::synchronise_hanging_nodes
  // Store number of continuosly interpolated values as int
  int ncont_inter_values=ncont_interpolated_values;
  
- // Loop over processes: Each processor checks that is haloed nodes
- // with proc d have consistent hanging stats with halo counterparts.
- for (int d=0; d<n_proc; d++)
+ // Get the processors we share halo(ed) nodes with: The hanging
+ // status only needs to be reconciled with those
+ Vector<unsigned> neighbour_proc;
+ get_neighbouring_processors(neighbour_proc);
+ unsigned n_neighbour=neighbour_proc.size();
+
+ // Loop over neighbours: Each processor records the hanging status of
+ // its haloed nodes with proc d and sends that of its halo nodes with
+ // proc d to proc d, where it's compared against the hanging status of
+ // the corresponding haloed nodes.
+ Vector<Vector<int> > local_halo_hanging(n_proc);
+ for (unsigned i=0;i<n_neighbour;i++)
   {
+   int d=neighbour_proc[i];
 
-   // No halo with self: Setup hang info for my haloed nodes with proc d 
-   // then get ready to receive halo info from processor d.
-   if (d!=my_rank) 
+   // Loop over haloed nodes
+   unsigned nh=nhaloed_node(d);     
+   for (unsigned j=0;j<nh;j++)
     {
+     // Get node
+     Node* nod_pt=haloed_node_pt(d,j);
      
-     // Loop over haloed nodes
-     unsigned nh=nhaloed_node(d);     
-     for (unsigned j=0;j<nh;j++)
-      {
-       // Get node
-       Node* nod_pt=haloed_node_pt(d,j);
-       
-       // Loop over the hanging status for each interpolated variable
-       // (and the geometry)
-       for (int icont=-1; icont<ncont_inter_values; icont++)
-        { 
-         // Store the hanging status of this haloed node
-         if (nod_pt->is_hanging(icont))
-          {
-           unsigned n_master=nod_pt->hanging_pt(icont)->nmaster();
-           haloed_hanging[d].push_back(n_master);
-          }
-         else
-          {
-           haloed_hanging[d].push_back(0);
-          }
+     // Loop over the hanging status for each interpolated variable
+     // (and the geometry)
+     for (int icont=-1; icont<ncont_inter_values; icont++)
+      { 
+       // Store the hanging status of this haloed node
+       if (nod_pt->is_hanging(icont))
+        {
+         unsigned n_master=nod_pt->hanging_pt(icont)->nmaster();
+         haloed_hanging[d].push_back(n_master);
+        }
+       else
+        {
+         haloed_hanging[d].push_back(0);
         }
-      }
-     
-     // Receive the hanging status information from the corresponding process
-     unsigned count_haloed=haloed_hanging[d].size();
-     
-#ifdef PARANOID
-     // Check that number of halo and haloed data match
-     unsigned tmp=0;     
-     MPI_Recv(&tmp,1,MPI_UNSIGNED,d,0,Comm_pt->mpi_comm(),&status);
-     if (tmp!=count_haloed)
-      {
-       std::ostringstream error_stream;
-       error_stream  << "Number of halo data, " << tmp  
-                     << ", does not match number of haloed data, " 
-                     << count_haloed << std::endl;
-       throw OomphLibError(
-        error_stream.str(),
-        OOMPH_CURRENT_FUNCTION,
-        OOMPH_EXCEPTION_LOCATION);
-      }
-#endif
-     
-     // Get the data (if any)
-     if (count_haloed!=0)
-      {
-       halo_hanging[d].resize(count_haloed);
-       MPI_Recv(&halo_hanging[d][0],count_haloed,MPI_INT,d,0,
-                Comm_pt->mpi_comm(),&status);       
       }
     }
-   else // d==my_rank, i.e. current process: Send halo hanging status 
-        // to process dd where it's received (see above) and compared
-        // and compared against the hang status of the haloed nodes
+
+   // Loop over halo nodes
+   nh=nhalo_node(d);
+   for (unsigned j=0;j<nh;j++)
     {
-     for (int dd=0; dd<n_proc; dd++)
-      {
-       // No halo with yourself
-       if (dd!=d)
+     // Get node
+     Node* nod_pt=halo_node_pt(d,j);
+     
+     // Loop over the hanging status for each interpolated variable
+     // (and the geometry)
+     for (int icont=-1; icont<ncont_inter_values; icont++)
+      { 
+       // Store hanging status of halo node
+       if (nod_pt->is_hanging(icont))
         {
-       
-         // Storage for halo hanging status and counter
-         Vector<int> local_halo_hanging;
-
-         // Loop over halo nodes
-         unsigned nh=nhalo_node(dd);
-         for (unsigned j=0;j<nh;j++)
-          {
-           // Get node
-           Node* nod_pt=halo_node_pt(dd,j);
-           
-           // Loop over the hanging status for each interpolated variable
-           // (and the geometry)
-           for (int icont=-1; icont<ncont_inter_values; icont++)
-            { 
-             // Store hanging status of halo node
-             if (nod_pt->is_hanging(icont))
-              {
-               unsigned n_master=nod_pt->hanging_pt(icont)->nmaster();
-               local_halo_hanging.push_back(n_master);
-              }
-             else
-              {
-               local_halo_hanging.push_back(0);
-              }
-            }
-          }
-         
-         
-         // Send the information to the relevant process
-         unsigned count_halo=local_halo_hanging.size();
-         
-#ifdef PARANOID
-         // Check that number of halo and haloed data match
-         MPI_Send(&count_halo,1,MPI_UNSIGNED,dd,0,Comm_pt->mpi_comm());
-#endif
-         
-         // Send data (if any)
-         if (count_halo!=0)
-          {
-           MPI_Send(&local_halo_hanging[0],count_halo,MPI_INT,
-                    dd,0,Comm_pt->mpi_comm());
-          }
+         unsigned n_master=nod_pt->hanging_pt(icont)->nmaster();
+         local_halo_hanging[d].push_back(n_master);
+        }
+       else
+        {
+         local_halo_hanging[d].push_back(0);
         }
       }
     }
   }
 
+ // Exchange the hanging status with the neighbours (there's no double
+ // data to be sent)
+ {
+  Vector<Vector<double> > send_double_data(n_proc);
+  Vector<Vector<double> > receive_double_data;
+  exchange_with_neighbouring_processors(neighbour_proc,
+                                        local_halo_hanging,send_double_data,
+                                        halo_hanging,receive_double_data);
+ }
+
+#ifdef PARANOID
+ // Check that number of halo and haloed data match
+ for (unsigned i=0;i<n_neighbour;i++)
+  {
+   int d=neighbour_proc[i];
+   if (halo_hanging[d].size()!=haloed_hanging[d].size())
+    {
+     std::ostringstream error_stream;
+     error_stream  << "Number of halo data, " << halo_hanging[d].size()  
+                   << ", does not match number of haloed data, " 
+                   << haloed_hanging[d].size() << std::endl;
+     throw OomphLibError(
+      error_stream.str(),
+      OOMPH_CURRENT_FUNCTION,
+      OOMPH_EXCEPTION_LOCATION);
+    }
+  }
+#endif
+
+
  if (Global_timings::Doc_comprehensive_timings)
   {
    t_end = TimingHelpers::timer();
-   oomph_info << "Time for first all-to-all in synchronise_hanging_nodes(): " 
+   oomph_info << "Time for first neighbour exchange in "
+              << "synchronise_hanging_nodes(): " 
               << t_end-t_start << std::endl;
    t_start = TimingHelpers::timer();
   }
@@ -2506,73 +2746,73 @@ void TreeBasedRefineableMeshBase::synchronise_hanging_nodes
   }
 
 
- // Loop over domains: Each processor checks consistency of hang status
+ // Loop over neighbours: Each processor checks consistency of hang status
  // of its haloed nodes with proc d against the halo counterpart. Haloed
  // wins if there are any discrepancies.
- for (int d=0; d<n_proc; d++)
+ Vector<Vector<int> > all_send_data(n_proc);
+ Vector<Vector<double> > all_send_double_data(n_proc);
+ for (unsigned i=0;i<n_neighbour;i++)
   {
-   // No halo with yourself
-   if (d!=my_rank)      
+   int d=neighbour_proc[i];
+
+   unsigned discrepancy_count=0;
+   unsigned discrepancy_count_buff=0;
+   
+   // Storage for hanging information that needs to be sent to the
+   // relevant process if there is a discrepancy in the hanging status
+   Vector<int> send_data;
+   Vector<double> send_double_data;
+   //Buffer storage for data to be sent
+   //(We need this because we cannot tell until the end of the loop over
+   //a node's master nodes whether we can reconcile its hanging status)
+   Vector<int> send_data_buff(0);
+   Vector<double> send_double_data_buff(0);
+   
+   // Counter for traversing haloed data
+   unsigned count=0;
+   
+   // Indicate presence of discrepancy. Default: there's none
+   unsigned discrepancy=0;
+   unsigned discrepancy_buff=0;
+   
+   // Loop over haloed nodes
+   unsigned nh=nhaloed_node(d);
+   for (unsigned j=0;j<nh;j++)
     {
- 
-     unsigned discrepancy_count=0;
-     unsigned discrepancy_count_buff=0;
-     
-     // Storage for hanging information that needs to be sent to the
-     // relevant process if there is a discrepancy in the hanging status
-     Vector<int> send_data;
-     Vector<double> send_double_data;
-     //Buffer storage for data to be sent
-     //(We need this because we cannot tell until the end of the loop over
-     //a node's master nodes whether we can reconcile its hanging status)
-     Vector<int> send_data_buff(0);
-     Vector<double> send_double_data_buff(0);
-     
-     // Counter for traversing haloed data
-     unsigned count=0;
+     // Get node
+     Node* nod_pt=haloed_node_pt(d,j);
      
-     // Indicate presence of discrepancy. Default: there's none
-     unsigned discrepancy=0;
-     unsigned discrepancy_buff=0;
-     
-     // Loop over haloed nodes
-     unsigned nh=nhaloed_node(d);
-     for (unsigned j=0;j<nh;j++)
-      {
-       // Get node
-       Node* nod_pt=haloed_node_pt(d,j);
+     // Loop over the hanging status for each interpolated variable
+     // (and the geometry)
+     for (int icont=-1; icont<ncont_inter_values; icont++)
+      { 
+       // Compare hanging status of halo/haloed counterpart structure
        
-       // Loop over the hanging status for each interpolated variable
-       // (and the geometry)
-       for (int icont=-1; icont<ncont_inter_values; icont++)
-        { 
-         // Compare hanging status of halo/haloed counterpart structure
-         
-         // Haloed is is hanging and haloed has different number
-         // of master nodes (which includes none in which case it isn't
-         // hanging)
-         if ((haloed_hanging[d][count]>0)&&
-             (haloed_hanging[d][count]!=halo_hanging[d][count]))
-          {
-           discrepancy_buff=1;
-           discrepancy_count_buff++;
+       // Haloed is is hanging and haloed has different number
+       // of master nodes (which includes none in which case it isn't
+       // hanging)
+       if ((haloed_hanging[d][count]>0)&&
+           (haloed_hanging[d][count]!=halo_hanging[d][count]))
+        {
+         discrepancy_buff=1;
+         discrepancy_count_buff++;
 
-           //Flag to check if all masters of this node have been found
-           bool found_all_masters=true;
+         //Flag to check if all masters of this node have been found
+         bool found_all_masters=true;
 
-           // Find master nodes of haloed node
-           HangInfo* hang_pt=nod_pt->hanging_pt(icont);
-           unsigned nhd_master=hang_pt->nmaster();
-           
-           // Add the number of master nodes to the hanging_nodes vector
-           send_data_buff.push_back(nhd_master);
+         // Find master nodes of haloed node
+         HangInfo* hang_pt=nod_pt->hanging_pt(icont);
+         unsigned nhd_master=hang_pt->nmaster();
+         
+         // Add the number of master nodes to the hanging_nodes vector
+         send_data_buff.push_back(nhd_master);
+         
+         // Loop over master nodes required for HangInfo
+         for (unsigned m=0; m<nhd_master; m++)
+          {
+           // Get mth master node
+           Node* master_nod_pt=hang_pt->master_node_pt(m);
            
-           // Loop over master nodes required for HangInfo
-           for (unsigned m=0; m<nhd_master; m++)
-            {
-             // Get mth master node
-             Node* master_nod_pt=hang_pt->master_node_pt(m);
-             
 
 
 //              //------------------------------------------
@@ -2609,545 +2849,505 @@ void TreeBasedRefineableMeshBase::synchronise_hanging_nodes
 //              // end direct search demo
 //              //-----------------------
 
-             
-             // This node will be shared: find it!
-             bool found=false;
+           
+           // This node will be shared: find it!
+           bool found=false;
 
-             // Which processor holds the non-halo counterpart of this
-             // node?
-             int non_halo_proc_id=master_nod_pt->non_halo_proc_ID();
+           // Which processor holds the non-halo counterpart of this
+           // node?
+           int non_halo_proc_id=master_nod_pt->non_halo_proc_ID();
 
-             // Try to find node in map with proc d and get iterator to entry
-             std::map<Node*,unsigned>::iterator it=
-              shared_node_map[d].find(master_nod_pt); 
+           // Try to find node in map with proc d and get iterator to entry
+           std::map<Node*,unsigned>::iterator it=
+            shared_node_map[d].find(master_nod_pt); 
+           
+           // If it's not in there iterator points to end of
+           // set
+           if (it!=shared_node_map[d].end())
+            {
+             // Found a master: When looking up the node in the shared
+             // node scheme on processor d, which processor do I work
+             // with? The current one
+             send_data_buff.push_back(my_rank);
+
+             // Found a master: Send its index in the shared 
+             // node scheme
+             send_data_buff.push_back((*it).second);
              
-             // If it's not in there iterator points to end of
-             // set
-             if (it!=shared_node_map[d].end())
+             // Add the weight
+             send_double_data_buff.push_back(hang_pt->master_weight(m));
+             
+             // Done
+             found=true;
+            }
+
+           // If we haven't found it in the shared node scheme with proc d
+           // find it in the shared node scheme with the processor that holds
+           // the non-halo version
+           if (!found)
+            {
+
+             // This is odd -- can't currently handle the case where
+             // node is owned by current processor (indicated by 
+             // non_halo_proc_id being negative
+             if (non_halo_proc_id<0)
               {
-               // Found a master: When looking up the node in the shared
-               // node scheme on processor d, which processor do I work
-               // with? The current one
-               send_data_buff.push_back(my_rank);
-
-               // Found a master: Send its index in the shared 
-               // node scheme
-               send_data_buff.push_back((*it).second);
-               
-               // Add the weight
-               send_double_data_buff.push_back(hang_pt->master_weight(m));
-               
-               // Done
-               found=true;
+               // This case is now handled by the function
+               // additional_synchronise_hanging_nodes()
+               // called (if necessary) at the end
+               //OomphLibWarning(
+               // "Odd: missing master node is owned by current proc. Will crash below.",
+               // "TreeBasedRefineableMeshBase::synchronise_hanging_nodes(...)",
+               // OOMPH_EXCEPTION_LOCATION);
               }
-
-             // If we haven't found it in the shared node scheme with proc d
-             // find it in the shared node scheme with the processor that holds
-             // the non-halo version
-             if (!found)
+             else // i.e. (non_halo_proc_id>=0)
               {
-
-               // This is odd -- can't currently handle the case where
-               // node is owned by current processor (indicated by 
-               // non_halo_proc_id being negative
-               if (non_halo_proc_id<0)
-                {
-                 // This case is now handled by the function
-                 // additional_synchronise_hanging_nodes()
-                 // called (if necessary) at the end
-                 //OomphLibWarning(
-                 // "Odd: missing master node is owned by current proc. Will crash below.",
-                 // "TreeBasedRefineableMeshBase::synchronise_hanging_nodes(...)",
-                 // OOMPH_EXCEPTION_LOCATION);
-                }
-               else // i.e. (non_halo_proc_id>=0)
+               if (shared_node_map[non_halo_proc_id].size()>0)
                 {
-                 if (shared_node_map[non_halo_proc_id].size()>0)
+                 std::map<Node*,unsigned>::iterator it=
+                  shared_node_map[non_halo_proc_id].find(master_nod_pt); 
+                 
+                 // If it's not in there iterator points to end of
+                 // set
+                 if (it!=shared_node_map[non_halo_proc_id].end())
                   {
-                   std::map<Node*,unsigned>::iterator it=
-                    shared_node_map[non_halo_proc_id].find(master_nod_pt); 
+                   // Found a master: Send ID of processor that holds 
+                   // non-halo (the fact that this is different from 
+                   // my_rank (the processor that sends this) will alert 
+                   // the other processor to the fact that it needs to 
+                   send_data_buff.push_back(non_halo_proc_id);
                    
-                   // If it's not in there iterator points to end of
-                   // set
-                   if (it!=shared_node_map[non_halo_proc_id].end())
-                    {
-                     // Found a master: Send ID of processor that holds 
-                     // non-halo (the fact that this is different from 
-                     // my_rank (the processor that sends this) will alert 
-                     // the other processor to the fact that it needs to 
-                     send_data_buff.push_back(non_halo_proc_id);
-                     
-                     // Found a master: Send its index in the shared 
-                     // node scheme
-                     send_data_buff.push_back((*it).second);
-                     
-                     // Add the weight
-                     send_double_data_buff.push_back(hang_pt->master_weight(m));
-                     
-                     // Done
-                     found=true;
-
-                     // It is possible that the master node found in the shared
-                     // storage with processor <non_halo_proc_id> does not
-                     // actually exist on processor d. If it does turn out to
-                     // exist, we are ok, but if not then we must remember to
-                     // create it later (in the
-                     // additional_synchronise_hanging_nodes() function)
-                    }
-                  }                 
-                }
+                   // Found a master: Send its index in the shared 
+                   // node scheme
+                   send_data_buff.push_back((*it).second);
+                   
+                   // Add the weight
+                   send_double_data_buff.push_back(hang_pt->master_weight(m));
+                   
+                   // Done
+                   found=true;
+
+                   // It is possible that the master node found in the shared
+                   // storage with processor <non_halo_proc_id> does not
+                   // actually exist on processor d. If it does turn out to
+                   // exist, we are ok, but if not then we must remember to
+                   // create it later (in the
+                   // additional_synchronise_hanging_nodes() function)
+                  }
+                }                 
               }
+            }
 
-             /*
-             // Don't throw error, we will construct missing master nodes in
-             // additional_synchronise_hanging_nodes() below
+           /*
+           // Don't throw error, we will construct missing master nodes in
+           // additional_synchronise_hanging_nodes() below
+           
+           // Paranoid check: if we haven't found the master node
+           // then throw an error
+           if (!found)
+            {
+             char filename[100];
+             std::ofstream some_file;
+             sprintf(filename,"sync_hanging_node_crash_mesh_proc%i.dat",
+                     my_rank);
+             some_file.open(filename);
+             this->output(some_file);
+             some_file.close();
+             
+             sprintf(filename,
+                     "sync_hanging_node_crash_mesh_with_haloes_proc%i.dat",
+                     my_rank);
+             some_file.open(filename);
+             this->enable_output_of_halo_elements();
+             this->output(some_file);
+             this->disable_output_of_halo_elements();
+             some_file.close();
              
-             // Paranoid check: if we haven't found the master node
-             // then throw an error
-             if (!found)
+
+             std::set<unsigned> other_proc_id;
+             other_proc_id.insert(d);
+             other_proc_id.insert(non_halo_proc_id);
+             for (std::set<unsigned>::iterator it=other_proc_id.begin();
+                  it!=other_proc_id.end();it++)
               {
-               char filename[100];
-               std::ofstream some_file;
-               sprintf(filename,"sync_hanging_node_crash_mesh_proc%i.dat",
-                       my_rank);
+               unsigned d_doc=(*it);
+               
+               sprintf(
+                filename,
+                "sync_hanging_node_crash_halo_elements_with_proc%i_proc%i.dat",
+                d_doc,my_rank);
                some_file.open(filename);
-               this->output(some_file);
+               Vector<GeneralisedElement*> 
+                halo_elem_pt(this->halo_element_pt(d_doc));
+               unsigned nelem=halo_elem_pt.size();
+               for (unsigned e=0;e<nelem;e++)
+                {
+                 FiniteElement* el_pt=
+                  dynamic_cast<FiniteElement*>(halo_elem_pt[e]);
+                 el_pt->output(some_file);
+                }
                some_file.close();
                
-               sprintf(filename,
-                       "sync_hanging_node_crash_mesh_with_haloes_proc%i.dat",
-                       my_rank);
+               sprintf(
+                filename,
+                "sync_hanging_node_crash_haloed_elements_with_proc%i_proc%i.dat",
+                d_doc,my_rank);
                some_file.open(filename);
-               this->enable_output_of_halo_elements();
-               this->output(some_file);
-               this->disable_output_of_halo_elements();
+               Vector<GeneralisedElement*> 
+                haloed_elem_pt(this->haloed_element_pt(d_doc));
+               nelem=haloed_elem_pt.size();
+               for (unsigned e=0;e<nelem;e++)
+                {
+                 FiniteElement* el_pt=
+                  dynamic_cast<FiniteElement*>(haloed_elem_pt[e]);
+                 el_pt->output(some_file);
+                }
                some_file.close();
                
-
-               std::set<unsigned> other_proc_id;
-               other_proc_id.insert(d);
-               other_proc_id.insert(non_halo_proc_id);
-               for (std::set<unsigned>::iterator it=other_proc_id.begin();
-                    it!=other_proc_id.end();it++)
+               
+               sprintf(
+                filename,
+                "sync_hanging_node_crash_shared_nodes_with_proc%i_proc%i.dat",
+                d_doc,my_rank);
+               some_file.open(filename);
+               unsigned n=nshared_node(d_doc);
+               for (unsigned j=0;j<n;j++)
                 {
-                 unsigned d_doc=(*it);
-                 
-                 sprintf(
-                  filename,
-                  "sync_hanging_node_crash_halo_elements_with_proc%i_proc%i.dat",
-                  d_doc,my_rank);
-                 some_file.open(filename);
-                 Vector<GeneralisedElement*> 
-                  halo_elem_pt(this->halo_element_pt(d_doc));
-                 unsigned nelem=halo_elem_pt.size();
-                 for (unsigned e=0;e<nelem;e++)
+                 Node* nod_pt=shared_node_pt(d_doc,j);
+                 unsigned nd=nod_pt->ndim();
+                 for (unsigned i=0;i<nd;i++)
                   {
-                   FiniteElement* el_pt=
-                    dynamic_cast<FiniteElement*>(halo_elem_pt[e]);
-                   el_pt->output(some_file);
+                   some_file << nod_pt->x(i) << " ";
                   }
-                 some_file.close();
-                 
-                 sprintf(
-                  filename,
-                  "sync_hanging_node_crash_haloed_elements_with_proc%i_proc%i.dat",
-                  d_doc,my_rank);
-                 some_file.open(filename);
-                 Vector<GeneralisedElement*> 
-                  haloed_elem_pt(this->haloed_element_pt(d_doc));
-                 nelem=haloed_elem_pt.size();
-                 for (unsigned e=0;e<nelem;e++)
+                 some_file << "\n";
+                }
+               some_file.close();
+               
+               
+               sprintf(
+                filename,
+                "sync_hanging_node_crash_halo_nodes_with_proc%i_proc%i.dat",
+                d_doc,my_rank);
+               some_file.open(filename);
+               n=nhalo_node(d_doc);
+               for (unsigned j=0;j<n;j++)
+                {
+                 Node* nod_pt=halo_node_pt(d_doc,j);
+                 unsigned nd=nod_pt->ndim();
+                 for (unsigned i=0;i<nd;i++)
                   {
-                   FiniteElement* el_pt=
-                    dynamic_cast<FiniteElement*>(haloed_elem_pt[e]);
-                   el_pt->output(some_file);
+                   some_file << nod_pt->x(i) << " ";
                   }
-                 some_file.close();
-                 
-                 
-                 sprintf(
-                  filename,
-                  "sync_hanging_node_crash_shared_nodes_with_proc%i_proc%i.dat",
-                  d_doc,my_rank);
-                 some_file.open(filename);
-                 unsigned n=nshared_node(d_doc);
-                 for (unsigned j=0;j<n;j++)
-                  {
-                   Node* nod_pt=shared_node_pt(d_doc,j);
-                   unsigned nd=nod_pt->ndim();
-                   for (unsigned i=0;i<nd;i++)
-                    {
-                     some_file << nod_pt->x(i) << " ";
-                    }
-                   some_file << "\n";
-                  }
-                 some_file.close();
-                 
-                 
-                 sprintf(
-                  filename,
-                  "sync_hanging_node_crash_halo_nodes_with_proc%i_proc%i.dat",
-                  d_doc,my_rank);
-                 some_file.open(filename);
-                 n=nhalo_node(d_doc);
-                 for (unsigned j=0;j<n;j++)
-                  {
-                   Node* nod_pt=halo_node_pt(d_doc,j);
-                   unsigned nd=nod_pt->ndim();
-                   for (unsigned i=0;i<nd;i++)
-                    {
-                     some_file << nod_pt->x(i) << " ";
-                    }
-                   some_file << "\n";
-                  }
-                 some_file.close();
-                 
-                 
-                 sprintf(
-                  filename,
-                  "sync_hanging_node_crash_haloed_nodes_with_proc%i_proc%i.dat",
-                  d_doc,my_rank);
-                 some_file.open(filename);
-                 n=nhaloed_node(d_doc);
-                 for (unsigned j=0;j<n;j++)
-                  {
-                   Node* nod_pt=haloed_node_pt(d_doc,j);
-                   unsigned nd=nod_pt->ndim();
-                   for (unsigned i=0;i<nd;i++)
-                    {
-                     some_file << nod_pt->x(i) << " ";
-                    }
-                   some_file << "\n";
-                  }
-                 some_file.close();
-                 
-                } // end of loop over all inter-processor lookup schemes
-               
-               std::ostringstream error_stream;
-               unsigned n=master_nod_pt->ndim();
-               error_stream  << "Error: Master node at:\n\n";
-               for (unsigned i=0;i<n;i++)
-                {
-                 error_stream <<  master_nod_pt->x(i) << " ";
+                 some_file << "\n";
                 }
-               error_stream   << "\n\nnot found for icont="
-                              << icont << "in  " 
-                              << "shared node storage with proc " << d << "\n"
-                              << "or in shared node storage with proc " 
-                              << non_halo_proc_id 
-                              << " which is where its non-halo counterpart lives.\n"
-                              << "Relevant files: sync_hanging_node_crash*.dat\n\n" 
-                              << "Hanging node itself: \n\n";
-               n=nod_pt->ndim();
-               for (unsigned i=0;i<n;i++)
-                {
-                 error_stream << nod_pt->x(i) << " ";
-                }
-               error_stream << nod_pt->non_halo_proc_ID();
-               error_stream << "\n\nMaster nodes:\n\n";
-               for (unsigned m=0; m<nhd_master; m++)
+               some_file.close();
+               
+               
+               sprintf(
+                filename,
+                "sync_hanging_node_crash_haloed_nodes_with_proc%i_proc%i.dat",
+                d_doc,my_rank);
+               some_file.open(filename);
+               n=nhaloed_node(d_doc);
+               for (unsigned j=0;j<n;j++)
                 {
-                 Node* master_nod_pt=hang_pt->master_node_pt(m);
-                 n=master_nod_pt->ndim();
-                 for (unsigned i=0;i<n;i++)
+                 Node* nod_pt=haloed_node_pt(d_doc,j);
+                 unsigned nd=nod_pt->ndim();
+                 for (unsigned i=0;i<nd;i++)
                   {
-                   error_stream << master_nod_pt->x(i) << " ";
+                   some_file << nod_pt->x(i) << " ";
                   }
-                 error_stream << master_nod_pt->non_halo_proc_ID();
-                 error_stream << "\n";
+                 some_file << "\n";
                 }
+               some_file.close();
                
-               // try to find it somewhere else -- sub-optimal search but
-               // we're about to die on our arses (yes, plural -- this is 
-               // a parallel run!) anyway...
-               for (int dddd=0;dddd<n_proc;dddd++)
+              } // end of loop over all inter-processor lookup schemes
+             
+             std::ostringstream error_stream;
+             unsigned n=master_nod_pt->ndim();
+             error_stream  << "Error: Master node at:\n\n";
+             for (unsigned i=0;i<n;i++)
+              {
+               error_stream <<  master_nod_pt->x(i) << " ";
+              }
+             error_stream   << "\n\nnot found for icont="
+                            << icont << "in  " 
+                            << "shared node storage with proc " << d << "\n"
+                            << "or in shared node storage with proc " 
+                            << non_halo_proc_id 
+                            << " which is where its non-halo counterpart lives.\n"
+                            << "Relevant files: sync_hanging_node_crash*.dat\n\n" 
+                            << "Hanging node itself: \n\n";
+             n=nod_pt->ndim();
+             for (unsigned i=0;i<n;i++)
+              {
+               error_stream << nod_pt->x(i) << " ";
+              }
+             error_stream << nod_pt->non_halo_proc_ID();
+             error_stream << "\n\nMaster nodes:\n\n";
+             for (unsigned m=0; m<nhd_master; m++)
+              {
+               Node* master_nod_pt=hang_pt->master_node_pt(m);
+               n=master_nod_pt->ndim();
+               for (unsigned i=0;i<n;i++)
                 {
-                 bool loc_found=false;
-                 unsigned nnnod_shared=nshared_node(dddd);
-                 for (unsigned k=0; k<nnnod_shared; k++)
-                  {
-                   if (master_nod_pt==shared_node_pt(dddd,k))
-                    {
-                     loc_found=true;
-                     error_stream 
-                      << "Found that master node as " << k 
-                      << "-th entry in shared node storage with proc " 
-                      << dddd << "\n";
-                    }
-                  }
-                 if (!loc_found)
+                 error_stream << master_nod_pt->x(i) << " ";
+                }
+               error_stream << master_nod_pt->non_halo_proc_ID();
+               error_stream << "\n";
+              }
+             
+             // try to find it somewhere else -- sub-optimal search but
+             // we're about to die on our arses (yes, plural -- this is 
+             // a parallel run!) anyway...
+             for (int dddd=0;dddd<n_proc;dddd++)
+              {
+               bool loc_found=false;
+               unsigned nnnod_shared=nshared_node(dddd);
+               for (unsigned k=0; k<nnnod_shared; k++)
+                {
+                 if (master_nod_pt==shared_node_pt(dddd,k))
                   {
+                   loc_found=true;
                    error_stream 
-                    << "Did not find that master node in shared node storage with proc " 
+                    << "Found that master node as " << k 
+                    << "-th entry in shared node storage with proc " 
                     << dddd << "\n";
                   }
                 }
-               error_stream << "\n\n";
-
-               throw OomphLibError(
-                error_stream.str(),
-                OOMPH_CURRENT_FUNCTION,
-                OOMPH_EXCEPTION_LOCATION);
+               if (!loc_found)
+                {
+                 error_stream 
+                  << "Did not find that master node in shared node storage with proc " 
+                  << dddd << "\n";
+                }
               }
-             */
+             error_stream << "\n\n";
 
-             //Check if the master has been found
-             if (!found)
-              {
-               //If this master hasn't been found then set the flag
-               found_all_masters=false;
-               //No need to continue searching for masters
-               break;
-              }
-             
-             
-            } // loop over master nodes
-           
+             throw OomphLibError(
+              error_stream.str(),
+              OOMPH_CURRENT_FUNCTION,
+              OOMPH_EXCEPTION_LOCATION);
+            }
+           */
 
-           // Check if we need to send the data
-           if(found_all_masters)
+           //Check if the master has been found
+           if (!found)
             {
-             // All masters were found, so populate send data from buffer
-             discrepancy = discrepancy_buff;
-             discrepancy_count += discrepancy_count_buff;
-             for(unsigned i=0; i<send_data_buff.size(); i++)
-              {
-               send_data.push_back(send_data_buff[i]);
-              }
-             for(unsigned i=0; i<send_double_data_buff.size(); i++)
-              {
-               send_double_data.push_back(send_double_data_buff[i]);
-              }
+             //If this master hasn't been found then set the flag
+             found_all_masters=false;
+             //No need to continue searching for masters
+             break;
+            }
+           
+           
+          } // loop over master nodes
+         
 
-             // Clear buffers and reset
-             discrepancy_buff = 0;
-             discrepancy_count_buff = 0;
-             send_data_buff.clear();
-             send_double_data_buff.clear();
+         // Check if we need to send the data
+         if(found_all_masters)
+          {
+           // All masters were found, so populate send data from buffer
+           discrepancy = discrepancy_buff;
+           discrepancy_count += discrepancy_count_buff;
+           for(unsigned i=0; i<send_data_buff.size(); i++)
+            {
+             send_data.push_back(send_data_buff[i]);
             }
-           else
+           for(unsigned i=0; i<send_double_data_buff.size(); i++)
             {
-             // At least one master node was not found, so we can't
-             // reconcile the hanging status of this node yet. We tell
-             // the other processor to do nothing for now.
-             send_data.push_back(0);
-
-             // Clear buffers and reset
-             discrepancy_buff = 0;
-             discrepancy_count_buff = 0;
-             send_data_buff.clear();
-             send_double_data_buff.clear();
-
-             // Set flag to trigger another round of synchronisation
-             nnode_still_requiring_synchronisation++;
+             send_double_data.push_back(send_double_data_buff[i]);
             }
-             
-          }
-         // Haloed node isn't hanging but halo is: the latter
-         // shouldn't so send a -1 to indicate that it's to be made
-         // non-hanging
-         else if ((haloed_hanging[d][count]==0) && 
-                  (halo_hanging[d][count]>0))
-          {
-           discrepancy=1;
-           discrepancy_count++;
-           send_data.push_back(-1);
-          }
-         // Both halo and haloed node have the same number of masters
-         // we're happy!
-         else if (haloed_hanging[d][count]==
-                  halo_hanging[d][count]) 
-          {
-           send_data.push_back(0);
+
+           // Clear buffers and reset
+           discrepancy_buff = 0;
+           discrepancy_count_buff = 0;
+           send_data_buff.clear();
+           send_double_data_buff.clear();
           }
          else
           {
-           std::ostringstream error_stream;
-           error_stream  << "Never get here!\n " 
-                         << "haloed_hanging[d][count]=" << haloed_hanging[d][count]
-                         << "; halo_hanging[d][count]=" <<   halo_hanging[d][count]
-                         << std::endl;
-           throw OomphLibError(
-            error_stream.str(),
-            OOMPH_CURRENT_FUNCTION,
-            OOMPH_EXCEPTION_LOCATION);
+           // At least one master node was not found, so we can't
+           // reconcile the hanging status of this node yet. We tell
+           // the other processor to do nothing for now.
+           send_data.push_back(0);
+
+           // Clear buffers and reset
+           discrepancy_buff = 0;
+           discrepancy_count_buff = 0;
+           send_data_buff.clear();
+           send_double_data_buff.clear();
+
+           // Set flag to trigger another round of synchronisation
+           nnode_still_requiring_synchronisation++;
           }
-         // Increment counter for number of haloed data
-         count++;
-        } // end of loop over icont
-      } // end of loop over haloed nodes
-     
-     // Now send all the required info to the equivalent halo layer -
-     // If there are no discrepancies, no need to send anything
-     Vector<unsigned> n_all_send(2,0);
-     if (discrepancy==0)
-      {
-       MPI_Send(&n_all_send[0],2,MPI_UNSIGNED,d,0,Comm_pt->mpi_comm());
-      }
-     else
-      {       
-       // How much data is there to be sent?
-       n_all_send[0]=send_data.size();         
-       n_all_send[1]=send_double_data.size();         
-       MPI_Send(&n_all_send[0],2,MPI_UNSIGNED,d,0,Comm_pt->mpi_comm());
-       
-       // Send flat-packed ints
-       if (n_all_send[0]!=0)
+           
+        }
+       // Haloed node isn't hanging but halo is: the latter
+       // shouldn't so send a -1 to indicate that it's to be made
+       // non-hanging
+       else if ((haloed_hanging[d][count]==0) && 
+                (halo_hanging[d][count]>0))
         {
-         MPI_Send(&send_data[0],n_all_send[0],MPI_INT,d,1,
-                  Comm_pt->mpi_comm());
+         discrepancy=1;
+         discrepancy_count++;
+         send_data.push_back(-1);
         }
-       
-       // Send flat-packed double data
-       if (n_all_send[1]!=0)
+       // Both halo and haloed node have the same number of masters
+       // we're happy!
+       else if (haloed_hanging[d][count]==
+                halo_hanging[d][count]) 
         {
-         MPI_Send(&send_double_data[0],n_all_send[1],MPI_DOUBLE,d,1,
-                  Comm_pt->mpi_comm());
+         send_data.push_back(0);
         }
-      }
+       else
+        {
+         std::ostringstream error_stream;
+         error_stream  << "Never get here!\n " 
+                       << "haloed_hanging[d][count]=" << haloed_hanging[d][count]
+                       << "; halo_hanging[d][count]=" <<   halo_hanging[d][count]
+                       << std::endl;
+         throw OomphLibError(
+          error_stream.str(),
+          OOMPH_CURRENT_FUNCTION,
+          OOMPH_EXCEPTION_LOCATION);
+        }
+       // Increment counter for number of haloed data
+       count++;
+      } // end of loop over icont
+    } // end of loop over haloed nodes
+   
+   // Now store all the required info for the equivalent halo layer -
+   // If there are no discrepancies, no need to send anything
+   if (discrepancy!=0)
+    {
+     all_send_data[d].swap(send_data);
+     all_send_double_data[d].swap(send_double_data);
     }
-   else // (d==my_rank), current process
+  }
+
+ // Exchange the master nodes and weights with the neighbours
+ Vector<Vector<int> > all_receive_data;
+ Vector<Vector<double> > all_receive_double_data;
+ exchange_with_neighbouring_processors(neighbour_proc,
+                                       all_send_data,all_send_double_data,
+                                       all_receive_data,
+                                       all_receive_double_data);
+
+ // Use the received master nodes and weights to modify the
+ // hanging status of nodes in the halo layer
+ for (unsigned i=0;i<n_neighbour;i++)
+  {
+   int dd=neighbour_proc[i];
+
+   // Received information (this is empty either if there are no
+   // discrepancies or there's zero data to be sent)
+   Vector<int>& receive_data=all_receive_data[dd];
+   Vector<double>& receive_double_data=all_receive_double_data[dd];
+
+   // If no information, no need to do anything else  
+   if (receive_data.size()!=0)
     {
-     // Receive the master nodes and weights in order to modify the
-     // hanging status of nodes in the halo layer
-     for (int dd=0; dd<n_proc; dd++)
+     // Counters for traversing received data
+     unsigned count=0;
+     unsigned count_double=0;
+     
+     // Loop over halo nodes
+     unsigned nh=nhalo_node(dd);
+     for (unsigned j=0;j<nh;j++)
       {
-       if (dd!=d) // don't talk to yourself
-        {
-         // Are we going to receive anything? This is zero
-         // either if there are no discrepancies or there's zero
-         // data to be sent.
-         Vector<unsigned> n_all_recv(2,0);
-         MPI_Recv(&n_all_recv[0],2,MPI_UNSIGNED,dd,0,
-                  Comm_pt->mpi_comm(),&status);
-
-         // Storage for received information
-         Vector<int> receive_data;
-         Vector<double> receive_double_data;
+       // Get node
+       Node* nod_pt=halo_node_pt(dd,j);           
+       
+       // Loop over the hanging status for each interpolated variable
+       // (and the geometry)
+       for (int icont=-1; icont<ncont_inter_values; icont++)
+        { 
          
-         // Receive unsigneds (if any)
-         if (n_all_recv[0]!=0)
-          {
-           // Receive the data
-           receive_data.resize(n_all_recv[0]);
-           MPI_Recv(&receive_data[0],n_all_recv[0],MPI_INT,dd,1,
-                    Comm_pt->mpi_comm(),&status);
-          }
-
-         // Receive doubles (if any)
-         if (n_all_recv[1]!=0)
-          {
-           // Receive the data
-           receive_double_data.resize(n_all_recv[1]);
-           MPI_Recv(&receive_double_data[0],n_all_recv[1],MPI_DOUBLE,dd,1,
-                    Comm_pt->mpi_comm(),&status);
-          }
+         // Read next entry
+         int next_entry=receive_data[count++];
          
-         // If no information, no need to do anything else  
-         if (n_all_recv[0]!=0)
+         // If it's positive, then the number tells us how 
+         // many master nodes we have
+         if (next_entry>0) 
           {
-           // Counters for traversing received data
-           unsigned count=0;
-           unsigned count_double=0;
+           unsigned nhd_master=unsigned(next_entry);
            
-           // Loop over halo nodes
-           unsigned nh=nhalo_node(dd);
-           for (unsigned j=0;j<nh;j++)
+           // Set up a new HangInfo for this node
+           HangInfo* hang_pt = new HangInfo(nhd_master);
+           
+           // Now set up the master nodes and weights
+           for (unsigned m=0; m<nhd_master; m++)
             {
-             // Get node
-             Node* nod_pt=halo_node_pt(dd,j);           
-             
-             // Loop over the hanging status for each interpolated variable
-             // (and the geometry)
-             for (int icont=-1; icont<ncont_inter_values; icont++)
-              { 
-               
-               // Read next entry
-               int next_entry=receive_data[count++];
-               
-               // If it's positive, then the number tells us how 
-               // many master nodes we have
-               if (next_entry>0) 
-                {
-                 unsigned nhd_master=unsigned(next_entry);
-                 
-                 // Set up a new HangInfo for this node
-                 HangInfo* hang_pt = new HangInfo(nhd_master);
-                 
-                 // Now set up the master nodes and weights
-                 for (unsigned m=0; m<nhd_master; m++)
-                  {
-                   // Get the sent master node (a shared node) and 
-                   // the weight
+             // Get the sent master node (a shared node) and 
+             // the weight
 
-                   // ID of proc in whose shared node lookup scheme
-                   // the sending processor found the node
-                   unsigned shared_node_proc=unsigned(receive_data[count++]);
+             // ID of proc in whose shared node lookup scheme
+             // the sending processor found the node
+             unsigned shared_node_proc=unsigned(receive_data[count++]);
 
-                   // Index of node in the shared node lookup scheme 
-                   unsigned shared_node_id=unsigned(receive_data[count++]);
-                   
-                   // Get weight
-                   double mtr_weight=receive_double_data[count_double++];
-
-                   // If the shared node processor is the same as the
-                   // the sending processor we can processor everything here
-                   if (shared_node_proc==unsigned(dd))
-                    {
-                     // Get node
-                     Node* master_nod_pt=shared_node_pt(dd,shared_node_id);
-                     
-                     // Set as a master node (with corresponding weight)
-                     hang_pt->set_master_node_pt(m,master_nod_pt,mtr_weight);
-                    }
-                   // ...otherwise we have do another communication with
-                   // intermediate processor that holds the non-halo
-                   // version of the master node -- only that processor can
-                   // translate the index of the node the share node 
-                   // lookup scheme with the sending processor to the
-                   // index in the shared node lookup scheme with this
-                   // processor
-                   else
-                    {
-                     // Store
-                     HangHelperStruct tmp;
-                     tmp.Sending_processor=dd;
-                     tmp.Shared_node_id_on_sending_processor=shared_node_id;
-                     tmp.Shared_node_proc=shared_node_proc;
-                     tmp.Weight=mtr_weight;
-                     tmp.Hang_pt=hang_pt;
-                     tmp.Master_node_index=m;
-                     tmp.Node_pt=nod_pt;
-                     tmp.icont=icont;
-                     hang_info.push_back(tmp);
-                    }
-                  }
+             // Index of node in the shared node lookup scheme 
+             unsigned shared_node_id=unsigned(receive_data[count++]);
+             
+             // Get weight
+             double mtr_weight=receive_double_data[count_double++];
 
-                 // Set the hanging pointer for the current halo node
-                 // (does delete any previous hang data)
-                 nod_pt->set_hanging_pt(hang_pt,icont);
-                }
-               // Negative entry: the hanging node already exists, 
-               // but it shouldn't, so set it to nonhanging
-               else if (next_entry<0)
-                {
-                 nod_pt->set_hanging_pt(0,icont);
-                }
+             // If the shared node processor is the same as the
+             // the sending processor we can processor everything here
+             if (shared_node_proc==unsigned(dd))
+              {
+               // Get node
+               Node* master_nod_pt=shared_node_pt(dd,shared_node_id);
                
-              } // end of loop over icont
-            } // end of loop over nodes
-          } // end of anything to receive
-        }
-      }
-    }
-  }// end loop over all processors
+               // Set as a master node (with corresponding weight)
+               hang_pt->set_master_node_pt(m,master_nod_pt,mtr_weight);
+              }
+             // ...otherwise we have do another communication with
+             // intermediate processor that holds the non-halo
+             // version of the master node -- only that processor can
+             // translate the index of the node the share node 
+             // lookup scheme with the sending processor to the
+             // index in the shared node lookup scheme with this
+             // processor
+             else
+              {
+               // Store
+               HangHelperStruct tmp;
+               tmp.Sending_processor=dd;
+               tmp.Shared_node_id_on_sending_processor=shared_node_id;
+               tmp.Shared_node_proc=shared_node_proc;
+               tmp.Weight=mtr_weight;
+               tmp.Hang_pt=hang_pt;
+               tmp.Master_node_index=m;
+               tmp.Node_pt=nod_pt;
+               tmp.icont=icont;
+               hang_info.push_back(tmp);
+              }
+            }
+
+           // Set the hanging pointer for the current halo node
+           // (does delete any previous hang data)
+           nod_pt->set_hanging_pt(hang_pt,icont);
+          }
+         // Negative entry: the hanging node already exists, 
+         // but it shouldn't, so set it to nonhanging
+         else if (next_entry<0)
+          {
+           nod_pt->set_hanging_pt(0,icont);
+          }
+         
+        } // end of loop over icont
+      } // end of loop over nodes
+    } // end of anything to receive
+  }
  
 
 
  if (Global_timings::Doc_comprehensive_timings)
   {
    t_end = TimingHelpers::timer();
-   oomph_info << "Time for second all-to-all in synchronise_hanging_nodes() " 
+   oomph_info << "Time for second neighbour exchange in "
+              << "synchronise_hanging_nodes(): " 
               << t_end-t_start << std::endl;
    t_start = TimingHelpers::timer();
   }  
@@ -3155,354 +3355,212 @@ void TreeBasedRefineableMeshBase::synchronise_hanging_nodes
 
  // Now identify master nodes by translating index in shared 
  // node lookup scheme from the lookup scheme with the sending
- // processor to that with the current processor
+ // processor to that with the current processor. Only the 
+ // (intermediate) processor that holds the non-halo version of the
+ // master node can do the translation, and only if it shares nodes
+ // with the current processor, i.e. if it's one of our neighbours.
+ // Queries (and answers) are therefore only exchanged with the 
+ // neighbours; queries for any other processor would fail anyway.
  unsigned n=hang_info.size();
+ {
+  // Is processor d a neighbour?
+  Vector<int> is_neighbour(n_proc,0);
+  for (unsigned i=0;i<n_neighbour;i++)
+   {
+    is_neighbour[neighbour_proc[i]]=1;
+   }
+
+  // Storage for how-many-th entry in this processor's 
+  // hang_info vector will be completed by processor rank.
+  Vector<Vector<unsigned> > hang_info_index_for_proc(n_proc);
+  
+  // Entries in hang_info vector for which the translation has failed.
+  // Their (partial) hang info can only be deleted once all the 
+  // successful translations have been processed, because the
+  // entries for a given node may share the same HangInfo.
+  Vector<unsigned> failed_hang_info_index;
+
+  // Send information to intermediate processor that holds
+  // non-halo version of missing master node
+  Vector<Vector<int> > send_data(n_proc);
+  for (unsigned i=0;i<n;i++)
+   {
+    HangHelperStruct tmp=hang_info[i];
+    unsigned rank=tmp.Shared_node_proc;
+    if (is_neighbour[rank])
+     {
+      // Add the sending processor
+      send_data[rank].push_back(tmp.Sending_processor);
+      
+      // Add the index of the missing master node
+      // in the shared node lookup scheme between
+      // sending processor and processor rank
+      send_data[rank].push_back(tmp.Shared_node_id_on_sending_processor);
+      
+      // Record the how-many-th entry in this processor's 
+      // hang_info vector will be completed by processor rank.
+      hang_info_index_for_proc[rank].push_back(i);
+     }
+    else
+     {
+      // Processor rank doesn't share any nodes with this processor
+      // so the translation query would fail
+      failed_hang_info_index.push_back(i);
+     }
+   }
 
- // Is there anything to do be done?
- unsigned global_n=0;
- MPI_Allreduce(&n,&global_n,1,MPI_UNSIGNED,MPI_MAX,
-               Comm_pt->mpi_comm());
- if (global_n==0)
+  // Exchange the queries with the neighbours (there's no double data
+  // to be sent)
+  Vector<Vector<int> > receive_data;
   {
-   oomph_info 
-    << "No need for reconciliation of wrongly synchronised hang nodes\n";
+   Vector<Vector<double> > send_double_data(n_proc);
+   Vector<Vector<double> > receive_double_data;
+   exchange_with_neighbouring_processors(neighbour_proc,
+                                         send_data,send_double_data,
+                                         receive_data,receive_double_data);
   }
- // Reconcilation required
- else  
- {
 
-   oomph_info 
-    << "Need to reconcile of wrongly syncronised hang nodes\n";
+  // Storage for the translated entries (in order) for/from
+  // other processors
+  // Must be ints so that an entry of -1 tells the other processor
+  // that the node could not be found. See comment above for why
+  // this may be necessary.
+  Vector<Vector<int> > translated_entry(n_proc);
 
-   // Storage for the translated entries (in order) for/from
-   // other processors
-   // Must be ints so that an entry of -1 tells the other processor
-   // that the node could not be found. See comment above for why
-   // this may be necessary.
-   Vector<Vector<int> > translated_entry(n_proc);
-   
-   // Storage for how-many-th entry in this processor's 
-   // hang_info vector will be completed by processor rank.
-   Vector<Vector<unsigned> > hang_info_index_for_proc(n_proc);
-   
-   // Send information to intermediate processor that holds
-   // non-halo version of missing master node
+  // Translate the queries received from the neighbours
+  for (unsigned i=0;i<n_neighbour;i++)
    {
-    // Storage for number of data to be sent to each processor
-    Vector<int> send_n(n_proc,0);
-    
-    // Storage for all values to be sent to all processors
-    Vector<int> send_data;
-    
-    // Start location within send_data for data to be sent to each processor 
-    Vector<int> send_displacement(n_proc,0);
-    
-    // Loop over all processors
-    for(int rank=0;rank<n_proc;rank++)
-     {  
-      //Set the offset for the current processor
-      send_displacement[rank] = send_data.size();
+    int send_rank=neighbour_proc[i];
+
+    // We're reading two numbers per missing halo node
+    unsigned n_rec=receive_data[send_rank].size();
+    unsigned count=0;
+    for (unsigned j=0;j<n_rec/2;j++)
+     {
+      // Receive orig sending proc
+      unsigned orig_sending_proc=receive_data[send_rank][count];
+      count++;
+      
+      // Receive the index of the missing master node
+      // in the shared node lookup scheme between
+      // orig sending processor and current processor
+      unsigned shared_node_id_on_orig_sending_proc=
+       receive_data[send_rank][count];
+      count++;
+      
+      // Extract node from shared node lookup scheme
+      Node* master_nod_pt=
+       shared_node_pt(orig_sending_proc,
+                      shared_node_id_on_orig_sending_proc);
+      
+      // Now find it in shared halo scheme with the processor
+      // that's sent the request
+      std::map<Node*,unsigned>::iterator it=
+       shared_node_map[send_rank].find(master_nod_pt); 
       
-      //Don't bother to do anything if the processor in the loop is the 
-      //current processor
-      if(rank!=my_rank)
+      // If it's not in there iterator points to end of
+      // set
+      if (it!=shared_node_map[send_rank].end())
+       {          
+        // Store it so we can send it back
+        translated_entry[send_rank].push_back((*it).second);
+       }
+      else
        {
-        
-        // Search through the (typically few) entries
-        // in hang info vector to find the ones that
-        // must be sent to proc rank (the proc that holds
-        // the non-halo version of the "missing" master node
-        for (unsigned i=0;i<n;i++)
-         {
-          HangHelperStruct tmp=hang_info[i];
-          if (tmp.Shared_node_proc==unsigned(rank))
-           {
-            // Add the sending processor
-            send_data.push_back(tmp.Sending_processor);
-            
-            // Add the index of the missing master node
-            // in the shared node lookup scheme between
-            // sending processor and processor rank
-            send_data.push_back(tmp.Shared_node_id_on_sending_processor);
-            
-            // Record the how-many-th entry in this processor's 
-            // hang_info vector will be completed by processor rank.
-            hang_info_index_for_proc[rank].push_back(i);
-           }
-         }
+        // This node has not been found in the shared scheme, so
+        // the translation query has failed. We send a -1 to tell
+        // the other processor the bad news. (No need to crash:
+        // additional_synchronise_hanging_nodes() will sort out
+        // the problem.)
+        translated_entry[send_rank].push_back(-1);
        }
-      
-      //Find the number of data added to the vector
-      send_n[rank] = send_data.size() - send_displacement[rank];
-     }
-    
-    
-    //Storage for the number of data to be received from each processor
-    Vector<int> receive_n(n_proc,0);
-    
-    //Now send numbers of data to be sent between all processors
-    MPI_Alltoall(&send_n[0],1,MPI_INT,&receive_n[0],1,MPI_INT,
-                 Comm_pt->mpi_comm());
-    
-    //We now prepare the data to be received
-    //by working out the displacements from the received data
-    Vector<int> receive_displacement(n_proc,0);
-    int receive_data_count=0;
-    for(int rank=0;rank<n_proc;++rank)
-     {
-      //Displacement is number of data received so far
-      receive_displacement[rank] = receive_data_count;
-      receive_data_count += receive_n[rank];
      }
-    
-    //Now resize the receive buffer for all data from all processors
-    //Make sure that it has a size of at least one
-    if(receive_data_count==0) {++receive_data_count;}
-    Vector<unsigned> receive_data(receive_data_count);
-    
-    //Make sure that the send buffer has size at least one
-    //so that we don't get a segmentation fault
-    if(send_data.size()==0) {send_data.resize(1);}
-    
-    //Now send the data between all the processors
-    MPI_Alltoallv(&send_data[0],&send_n[0],&send_displacement[0],
-                  MPI_INT,
-                  &receive_data[0],&receive_n[0],
-                  &receive_displacement[0],
-                  MPI_INT,
-                  Comm_pt->mpi_comm());
-    
-    //Now use the received data to update the halo nodes
-    for (int send_rank=0;send_rank<n_proc;send_rank++)
+   }
+  
+  if (Global_timings::Doc_comprehensive_timings)
+   {
+    t_end = TimingHelpers::timer();
+    oomph_info << "Time for third neighbour exchange in "
+               << "synchronise_hanging_nodes(): " 
+               << t_end-t_start << std::endl;
+    t_start = TimingHelpers::timer();
+   }  
+
+  // Send the translated entries back to the processors that need to
+  // identify missing master nodes via shared node lookup scheme with
+  // this processor
+  Vector<Vector<int> > received_translated_entry;
+  {
+   Vector<Vector<double> > send_double_data(n_proc);
+   Vector<Vector<double> > receive_double_data;
+   exchange_with_neighbouring_processors(neighbour_proc,
+                                         translated_entry,send_double_data,
+                                         received_translated_entry,
+                                         receive_double_data);
+  }
+
+  // Now use the received data to update the halo nodes
+  for (unsigned i=0;i<n_neighbour;i++)
+   {
+    int send_rank=neighbour_proc[i];
+
+    // We're reading one number per missing halo node
+    unsigned n_rec=received_translated_entry[send_rank].size();
+    for (unsigned j=0;j<n_rec;j++)
      {
-      //Don't bother to do anything for the processor corresponding to the
-      //current processor or if no data were received from this processor
-      if((send_rank != my_rank) && (receive_n[send_rank] != 0))
+      // Index of missing master node in shared node lookup scheme
+      // with processor send_rank:
+      // Must be an int because failure returns -1
+      int index=received_translated_entry[send_rank][j];
+      
+      // Recall information associated with that missing master
+      unsigned hang_info_index=hang_info_index_for_proc[send_rank][j];
+
+      // Translation query has been successful if index >= 0
+      if (index >= 0)
        {
-        //Counter for the data within the large array
-        unsigned count=receive_displacement[send_rank];
+        HangHelperStruct tmp=hang_info[hang_info_index];
         
-        // We're reading two numbers per missing halo node
-        unsigned n_rec=unsigned(receive_n[send_rank]);
-        for (unsigned i=0;i<n_rec/2;i++)
-         {
-          
-          // Receive orig sending proc
-          unsigned orig_sending_proc=receive_data[count];
-          count++;
-          
-          // Receive the index of the missing master node
-          // in the shared node lookup scheme between
-          // orig sending processor and current processor
-          unsigned shared_node_id_on_orig_sending_proc=
-           receive_data[count];
-          count++;
-          
-          // Extract node from shared node lookup scheme
-          Node* master_nod_pt=
-           shared_node_pt(orig_sending_proc,
-                          shared_node_id_on_orig_sending_proc);
-          
-          // Now find it in shared halo scheme with the processor
-          // that's sent the request
-          
-          std::map<Node*,unsigned>::iterator it=
-           shared_node_map[send_rank].find(master_nod_pt); 
-          
-          // If it's not in there iterator points to end of
-          // set
-          if (it!=shared_node_map[send_rank].end())
-           {          
-            // Store it so we can send it back
-            translated_entry[send_rank].push_back((*it).second);
-           }
-          else
-           {
-            // This node has not been found in the shared scheme, so
-            // the translation query has failed. We send a -1 to tell
-            // the other processor the bad news.
-            translated_entry[send_rank].push_back(-1);
-
-            /*
-            // We don't need to crash anymore because the function
-            // additional_synchronise_hanging_nodes() will magically
-            // sort out all the problems!
-            std::ostringstream error_stream;
-            error_stream
-             << "Received translation query for shared node"
-             << " entry " << shared_node_id_on_orig_sending_proc 
-             << " with processor " << orig_sending_proc 
-             << " from proc " << send_rank << std::endl
-             << "but did not find node in shared node scheme with proc "
-             << send_rank << std::endl;
-            throw OomphLibError(
-             error_stream.str(),
-             OOMPH_CURRENT_FUNCTION,
-             OOMPH_EXCEPTION_LOCATION);
-            */
-           }
-          
-         }
+        // Extract node from shared node lookup scheme
+        Node* master_nod_pt=shared_node_pt(send_rank,index);
         
+        // Set as a master node (with corresponding weight)
+        tmp.Hang_pt->set_master_node_pt(tmp.Master_node_index,
+                                        master_nod_pt,tmp.Weight);
        }
-     } //End of data is received
-    
-   }   // end of sending stuff to intermediate processor that holds
-       // non halo version of missing master node
-   
-   
-   if (Global_timings::Doc_comprehensive_timings)
-    {
-     t_end = TimingHelpers::timer();
-     oomph_info << "Time for third all-to-all in synchronise_hanging_nodes() " 
-                << t_end-t_start << std::endl;
-     t_start = TimingHelpers::timer();
-    }  
-   
-   
-   
-   // Send information back to processor that needs to identify
-   // missing master node via shared node lookup scheme with
-   // this processor
-   {
-    // Storage for number of data to be sent to each processor
-    Vector<int> send_n(n_proc,0);
-    
-    // Storage for all values to be sent to all processors
-    Vector<int> send_data;
-    
-    // Start location within send_data for data to be sent to each processor 
-    Vector<int> send_displacement(n_proc,0);
-    
-    // Loop over all processors
-    for(int rank=0;rank<n_proc;rank++)
-     {  
-      //Set the offset for the current processor
-      send_displacement[rank] = send_data.size();
-      
-      //Don't bother to do anything if the processor in the loop is the 
-      //current processor
-      if(rank!=my_rank)
+      else
        {
-        // Put the translated entries for processor rank into
-        // send data
-        unsigned n=translated_entry[rank].size();
-        for (unsigned j=0;j<n;j++)
-         {
-          send_data.push_back(translated_entry[rank][j]);
-         }
+        failed_hang_info_index.push_back(hang_info_index);
        }
-      
-      //Find the number of data added to the vector
-      send_n[rank] = send_data.size() - send_displacement[rank];
      }
-    
-    
-    //Storage for the number of data to be received from each processor
-    Vector<int> receive_n(n_proc,0);
-    
-    //Now send numbers of data to be sent between all processors
-    MPI_Alltoall(&send_n[0],1,MPI_INT,&receive_n[0],1,MPI_INT,
-                 Comm_pt->mpi_comm());
-    
-    //We now prepare the data to be received
-    //by working out the displacements from the received data
-    Vector<int> receive_displacement(n_proc,0);
-    int receive_data_count=0;
-    for(int rank=0;rank<n_proc;++rank)
-     {
-      //Displacement is number of data received so far
-      receive_displacement[rank] = receive_data_count;
-      receive_data_count += receive_n[rank];
-     }
-    
-    //Now resize the receive buffer for all data from all processors
-    //Make sure that it has a size of at least one
-    if(receive_data_count==0) {++receive_data_count;}
-    Vector<unsigned> receive_data(receive_data_count);
-    
-    //Make sure that the send buffer has size at least one
-    //so that we don't get a segmentation fault
-    if(send_data.size()==0) {send_data.resize(1);}
-    
-    //Now send the data between all the processors
-    MPI_Alltoallv(&send_data[0],&send_n[0],&send_displacement[0],
-                  MPI_INT,
-                  &receive_data[0],&receive_n[0],
-                  &receive_displacement[0],
-                  MPI_INT,
-                  Comm_pt->mpi_comm());
-    
-    //Now use the received data to update the halo nodes
-    for (int send_rank=0;send_rank<n_proc;send_rank++)
-     {
-      //Don't bother to do anything for the processor corresponding to the
-      //current processor or if no data were received from this processor
-      if((send_rank != my_rank) && (receive_n[send_rank] != 0))
-       {
-        //Counter for the data within the large array
-        unsigned count=receive_displacement[send_rank];
-        
-        // We're reading one number per missing halo node
-        unsigned n_rec=unsigned(receive_n[send_rank]);
-        for (unsigned i=0;i<n_rec;i++)
-         {
-          // Index of missing master node in shared node lookup scheme
-          // with processor send_rank:
-          // Must be an int because failure returns -1
-          int index=receive_data[count];
-          count++;
-
-          // Translation query has been successful if index >= 0
-          if(index >= 0)
-           {
-            // Recall information associated with that missing master
-            unsigned hang_info_index=hang_info_index_for_proc[send_rank][i];
-            HangHelperStruct tmp=hang_info[hang_info_index];
+   }
 
-            // Extract node from shared node lookup scheme
-            Node* master_nod_pt=
-             shared_node_pt(send_rank,index);
+  // Translation queries that have failed: This is the processor
+  // on which the node was a halo, so we must delete the
+  // partial hang info.
+  unsigned n_failed=failed_hang_info_index.size();
+  for (unsigned i=0;i<n_failed;i++)
+   {
+    HangHelperStruct tmp=hang_info[failed_hang_info_index[i]];
 
-            // Set as a master node (with corresponding weight)
-            tmp.Hang_pt->set_master_node_pt(tmp.Master_node_index,
-                                            master_nod_pt,tmp.Weight);
-           }
-          else
-           {
-            // Translation query has failed. This is the processor
-            // on which the node was a halo, so we must delete the
-            // partial hang info.
-
-            // Recall information associated with that missing master
-            unsigned hang_info_index=hang_info_index_for_proc[send_rank][i];
-            HangHelperStruct tmp=hang_info[hang_info_index];
-
-            // Delete partial hanging information
-            tmp.Node_pt->set_hanging_pt(0,tmp.icont);
-            
-            // Set flag to trigger another round of synchronisation
-            // This works even though we don't own the node that
-            // still requires synchrionisation because this variable
-            // is reduced over all processors at the end
-            nnode_still_requiring_synchronisation++;
-           }
-         }
-        
-       }
-     } //End of data is received
+    // Delete partial hanging information
+    tmp.Node_pt->set_hanging_pt(0,tmp.icont);
     
-   } // end of completing hang info for missing master nodes
-   
-   
-   if (Global_timings::Doc_comprehensive_timings)
-    {
-     t_end = TimingHelpers::timer();
-     oomph_info 
-      << "Time for fourth all-to-all in synchronise_hanging_nodes() " 
-      << t_end-t_start << std::endl;
-    }  
-  } // end  of reconciliation required
+    // Set flag to trigger another round of synchronisation
+    // This works even though we don't own the node that
+    // still requires synchrionisation because this variable
+    // is reduced over all processors at the end
+    nnode_still_requiring_synchronisation++;
+   }
+  
+  if (Global_timings::Doc_comprehensive_timings)
+   {
+    t_end = TimingHelpers::timer();
+    oomph_info << "Time for fourth neighbour exchange in "
+               << "synchronise_hanging_nodes(): " 
+               << t_end-t_start << std::endl;
+   }  
+ } // end of reconciliation
 
 
  //Get global number of nodes still requiring synchronisation due to
@@ -3558,245 +3616,174 @@ void TreeBasedRefineableMeshBase::synchronise_hanging_nodes
 //========================================================================
 void TreeBasedRefineableMeshBase::synchronise_nonhanging_nodes()
 {
- // Store number of processors and current process
- MPI_Status status;
+ // Store number of processors
  int n_proc=Comm_pt->nproc();
- int my_rank=Comm_pt->my_rank();
 
  double t_start = 0.0;
  double t_end = 0.0;
  
- // Storage for the hanging status of halo/haloed nodes on elements
- Vector<Vector<unsigned> > recv_unsigneds(n_proc);
- Vector<Vector<double> > recv_doubles(n_proc);
-
  if (Global_timings::Doc_comprehensive_timings)
   {
    t_start = TimingHelpers::timer();
   }
 
- // Loop over processes: Each processor checks if its nonhaning nodes in
- // haloed elements with proc d require additional information to determine
- // their positions.
- for (int d=0; d<n_proc; d++)
+ // Get the processors we share halo(ed) elements with: Only those
+ // can hold nodes whose positions need adjusting
+ Vector<unsigned> neighbour_proc;
+ get_neighbouring_processors(neighbour_proc);
+ unsigned n_neighbour=neighbour_proc.size();
+
+ // Storage for the indices and positions of nodes to be sent to/received
+ // from each processor
+ Vector<Vector<int> > send_unsigneds(n_proc);
+ Vector<Vector<double> > send_doubles(n_proc);
+ Vector<Vector<int> > recv_unsigneds;
+ Vector<Vector<double> > recv_doubles;
+
+ // Loop over neighbours: Each processor checks if its nonhanging nodes in
+ // haloed elements with proc dd require additional information to determine
+ // their positions on proc dd.
+ for (unsigned i=0;i<n_neighbour;i++)
   {
+   int dd=neighbour_proc[i];
 
-   // No halo with self: Setup hang info for my haloed nodes with proc d 
-   // then get ready to receive halo info from processor d.
-   if (d!=my_rank) 
-    {
-     
-     // Receive the position information from the corresponding process
-     unsigned recv_unsigneds_count=0;
-     MPI_Recv(&recv_unsigneds_count,1,MPI_UNSIGNED,d,0,Comm_pt->mpi_comm(),&status);
-     unsigned recv_doubles_count=0;
-     MPI_Recv(&recv_doubles_count,1,MPI_UNSIGNED,d,1,Comm_pt->mpi_comm(),&status); 
-
-     // Get the data (if any)
-     if (recv_unsigneds_count!=0)
-      {
-       recv_unsigneds[d].resize(recv_unsigneds_count);
-       MPI_Recv(&recv_unsigneds[d][0],recv_unsigneds_count,MPI_UNSIGNED,d,0,
-                Comm_pt->mpi_comm(),&status);
-      }
-     if (recv_doubles_count!=0)
-      {
-       recv_doubles[d].resize(recv_doubles_count);
-       MPI_Recv(&recv_doubles[d][0],recv_doubles_count,MPI_DOUBLE,d,1,
-                Comm_pt->mpi_comm(),&status);      
-      }
-
-     // Counters for received data
-     unsigned recv_unsigneds_index = 0;
-     double recv_doubles_index = 0;
+   // Set to store nodes whose position requires adjustment
+   std::set<Node*> nodes_requiring_adjustment;
 
-     // Get halo elements with processor d
-     Vector<GeneralisedElement*> halo_element_pt(this->halo_element_pt(d));
+   // Get haloed elements with processor dd
+   Vector<GeneralisedElement*> haloed_element_pt(this->haloed_element_pt(dd));
+     
+   // Loop over haloed elements with processor dd
+   unsigned nh=haloed_element_pt.size();
+   for (unsigned e=0;e<nh;e++)
+    {
+     // Get (finite) element
+     FiniteElement* el_pt=dynamic_cast<FiniteElement*>(haloed_element_pt[e]);
 
-     // Loop over recieved indices
-     while(recv_unsigneds_index<recv_unsigneds_count)
+     // If we have a finite element...
+     if(el_pt!=0)
       {
-       // Get (finite) element
-       FiniteElement* el_pt=
-        dynamic_cast<FiniteElement*>(
-         halo_element_pt[recv_unsigneds[d][recv_unsigneds_index++]]);
+       // Get dimension
+       unsigned n_dim = el_pt->dim();
 
-       // If we have a finite element...
-       if(el_pt!=0)
+       // Loop over element nodes
+       unsigned n_node = el_pt->nnode();
+       for (unsigned j=0;j<n_node;j++)
         {
-         // Get dimension
-         unsigned n_dim = el_pt->dim();
-
          // Get node
-         Node* nod_pt=el_pt->node_pt(recv_unsigneds[d][recv_unsigneds_index++]);
-         
-         // Get current position
-         Vector<double> x_cur(n_dim);
-         for(unsigned dir=0; dir<n_dim; dir++)
-          {
-           x_cur[dir] = nod_pt->x(dir);
-          }
+         Node* nod_pt=el_pt->node_pt(j);
          
-         // Get recieved position
-         Vector<double> x_rec(n_dim);
-         for(unsigned dir=0; dir<n_dim; dir++)
+         // Only do non-hanging nodes
+         if (!nod_pt->is_hanging())
           {
-           x_rec[dir] = recv_doubles[d][recv_doubles_index+dir];
-          }
+           // Check if node's position is the same as that interpolated
+           // using its local coordinate in the haloed element
 
-         // Compare actual and expected positions
-         bool node_pos_differs=false;
-         for(unsigned dir=0; dir<n_dim; dir++)
-          {
-           node_pos_differs = node_pos_differs
-            || (std::fabs(x_cur[dir]-x_rec[dir])>1.0e-14);
-          }
-         
-         // Set the actual position
-         Vector<double> x_act(n_dim);
-         for(unsigned dir=0; dir<n_dim; dir++)
-          {
-           nod_pt->x(dir) = recv_doubles[d][recv_doubles_index++];
-          }
-        }
-      }
-
-     if(recv_unsigneds_count!=recv_unsigneds_index)
-      {
-       std::ostringstream error_stream;
-       error_stream << "recv_unsigneds_count != recv_unsigneds_index ( "
-                    << recv_unsigneds_count << " != "
-                    << recv_unsigneds_index << ")" << std::endl;
-       throw OomphLibError(
-              error_stream.str(),
-              "TreeBasedRefineableMeshBase::synchronise_nonhanging_nodes()",
-              OOMPH_EXCEPTION_LOCATION);
-      }
-
-    }
-   else // d==my_rank, i.e. current process: Send halo hanging status 
-        // to process dd where it's received (see above) and compared
-        // and compared against the hang status of the haloed nodes
-    {
-     for (int dd=0; dd<n_proc; dd++)
-      {
-       // No halo with yourself
-       if (dd!=d)
-        {
-       
-         // Storage for halo hanging status and counter
-         Vector<int> send_unsigneds;
-         Vector<double> send_doubles;
-
-         // Set to store nodes whose position requires adjustment
-         std::set<Node*> nodes_requiring_adjustment;
-
-         // Get haloed elements with processor dd
-         Vector<GeneralisedElement*> haloed_element_pt(this->haloed_element_pt(dd));
-     
-         // Loop over haloed elements with processor dd
-         unsigned nh=haloed_element_pt.size();
-         for (unsigned e=0;e<nh;e++)
-          {
-           // Get (finite) element
-           FiniteElement* el_pt=dynamic_cast<FiniteElement*>(haloed_element_pt[e]);
-
-           // If we have a finite element...
-           if(el_pt!=0)
+           // Loop over all history values
+           unsigned nt=nod_pt->ntstorage();
+           for(unsigned t=0;t<nt;t++)
             {
-             // Get dimension
-             unsigned n_dim = el_pt->dim();
+             // Get expected position
+             Vector<double> s(n_dim), x_exp(n_dim);
+             el_pt->local_coordinate_of_node(j,s);
+             el_pt->get_x(t,s,x_exp);
+               
+             // Get actual position
+             Vector<double> x_act(n_dim);
+             for(unsigned dir=0; dir<n_dim; dir++)
+              {
+               x_act[dir] = nod_pt->x(dir);
+              }
 
-             // Loop over element nodes
-             unsigned n_node = el_pt->nnode();
-             for (unsigned j=0;j<n_node;j++)
+             // Compare actual and expected positions
+             bool node_pos_differs=false;
+             for(unsigned dir=0; dir<n_dim; dir++)
               {
-               // Get node
-               Node* nod_pt=el_pt->node_pt(j);
-         
-               // Only do non-hanging nodes
-               if (!nod_pt->is_hanging())
-                {
-                 // Check if node's position is the same as that interpolated using its
-                 // local coordinate in the haloed element
+               node_pos_differs = node_pos_differs
+                || (std::fabs(x_act[dir]-x_exp[dir])>1.0e-14);
+              }
 
-                 // Loop over all history values
-                 unsigned nt=nod_pt->ntstorage();
-                 for(unsigned t=0;t<nt;t++)
+             // If the node's actual position differs from its
+             // expected position we need to communicate this
+             // information to processors on which this is a halo node
+             if(node_pos_differs)
+              {
+               // Check that node has not been done already
+               if(nodes_requiring_adjustment.insert(nod_pt).second)
+                {
+                 // Send index of haloed element
+                 send_unsigneds[dd].push_back(e);
+                 // Send index of node in the element
+                 send_unsigneds[dd].push_back(j);
+                 // Send actual position of node
+                 for(unsigned dir=0; dir<n_dim; dir++)
                   {
-                   // Get expected position
-                   Vector<double> s(n_dim), x_exp(n_dim);
-                   el_pt->local_coordinate_of_node(j,s);
-                   el_pt->get_x(t,s,x_exp);
-               
-                   // Get actual position
-                   Vector<double> x_act(n_dim);
-                   for(unsigned dir=0; dir<n_dim; dir++)
-                    {
-                     x_act[dir] = nod_pt->x(dir);
-                    }
-
-                   // Compare actual and expected positions
-                   bool node_pos_differs=false;
-                   for(unsigned dir=0; dir<n_dim; dir++)
-                    {
-                     node_pos_differs = node_pos_differs
-                      || (std::fabs(x_act[dir]-x_exp[dir])>1.0e-14);
-                    }
-
-                   // If the node's actual position differs from its
-                   // expected position we need to communicate this
-                   // information to processors on which this is a halo node
-                   if(node_pos_differs)
-                    {
-                     // Check that node has not been done already
-                     if(nodes_requiring_adjustment.insert(nod_pt).second)
-                      {
-                       // Send index of haloed element
-                       send_unsigneds.push_back(e);
-                       // Send index of node in the element
-                       send_unsigneds.push_back(j);
-                       // Send actual position of node
-                       for(unsigned dir=0; dir<n_dim; dir++)
-                        {
-                         send_doubles.push_back(x_act[dir]);
-                        }
-                      }
-                    }
+                   send_doubles[dd].push_back(x_act[dir]);
                   }
                 }
               }
             }
           }
-         
-         // Send the information to the relevant process
-         unsigned send_unsigneds_count=send_unsigneds.size();
-         unsigned send_doubles_count=send_doubles.size();
+        }
+      }
+    }
+  }
 
-         if(send_unsigneds_count>0)
-          {
-           //exit(1);
-          }
+ // Exchange the positions with the neighbours
+ exchange_with_neighbouring_processors(neighbour_proc,
+                                       send_unsigneds,send_doubles,
+                                       recv_unsigneds,recv_doubles);
 
-         // Tell processor dd how much data to receive
-         MPI_Send(&send_unsigneds_count,1,MPI_UNSIGNED,dd,0,Comm_pt->mpi_comm());
-         MPI_Send(&send_doubles_count,1,MPI_UNSIGNED,dd,1,Comm_pt->mpi_comm());
-         
-         // Send data (if any)
-         if (send_unsigneds_count!=0)
-          {
-           MPI_Send(&send_unsigneds[0],send_unsigneds_count,MPI_UNSIGNED,
-                    dd,0,Comm_pt->mpi_comm());
-          }
-         if (send_doubles_count!=0)
-          {
-           MPI_Send(&send_doubles[0],send_doubles_count,MPI_DOUBLE,
-                    dd,1,Comm_pt->mpi_comm());
-          }
+ // Loop over neighbours: Update the positions of the halo nodes with
+ // proc d
+ for (unsigned i=0;i<n_neighbour;i++)
+  {
+   int d=neighbour_proc[i];
+
+   // Counters for received data
+   unsigned recv_unsigneds_count=recv_unsigneds[d].size();
+   unsigned recv_unsigneds_index = 0;
+   unsigned recv_doubles_index = 0;
+
+   // Get halo elements with processor d
+   Vector<GeneralisedElement*> halo_element_pt(this->halo_element_pt(d));
+
+   // Loop over recieved indices
+   while(recv_unsigneds_index<recv_unsigneds_count)
+    {
+     // Get (finite) element
+     FiniteElement* el_pt=
+      dynamic_cast<FiniteElement*>(
+       halo_element_pt[recv_unsigneds[d][recv_unsigneds_index++]]);
 
+     // If we have a finite element...
+     if(el_pt!=0)
+      {
+       // Get dimension
+       unsigned n_dim = el_pt->dim();
+
+       // Get node
+       Node* nod_pt=el_pt->node_pt(recv_unsigneds[d][recv_unsigneds_index++]);
+         
+       // Set the actual position
+       for(unsigned dir=0; dir<n_dim; dir++)
+        {
+         nod_pt->x(dir) = recv_doubles[d][recv_doubles_index++];
         }
       }
     }
+
+   if(recv_unsigneds_count!=recv_unsigneds_index)
+    {
+     std::ostringstream error_stream;
+     error_stream << "recv_unsigneds_count != recv_unsigneds_index ( "
+                  << recv_unsigneds_count << " != "
+                  << recv_unsigneds_index << ")" << std::endl;
+     throw OomphLibError(
+      error_stream.str(),
+      "TreeBasedRefineableMeshBase::synchronise_nonhanging_nodes()",
+      OOMPH_EXCEPTION_LOCATION);
+    }
   }
 
  if (Global_timings::Doc_comprehensive_timings)
@@ -3809,6 +3796,99 @@ void TreeBasedRefineableMeshBase::synchronise_nonhanging_nodes()
  
 }
 
+
+
+//========================================================================
+/// Exchange flat-packed int and double data with the neighbouring
+/// processors, using non-blocking point-to-point communication:
+/// send_int[d] and send_double[d] are sent to processor d; on return
+/// recv_int[d] and recv_double[d] contain the data received from
+/// processor d. All vectors are indexed by processor rank; entries for
+/// processors that aren't neighbours are ignored (send) or left empty
+/// (receive).
+//========================================================================
+void TreeBasedRefineableMeshBase::exchange_with_neighbouring_processors(
+ const Vector<unsigned>& neighbour_proc,
+ Vector<Vector<int> >& send_int,
+ Vector<Vector<double> >& send_double,
+ Vector<Vector<int> >& recv_int,
+ Vector<Vector<double> >& recv_double)
+{
+ int n_proc=Comm_pt->nproc();
+ unsigned n_neighbour=neighbour_proc.size();
+
+ recv_int.clear();
+ recv_int.resize(n_proc);
+ recv_double.clear();
+ recv_double.resize(n_proc);
+
+ // Nothing to do if we don't have any neighbours (also avoids
+ // taking the address of the first entry of empty vectors below)
+ if (n_neighbour==0) {return;}
+
+ // Exchange the number of ints and doubles with each neighbour
+ Vector<unsigned> send_count(2*n_neighbour);
+ Vector<unsigned> recv_count(2*n_neighbour);
+ Vector<MPI_Request> requests;
+ for (unsigned i=0;i<n_neighbour;i++)
+  {
+   unsigned d=neighbour_proc[i];
+   send_count[2*i]=send_int[d].size();
+   send_count[2*i+1]=send_double[d].size();
+
+   MPI_Request request;
+   MPI_Irecv(&recv_count[2*i],2,MPI_UNSIGNED,d,0,
+             Comm_pt->mpi_comm(),&request);
+   requests.push_back(request);
+   MPI_Isend(&send_count[2*i],2,MPI_UNSIGNED,d,0,
+             Comm_pt->mpi_comm(),&request);
+   requests.push_back(request);
+  }
+ MPI_Waitall(requests.size(),&requests[0],MPI_STATUSES_IGNORE);
+ requests.clear();
+
+ // Exchange the data itself
+ for (unsigned i=0;i<n_neighbour;i++)
+  {
+   unsigned d=neighbour_proc[i];
+   MPI_Request request;
+
+   // Receive ints and doubles (if any)
+   if (recv_count[2*i]!=0)
+    {
+     recv_int[d].resize(recv_count[2*i]);
+     MPI_Irecv(&recv_int[d][0],recv_count[2*i],MPI_INT,d,1,
+               Comm_pt->mpi_comm(),&request);
+     requests.push_back(request);
+    }
+   if (recv_count[2*i+1]!=0)
+    {
+     recv_double[d].resize(recv_count[2*i+1]);
+     MPI_Irecv(&recv_double[d][0],recv_count[2*i+1],MPI_DOUBLE,d,2,
+               Comm_pt->mpi_comm(),&request);
+     requests.push_back(request);
+    }
+
+   // Send ints and doubles (if any)
+   if (send_count[2*i]!=0)
+    {
+     MPI_Isend(&send_int[d][0],send_count[2*i],MPI_INT,d,1,
+               Comm_pt->mpi_comm(),&request);
+     requests.push_back(request);
+    }
+   if (send_count[2*i+1]!=0)
+    {
+     MPI_Isend(&send_double[d][0],send_count[2*i+1],MPI_DOUBLE,d,2,
+               Comm_pt->mpi_comm(),&request);
+     requests.push_back(request);
+    }
+  }
+ if (requests.size()!=0)
+  {
+   MPI_Waitall(requests.size(),&requests[0],MPI_STATUSES_IGNORE);
+  }
+}
+
 #endif
 
 
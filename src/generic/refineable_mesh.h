@@ -366,6 +366,9 @@ public:
 
    // Mesh hasn't been pruned yet
    Uniform_refinement_level_when_pruned=0;
+
+   // Adapt in serial by default
+   Nthread=1;
   }
 
 
@@ -432,6 +435,21 @@ public:
  /// Return pointer to the Forest represenation of the mesh
  TreeForest* forest_pt(){return Forest_pt;}
 
+ /// \short Access function for the number of threads used to split the
+ /// elements and to set up their geometric hanging node schemes during
+ /// the mesh adaptation (only used if oomph-lib was built with pthreads;
+ /// defaults to one). The elements' constructors and initial_setup()
+ /// must be thread-safe if this is increased.
+ unsigned& nthread() {return Nthread;}
+
+ /// \short Number of threads used during the mesh adaptation 
+ /// (const version)
+ unsigned nthread() const {return Nthread;}
+
+ /// \short Min. number of elements per thread in the threaded parts
+ /// of the mesh adaptation
+ static unsigned Min_nelement_per_thread;
+
 
  /// Doc the targets for mesh adaptation
  void doc_adaptivity_targets(std::ostream &outfile)
@@ -663,7 +681,17 @@ protected:
  
 #ifdef OOMPH_HAS_MPI
 
- /// Synchronise the hanging nodes if the mesh is distributed
+ /// \short Synchronise the hanging nodes if the mesh is distributed.
+ /// Only the neighbouring processors (those this mesh shares halo(ed)
+ /// data with) are involved in the exchange of hanging node
+ /// information, including the reconciliation of master nodes held 
+ /// on a third processor. The only global collective is the reduction
+ /// that decides whether the (collective)
+ /// additional_synchronise_hanging_nodes(...) is required. 
+ /// NOTE: Every processor still stores the entire (global) base mesh
+ /// and its refinement pattern, so the memory required on each 
+ /// processor still scales with the size of the global base mesh; 
+ /// only the communication is local.
  void synchronise_hanging_nodes(const unsigned& ncont_interpolated_values);
 
  /// Additional synchronisation of hanging nodes
@@ -680,6 +708,21 @@ protected:
  /// with different p-orders where the shared edge is on the outer edge of
  /// the halo layer)
  void synchronise_nonhanging_nodes();
+
+ /// \short Exchange flat-packed int and double data with the
+ /// neighbouring processors (as returned by
+ /// Mesh::get_neighbouring_processors(...)) using non-blocking
+ /// point-to-point communication. (This only localises the 
+ /// communication: the base mesh is not distributed.) All vectors are indexed by
+ /// processor rank: send_int[d] and send_double[d] are sent to
+ /// processor d; on return recv_int[d] and recv_double[d] contain the
+ /// data received from processor d.
+ void exchange_with_neighbouring_processors(
+  const Vector<unsigned>& neighbour_proc,
+  Vector<Vector<int> >& send_int,
+  Vector<Vector<double> >& send_double,
+  Vector<Vector<int> >& recv_int,
+  Vector<Vector<double> >& recv_double);
  
 #endif
 
@@ -688,6 +731,20 @@ protected:
  /// any new elements that are created will be of the correct type.
  virtual void split_elements_if_required()=0;
 
+ /// \short Call the member function for all the leaves in the forest.
+ /// With pthreads, contiguous chunks of leaves are processed 
+ /// concurrently by up to Nthread threads, so the member function
+ /// must be thread-safe for distinct leaves.
+ void call_for_all_leaves(Tree::VoidMemberFctPt member_function);
+
+ /// \short Set up the hanging nodes for the elements in tree_nodes_pt
+ /// (the leaves of the forest), computing the geometric hanging node 
+ /// schemes concurrently with up to Nthread threads. Returns false 
+ /// (without changing anything) if this isn't supported by all
+ /// elements, in which case their setup_hanging_nodes(...) has to be
+ /// used instead.
+ bool setup_hanging_nodes_with_threads(Vector<Tree*>& tree_nodes_pt);
+
  /// \short p-refine all the elements in the mesh if required. This template
  /// free interface will be overloaded in RefineableMesh<ELEMENT> so that
  /// any temporary copies of the element that are created will be of the
@@ -722,6 +779,9 @@ protected:
  /// Forest representation of the mesh
  TreeForest* Forest_pt;
 
+ /// Number of threads used during the mesh adaptation
+ unsigned Nthread;
+
   private:
 
 #ifdef OOMPH_HAS_MPI
@@ -771,15 +831,9 @@ class TreeBasedRefineableMesh : public virtual TreeBasedRefineableMeshBase
   /// will be of the correct type.
   void split_elements_if_required()
    {
-    //Find the number of trees in the forest
-    unsigned n_tree = this->Forest_pt->ntree();
     //Loop over all "active" elements in the forest and split them
     //if required
-    for (unsigned long e=0;e<n_tree;e++)
-     {
-      this->Forest_pt->tree_pt(e)->
-       traverse_leaves(&Tree::split_if_required<ELEMENT>);
-     }
+    this->call_for_all_leaves(&Tree::split_if_required<ELEMENT>);
    }
    
   /// \short p-refine all the elements if required. Overload the template-free
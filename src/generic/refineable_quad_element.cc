@@ -99,6 +99,57 @@ void RefineableQElement<2>::setup_father_bounds()
 
 }
 
+//==================================================================
+/// Setup static matrices of the father's shape functions at the
+/// son's nodal points:
+///
+/// Father_to_son_shape[nnode_1d][son_type](jnod_son,jnod_father)
+///
+/// These are used to transfer the solution from father to son
+/// during refinement for elements whose values are interpolated
+/// isoparametrically (see get_isoparametric_value_indices(...)).
+//==================================================================
+void RefineableQElement<2>::setup_father_to_son_shape()
+{
+ using namespace QuadTreeNames;
+
+ //Find the number of nodes along a 1D edge
+ unsigned n_p = nnode_1d();
+ unsigned n_node = n_p*n_p;
+
+ //Allocate space for the matrices
+ Father_to_son_shape[n_p].resize(4);
+
+ Shape psi(n_node);
+ Vector<double> s_lo(2);
+ Vector<double> s(2);
+ for(int son_type=SW;son_type<=NE;son_type++)
+  {
+   // Lower left vertex of the son in the father element
+   s_lo[0] = (son_type==SE || son_type==NE) ? 0.0 : -1.0;
+   s_lo[1] = (son_type==NW || son_type==NE) ? 0.0 : -1.0;
+
+   DenseMatrix<double>& father_to_son_shape=
+    Father_to_son_shape[n_p][son_type];
+   father_to_son_shape.resize(n_node,n_node);
+   for(unsigned i0=0;i0<n_p;i0++)
+    {
+     s[0] = s_lo[0] + local_one_d_fraction_of_node(i0,0);
+     for(unsigned i1=0;i1<n_p;i1++)
+      {
+       s[1] = s_lo[1] + local_one_d_fraction_of_node(i1,1);
+
+       // Father's shape functions at the son's node
+       shape(s,psi);
+       for(unsigned l=0;l<n_node;l++)
+        {
+         father_to_son_shape(i0+n_p*i1,l)=psi[l];
+        }
+      }
+    }
+  }
+}
+
 //==================================================================
 /// Determine Vector of boundary conditions along the element's boundary 
 /// (or vertex) bound (S/W/N/E/SW/SE/NW/NE). 
@@ -729,6 +780,22 @@ void RefineableQElement<2>::build(Mesh*& mesh_pt,
      Vector<double> x_large(2);
 
      Vector<double> s_fraction(2);
+
+     // If the father interpolates its values isoparametrically, transfer
+     // them to all of our nodes and history levels in one go, using the
+     // precomputed father-to-son interpolation matrix
+     Vector<unsigned> value_index;
+     bool batched_transfer=
+      father_el_pt->batched_value_transfer_is_possible(value_index);
+     DenseMatrix<double> son_values;
+     if (batched_transfer)
+      {
+       if(Father_to_son_shape[n_p].size()==0) {setup_father_to_son_shape();}
+       interpolate_father_values_to_son_nodes(
+        father_el_pt,Father_to_son_shape[n_p][son_type],
+        value_index,ntstorage,son_values);
+      }
+
      // Loop over nodes in element
      for(unsigned i0=0;i0<n_p;i0++)
       {
@@ -780,25 +847,33 @@ void RefineableQElement<2>::build(Mesh*& mesh_pt,
            //This is only need for mixed interpolation where the value
            //at the father could now become active.
           
-           // Loop over all history values
-           for(unsigned t=0;t<ntstorage;t++)
+           if (batched_transfer)
+            {
+             set_nodal_values_from_son_values(created_node_pt,jnod,
+                                              son_values,ntstorage);
+            }
+           else
             {
-             // Get values from father element
-             // Note: get_interpolated_values() sets Vector size itself.
-             Vector<double> prev_values;
-             father_el_pt->get_interpolated_values(t,s,prev_values);
-             //Find the minimum number of values
-             //(either those stored at the node, or those returned by
-             // the function)
-             unsigned n_val_at_node = created_node_pt->nvalue();
-             unsigned n_val_from_function = prev_values.size(); 
-             //Use the ternary conditional operator here
-             unsigned n_var = n_val_at_node < n_val_from_function ?
-              n_val_at_node : n_val_from_function;
-             //Assign the values that we can
-             for(unsigned k=0;k<n_var;k++)
+             // Loop over all history values
+             for(unsigned t=0;t<ntstorage;t++)
               {
-               created_node_pt->set_value(t,k,prev_values[k]);
+               // Get values from father element
+               // Note: get_interpolated_values() sets Vector size itself.
+               Vector<double> prev_values;
+               father_el_pt->get_interpolated_values(t,s,prev_values);
+               //Find the minimum number of values
+               //(either those stored at the node, or those returned by
+               // the function)
+               unsigned n_val_at_node = created_node_pt->nvalue();
+               unsigned n_val_from_function = prev_values.size(); 
+               //Use the ternary conditional operator here
+               unsigned n_var = n_val_at_node < n_val_from_function ?
+                n_val_at_node : n_val_from_function;
+               //Assign the values that we can
+               for(unsigned k=0;k<n_var;k++)
+                {
+                 created_node_pt->set_value(t,k,prev_values[k]);
+                }
               }
             }
 
@@ -1224,18 +1299,26 @@ void RefineableQElement<2>::build(Mesh*& mesh_pt,
               }
             }
 
-           // Loop over all history values
-           for (unsigned t=0;t<ntstorage;t++)
+           if (batched_transfer)
             {
-             // Get values from father element
-             // Note: get_interpolated_values() sets Vector size itself.
-             Vector<double> prev_values;
-             father_el_pt->get_interpolated_values(t,s,prev_values);
-             //Initialise the values at the new node
-             unsigned n_value = created_node_pt->nvalue();
-             for(unsigned k=0;k<n_value;k++)
+             set_nodal_values_from_son_values(created_node_pt,jnod,
+                                              son_values,ntstorage);
+            }
+           else
+            {
+             // Loop over all history values
+             for (unsigned t=0;t<ntstorage;t++)
               {
-               created_node_pt->set_value(t,k,prev_values[k]);
+               // Get values from father element
+               // Note: get_interpolated_values() sets Vector size itself.
+               Vector<double> prev_values;
+               father_el_pt->get_interpolated_values(t,s,prev_values);
+               //Initialise the values at the new node
+               unsigned n_value = created_node_pt->nvalue();
+               for(unsigned k=0;k<n_value;k++)
+                {
+                 created_node_pt->set_value(t,k,prev_values[k]);
+                }
               }
             }
 
@@ -1472,6 +1555,31 @@ void RefineableQElement<2>::setup_hang_for_value(const int &value_id)
 }
  
 
+//====================================================================
+/// Compute the changes that setup_hanging_nodes(...) would make to the
+/// geometric hanging node schemes and nodal positions, without changing
+/// any nodes. Returns false for solid and p-refineable elements, whose
+/// overloaded quad_hang_helper(...) isn't covered.
+//====================================================================
+bool RefineableQElement<2>::get_pending_geometric_hanging_nodes(
+ Vector<PendingHangingNode>& pending)
+{
+ if ((dynamic_cast<RefineableSolidElement*>(this)!=0)||
+     (dynamic_cast<PRefineableElement*>(this)!=0))
+  {
+   return false;
+  }
+
+ using namespace QuadTreeNames;
+
+ std::ofstream dummy_hangfile;
+ edge_hang_helper(-1,S,dummy_hangfile,&pending);
+ edge_hang_helper(-1,N,dummy_hangfile,&pending);
+ edge_hang_helper(-1,W,dummy_hangfile,&pending);
+ edge_hang_helper(-1,E,dummy_hangfile,&pending);
+ return true;
+}
+
 //=================================================================
 /// Internal function to set up the hanging nodes on a particular
 /// edge of the element
@@ -1479,6 +1587,19 @@ void RefineableQElement<2>::setup_hang_for_value(const int &value_id)
 void RefineableQElement<2>::
 quad_hang_helper(const int &value_id,
                  const int &my_edge, std::ofstream& output_hangfile)
+{
+ edge_hang_helper(value_id,my_edge,output_hangfile,0);
+}
+
+//=================================================================
+/// Implementation of quad_hang_helper(...). If pending_pt is non-null,
+/// the changes to the nodes are appended to *pending_pt rather than
+/// being made.
+//=================================================================
+void RefineableQElement<2>::
+edge_hang_helper(const int &value_id,
+                 const int &my_edge, std::ofstream& output_hangfile,
+                 Vector<PendingHangingNode>* pending_pt)
 {
  using namespace QuadTreeNames;
 
@@ -1642,9 +1763,16 @@ quad_hang_helper(const int &value_id,
          //initially
          bool make_hanging_node = false;
          
+         // The geometric hanging node scheme is always (re)made, so
+         // there's no need to look at the node when the change is 
+         // only recorded
+         if(pending_pt!=0)
+          {
+           make_hanging_node = true;
+          }
          // If the node is not hanging geometrically, then we must make
          // it hang
-         if(!local_node_pt->is_hanging())
+         else if(!local_node_pt->is_hanging())
           {
            make_hanging_node = true;
           }
@@ -1716,7 +1844,17 @@ quad_hang_helper(const int &value_id,
            //Now set the hanging data for the position
            //This also constrains the data values associated with the
            //value id
-           local_node_pt->set_hanging_pt(hang_pt,value_id);
+           if(pending_pt!=0)
+            {
+             PendingHangingNode pending;
+             pending.Node_pt=local_node_pt;
+             pending.Hang_pt=hang_pt;
+             pending_pt->push_back(pending);
+            }
+           else
+            {
+             local_node_pt->set_hanging_pt(hang_pt,value_id);
+            }
           }
          
          //Dump the output if the file has been openeed
@@ -1730,7 +1868,16 @@ quad_hang_helper(const int &value_id,
        else
         {
 #ifdef PARANOID
-         if (local_node_pt!=neighbouring_node_pt)
+         //If the change is only recorded (possibly by a worker thread)
+         //the mismatch is reported when it's applied
+         if ((pending_pt!=0)&&(local_node_pt!=neighbouring_node_pt))
+          {
+           PendingHangingNode pending;
+           pending.Node_pt=local_node_pt;
+           pending.Neighbouring_node_pt=neighbouring_node_pt;
+           pending_pt->push_back(pending);
+          }
+         else if (local_node_pt!=neighbouring_node_pt)
           {
            std::ostringstream warning_stream;
            warning_stream << "SANITY CHECK in quad_hang_helper      \n"
@@ -1756,14 +1903,28 @@ quad_hang_helper(const int &value_id,
        //If we are doing the position, then
        if(value_id==-1)
         {
-         // Get the nodal position from neighbour element
-         Vector<double> x_in_neighb(2);
-         neigh_pt->object_pt()->interpolated_x(s_in_neighb,x_in_neighb);
-         
-         // Fine adjust the coordinates (macro map will pick up boundary
-         // accurately but will lead to different element edges)
-         local_node_pt->x(0)=x_in_neighb[0];
-         local_node_pt->x(1)=x_in_neighb[1];
+         // If the change is only recorded, the position is interpolated
+         // from the neighbour when it's applied (the neighbour's nodes
+         // may be fine-adjusted before then)
+         if(pending_pt!=0)
+          {
+           PendingHangingNode pending;
+           pending.Node_pt=local_node_pt;
+           pending.Neighbour_pt=neigh_pt->object_pt();
+           pending.S_in_neighbour=s_in_neighb;
+           pending_pt->push_back(pending);
+          }
+         else
+          {
+           // Get the nodal position from neighbour element
+           Vector<double> x_in_neighb(2);
+           neigh_pt->object_pt()->interpolated_x(s_in_neighb,x_in_neighb);
+           
+           // Fine adjust the coordinates (macro map will pick up boundary
+           // accurately but will lead to different element edges)
+           local_node_pt->x(0)=x_in_neighb[0];
+           local_node_pt->x(1)=x_in_neighb[1];
+          }
         }
       }
     }
@@ -1974,6 +2135,13 @@ void RefineableQElement<2>::check_integrity(double& max_error)
 //========================================================================
 std::map<unsigned,DenseMatrix<int> > RefineableQElement<2>::Father_bound;
 
+//========================================================================
+/// Static matrices of the father's shape functions at the son's
+/// nodal points
+//========================================================================
+std::map<unsigned, Vector<DenseMatrix<double> > > 
+ RefineableQElement<2>::Father_to_son_shape;
+
 
 
 
@@ -215,6 +215,9 @@ public:
                all_sons_pt[i]->root_pt()=tree_root_pt;
               }
             }
+
+           // The descendants' positions are now relative to the new root
+           tree_root_pt->update_morton_keys_of_descendants();
            
            // Add tree-root to the trees_pt vector
            trees_pt.push_back(tree_root_pt);
@@ -684,6 +684,27 @@ unsigned BinArray::max_bin_dimension() const
 }
 
 
+//==============================================================================
+/// \short Batched version of locate_zeta(...). The default implementation
+/// ignores the guesses and locates the points one after the other.
+//==============================================================================
+ void SamplePointContainer::locate_zeta_batch(
+  const Vector<Vector<double> >& zeta, 
+  const Vector<FiniteElement*>& /*guess_el_pt*/,
+  Vector<GeomObject*>& sub_geom_object_pt,
+  Vector<Vector<double> >& s)
+ {
+  unsigned n_point=zeta.size();
+  sub_geom_object_pt.resize(n_point);
+  s.resize(n_point);
+  for (unsigned p=0;p<n_point;p++)
+   {
+    s[p].resize(ndim_zeta());
+    locate_zeta(zeta[p],sub_geom_object_pt[p],s[p]);
+   }
+ }
+
+
 //========================================================================
 /// Setup the min and max coordinates for the mesh, in each dimension 
 //========================================================================
@@ -3371,6 +3392,937 @@ unsigned NonRefineableBinArray::total_number_of_sample_points_computed_recursive
  bool NonRefineableBinArray::Already_warned_about_small_number_of_bin_cells=false;
 
 
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//                          BoundingBoxTree class
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+
+//==============================================================================
+/// Helper namespace for the BoundingBoxTree
+//==============================================================================
+namespace BoundingBoxTreeHelpers
+{
+
+ //============================================================================
+ /// \short Comparison "function" that orders the elements in a 
+ /// BoundingBoxTree by the position of the centroids of their bounding 
+ /// boxes in a given coordinate direction.
+ //============================================================================
+ class CentroidComparator
+ {
+
+   public:
+
+  /// \short Constructor: Pass the flat-packed min/max coordinates of the 
+  /// bounding boxes, their dimension and the coordinate direction
+  CentroidComparator(const Vector<double>& box_min, 
+                     const Vector<double>& box_max,
+                     const unsigned& dim, 
+                     const unsigned& direction) :
+   Box_min_pt(&box_min), Box_max_pt(&box_max), Dim(dim), 
+   Direction(direction)
+   {}
+
+  /// Is the centroid of the e1-th box before that of the e2-th one?
+  bool operator()(const unsigned& e1, const unsigned& e2) const
+  {
+   unsigned i1=e1*Dim+Direction;
+   unsigned i2=e2*Dim+Direction;
+   return ((*Box_min_pt)[i1]+(*Box_max_pt)[i1])<
+    ((*Box_min_pt)[i2]+(*Box_max_pt)[i2]);
+  }
+
+   private:
+
+  /// Pointer to the flat-packed min. coordinates of the boxes
+  const Vector<double>* Box_min_pt;
+
+  /// Pointer to the flat-packed max. coordinates of the boxes
+  const Vector<double>* Box_max_pt;
+
+  /// Dimension of the boxes
+  unsigned Dim;
+
+  /// Coordinate direction
+  unsigned Direction;
+
+ };
+
+#ifdef OOMPH_HAS_PTHREADS
+
+ //============================================================================
+ /// \short Work for one of the threads in 
+ /// BoundingBoxTree::locate_zeta_batch(...): The range of (ordered) points
+ /// to be located, pointers to the input/output and the thread's own 
+ /// search state.
+ //============================================================================
+ class BatchChunk
+ {
+
+   public:
+
+  /// Constructor: Everything is set up by the caller
+  BatchChunk() : Tree_pt(0), First(0), Last(0), Order_pt(0), Zeta_pt(0),
+   Guess_el_pt(0), Sub_geom_object_pt(0), S_pt(0), State_pt(0) {}
+
+  /// The tree
+  const BoundingBoxTree* Tree_pt;
+
+  /// First point (in the ordered list)
+  unsigned First;
+
+  /// One after the last point (in the ordered list)
+  unsigned Last;
+
+  /// The ordering of the points
+  const Vector<std::pair<unsigned long long,unsigned> >* Order_pt;
+
+  /// The points to be located
+  const Vector<Vector<double> >* Zeta_pt;
+
+  /// Initial guesses for the elements
+  const Vector<FiniteElement*>* Guess_el_pt;
+
+  /// Output: The elements containing the points
+  Vector<GeomObject*>* Sub_geom_object_pt;
+
+  /// Output: The local coordinates of the points
+  Vector<Vector<double> >* S_pt;
+
+  /// The thread's search state (passed as void* because it's private)
+  void* State_pt;
+
+ };
+
+#endif
+
+}
+
+
+//==============================================================================
+/// Constructor
+//==============================================================================
+ BoundingBoxTree::BoundingBoxTree(
+  SamplePointContainerParameters* sample_point_container_parameters_pt) :
+  SamplePointContainer(
+   sample_point_container_parameters_pt->mesh_pt(),
+   sample_point_container_parameters_pt->min_and_max_coordinates(),
+   sample_point_container_parameters_pt->
+   use_eulerian_coordinates_during_setup(),
+   sample_point_container_parameters_pt->
+   ignore_halo_elements_during_locate_zeta_search(),
+   sample_point_container_parameters_pt->
+   nsample_points_generated_per_element()),
+  Ndim_zeta(0),
+  Min_and_max_coordinates_from_tree(false)
+ {
+  BoundingBoxTreeParameters* tree_parameters_pt=
+   dynamic_cast<BoundingBoxTreeParameters*>
+   (sample_point_container_parameters_pt);
+
+#ifdef PARANOID
+  if (tree_parameters_pt==0)
+   {
+    throw OomphLibError("Wrong sample_point_container_parameters_pt",
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+#endif
+
+  Max_nelement_per_leaf=tree_parameters_pt->max_nelement_per_leaf();
+  if (Max_nelement_per_leaf==0)
+   {
+    Max_nelement_per_leaf=1;
+   }
+  Relative_bounding_box_inflation=
+   tree_parameters_pt->relative_bounding_box_inflation();
+  Nthread=tree_parameters_pt->nthread();
+
+  // Get the spatial dimension (int because of mpi below)
+  int dim=0;
+  if(Mesh_pt->nelement()!=0) 
+   {
+    dim = Mesh_pt->finite_element_pt(0)->dim();
+   }
+  
+  // Need to do an Allreduce to ensure that the dimension is consistent
+  // even when no elements are assigned to a certain processor
+#ifdef OOMPH_HAS_MPI
+  //Only a problem if the mesh has been distributed
+  if(Mesh_pt->is_mesh_distributed())
+   {
+    //Need a non-null communicator
+    if(Mesh_pt->communicator_pt()!=0)
+     {
+      int n_proc=Mesh_pt->communicator_pt()->nproc();
+      if (n_proc > 1)
+       {
+        int dim_reduce;
+        MPI_Allreduce(&dim,&dim_reduce,1,MPI_INT,
+                      MPI_MAX,Mesh_pt->communicator_pt()->mpi_comm());
+        dim = dim_reduce; 
+       }
+     }
+   }
+#endif
+  
+  Ndim_zeta=dim;
+
+  // Time it
+  double t_start=0.0;
+  if (SamplePointContainer::Enable_timing_of_setup)
+   {
+    t_start=TimingHelpers::timer();
+   }
+
+  // Collect the elements (skipping halos if we're ignoring them anyway)
+  unsigned nel=Mesh_pt->nelement();
+  Element_pt.reserve(nel);
+  for (unsigned e=0;e<nel;e++)
+   {
+    FiniteElement* el_pt=Mesh_pt->finite_element_pt(e);
+#ifdef OOMPH_HAS_MPI
+    if (Ignore_halo_elements_during_locate_zeta_search&&(el_pt->is_halo()))
+     {
+      continue;
+     }
+#endif
+    Element_number[el_pt]=Element_pt.size();
+    Element_pt.push_back(el_pt);
+   }
+
+  // Get the bounding boxes
+  unsigned n=Element_pt.size();
+  Element_box_min.resize(n*Ndim_zeta);
+  Element_box_max.resize(n*Ndim_zeta);
+  for (unsigned e=0;e<n;e++)
+   {
+    compute_element_bounding_box(e);
+   }
+
+  // Build the tree
+  Tree_element.resize(n);
+  for (unsigned e=0;e<n;e++)
+   {
+    Tree_element[e]=e;
+   }
+  if (n>0)
+   {
+    build_tree(0,n);
+   }
+  Search_state.Element_search_stamp.resize(n,0);
+
+  // Who are the neighbours?
+  setup_neighbours();
+
+  // Have we specified max/min coordinates?
+  // If not, get them from the tree
+  if (Min_and_max_coordinates.size()==0)
+   {
+    Min_and_max_coordinates_from_tree=true;
+    setup_min_and_max_coordinates_from_tree();
+   }
+
+  if (SamplePointContainer::Enable_timing_of_setup)
+   {
+    double t_end=TimingHelpers::timer();
+    oomph_info << "Time for setup of " << dim 
+               << "-dimensional bounding box tree containing "
+               << n << " elements in " << ntree_node() << " tree nodes: "
+               << t_end-t_start << " sec " << std::endl;
+   }
+ }
+
+
+//==============================================================================
+/// Compute the (inflated) bounding box of the e-th element in the tree
+//==============================================================================
+ void BoundingBoxTree::compute_element_bounding_box(const unsigned& e)
+ {
+  FiniteElement* el_pt=Element_pt[e];
+
+  // Storage for local and global coordinates (interpolated_x() may 
+  // return more coordinates than we need, e.g. for FaceElements)
+  Vector<double> s(el_pt->dim());
+  unsigned n_coord=Ndim_zeta;
+  if (Use_eulerian_coordinates_during_setup)
+   {
+    n_coord=std::max(Ndim_zeta,el_pt->nodal_dimension());
+   }
+  Vector<double> zeta(n_coord);
+
+  unsigned offset=e*Ndim_zeta;
+  for (unsigned i=0;i<Ndim_zeta;i++)
+   {
+    Element_box_min[offset+i]=DBL_MAX;
+    Element_box_max[offset+i]=-DBL_MAX;
+   }
+
+  // Loop over the sample points (including the vertices)
+  unsigned nplot=el_pt->nplot_points(Nsample_points_generated_per_element);
+  for (unsigned j=0;j<nplot;j++)
+   {
+    bool use_equally_spaced_interior_sample_points=false; 
+    el_pt->get_s_plot(j,Nsample_points_generated_per_element,s,
+                      use_equally_spaced_interior_sample_points);
+    if (Use_eulerian_coordinates_during_setup)
+     {
+      el_pt->interpolated_x(s,zeta);
+     }
+    else
+     {
+      el_pt->interpolated_zeta(s,zeta);
+     }
+    for (unsigned i=0;i<Ndim_zeta;i++)
+     {
+      if (zeta[i]<Element_box_min[offset+i])
+       {
+        Element_box_min[offset+i]=zeta[i];
+       }
+      if (zeta[i]>Element_box_max[offset+i])
+       {
+        Element_box_max[offset+i]=zeta[i];
+       }
+     }
+   }
+
+  // Inflate by a fraction of the max. extent (in all directions, so 
+  // boxes for elements that are aligned with a coordinate direction
+  // don't collapse) to allow for curved boundaries between the sample
+  // points
+  double max_extent=0.0;
+  for (unsigned i=0;i<Ndim_zeta;i++)
+   {
+    max_extent=std::max(max_extent,
+                        Element_box_max[offset+i]-Element_box_min[offset+i]);
+   }
+  double inflation=Relative_bounding_box_inflation*max_extent;
+  for (unsigned i=0;i<Ndim_zeta;i++)
+   {
+    Element_box_min[offset+i]-=inflation;
+    Element_box_max[offset+i]+=inflation;
+   }
+ }
+
+
+//==============================================================================
+/// Build the (sub-)tree for the elements Tree_element[first],...,
+/// Tree_element[last-1]; returns the number of its root node
+//==============================================================================
+ unsigned BoundingBoxTree::build_tree(const unsigned& first, 
+                                      const unsigned& last)
+ {
+  // Create the node (as a leaf)
+  unsigned node=Tree_nelement.size();
+  Tree_first.push_back(first);
+  Tree_nelement.push_back(last-first);
+  Tree_child.push_back(0);
+  Tree_child.push_back(0);
+  Tree_box_min.resize((node+1)*Ndim_zeta);
+  Tree_box_max.resize((node+1)*Ndim_zeta);
+
+  // Split it?
+  if (last-first>Max_nelement_per_leaf)
+   {
+    // Find the direction in which the centroids are spread out most
+    unsigned direction=0;
+    double max_spread=-1.0;
+    for (unsigned i=0;i<Ndim_zeta;i++)
+     {
+      double c_min=DBL_MAX;
+      double c_max=-DBL_MAX;
+      for (unsigned k=first;k<last;k++)
+       {
+        unsigned j=Tree_element[k]*Ndim_zeta+i;
+        double c=Element_box_min[j]+Element_box_max[j];
+        c_min=std::min(c_min,c);
+        c_max=std::max(c_max,c);
+       }
+      if (c_max-c_min>max_spread)
+       {
+        max_spread=c_max-c_min;
+        direction=i;
+       }
+     }
+
+    // Split at the median
+    unsigned middle=(first+last)/2;
+    std::nth_element(Tree_element.begin()+first,
+                     Tree_element.begin()+middle,
+                     Tree_element.begin()+last,
+                     BoundingBoxTreeHelpers::CentroidComparator(
+                      Element_box_min,Element_box_max,Ndim_zeta,direction));
+    
+    Tree_nelement[node]=0;
+    unsigned left_child=build_tree(first,middle);
+    unsigned right_child=build_tree(middle,last);
+    Tree_child[2*node]=left_child;
+    Tree_child[2*node+1]=right_child;
+   }
+
+  compute_tree_node_bounding_box(node);
+  return node;
+ }
+
+
+//==============================================================================
+/// Compute the bounding box of the specified tree node from those of its
+/// children (or its elements if it's a leaf)
+//==============================================================================
+ void BoundingBoxTree::compute_tree_node_bounding_box(const unsigned& node)
+ {
+  unsigned offset=node*Ndim_zeta;
+  for (unsigned i=0;i<Ndim_zeta;i++)
+   {
+    Tree_box_min[offset+i]=DBL_MAX;
+    Tree_box_max[offset+i]=-DBL_MAX;
+   }
+
+  // Leaf: Get it from the elements
+  unsigned n=Tree_nelement[node];
+  if (n>0)
+   {
+    unsigned first=Tree_first[node];
+    for (unsigned k=first;k<first+n;k++)
+     {
+      unsigned e_offset=Tree_element[k]*Ndim_zeta;
+      for (unsigned i=0;i<Ndim_zeta;i++)
+       {
+        Tree_box_min[offset+i]=std::min(Tree_box_min[offset+i],
+                                        Element_box_min[e_offset+i]);
+        Tree_box_max[offset+i]=std::max(Tree_box_max[offset+i],
+                                        Element_box_max[e_offset+i]);
+       }
+     }
+   }
+  // Otherwise get it from the children
+  else
+   {
+    for (unsigned c=0;c<2;c++)
+     {
+      unsigned c_offset=Tree_child[2*node+c]*Ndim_zeta;
+      for (unsigned i=0;i<Ndim_zeta;i++)
+       {
+        Tree_box_min[offset+i]=std::min(Tree_box_min[offset+i],
+                                        Tree_box_min[c_offset+i]);
+        Tree_box_max[offset+i]=std::max(Tree_box_max[offset+i],
+                                        Tree_box_max[c_offset+i]);
+       }
+     }
+   }
+ }
+
+
+//==============================================================================
+/// Setup the lookup scheme for the neighbours of each element, i.e. the 
+/// elements whose bounding boxes overlap with its own
+//==============================================================================
+ void BoundingBoxTree::setup_neighbours()
+ {
+  unsigned n=Element_pt.size();
+  Neighbour_start.resize(n+1);
+  Neighbour.clear();
+  Neighbour.reserve(8*n);
+  Vector<unsigned> stack;
+  for (unsigned e=0;e<n;e++)
+   {
+    Neighbour_start[e]=Neighbour.size();
+    unsigned e_offset=e*Ndim_zeta;
+
+    // Traverse the tree, only descending into nodes that overlap with
+    // the element's box
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty())
+     {
+      unsigned node=stack.back();
+      stack.pop_back();
+      unsigned offset=node*Ndim_zeta;
+      bool overlap=true;
+      for (unsigned i=0;i<Ndim_zeta;i++)
+       {
+        if ((Tree_box_max[offset+i]<Element_box_min[e_offset+i])||
+            (Tree_box_min[offset+i]>Element_box_max[e_offset+i]))
+         {
+          overlap=false;
+          break;
+         }
+       }
+      if (!overlap)
+       {
+        continue;
+       }
+      unsigned n_el=Tree_nelement[node];
+      if (n_el>0)
+       {
+        unsigned first=Tree_first[node];
+        for (unsigned k=first;k<first+n_el;k++)
+         {
+          unsigned e2=Tree_element[k];
+          if (e2==e)
+           {
+            continue;
+           }
+          unsigned e2_offset=e2*Ndim_zeta;
+          bool el_overlap=true;
+          for (unsigned i=0;i<Ndim_zeta;i++)
+           {
+            if ((Element_box_max[e2_offset+i]<Element_box_min[e_offset+i])||
+                (Element_box_min[e2_offset+i]>Element_box_max[e_offset+i]))
+             {
+              el_overlap=false;
+              break;
+             }
+           }
+          if (el_overlap)
+           {
+            Neighbour.push_back(e2);
+           }
+         }
+       }
+      else
+       {
+        stack.push_back(Tree_child[2*node+1]);
+        stack.push_back(Tree_child[2*node]);
+       }
+     }
+   }
+  Neighbour_start[n]=Neighbour.size();
+ }
+
+
+//==============================================================================
+/// Set the min/max coordinates of the container to those of the bounding
+/// box of the root of the tree
+//==============================================================================
+ void BoundingBoxTree::setup_min_and_max_coordinates_from_tree()
+ {
+  Min_and_max_coordinates.resize(Ndim_zeta);
+  for (unsigned i=0;i<Ndim_zeta;i++)
+   {
+    if (Tree_nelement.size()>0)
+     {
+      Min_and_max_coordinates[i].first=Tree_box_min[i];
+      Min_and_max_coordinates[i].second=Tree_box_max[i];
+     }
+    else
+     {
+      Min_and_max_coordinates[i].first=0.0;
+      Min_and_max_coordinates[i].second=0.0;
+     }
+   }
+ }
+
+
+//==============================================================================
+/// Recompute the bounding boxes (e.g. after the nodes have moved) without
+/// rebuilding the structure of the tree. 
+//==============================================================================
+ void BoundingBoxTree::update_bounding_boxes()
+ {
+  unsigned n=Element_pt.size();
+  for (unsigned e=0;e<n;e++)
+   {
+    compute_element_bounding_box(e);
+   }
+
+  // Children are numbered after their parents so we can update the
+  // tree bottom-up by going through it backwards
+  unsigned n_node=Tree_nelement.size();
+  for (unsigned node=n_node;node>0;node--)
+   {
+    compute_tree_node_bounding_box(node-1);
+   }
+
+  setup_neighbours();
+  if (Min_and_max_coordinates_from_tree)
+   {
+    setup_min_and_max_coordinates_from_tree();
+   }
+ }
+
+
+//==============================================================================
+/// Try to locate zeta in the e-th element in the tree (unless it has
+/// already been tried during the current search); returns true if 
+/// successful.
+//==============================================================================
+ bool BoundingBoxTree::try_element(const unsigned& e, 
+                                   const Vector<double>& zeta, 
+                                   GeomObject*& sub_geom_object_pt,
+                                   Vector<double>& s,
+                                   const bool& use_coordinate_as_initial_guess,
+                                   SearchState& state) const
+ {
+  if (state.Element_search_stamp[e]==state.Search_stamp)
+   {
+    return false;
+   }
+  state.Element_search_stamp[e]=state.Search_stamp;
+
+  Element_pt[e]->locate_zeta(zeta,sub_geom_object_pt,s,
+                             use_coordinate_as_initial_guess);
+
+  // Always fail? (Used for debugging)
+  if (SamplePointContainer::Always_fail_elemental_locate_zeta)
+   {
+    sub_geom_object_pt=0;
+   }
+
+  if (sub_geom_object_pt!=0)
+   {
+    state.Last_located_element=e;
+    return true;
+   }
+  return false;
+ }
+
+
+//==============================================================================
+/// Search for zeta, starting in the e-th element in the tree and its
+/// neighbours before traversing the tree. e=UINT_MAX means start at
+/// the root of the tree. Returns the number of elements that were tried.
+//==============================================================================
+ unsigned BoundingBoxTree::locate_zeta_from_element(
+  const unsigned& e,
+  const Vector<double>& zeta, 
+  GeomObject*& sub_geom_object_pt,
+  Vector<double>& s,
+  const bool& use_coordinate_as_initial_guess,
+  SearchState& state) const
+ {
+  // Initialise return to null -- if it's still null when we're
+  // leaving we've failed!
+  sub_geom_object_pt=0;
+  if (Tree_nelement.size()==0)
+   {
+    return 0;
+   }
+
+  // Start a new search
+  unsigned n=Element_pt.size();
+  if (state.Element_search_stamp.size()!=n)
+   {
+    state.Element_search_stamp.assign(n,0);
+    state.Search_stamp=0;
+   }
+  state.Search_stamp++;
+  if (state.Search_stamp==0)
+   {
+    state.Element_search_stamp.assign(n,0);
+    state.Search_stamp=1;
+   }
+  unsigned n_tried=0;
+
+  // Warm start: Try the specified element and its neighbours first
+  if (e!=UINT_MAX)
+   {
+    if (element_bounding_box_contains(e,zeta))
+     {
+      n_tried++;
+      if (try_element(e,zeta,sub_geom_object_pt,s,
+                      use_coordinate_as_initial_guess,state))
+       {
+        return n_tried;
+       }
+     }
+    unsigned k_end=Neighbour_start[e+1];
+    for (unsigned k=Neighbour_start[e];k<k_end;k++)
+     {
+      unsigned e2=Neighbour[k];
+      if (element_bounding_box_contains(e2,zeta))
+       {
+        n_tried++;
+        if (try_element(e2,zeta,sub_geom_object_pt,s,false,state))
+         {
+          return n_tried;
+         }
+       }
+     }
+   }
+
+  // Traverse the tree, only descending into nodes that contain zeta
+  Vector<unsigned> stack;
+  stack.push_back(0);
+  while (!stack.empty())
+   {
+    unsigned node=stack.back();
+    stack.pop_back();
+    unsigned offset=node*Ndim_zeta;
+    bool is_inside=true;
+    for (unsigned i=0;i<Ndim_zeta;i++)
+     {
+      if ((zeta[i]<Tree_box_min[offset+i])||(zeta[i]>Tree_box_max[offset+i]))
+       {
+        is_inside=false;
+        break;
+       }
+     }
+    if (!is_inside)
+     {
+      continue;
+     }
+    unsigned n_el=Tree_nelement[node];
+    if (n_el>0)
+     {
+      unsigned first=Tree_first[node];
+      for (unsigned k=first;k<first+n_el;k++)
+       {
+        unsigned e2=Tree_element[k];
+        if (element_bounding_box_contains(e2,zeta))
+         {
+          n_tried++;
+          if (try_element(e2,zeta,sub_geom_object_pt,s,false,state))
+           {
+            return n_tried;
+           }
+         }
+       }
+     }
+    else
+     {
+      stack.push_back(Tree_child[2*node+1]);
+      stack.push_back(Tree_child[2*node]);
+     }
+   }
+  return n_tried;
+ }
+
+
+//==============================================================================
+/// Search for zeta using the specified search state, starting from 
+/// guess_el_pt (if it's in the tree) or from the element in which the
+/// previous point was located
+//==============================================================================
+ void BoundingBoxTree::locate_zeta_from_guess(
+  const Vector<double>& zeta, 
+  FiniteElement* const& guess_el_pt,
+  GeomObject*& sub_geom_object_pt,
+  Vector<double>& s,
+  SearchState& state) const
+ {
+  // Is the guess in the tree? (Don't dereference it before we know!)
+  unsigned e=state.Last_located_element;
+  bool use_coordinate_as_initial_guess=false;
+  if (guess_el_pt!=0)
+   {
+    std::map<FiniteElement*,unsigned>::const_iterator it=
+     Element_number.find(guess_el_pt);
+    if (it!=Element_number.end())
+     {
+      e=it->second;
+      use_coordinate_as_initial_guess=(s.size()==guess_el_pt->dim());
+     }
+   }
+  if ((!use_coordinate_as_initial_guess)&&(s.size()!=Ndim_zeta))
+   {
+    s.resize(Ndim_zeta);
+   }
+  locate_zeta_from_element(e,zeta,sub_geom_object_pt,s,
+                           use_coordinate_as_initial_guess,state);
+ }
+
+
+//==============================================================================
+/// \short Find the sub geometric object and local coordinate therein that
+/// corresponds to the intrinsic coordinate zeta. If sub_geom_object_pt=0
+/// on return from this function, none of the constituent sub-objects 
+/// contain the required coordinate.
+//==============================================================================
+ void BoundingBoxTree::locate_zeta(const Vector<double>& zeta, 
+                                   GeomObject*& sub_geom_object_pt,
+                                   Vector<double>& s)
+ {
+  bool use_coordinate_as_initial_guess=false;
+  Total_number_of_sample_points_visited_during_locate_zeta_from_top_level=
+   locate_zeta_from_element(Search_state.Last_located_element,zeta,
+                            sub_geom_object_pt,s,
+                            use_coordinate_as_initial_guess,Search_state);
+ }
+
+
+//==============================================================================
+/// \short Find the sub geometric object and local coordinate therein that
+/// corresponds to the intrinsic coordinate zeta, starting the search in
+/// the element guess_el_pt (with s as the initial guess for the local 
+/// coordinate) and its neighbours. 
+//==============================================================================
+ void BoundingBoxTree::locate_zeta(const Vector<double>& zeta, 
+                                   FiniteElement* const& guess_el_pt,
+                                   GeomObject*& sub_geom_object_pt,
+                                   Vector<double>& s)
+ {
+  locate_zeta_from_guess(zeta,guess_el_pt,sub_geom_object_pt,s,Search_state);
+ }
+
+
+//==============================================================================
+/// Locate the points zeta[order[k].second] for k=first,...,last-1, 
+/// using the specified search state
+//==============================================================================
+ void BoundingBoxTree::locate_zeta_batch_chunk(
+  const unsigned& first, const unsigned& last,
+  const Vector<std::pair<unsigned long long,unsigned> >& order,
+  const Vector<Vector<double> >& zeta, 
+  const Vector<FiniteElement*>& guess_el_pt,
+  Vector<GeomObject*>& sub_geom_object_pt,
+  Vector<Vector<double> >& s,
+  SearchState& state) const
+ {
+  bool have_guess=(guess_el_pt.size()!=0);
+  FiniteElement* no_guess_pt=0;
+  for (unsigned k=first;k<last;k++)
+   {
+    unsigned p=order[k].second;
+    if (have_guess)
+     {
+      locate_zeta_from_guess(zeta[p],guess_el_pt[p],sub_geom_object_pt[p],
+                             s[p],state);
+     }
+    else
+     {
+      locate_zeta_from_guess(zeta[p],no_guess_pt,sub_geom_object_pt[p],
+                             s[p],state);
+     }
+   }
+ }
+
+
+#ifdef OOMPH_HAS_PTHREADS
+
+//==============================================================================
+/// Work for one of the threads in locate_zeta_batch(...); the argument
+/// is a pointer to a BoundingBoxTreeHelpers::BatchChunk
+//==============================================================================
+ void BoundingBoxTree::locate_zeta_batch_chunk_work(void* chunk_pt)
+ {
+  BoundingBoxTreeHelpers::BatchChunk* c_pt=
+   static_cast<BoundingBoxTreeHelpers::BatchChunk*>(chunk_pt);
+  c_pt->Tree_pt->locate_zeta_batch_chunk(
+   c_pt->First,c_pt->Last,*(c_pt->Order_pt),*(c_pt->Zeta_pt),
+   *(c_pt->Guess_el_pt),*(c_pt->Sub_geom_object_pt),*(c_pt->S_pt),
+   *static_cast<SearchState*>(c_pt->State_pt));
+ }
+
+#endif
+
+
+//==============================================================================
+/// \short Batched locate_zeta(...) for the points zeta[i], visited in the
+/// order of their position along a space-filling curve so that each 
+/// search starts from the element that contained the previous point.
+/// With pthreads, contiguous chunks of the ordered points are located
+/// concurrently, each with its own search state.
+//==============================================================================
+ void BoundingBoxTree::locate_zeta_batch(
+  const Vector<Vector<double> >& zeta, 
+  const Vector<FiniteElement*>& guess_el_pt,
+  Vector<GeomObject*>& sub_geom_object_pt,
+  Vector<Vector<double> >& s)
+ {
+  unsigned n_point=zeta.size();
+
+#ifdef PARANOID
+  if ((guess_el_pt.size()!=0)&&(guess_el_pt.size()!=n_point))
+   {
+    std::ostringstream error_stream;
+    error_stream << "Number of guesses [ " << guess_el_pt.size() 
+                 << " ] doesn't match the number of points [ " 
+                 << n_point << " ]\n";
+    throw OomphLibError(error_stream.str(),
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+   }
+#endif
+
+  sub_geom_object_pt.resize(n_point);
+  s.resize(n_point);
+
+  // Order the points along the Morton curve through the (scaled) 
+  // bounding box of the tree (Morton keys can only deal with up to
+  // three coordinates but that's more than good enough for sorting)
+  unsigned n_key_dim=std::min(Ndim_zeta,unsigned(3));
+  Vector<std::pair<unsigned long long,unsigned> > order(n_point);
+  Vector<double> scaled_zeta(n_key_dim);
+  for (unsigned p=0;p<n_point;p++)
+   {
+    unsigned long long key=0;
+    if ((n_key_dim>0)&&(Tree_nelement.size()>0))
+     {
+      for (unsigned i=0;i<n_key_dim;i++)
+       {
+        double extent=Tree_box_max[i]-Tree_box_min[i];
+        double scaled=0.0;
+        if (extent>0.0)
+         {
+          scaled=(zeta[p][i]-Tree_box_min[i])/extent;
+         }
+        scaled_zeta[i]=std::max(0.0,std::min(1.0,scaled));
+       }
+      key=LocalityReorderingHelpers::morton_key(scaled_zeta);
+     }
+    order[p]=std::make_pair(key,p);
+   }
+  std::sort(order.begin(),order.end());
+
+#ifdef OOMPH_HAS_PTHREADS
+
+  // How many threads are worth it?
+  unsigned n_thread=Nthread;
+  if (Min_npoint_per_thread>0)
+   {
+    n_thread=std::min(n_thread,n_point/Min_npoint_per_thread);
+   }
+  if (n_thread>1)
+   {
+    // Split the ordered points into contiguous chunks; the first one 
+    // is done by this thread
+    Vector<SearchState> state(n_thread);
+    Vector<BoundingBoxTreeHelpers::BatchChunk> chunk(n_thread);
+    for (unsigned t=0;t<n_thread;t++)
+     {
+      chunk[t].Tree_pt=this;
+      chunk[t].First=(t*n_point)/n_thread;
+      chunk[t].Last=((t+1)*n_point)/n_thread;
+      chunk[t].Order_pt=&order;
+      chunk[t].Zeta_pt=&zeta;
+      chunk[t].Guess_el_pt=&guess_el_pt;
+      chunk[t].Sub_geom_object_pt=&sub_geom_object_pt;
+      chunk[t].S_pt=&s;
+      chunk[t].State_pt=&state[t];
+     }
+    std::string error_message=ThreadingHelpers::do_work_in_threads(
+     &BoundingBoxTree::locate_zeta_batch_chunk_work,chunk);
+    if (!error_message.empty())
+     {
+      throw OomphLibError(error_message,
+                          OOMPH_CURRENT_FUNCTION,
+                          OOMPH_EXCEPTION_LOCATION);
+     }
+    return;
+   }
+
+#endif
+
+  // Serial: Use (and update) our own search state
+  locate_zeta_batch_chunk(0,n_point,order,zeta,guess_el_pt,
+                          sub_geom_object_pt,s,Search_state);
+ }
+
+
+ /// \short Min. number of points per thread in 
+ /// BoundingBoxTree::locate_zeta_batch(...)
+ unsigned BoundingBoxTree::Min_npoint_per_thread=256;
+
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -269,6 +269,20 @@ class SamplePointContainer
  virtual void locate_zeta(const Vector<double>& zeta, 
                           GeomObject*& sub_geom_object_pt,
                           Vector<double>& s)=0;
+
+ /// \short Batched version of locate_zeta(...): Find the sub-GeomObjects
+ /// (finite elements) and the local coordinates s[i] within them that 
+ /// contain the points with global coordinates zeta[i]; 
+ /// sub_geom_object_pt[i]=0 if the i-th point can't be found. 
+ /// guess_el_pt is either empty or contains an (optional, possibly null)
+ /// initial guess for the element containing each point, in which case
+ /// s[i] is used as the initial guess for its local coordinate. 
+ /// The default implementation ignores the guesses and locates the 
+ /// points one after the other.
+ virtual void locate_zeta_batch(const Vector<Vector<double> >& zeta, 
+                                const Vector<FiniteElement*>& guess_el_pt,
+                                Vector<GeomObject*>& sub_geom_object_pt,
+                                Vector<Vector<double> >& s);
  
 
   /// \short Counter to keep track of how many sample points we've 
@@ -1062,6 +1076,316 @@ class BinArray : public virtual SamplePointContainer
  };
 
 
+////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////
+
+
+//====================================================================
+/// \short SamplePointContainer that stores the (slightly inflated) 
+/// bounding boxes of the mesh's elements in a bounding volume hierarchy,
+/// i.e. a binary tree whose nodes are split at the median of the 
+/// centroids of their elements' bounding boxes, in the direction in
+/// which the centroids are spread out most. The elemental locate_zeta(...)
+/// is only called for elements whose bounding box contains the point, 
+/// so the search is exhaustive and doesn't require any "spiraling".
+/// Each search starts with the element in which the previous point was 
+/// found (and its neighbours, i.e. the elements whose bounding boxes 
+/// overlap with its own) so that sequences of nearby points (e.g. the
+/// integration points of an element, or points that have moved only
+/// slightly since they were last located) are usually found without
+/// traversing the tree. Note that the boxes are computed from the
+/// elements' sample points (inflated by 
+/// BoundingBoxTreeParameters::relative_bounding_box_inflation()) so
+/// they are only guaranteed to enclose elements whose boundaries don't 
+/// bulge out further than that between the sample points. This is why
+/// the container is not the default and has to be selected explicitly.
+//====================================================================
+class BoundingBoxTree : public virtual SamplePointContainer
+{
+
+  public:
+ 
+ /// Constructor
+ BoundingBoxTree(SamplePointContainerParameters* 
+                 sample_point_container_parameters_pt);
+
+ /// \short Broken copy constructor.
+ BoundingBoxTree(const BoundingBoxTree& data) 
+  {
+   BrokenCopy::broken_copy("BoundingBoxTree");
+  }
+ 
+ /// Broken assignment operator.
+ void operator=(const BoundingBoxTree&) 
+  {
+   BrokenCopy::broken_assign("BoundingBoxTree");
+  }
+
+ /// Empty destructor
+ virtual ~BoundingBoxTree() {}
+ 
+ /// \short Find sub-GeomObject (finite element) and the local coordinate 
+ /// s within it that contains point with global coordinate zeta. 
+ /// sub_geom_object_pt=0 if point can't be found.
+ void locate_zeta(const Vector<double>& zeta, 
+                  GeomObject*& sub_geom_object_pt,
+                  Vector<double>& s);
+
+ /// \short Find sub-GeomObject (finite element) and the local coordinate 
+ /// s within it that contains point with global coordinate zeta,
+ /// starting the search in the element guess_el_pt (with s as the
+ /// initial guess for the local coordinate) and its neighbours. 
+ /// This is typically the element in which the point was located
+ /// previously. guess_el_pt is ignored (and not dereferenced, so it
+ /// may point to an element that has since been deleted) if it's 
+ /// not in the tree. sub_geom_object_pt=0 if point can't be found.
+ void locate_zeta(const Vector<double>& zeta, 
+                  FiniteElement* const& guess_el_pt,
+                  GeomObject*& sub_geom_object_pt,
+                  Vector<double>& s);
+
+ /// \short Batched locate_zeta(...) for the points zeta[i]: The points
+ /// are visited in the order of their position along a space-filling 
+ /// curve so that each search starts from the element that contained
+ /// the previous point. guess_el_pt is either empty or contains
+ /// an (optional, possibly null) initial guess for the element 
+ /// containing each point, in which case s[i] is used as the initial
+ /// guess for its local coordinate. sub_geom_object_pt[i]=0 if 
+ /// the i-th point can't be found. If compiled with pthreads, the 
+ /// ordered points are split into nthread() contiguous chunks that
+ /// are located concurrently. The threads only read the tree, but they
+ /// call the elements' locate_zeta(...) concurrently (possibly for the
+ /// same element). FiniteElement::locate_zeta(...) is re-entrant: It
+ /// (and the interpolated_zeta(...) it calls) only reads the nodal 
+ /// positions (or the macro element) and works on local storage. 
+ /// Elements that overload locate_zeta(...), shape(...) or 
+ /// zeta_nodal(...), and the GeomObjects behind macro elements, must
+ /// be thread-safe too if nthread()>1.
+ void locate_zeta_batch(const Vector<Vector<double> >& zeta, 
+                        const Vector<FiniteElement*>& guess_el_pt,
+                        Vector<GeomObject*>& sub_geom_object_pt,
+                        Vector<Vector<double> >& s);
+
+ /// \short Number of threads used in locate_zeta_batch(...) (only 
+ /// if compiled with pthreads; see there for the requirements on the
+ /// elements)
+ unsigned& nthread()
+ {
+  return Nthread;
+ }
+
+ /// \short Recompute the bounding boxes (e.g. after the nodes have moved)
+ /// without rebuilding the structure of the tree. The tree remains
+ /// valid but becomes less efficient if the mesh deforms a lot.
+ void update_bounding_boxes();
+
+ /// \short Forget the element in which the previous point was located
+ /// (the next search starts from the root of the tree)
+ void reset_warm_start()
+ {
+  Search_state.Last_located_element=UINT_MAX;
+ }
+
+ /// \short Min. number of points per thread in locate_zeta_batch(...);
+ /// smaller batches are located by fewer threads.
+ static unsigned Min_npoint_per_thread;
+
+ /// Dimension of the zeta ( =  dim of local coordinate of elements)
+ unsigned ndim_zeta() const
+  {
+   return Ndim_zeta;
+  }
+
+ /// \short Total number of "sample points", i.e. the number of elements
+ /// (represented by their bounding boxes) in the tree
+ unsigned total_number_of_sample_points_computed_recursively() const
+ {
+  return Element_pt.size();
+ }
+
+ /// Number of nodes in the tree
+ unsigned ntree_node() const
+ {
+  return Tree_nelement.size();
+ }
+
+  private:
+
+ /// \short Book-keeping for a search: The element in which the previous 
+ /// point was located, and the (number of the) search during which each
+ /// element was last tried. Each thread in locate_zeta_batch(...) 
+ /// has its own.
+ class SearchState
+ {
+   public:
+
+  /// Constructor
+  SearchState() : Last_located_element(UINT_MAX), Search_stamp(0) {}
+
+  /// \short Element (number in the tree) in which the previous point
+  /// was located; UINT_MAX if none.
+  unsigned Last_located_element;
+
+  /// Number of the current search
+  unsigned Search_stamp;
+
+  /// \short Number of the search during which each element was last 
+  /// tried (so we don't try it twice in the same search)
+  Vector<unsigned> Element_search_stamp;
+ };
+
+ /// \short Compute the (inflated) bounding box of the e-th element 
+ /// in the tree
+ void compute_element_bounding_box(const unsigned& e);
+
+ /// \short Build the (sub-)tree for the elements 
+ /// Tree_element[first],...,Tree_element[last-1]; returns the number
+ /// of its root node
+ unsigned build_tree(const unsigned& first, const unsigned& last);
+
+ /// \short Compute the bounding box of the specified tree node from
+ /// those of its children (or its elements if it's a leaf)
+ void compute_tree_node_bounding_box(const unsigned& node);
+
+ /// \short Setup the lookup scheme for the neighbours of each element,
+ /// i.e. the elements whose bounding boxes overlap with its own
+ void setup_neighbours();
+
+ /// \short Set the min/max coordinates of the container to those of the
+ /// bounding box of the root of the tree
+ void setup_min_and_max_coordinates_from_tree();
+
+ /// \short Does the bounding box of the e-th element in the tree
+ /// contain zeta?
+ bool element_bounding_box_contains(const unsigned& e,
+                                    const Vector<double>& zeta) const
+ {
+  for (unsigned i=0;i<Ndim_zeta;i++)
+   {
+    if ((zeta[i]<Element_box_min[e*Ndim_zeta+i])||
+        (zeta[i]>Element_box_max[e*Ndim_zeta+i]))
+     {
+      return false;
+     }
+   }
+  return true;
+ }
+
+ /// \short Try to locate zeta in the e-th element in the tree (unless it
+ /// has already been tried during the current search); returns true
+ /// if successful.
+ bool try_element(const unsigned& e, 
+                  const Vector<double>& zeta, 
+                  GeomObject*& sub_geom_object_pt,
+                  Vector<double>& s,
+                  const bool& use_coordinate_as_initial_guess,
+                  SearchState& state) const;
+
+ /// \short Search for zeta, starting in the e-th element in the tree 
+ /// and its neighbours before traversing the tree. e=UINT_MAX
+ /// means start at the root of the tree. Returns the number of
+ /// elements that were tried.
+ unsigned locate_zeta_from_element(
+  const unsigned& e,
+  const Vector<double>& zeta, 
+  GeomObject*& sub_geom_object_pt,
+  Vector<double>& s,
+  const bool& use_coordinate_as_initial_guess,
+  SearchState& state) const;
+
+ /// \short Locate the points zeta[order[k].second] for 
+ /// k=first,...,last-1 (see locate_zeta_batch(...)), using the 
+ /// specified search state
+ void locate_zeta_batch_chunk(
+  const unsigned& first, const unsigned& last,
+  const Vector<std::pair<unsigned long long,unsigned> >& order,
+  const Vector<Vector<double> >& zeta, 
+  const Vector<FiniteElement*>& guess_el_pt,
+  Vector<GeomObject*>& sub_geom_object_pt,
+  Vector<Vector<double> >& s,
+  SearchState& state) const;
+
+ /// \short Search for zeta using the specified search state, starting 
+ /// from guess_el_pt (if it's in the tree) or from the element in which
+ /// the previous point was located
+ void locate_zeta_from_guess(const Vector<double>& zeta, 
+                             FiniteElement* const& guess_el_pt,
+                             GeomObject*& sub_geom_object_pt,
+                             Vector<double>& s,
+                             SearchState& state) const;
+
+#ifdef OOMPH_HAS_PTHREADS
+
+ /// \short Work for one of the threads in locate_zeta_batch(...); 
+ /// the argument is a pointer to a BoundingBoxTreeHelpers::BatchChunk
+ static void locate_zeta_batch_chunk_work(void* chunk_pt);
+
+#endif
+ 
+ /// Dimension of the zeta ( =  dim of local coordinate of elements)
+ unsigned Ndim_zeta;
+
+ /// Max. number of elements in a leaf of the tree
+ unsigned Max_nelement_per_leaf;
+
+ /// Relative inflation of elemental bounding boxes
+ double Relative_bounding_box_inflation;
+
+ /// Elements in the tree (non-halo ones only, if halos are ignored)
+ Vector<FiniteElement*> Element_pt;
+
+ /// Lookup scheme for the number of an element in the tree
+ std::map<FiniteElement*,unsigned> Element_number;
+
+ /// \short Min. coordinates of the elements' bounding boxes, flat-packed:
+ /// Element_box_min[e*Ndim_zeta+i]
+ Vector<double> Element_box_min;
+
+ /// \short Max. coordinates of the elements' bounding boxes, flat-packed:
+ /// Element_box_max[e*Ndim_zeta+i]
+ Vector<double> Element_box_max;
+
+ /// \short Numbers of the elements in the order in which they're stored
+ /// in the tree; each leaf contains a contiguous range.
+ Vector<unsigned> Tree_element;
+
+ /// Min. coordinates of the tree nodes' bounding boxes, flat-packed
+ Vector<double> Tree_box_min;
+
+ /// Max. coordinates of the tree nodes' bounding boxes, flat-packed
+ Vector<double> Tree_box_max;
+
+ /// \short Index (in Tree_element) of the first element in each tree node
+ Vector<unsigned> Tree_first;
+
+ /// \short Number of elements in each tree node; zero for non-leaves.
+ Vector<unsigned> Tree_nelement;
+
+ /// \short Left and right children of each tree node (flat-packed);
+ /// children are always numbered after their parents.
+ Vector<unsigned> Tree_child;
+
+ /// \short Neighbours of the e-th element in the tree are 
+ /// Neighbour[Neighbour_start[e]],...,Neighbour[Neighbour_start[e+1]-1]
+ Vector<unsigned> Neighbour_start;
+
+ /// Flat-packed neighbours of the elements in the tree
+ Vector<unsigned> Neighbour;
+
+ /// Book-keeping for searches that don't use threads
+ SearchState Search_state;
+
+ /// Number of threads used in locate_zeta_batch(...)
+ unsigned Nthread;
+
+ /// \short Were the min/max coordinates of the container obtained from
+ /// the tree (rather than specified by the user)?
+ bool Min_and_max_coordinates_from_tree;
+
+};
+
+
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////
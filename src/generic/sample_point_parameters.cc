@@ -43,5 +43,14 @@ namespace oomph
  /// \short Default value for number of spirals that are being
  /// visited before doing another circular mpi communication
  unsigned NonRefineableBinArrayParameters::Default_nspiral_chunk=10; // hierher explore 1;
+
+ /// Default value for max. number of elements in a leaf of the tree
+ unsigned BoundingBoxTreeParameters::Default_max_nelement_per_leaf=4;
+
+ /// Default value for relative inflation of elemental bounding boxes
+ double BoundingBoxTreeParameters::Default_relative_bounding_box_inflation=0.05;
+
+ /// Default value for number of threads used in batched locate_zeta
+ unsigned BoundingBoxTreeParameters::Default_nthread=1;
  
 }
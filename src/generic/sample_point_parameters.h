@@ -44,6 +44,7 @@ namespace oomph
 #ifdef OOMPH_HAS_CGAL
   , UseCGALSamplePointContainer=3
 #endif
+  , UseBoundingBoxTree=4
  };
 
 
@@ -81,6 +82,7 @@ namespace oomph
   friend class BinArrayParameters;
   friend class RefineableBinArrayParameters;
   friend class NonRefineableBinArrayParameters;
+  friend class BoundingBoxTreeParameters;
 #ifdef OOMPH_HAS_CGAL
   friend class CGALSamplePointContainerParameters;
 #endif
@@ -557,6 +559,112 @@ namespace oomph
 
  };
 
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+
+//=========================================================================
+/// \short Helper object for dealing with the parameters used for the
+/// BoundingBoxTree objects
+//=========================================================================
+ class BoundingBoxTreeParameters : 
+  public virtual SamplePointContainerParameters
+ {
+
+ public:
+
+  /// Constructor: Pass mesh
+   BoundingBoxTreeParameters(Mesh* mesh_pt) : 
+  SamplePointContainerParameters(mesh_pt),
+   Max_nelement_per_leaf(Default_max_nelement_per_leaf),
+   Relative_bounding_box_inflation(Default_relative_bounding_box_inflation),
+   Nthread(Default_nthread)
+    {}
+
+  /// \short Broken copy constructor.
+  BoundingBoxTreeParameters(const BoundingBoxTreeParameters& data)
+   {
+    BrokenCopy::broken_copy("BoundingBoxTreeParameters");
+   }
+  
+  /// Broken assignment operator.
+ void operator=(const BoundingBoxTreeParameters&) 
+  {
+   BrokenCopy::broken_assign("BoundingBoxTreeParameters");
+  }
+
+  /// Empty destructor
+  virtual ~BoundingBoxTreeParameters()
+   {}
+
+  /// \short Max. number of elements in a leaf of the tree; const version
+  unsigned max_nelement_per_leaf() const
+  {
+   return Max_nelement_per_leaf;
+  }
+
+  /// \short Max. number of elements in a leaf of the tree
+  unsigned& max_nelement_per_leaf()
+  {
+   return Max_nelement_per_leaf;
+  }
+
+  /// \short Amount (relative to the element's own extent) by which the 
+  /// bounding box of each element is inflated to allow for curved
+  /// boundaries between the sample points; const version
+  double relative_bounding_box_inflation() const
+  {
+   return Relative_bounding_box_inflation;
+  }
+
+  /// \short Amount (relative to the element's own extent) by which the 
+  /// bounding box of each element is inflated to allow for curved
+  /// boundaries between the sample points
+  double& relative_bounding_box_inflation()
+  {
+   return Relative_bounding_box_inflation;
+  }
+
+  /// \short Number of threads used in batched locate_zeta (only if
+  /// compiled with pthreads); const version
+  unsigned nthread() const
+  {
+   return Nthread;
+  }
+
+  /// \short Number of threads used in batched locate_zeta (only if
+  /// compiled with pthreads). The elements' locate_zeta(...) must
+  /// be thread-safe if this is increased (see 
+  /// BoundingBoxTree::locate_zeta_batch(...)).
+  unsigned& nthread()
+  {
+   return Nthread;
+  }
+
+  /// Default value for max. number of elements in a leaf of the tree
+  static unsigned Default_max_nelement_per_leaf;
+
+  /// Default value for relative inflation of elemental bounding boxes
+  static double Default_relative_bounding_box_inflation;
+
+  /// Default value for number of threads used in batched locate_zeta
+  static unsigned Default_nthread;
+
+   private:
+
+  /// Max. number of elements in a leaf of the tree
+  unsigned Max_nelement_per_leaf;
+
+  /// Relative inflation of elemental bounding boxes
+  double Relative_bounding_box_inflation;
+
+  /// Number of threads used in batched locate_zeta
+  unsigned Nthread;
+
+ };
+
 }
 
 #endif
@@ -293,4 +293,69 @@ void SpineMesh::read(std::ifstream &restart_file)
   }
 }
 
+//========================================================================
+/// Overload the binary dump function so that the spine heights are 
+/// also dumped
+//========================================================================
+void SpineMesh::dump_binary(Vector<unsigned>& size, Vector<double>& values,
+                            const bool& use_old_ordering) const
+{
+ //Call the standard mesh dump function
+ Mesh::dump_binary(size,values,use_old_ordering);
+
+ //Now dump the spine height data (the geometric data is assumed to 
+ //be dumped elsewhere, as in dump(...))
+ unsigned long n_spine = nspine();
+ size.push_back(n_spine);
+ for(unsigned long s=0;s<n_spine;s++)
+  {
+   spine_pt(s)->spine_height_pt()->dump_binary(size,values);
+  }
+}
+
+//========================================================================
+/// Overload the binary read function so that the spine heights are 
+/// also read
+//========================================================================
+bool SpineMesh::read_binary(const Vector<unsigned>& size, 
+                            unsigned long& size_index,
+                            const Vector<double>& values, 
+                            unsigned long& value_index)
+{
+ //Call the standard mesh read function
+ bool mismatch=Mesh::read_binary(size,size_index,values,value_index);
+
+ //check the number of spines
+ unsigned long n_spine = nspine();
+ unsigned long check_n_spine=0;
+ if (size_index<size.size())
+  {
+   check_n_spine=size[size_index++];
+  }
+ if(check_n_spine != n_spine)
+  {
+   std::ostringstream error_stream;
+    error_stream 
+     << "Number of spines in the restart file, " << check_n_spine 
+     << std::endl << "does not equal the number of spines in the mesh " 
+     << n_spine << std::endl;
+
+    throw OomphLibError(error_stream.str(),
+                        OOMPH_CURRENT_FUNCTION,
+                        OOMPH_EXCEPTION_LOCATION);
+  }
+
+ //Loop over the spines and read the data
+ for(unsigned long s=0;s<n_spine;s++)
+  {
+   if (spine_pt(s)->spine_height_pt()->read_binary(size,size_index,
+                                                   values,value_index))
+    {
+     mismatch=true;
+    }
+  }
+
+ return mismatch;
+}
+
 }
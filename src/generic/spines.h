@@ -704,6 +704,18 @@ public:
  /// from the restart file
  void read(std::ifstream &restart_file);
 
+ /// \short Overload the binary dump function so that the spine data 
+ /// is dumped
+ void dump_binary(Vector<unsigned>& size, Vector<double>& values,
+                  const bool& use_old_ordering=true) const;
+
+ /// \short Overload the binary read function so that the spine data 
+ /// is read
+ bool read_binary(const Vector<unsigned>& size, 
+                  unsigned long& size_index,
+                  const Vector<double>& values, 
+                  unsigned long& value_index);
+
 };
 
 
@@ -931,6 +931,13 @@ public:
  unsigned ncont_interpolated_values() const 
   {return DIM+1;}
 
+ /// \short Overload the advection-diffusion element's version (which only
+ /// covers the temperature): the solution is transferred to the sons
+ /// by get_interpolated_values(...) during refinement
+ bool get_isoparametric_value_indices(
+  Vector<unsigned>& /*value_index*/) const
+  {return false;}
+
 
  /// \short Get the continuously interpolated values at the local coordinate s.
  /// We choose to put the fluid velocities first, followed by the
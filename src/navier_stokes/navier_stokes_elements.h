@@ -998,6 +998,45 @@ namespace oomph
     }
 
 
+    /// \short Append the velocities and the pressure at the plot points
+    /// to values (ordered by plot point). Overloads the generic version
+    /// to evaluate the velocity shape functions only once per plot point.
+    /// Derived elements that output a different number of scalars
+    /// use the generic version.
+    void get_scalar_values_paraview(const unsigned& nplot,
+                                    Vector<double>& values) const
+    {
+      if (this->nscalar_paraview()!=DIM+1)
+      {
+        FiniteElement::get_scalar_values_paraview(nplot,values);
+        return;
+      }
+
+      // Vector of local coordinates and velocity
+      Vector<double> s(DIM);
+      Vector<double> veloc(DIM);
+
+      // Loop over plot points
+      unsigned num_plot_points=nplot_points_paraview(nplot);
+      values.reserve(values.size()+(DIM+1)*num_plot_points);
+      for (unsigned iplot=0; iplot<num_plot_points; iplot++)
+      {
+        // Get local coordinates of plot point
+        get_s_plot(iplot,nplot,s);
+
+        // Velocities
+        interpolated_u_nst(s,veloc);
+        for (unsigned i=0; i<DIM; i++)
+        {
+          values.push_back(veloc[i]);
+        }
+
+        // Pressure
+        values.push_back(interpolated_p_nst(s));
+      }
+    }
+
+
     /// \short Write values of the i-th scalar field at the plot points. Needs
     /// to be implemented for each new specific element type.
     void scalar_value_fct_paraview(std::ofstream& file_out,
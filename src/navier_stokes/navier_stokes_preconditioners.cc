@@ -1707,6 +1707,10 @@ namespace oomph
       delete P_preconditioner_pt;
       P_preconditioner_pt = 0;
      }
+
+    // Note: The AMG preconditioners (if used) are retained so that their
+    // hierarchies can be reused when the preconditioner is set up again;
+    // they are deleted in the destructor.
    }
  }
 
@@ -40,6 +40,7 @@
 #include "../generic/block_preconditioner.h"
 #include "../generic/preconditioner.h"
 #include "../generic/SuperLU_preconditioner.h"
+#include "../generic/algebraic_multigrid.h"
 #include "../generic/matrix_vector_product.h"
 #include "navier_stokes_elements.h"
 #include "refineable_navier_stokes_elements.h"
@@ -674,6 +675,21 @@ namespace oomph
 /// \code
 /// NavierStokesSchurComplementPreconditioner::set_p_preconditioner(...)
 /// \endcode
+/// SuperLU's setup cost and memory requirements grow superlinearly
+/// with the problem size. For large problems the library's own 
+/// aggregation-based algebraic multigrid preconditioner 
+/// (AggregationAMGPreconditioner) can be selected for either block via
+/// \code
+/// NavierStokesSchurComplementPreconditioner::set_p_amg_preconditioner()
+/// \endcode
+/// and
+/// \code
+/// NavierStokesSchurComplementPreconditioner::set_f_amg_preconditioner()
+/// \endcode
+/// The AMG preconditioners are retained when the preconditioner is 
+/// set up again (e.g. in the next Newton step) and their multigrid
+/// hierarchies are reused as long as the sparsity patterns of the 
+/// blocks do not change.
 //===========================================================================
  class NavierStokesSchurComplementPreconditioner :
  public BlockPreconditioner<CRDoubleMatrix>
@@ -705,6 +721,10 @@ namespace oomph
      Using_default_p_preconditioner=true;
      Using_default_f_preconditioner=true;
 
+     // ...and not the AMG preconditioners
+     Using_amg_p_preconditioner=false;
+     Using_amg_f_preconditioner=false;
+
      // Pin pressure dof in press adv diff problem for Fp precond
      Pin_first_pressure_dof_in_press_adv_diff=true;
 
@@ -739,6 +759,19 @@ namespace oomph
    virtual ~NavierStokesSchurComplementPreconditioner()
     {
      clean_up_memory();
+
+     // The AMG preconditioners survive clean_up_memory() so their
+     // hierarchies can be reused; kill them now
+     if (Using_amg_p_preconditioner)
+      {
+       delete P_preconditioner_pt;
+       P_preconditioner_pt=0;
+      }
+     if (Using_amg_f_preconditioner)
+      {
+       delete F_preconditioner_pt;
+       F_preconditioner_pt=0;
+      }
     }
 
    /// Broken copy constructor
@@ -822,14 +855,15 @@ namespace oomph
    /// Function to set a new pressure matrix preconditioner (inexact solver)
    void set_p_preconditioner(Preconditioner* new_p_preconditioner_pt)
    {
-    // If the default preconditioner has been used
+    // If the default (or AMG) preconditioner has been used
     // clean it up now...
-    if (Using_default_p_preconditioner)
+    if (Using_default_p_preconditioner || Using_amg_p_preconditioner)
      {
       delete P_preconditioner_pt;
      }
     P_preconditioner_pt = new_p_preconditioner_pt;
     Using_default_p_preconditioner = false;
+    Using_amg_p_preconditioner = false;
    }
 
    /// \short Function to (re-)set pressure matrix preconditioner  (inexact 
@@ -838,22 +872,49 @@ namespace oomph
    {
     if (!Using_default_p_preconditioner)
      {
+      if (Using_amg_p_preconditioner)
+       {
+        delete P_preconditioner_pt;
+        Using_amg_p_preconditioner = false;
+       }
       P_preconditioner_pt = new SuperLUPreconditioner;
       Using_default_p_preconditioner = true;
      }
    }
 
+   /// \short Function to (re-)set pressure matrix preconditioner (inexact
+   /// solver) to the library's aggregation-based AMG (one V-cycle with 
+   /// smoothed aggregation and symmetric Gauss-Seidel smoothing). 
+   /// The hierarchy is reused in subsequent setups as long as the 
+   /// sparsity pattern of the pressure Poisson matrix does not change.
+   void set_p_amg_preconditioner()
+   {
+    if (!Using_amg_p_preconditioner)
+     {
+      if (Using_default_p_preconditioner)
+       {
+        delete P_preconditioner_pt;
+       }
+      AggregationAMGPreconditioner* amg_pt=new AggregationAMGPreconditioner;
+      amg_pt->enable_reuse_of_hierarchy();
+      P_preconditioner_pt = amg_pt;
+      Using_default_p_preconditioner = false;
+      Using_amg_p_preconditioner = true;
+     }
+   }
+
    /// Function to set a new momentum matrix preconditioner (inexact solver)
    void set_f_preconditioner(Preconditioner* new_f_preconditioner_pt)
    {
-    // If the default preconditioner has been used
+    // If the default (or AMG) preconditioner has been used
     // clean it up now...
-    if (Using_default_f_preconditioner)
+    if (Using_default_f_preconditioner || Using_amg_f_preconditioner)
      {
       delete F_preconditioner_pt;
      }
     F_preconditioner_pt = new_f_preconditioner_pt;
     Using_default_f_preconditioner = false;
+    Using_amg_f_preconditioner = false;
    }
 
    /// Use LSC version of the preconditioner
@@ -868,11 +929,40 @@ namespace oomph
    {
     if (!Using_default_f_preconditioner)
      {
+      if (Using_amg_f_preconditioner)
+       {
+        delete F_preconditioner_pt;
+        Using_amg_f_preconditioner = false;
+       }
       F_preconditioner_pt = new SuperLUPreconditioner;
       Using_default_f_preconditioner = true;
      }
    }
 
+   /// \short Function to (re-)set momentum matrix preconditioner (inexact
+   /// solver) to the library's aggregation-based AMG. Since the momentum
+   /// block is non-symmetric (advection) we use plain (unsmoothed)
+   /// aggregation with Gauss-Seidel smoothing. The hierarchy (aggregates
+   /// and transfer operators) is reused in subsequent setups as long as
+   /// the sparsity pattern of the momentum block does not change; only
+   /// the coarse operators are recomputed.
+   void set_f_amg_preconditioner()
+   {
+    if (!Using_amg_f_preconditioner)
+     {
+      if (Using_default_f_preconditioner)
+       {
+        delete F_preconditioner_pt;
+       }
+      AggregationAMGPreconditioner* amg_pt=new AggregationAMGPreconditioner;
+      amg_pt->disable_smoothed_prolongation();
+      amg_pt->enable_reuse_of_hierarchy();
+      F_preconditioner_pt = amg_pt;
+      Using_default_f_preconditioner = false;
+      Using_amg_f_preconditioner = true;
+     }
+   }
+
    ///Enable documentation of time
    void enable_doc_time() {Doc_time = true;}
 
@@ -1186,6 +1276,14 @@ namespace oomph
    /// flag indicating whether the default P preconditioner is used
    bool Using_default_p_preconditioner;
 
+   /// \short flag indicating whether the (internally allocated) AMG F 
+   /// preconditioner is used
+   bool Using_amg_f_preconditioner;
+
+   /// \short flag indicating whether the (internally allocated) AMG P 
+   /// preconditioner is used
+   bool Using_amg_p_preconditioner;
+
    /// \short Control flag is true if the preconditioner has been setup
    /// (used so we can wipe the data when the preconditioner is
    /// called again)
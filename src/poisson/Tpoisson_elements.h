@@ -70,6 +70,20 @@ class TPoissonElement : public virtual TElement<DIM,NNODE_1D>,
  TPoissonElement() : TElement<DIM,NNODE_1D>(), PoissonEquations<DIM>()
   { }
 
+ /// \short Evaluate the scalars for the binary paraview output directly
+ /// (unless a derived element outputs a different number of them)
+ bool interpolated_scalar_paraview(const Vector<double>& s,
+                                   const unsigned& i,
+                                   double& value) const
+  {
+   if (this->nscalar_paraview()!=PoissonEquations<DIM>::nscalar_paraview())
+    {
+     return false;
+    }
+   value=PoissonEquations<DIM>::interpolated_scalar_poisson_paraview(s,i);
+   return true;
+  }
+
 
  /// Broken copy constructor
  TPoissonElement(const TPoissonElement<DIM,NNODE_1D>& dummy) 
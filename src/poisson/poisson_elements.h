@@ -156,6 +156,29 @@ public:
     }
   }
 
+ /// \short Value of the i-th scalar field (as written by
+ /// scalar_value_paraview(...)) at local coordinate s. Used by the 
+ /// elements that opt in to the direct evaluation of the scalars in the
+ /// binary output (see FiniteElement::interpolated_scalar_paraview(...))
+ double interpolated_scalar_poisson_paraview(const Vector<double>& s,
+                                             const unsigned& i) const
+  {
+#ifdef PARANOID
+   if (i!=0)
+    {
+     std::stringstream error_stream;
+     error_stream 
+      << "Poisson elements only store a single field so i must be 0 rather"
+      << " than " << i << std::endl;
+     throw OomphLibError(
+      error_stream.str(),
+      OOMPH_CURRENT_FUNCTION,
+      OOMPH_EXCEPTION_LOCATION);
+    }
+#endif
+   return this->interpolated_u_poisson(s);
+  }
+
  /// \short Name of the i-th scalar field. Default implementation
  /// returns V1 for the first one, V2 for the second etc. Can (should!) be
  /// overloaded with more meaningful names in specific elements.
@@ -564,6 +587,20 @@ private:
  /// Poisson equations
  QPoissonElement() : QElement<DIM,NNODE_1D>(), PoissonEquations<DIM>()
   {}
+
+ /// \short Evaluate the scalars for the binary paraview output directly
+ /// (unless a derived element outputs a different number of them)
+ bool interpolated_scalar_paraview(const Vector<double>& s,
+                                   const unsigned& i,
+                                   double& value) const
+  {
+   if (this->nscalar_paraview()!=PoissonEquations<DIM>::nscalar_paraview())
+    {
+     return false;
+    }
+   value=PoissonEquations<DIM>::interpolated_scalar_poisson_paraview(s,i);
+   return true;
+  }
  
  /// Broken copy constructor
  QPoissonElement(const QPoissonElement<DIM,NNODE_1D>& dummy) 
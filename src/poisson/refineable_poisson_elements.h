@@ -220,6 +220,16 @@ template <unsigned DIM, unsigned NNODE_1D>
  unsigned nvertex_node() const
   {return QPoissonElement<DIM,NNODE_1D>::nvertex_node();}
 
+ /// \short The unknown is interpolated isoparametrically from its 
+ /// nodal values, so it can be transferred to the sons with a 
+ /// precomputed interpolation matrix during refinement
+ bool get_isoparametric_value_indices(Vector<unsigned>& value_index) const
+  {
+   value_index.resize(1);
+   value_index[0]=this->u_index_poisson();
+   return true;
+  }
+
  /// \short Pointer to the j-th vertex node in the element
  Node* vertex_node_pt(const unsigned& j) const
   {return QPoissonElement<DIM,NNODE_1D>::vertex_node_pt(j);}